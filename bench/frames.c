@@ -0,0 +1,126 @@
+/**
+ * @file
+ * Reference SNMP frames, see frames.h.
+ *
+ * The SNMPv3 frames are addressed to the engine and user of host_port.c.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwip/def.h"
+
+#include "frames.h"
+
+/* SNMPv1 get of sysDescr, sysObjectID and sysUpTime */
+static const u8_t frame_v1_get[] = {
+  0x30, 0x43, 0x02, 0x01, 0x00, 0x04, 0x06, 0x70, 0x75, 0x62, 0x6c, 0x69,
+  0x63, 0xa0, 0x36, 0x02, 0x02, 0x03, 0xe9, 0x02, 0x01, 0x00, 0x02, 0x01,
+  0x00, 0x30, 0x2a, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01,
+  0x01, 0x01, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01,
+  0x02, 0x01, 0x01, 0x02, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b,
+  0x06, 0x01, 0x02, 0x01, 0x01, 0x03, 0x00, 0x05, 0x00,
+};
+
+/* SNMPv2c get of five system scalars */
+static const u8_t frame_v2c_get[] = {
+  0x30, 0x5f, 0x02, 0x01, 0x01, 0x04, 0x06, 0x70, 0x75, 0x62, 0x6c, 0x69,
+  0x63, 0xa0, 0x52, 0x02, 0x02, 0x03, 0xea, 0x02, 0x01, 0x00, 0x02, 0x01,
+  0x00, 0x30, 0x46, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01,
+  0x01, 0x01, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01,
+  0x02, 0x01, 0x01, 0x02, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b,
+  0x06, 0x01, 0x02, 0x01, 0x01, 0x03, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06,
+  0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x04, 0x00, 0x05, 0x00, 0x30,
+  0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x05, 0x00, 0x05,
+  0x00,
+};
+
+/* SNMPv2c getnext walking into the system group */
+static const u8_t frame_v2c_getnext[] = {
+  0x30, 0x41, 0x02, 0x01, 0x01, 0x04, 0x06, 0x70, 0x75, 0x62, 0x6c, 0x69,
+  0x63, 0xa1, 0x34, 0x02, 0x02, 0x03, 0xeb, 0x02, 0x01, 0x00, 0x02, 0x01,
+  0x00, 0x30, 0x28, 0x30, 0x0a, 0x06, 0x06, 0x2b, 0x06, 0x01, 0x02, 0x01,
+  0x01, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01,
+  0x01, 0x01, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01,
+  0x02, 0x01, 0x01, 0x03, 0x00, 0x05, 0x00,
+};
+
+/* SNMPv2c getbulk of ten repetitions from the system group */
+static const u8_t frame_v2c_getbulk[] = {
+  0x30, 0x25, 0x02, 0x01, 0x01, 0x04, 0x06, 0x70, 0x75, 0x62, 0x6c, 0x69,
+  0x63, 0xa5, 0x18, 0x02, 0x02, 0x03, 0xec, 0x02, 0x01, 0x00, 0x02, 0x01,
+  0x0a, 0x30, 0x0c, 0x30, 0x0a, 0x06, 0x06, 0x2b, 0x06, 0x01, 0x02, 0x01,
+  0x01, 0x05, 0x00,
+};
+
+/* SNMPv2c set of sysContact */
+static const u8_t frame_v2c_set[] = {
+  0x30, 0x39, 0x02, 0x01, 0x01, 0x04, 0x07, 0x70, 0x72, 0x69, 0x76, 0x61,
+  0x74, 0x65, 0xa3, 0x2b, 0x02, 0x02, 0x03, 0xed, 0x02, 0x01, 0x00, 0x02,
+  0x01, 0x00, 0x30, 0x1f, 0x30, 0x1d, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02,
+  0x01, 0x01, 0x04, 0x00, 0x04, 0x11, 0x62, 0x65, 0x6e, 0x63, 0x68, 0x40,
+  0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2e, 0x63, 0x6f, 0x6d,
+};
+
+/* SNMPv3 engine discovery, answered with a report */
+static const u8_t frame_v3_discovery[] = {
+  0x30, 0x39, 0x02, 0x01, 0x03, 0x30, 0x0e, 0x02, 0x02, 0x07, 0xd1, 0x02,
+  0x02, 0x05, 0xc0, 0x04, 0x01, 0x04, 0x02, 0x01, 0x03, 0x04, 0x10, 0x30,
+  0x0e, 0x04, 0x00, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x04, 0x00, 0x04,
+  0x00, 0x04, 0x00, 0x30, 0x12, 0x04, 0x00, 0x04, 0x00, 0xa0, 0x0c, 0x02,
+  0x02, 0x07, 0xd1, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x30, 0x00,
+};
+
+/* SNMPv3 noAuthNoPriv get of three system scalars */
+static const u8_t frame_v3_get[] = {
+  0x30, 0x7c, 0x02, 0x01, 0x03, 0x30, 0x0e, 0x02, 0x02, 0x07, 0xd2, 0x02,
+  0x02, 0x05, 0xc0, 0x04, 0x01, 0x04, 0x02, 0x01, 0x03, 0x04, 0x1f, 0x30,
+  0x1d, 0x04, 0x0a, 0x80, 0x00, 0x1f, 0x88, 0x04, 0x62, 0x65, 0x6e, 0x63,
+  0x68, 0x02, 0x01, 0x01, 0x02, 0x01, 0x00, 0x04, 0x05, 0x62, 0x65, 0x6e,
+  0x63, 0x68, 0x04, 0x00, 0x04, 0x00, 0x30, 0x46, 0x04, 0x0a, 0x80, 0x00,
+  0x1f, 0x88, 0x04, 0x62, 0x65, 0x6e, 0x63, 0x68, 0x04, 0x00, 0xa0, 0x36,
+  0x02, 0x02, 0x07, 0xd2, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x30, 0x2a,
+  0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00,
+  0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01,
+  0x02, 0x00, 0x05, 0x00, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02,
+  0x01, 0x01, 0x03, 0x00, 0x05, 0x00,
+};
+
+#define FRAME(name, description) { #name, description, frame_##name, sizeof(frame_##name) }
+
+const struct snmp_host_frame snmp_host_frames[] = {
+  FRAME(v1_get, "SNMPv1 get of sysDescr, sysObjectID and sysUpTime"),
+  FRAME(v2c_get, "SNMPv2c get of five system scalars"),
+  FRAME(v2c_getnext, "SNMPv2c getnext walking into the system group"),
+  FRAME(v2c_getbulk, "SNMPv2c getbulk of ten repetitions from the system group"),
+  FRAME(v2c_set, "SNMPv2c set of sysContact"),
+  FRAME(v3_discovery, "SNMPv3 engine discovery, answered with a report"),
+  FRAME(v3_get, "SNMPv3 noAuthNoPriv get of three system scalars"),
+};
+
+const size_t snmp_host_frame_count = LWIP_ARRAYSIZE(snmp_host_frames);
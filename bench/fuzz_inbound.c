@@ -0,0 +1,88 @@
+/**
+ * @file
+ * Fuzz target feeding arbitrary datagrams to snmp_receive().
+ *
+ * Built with clang and -fsanitize=fuzzer this is a libFuzzer target, which
+ * reports exec/s itself. Otherwise fuzz_main.c provides a small mutating
+ * driver. Besides crashes, every input is checked for leaked pbufs and
+ * heap blocks.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_arena.h"
+#include "lwip/apps/snmp_zephyr.h"
+
+#include "host_port.h"
+
+int LLVMFuzzerTestOneInput(const u8_t *data, size_t size);
+
+static void
+fuzz_check_leaks(void)
+{
+  int pool;
+
+  for (pool = 0; pool < SNMP_MEM_POOL_COUNT; pool++) {
+    struct snmp_mem_stats stats;
+    if (snmp_mem_get_stats((snmp_mem_pool_t)pool, &stats) && (stats.used != 0)) {
+      fprintf(stderr, "fuzz_inbound: %s leaks %u\n", stats.name, (unsigned)stats.used);
+      abort();
+    }
+  }
+}
+
+int
+LLVMFuzzerTestOneInput(const u8_t *data, size_t size)
+{
+  static int initialized;
+  struct pbuf *p;
+
+  if (!initialized) {
+    snmp_host_init();
+    initialized = 1;
+  }
+
+  if ((size == 0) || (size > SNMP_HOST_MAX_FRAME)) {
+    return 0;
+  }
+
+  p = snmp_host_pbuf_from(data, (u16_t)size);
+  if (p == NULL) {
+    return 0;
+  }
+  snmp_receive(NULL, p, &snmp_host_source_ip, 161);
+  pbuf_free(p);
+
+  fuzz_check_leaks();
+  return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file
+ * Stand-alone driver for fuzz_inbound.c when libFuzzer is not available.
+ *
+ * Usage: snmp_fuzz [-t <seconds>] [-s <seed>] <corpus file or dir>...
+ *
+ * Every input of the corpus is run once, then randomly mutated copies are
+ * run until the time is up. The rate is reported as exec/s once per second
+ * and at the end. Inputs that crash can be replayed by passing the file.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/arch.h"
+
+#include "host_port.h"
+
+#define FUZZ_MAX_INPUTS  256
+
+int LLVMFuzzerTestOneInput(const u8_t *data, size_t size);
+
+struct fuzz_input {
+  u8_t *data;
+  size_t size;
+};
+
+static struct fuzz_input fuzz_inputs[FUZZ_MAX_INPUTS];
+static size_t fuzz_num_inputs;
+
+static double
+fuzz_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void
+fuzz_load_file(const char *path)
+{
+  struct fuzz_input *input;
+  FILE *file;
+  long size;
+
+  if (fuzz_num_inputs >= FUZZ_MAX_INPUTS) {
+    return;
+  }
+  file = fopen(path, "rb");
+  if (file == NULL) {
+    return;
+  }
+  input = &fuzz_inputs[fuzz_num_inputs];
+  if ((fseek(file, 0, SEEK_END) == 0) && ((size = ftell(file)) > 0) &&
+      (size <= SNMP_HOST_MAX_FRAME) && (fseek(file, 0, SEEK_SET) == 0)) {
+    input->data = (u8_t *)malloc((size_t)size);
+    if ((input->data != NULL) && (fread(input->data, 1, (size_t)size, file) == (size_t)size)) {
+      input->size = (size_t)size;
+      fuzz_num_inputs++;
+    } else {
+      free(input->data);
+      input->data = NULL;
+    }
+  }
+  fclose(file);
+}
+
+static void
+fuzz_load(const char *path)
+{
+  DIR *dir = opendir(path);
+  struct dirent *entry;
+
+  if (dir == NULL) {
+    fuzz_load_file(path);
+    return;
+  }
+  while ((entry = readdir(dir)) != NULL) {
+    char file_path[1024];
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+    fuzz_load_file(file_path);
+  }
+  closedir(dir);
+}
+
+/** applies a few byte-level mutations, biased towards the BER length octets */
+static size_t
+fuzz_mutate(u8_t *data, size_t size)
+{
+  int count = 1 + rand() % 4;
+
+  while (count-- > 0) {
+    size_t pos = (size_t)rand() % size;
+    switch (rand() % 6) {
+      case 0:
+        data[pos] ^= (u8_t)(1u << (rand() % 8));
+        break;
+      case 1:
+        data[pos] = (u8_t)rand();
+        break;
+      case 2:
+        data[pos] = (u8_t)(data[pos] + 1 - 2 * (rand() % 2));
+        break;
+      case 3:
+        /* interesting values for lengths and integers */
+        {
+          static const u8_t values[] = { 0x00, 0x01, 0x7f, 0x80, 0x81, 0x82, 0xff };
+          data[pos] = values[rand() % sizeof(values)];
+        }
+        break;
+      case 4:
+        if (size > 1) {
+          memmove(&data[pos], &data[pos + 1], size - pos - 1);
+          size--;
+        }
+        break;
+      default:
+        if (size < SNMP_HOST_MAX_FRAME) {
+          memmove(&data[pos + 1], &data[pos], size - pos);
+          data[pos] = (u8_t)rand();
+          size++;
+        }
+        break;
+    }
+  }
+  return size;
+}
+
+int
+main(int argc, char **argv)
+{
+  static u8_t buf[SNMP_HOST_MAX_FRAME];
+  double seconds = 10.0;
+  double start, last_report, now;
+  unsigned long execs = 0, last_execs = 0;
+  unsigned int seed = (unsigned int)time(NULL);
+  size_t i;
+  int arg;
+
+  for (arg = 1; arg < argc; arg++) {
+    if ((strcmp(argv[arg], "-t") == 0) && (arg + 1 < argc)) {
+      seconds = strtod(argv[++arg], NULL);
+    } else if ((strcmp(argv[arg], "-s") == 0) && (arg + 1 < argc)) {
+      seed = (unsigned int)strtoul(argv[++arg], NULL, 10);
+    } else {
+      fuzz_load(argv[arg]);
+    }
+  }
+  if (fuzz_num_inputs == 0) {
+    fprintf(stderr, "usage: %s [-t <seconds>] [-s <seed>] <corpus file or dir>...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < fuzz_num_inputs; i++) {
+    LLVMFuzzerTestOneInput(fuzz_inputs[i].data, fuzz_inputs[i].size);
+  }
+  printf("#%zu inputs replayed, seed %u\n", fuzz_num_inputs, seed);
+
+  srand(seed);
+  start = last_report = now = fuzz_now();
+  while (now - start < seconds) {
+    const struct fuzz_input *input = &fuzz_inputs[(size_t)rand() % fuzz_num_inputs];
+    size_t size;
+
+    memcpy(buf, input->data, input->size);
+    size = fuzz_mutate(buf, input->size);
+    LLVMFuzzerTestOneInput(buf, size);
+    execs++;
+
+    if ((execs & 0x3ff) == 0) {
+      now = fuzz_now();
+      if (now - last_report >= 1.0) {
+        printf("#%lu exec/s: %.0f\n", execs, (double)(execs - last_execs) / (now - last_report));
+        fflush(stdout);
+        last_report = now;
+        last_execs = execs;
+      }
+    }
+  }
+  now = fuzz_now();
+
+  printf("#%lu done, exec/s: %.0f\n", execs, (double)execs / (now - start));
+  return EXIT_SUCCESS;
+}
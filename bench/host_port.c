@@ -0,0 +1,280 @@
+/**
+ * @file
+ * Host port of the SNMP agent, see host_port.h.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_mib2.h"
+#include "lwip/apps/snmpv3.h"
+#include "lwip/apps/snmpv3_user_store.h"
+#include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "lwip/udp.h"
+
+#include "host_port.h"
+
+u8_t  snmp_host_response[1500];
+u16_t snmp_host_response_len;
+u32_t snmp_host_responses;
+u8_t  snmp_host_link_down;
+u32_t snmp_host_time_ms;
+
+const ip_addr_t snmp_host_source_ip = { 0x0100007fUL };
+const ip_addr_t ip_addr_any = { 0 };
+
+/* lwIP objects read by the MIB-2 tables, the host has no interfaces */
+struct stats_ lwip_stats;
+struct netif *netif_list;
+struct netif *netif_default;
+struct udp_pcb *udp_pcbs;
+
+size_t
+zephyr_log(const char *format, ...)
+{
+  /* logging would dominate every measurement */
+  (void)format;
+  return 0;
+}
+
+/* everything runs in one thread */
+void
+snmp_core_lock(void)
+{
+}
+
+void
+snmp_core_unlock(void)
+{
+}
+
+u32_t
+sys_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000) + snmp_host_time_ms;
+}
+
+const char *
+print_oid(size_t oid_len, const u32_t *oid_words)
+{
+  static char buf[128];
+  size_t count = (oid_len <= SNMP_MAX_OBJ_ID_LEN) ? oid_len : SNMP_MAX_OBJ_ID_LEN;
+  size_t index;
+  int length = 0;
+
+  buf[0] = 0;
+  for (index = 0; (index < count) && (length < (int)sizeof(buf)); index++) {
+    length += snprintf(buf + length, sizeof(buf) - length, index ? ".%u" : "%u", (unsigned)oid_words[index]);
+  }
+  return buf;
+}
+
+err_t
+snmp_sendto(void *handle, struct pbuf *p, const ip_addr_t *dst, u16_t port)
+{
+  (void)handle;
+  (void)dst;
+  (void)port;
+
+  if (snmp_host_link_down) {
+    return 0;
+  }
+  snmp_host_response_len = pbuf_copy_partial(p, snmp_host_response, sizeof(snmp_host_response), 0);
+  snmp_host_responses++;
+
+  /* snmp_receive() only checks for a positive result */
+  return (err_t)(snmp_host_response_len > 0);
+}
+
+u8_t
+snmp_get_local_ip_for_dst(void *handle, const ip_addr_t *dst, ip_addr_t *result)
+{
+  (void)handle;
+
+  ip_addr_copy(*result, *dst);
+  return 1;
+}
+
+struct pbuf *
+snmp_host_pbuf_from(const u8_t *frame, u16_t len)
+{
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+
+  if (p != NULL) {
+    if (pbuf_take_at(p, frame, len, 0) != ERR_OK) {
+      pbuf_free(p);
+      p = NULL;
+    }
+  }
+  return p;
+}
+
+void
+snmp_host_init(void)
+{
+  static const struct snmp_obj_id enterprise = { 7, { 1, 3, 6, 1, 4, 1, 26381 } };
+  static u8_t syscontact[64] = "root@localhost";
+  static u16_t syscontact_len = 14;
+
+  mem_init();
+  snmp_set_device_enterprise_oid(&enterprise);
+  snmp_mib2_set_syscontact(syscontact, &syscontact_len, sizeof(syscontact));
+#if LWIP_SNMP_V3 && SNMP_V3_USER_STORE
+  snmpv3_user_store_add(NULL, 0, SNMP_HOST_USER, SNMP_V3_AUTH_ALGO_INVAL, NULL,
+                        SNMP_V3_PRIV_ALGO_INVAL, NULL, SNMP_V3_USER_STORAGETYPE_READONLY);
+#endif
+}
+
+#if LWIP_SNMP_V3
+
+static u32_t engine_boots = 1;
+
+void
+snmpv3_get_engine_id(const char **id, u8_t *len)
+{
+  *id  = SNMP_HOST_ENGINE_ID;
+  *len = SNMP_HOST_ENGINE_ID_LEN;
+}
+
+err_t
+snmpv3_set_engine_id(const char *id, u8_t len)
+{
+  (void)id;
+  (void)len;
+  return ERR_VAL;
+}
+
+u32_t
+snmpv3_get_engine_boots(void)
+{
+  return engine_boots;
+}
+
+void
+snmpv3_set_engine_boots(u32_t boots)
+{
+  engine_boots = boots;
+}
+
+u32_t
+snmpv3_get_engine_time(void)
+{
+  return sys_now() / 1000;
+}
+
+void
+snmpv3_reset_engine_time(void)
+{
+}
+
+#if SNMP_V3_USER_STORE
+
+err_t
+snmpv3_get_user(const char *username, snmpv3_auth_algo_t *auth_algo, u8_t *auth_key, snmpv3_priv_algo_t *priv_algo, u8_t *priv_key)
+{
+  return snmpv3_user_store_get_user(username, auth_algo, auth_key, priv_algo, priv_key);
+}
+
+u8_t
+snmpv3_get_amount_of_users(void)
+{
+  return snmpv3_user_store_get_amount_of_users();
+}
+
+err_t
+snmpv3_get_user_storagetype(const char *username, snmpv3_user_storagetype_t *storagetype)
+{
+  return snmpv3_user_store_get_user_storagetype(username, storagetype);
+}
+
+err_t
+snmpv3_get_username(char *username, u8_t index)
+{
+  return snmpv3_user_store_get_username(username, index);
+}
+
+#else /* SNMP_V3_USER_STORE */
+
+err_t
+snmpv3_get_user(const char *username, snmpv3_auth_algo_t *auth_algo, u8_t *auth_key, snmpv3_priv_algo_t *priv_algo, u8_t *priv_key)
+{
+  (void)auth_key;
+  (void)priv_key;
+
+  if (strcmp(username, SNMP_HOST_USER) != 0) {
+    return ERR_VAL;
+  }
+  if (auth_algo != NULL) {
+    *auth_algo = SNMP_V3_AUTH_ALGO_INVAL;
+  }
+  if (priv_algo != NULL) {
+    *priv_algo = SNMP_V3_PRIV_ALGO_INVAL;
+  }
+  return ERR_OK;
+}
+
+u8_t
+snmpv3_get_amount_of_users(void)
+{
+  return 1;
+}
+
+err_t
+snmpv3_get_user_storagetype(const char *username, snmpv3_user_storagetype_t *storagetype)
+{
+  if (strcmp(username, SNMP_HOST_USER) != 0) {
+    return ERR_VAL;
+  }
+  *storagetype = SNMP_V3_USER_STORAGETYPE_READONLY;
+  return ERR_OK;
+}
+
+err_t
+snmpv3_get_username(char *username, u8_t index)
+{
+  if (index != 0) {
+    return ERR_VAL;
+  }
+  strcpy(username, SNMP_HOST_USER);
+  return ERR_OK;
+}
+
+#endif /* SNMP_V3_USER_STORE */
+
+#endif /* LWIP_SNMP_V3 */
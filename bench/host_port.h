@@ -0,0 +1,88 @@
+/**
+ * @file
+ * Host port of the SNMP agent used by the benchmarks and the fuzz target.
+ *
+ * It stands in for snmp_zephyr.c: log output is dropped, responses passed to
+ * snmp_sendto() are captured in memory, and a fixed SNMPv3 engine with one
+ * noAuthNoPriv user ("bench") is provided. The static functions of
+ * snmp_msg.c that make up a request are exported by snmp_msg_host.c.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef SNMP_BENCH_HOST_PORT_H
+#define SNMP_BENCH_HOST_PORT_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+
+#include "snmp_msg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** SNMPv3 engine ID of the host agent */
+#define SNMP_HOST_ENGINE_ID      "\x80\x00\x1f\x88\x04" "bench"
+#define SNMP_HOST_ENGINE_ID_LEN  10
+/** name of the noAuthNoPriv SNMPv3 user */
+#define SNMP_HOST_USER           "bench"
+/** largest datagram fed to the agent */
+#define SNMP_HOST_MAX_FRAME      1472
+
+/** contents and length of the last response passed to snmp_sendto() */
+extern u8_t  snmp_host_response[1500];
+extern u16_t snmp_host_response_len;
+/** number of responses passed to snmp_sendto() */
+extern u32_t snmp_host_responses;
+/** while set, snmp_sendto() fails as with the link down */
+extern u8_t  snmp_host_link_down;
+/** added to sys_now(), lets time pass for the timers of the agent */
+extern u32_t snmp_host_time_ms;
+
+/** source address used for all requests */
+extern const ip_addr_t snmp_host_source_ip;
+
+void snmp_host_init(void);
+/** copies a frame into a PBUF_RAM pbuf, as the receive path of snmp_zephyr.c does */
+struct pbuf *snmp_host_pbuf_from(const u8_t *frame, u16_t len);
+
+/* the steps of snmp_receive(), exported from snmp_msg.c */
+void  snmp_host_request_init(struct snmp_request *request, struct pbuf *p);
+err_t snmp_host_parse_inbound_frame(struct snmp_request *request);
+err_t snmp_host_prepare_outbound_frame(struct snmp_request *request);
+err_t snmp_host_process_request(struct snmp_request *request);
+err_t snmp_host_complete_outbound_frame(struct snmp_request *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNMP_BENCH_HOST_PORT_H */
@@ -0,0 +1,206 @@
+/**
+ * @file
+ * Host replacement for the few kernel services used by snmp_zephyr_mem.c,
+ * snmpv3_user_store.c and snmp_trap_queue.c, so the benchmark runs the same
+ * allocators, user store and trap queue as the target. Everything runs in
+ * one thread, so the spinlock, the mutex and the semaphore are no-ops, and
+ * threads are never started: the benchmark drains the trap queue with
+ * snmp_trap_queue_flush().
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef SNMP_BENCH_ZEPHYR_KERNEL_H
+#define SNMP_BENCH_ZEPHYR_KERNEL_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define __aligned(x)                     __attribute__((aligned(x)))
+#define BUILD_ASSERT(cond, msg)          _Static_assert(cond, msg)
+#define ARRAY_SIZE(array)                (sizeof(array) / sizeof((array)[0]))
+#define ARG_UNUSED(x)                    (void)(x)
+
+typedef struct {
+  int64_t ticks;
+} k_timeout_t;
+
+#define K_NO_WAIT                        ((k_timeout_t){ 0 })
+
+struct k_spinlock {
+  int unused;
+};
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t
+k_spin_lock(struct k_spinlock *lock)
+{
+  (void)lock;
+  return 0;
+}
+
+static inline void
+k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key)
+{
+  (void)lock;
+  (void)key;
+}
+
+#define K_FOREVER                        ((k_timeout_t){ -1 })
+
+struct k_mutex {
+  int unused;
+};
+
+#define K_MUTEX_DEFINE(name)             struct k_mutex name = { 0 }
+
+static inline int
+k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+  (void)mutex;
+  (void)timeout;
+  return 0;
+}
+
+static inline int
+k_mutex_unlock(struct k_mutex *mutex)
+{
+  (void)mutex;
+  return 0;
+}
+
+struct k_sem {
+  int unused;
+};
+
+#define K_SEM_DEFINE(name, initial_count, count_limit) struct k_sem name = { 0 }
+
+static inline void
+k_sem_give(struct k_sem *sem)
+{
+  (void)sem;
+}
+
+static inline int
+k_sem_take(struct k_sem *sem, k_timeout_t timeout)
+{
+  (void)sem;
+  (void)timeout;
+  return -EAGAIN;
+}
+
+typedef void (*k_thread_entry_t)(void *p1, void *p2, void *p3);
+
+/* keeps the entry referenced, the thread is not run */
+#define K_THREAD_DEFINE(name, stack_size, entry, p1, p2, p3, prio, options, delay) \
+  const k_thread_entry_t name = (entry)
+
+#define K_MSEC(ms)                       ((k_timeout_t){ (ms) })
+
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+  k_work_handler_t handler;
+};
+
+struct k_work_delayable {
+  struct k_work work;
+};
+
+#define K_WORK_DELAYABLE_DEFINE(name, work_handler) \
+  struct k_work_delayable name = { { (work_handler) } }
+
+/* the work is not run, the bench polls instead */
+static inline int
+k_work_schedule(struct k_work_delayable *dwork, k_timeout_t delay)
+{
+  (void)dwork;
+  (void)delay;
+  return 0;
+}
+
+static inline int
+k_work_reschedule(struct k_work_delayable *dwork, k_timeout_t delay)
+{
+  (void)dwork;
+  (void)delay;
+  return 0;
+}
+
+struct k_mem_slab {
+  char *buffer;
+  size_t block_size;
+  uint32_t num_blocks;
+  uint32_t num_used;
+  void *free_list;
+  bool ready;
+};
+
+#define K_MEM_SLAB_DEFINE_STATIC(name, slab_block_size, slab_num_blocks, slab_align) \
+  static char __aligned(slab_align) _k_mem_slab_buf_##name[(slab_block_size) * (slab_num_blocks)]; \
+  static struct k_mem_slab name = { _k_mem_slab_buf_##name, (slab_block_size), (slab_num_blocks), 0, NULL, false }
+
+static inline int
+k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, k_timeout_t timeout)
+{
+  (void)timeout;
+
+  if (!slab->ready) {
+    uint32_t index;
+    for (index = 0; index < slab->num_blocks; index++) {
+      void **block = (void **)(slab->buffer + index * slab->block_size);
+      *block = slab->free_list;
+      slab->free_list = block;
+    }
+    slab->ready = true;
+  }
+
+  if (slab->free_list == NULL) {
+    *mem = NULL;
+    return -ENOMEM;
+  }
+
+  *mem = slab->free_list;
+  slab->free_list = *(void **)slab->free_list;
+  slab->num_used++;
+  return 0;
+}
+
+static inline void
+k_mem_slab_free(struct k_mem_slab *slab, void *mem)
+{
+  *(void **)mem = slab->free_list;
+  slab->free_list = mem;
+  slab->num_used--;
+}
+
+#endif /* SNMP_BENCH_ZEPHYR_KERNEL_H */
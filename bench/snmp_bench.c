@@ -0,0 +1,1177 @@
+/**
+ * @file
+ * Host benchmarks of the SNMP codec and of complete requests.
+ *
+ * Usage: snmp_bench [-t <ms per benchmark>] [-f <name filter>] [-c <corpus dir>]
+ *
+ * The codec benchmarks encode and decode TLV headers, integers, OIDs and
+ * Counter64 values through a snmp_pbuf_stream. The frame benchmarks run the
+ * reference frames of frames.c through snmp_parse_inbound_frame(),
+ * snmp_complete_outbound_frame() and the whole of snmp_receive(). The trap
+ * benchmarks send a notification to one and to all SNMP_TRAP_DESTINATIONS
+ * with snmp_send_trap(), to an SNMPv3 target with SNMP_V3_NOTIFICATIONS,
+ * through the spool of a failed send, from a template of
+ * snmp_trap_template_register(), whose traps are also compared with those
+ * of snmp_send_trap(), and queue it through snmp_trap_post().
+ * Results are reported in nanoseconds per operation.
+ *
+ * With -c, the reference frames are written to the given directory as
+ * fuzzing seeds and nothing is measured.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_arena.h"
+#include "lwip/apps/snmp_inform.h"
+#include "lwip/apps/snmp_mib2.h"
+#include "lwip/apps/snmp_notification.h"
+#include "lwip/apps/snmp_notify_filter.h"
+#include "lwip/apps/snmp_scalar.h"
+#include "lwip/apps/snmp_target.h"
+#include "lwip/apps/snmp_trap_limit.h"
+#include "lwip/apps/snmp_trap_queue.h"
+#include "lwip/apps/snmp_trap_spool.h"
+#include "lwip/apps/snmp_trap_template.h"
+#include "lwip/apps/snmp_zephyr.h"
+
+#include "snmp_asn1.h"
+#include "snmp_pbuf_stream.h"
+
+#include "host_port.h"
+#include "frames.h"
+
+/* number of values handled by one call of a codec benchmark */
+#define BENCH_ITEMS  32
+
+typedef u32_t (*bench_fn)(const void *arg);
+
+static u32_t bench_min_ms = 200;
+static const char *bench_filter;
+static volatile u32_t bench_sink;
+
+static u64_t
+bench_now_ns(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u64_t)now.tv_sec * 1000000000ULL + (u64_t)now.tv_nsec;
+}
+
+static void
+bench_check(err_t err, const char *what)
+{
+  if (err != ERR_OK) {
+    fprintf(stderr, "snmp_bench: %s failed (%d)\n", what, (int)err);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/** reads the type and length of the TLV at *pos of a message and moves
+ * *pos to its value */
+static u8_t
+bench_tlv(const u8_t *msg, u16_t *pos, u16_t *len)
+{
+  u8_t type = msg[(*pos)++];
+  u8_t octets = msg[(*pos)++];
+
+  *len = octets;
+  if (octets & 0x80) {
+    octets &= 0x7F;
+    *len = 0;
+    while (octets-- > 0) {
+      *len = (u16_t)((*len << 8) | msg[(*pos)++]);
+    }
+  }
+  return type;
+}
+
+/**
+ * Runs 'fn' until bench_min_ms have passed and prints the time taken per
+ * operation. 'ops' is the number of operations done by one call of 'fn'.
+ * If 'fn' only times part of its work, it adds that time in ns to 'timed',
+ * which then replaces the wall time of the loop.
+ */
+static void
+bench_run(const char *group, const char *name, bench_fn fn, const void *arg, u32_t ops, u64_t *timed)
+{
+  u64_t start, elapsed;
+  u64_t calls = 0;
+  u32_t batch = 1;
+  char full_name[64];
+
+  snprintf(full_name, sizeof(full_name), "%s/%s", group, name);
+  if ((bench_filter != NULL) && (strstr(full_name, bench_filter) == NULL)) {
+    return;
+  }
+
+  /* warm up caches and the value cache */
+  bench_sink += fn(arg);
+
+  if (timed != NULL) {
+    *timed = 0;
+  }
+  start = bench_now_ns();
+  do {
+    u32_t i;
+    for (i = 0; i < batch; i++) {
+      bench_sink += fn(arg);
+    }
+    calls += batch;
+    if (batch < 4096) {
+      batch *= 2;
+    }
+    elapsed = bench_now_ns() - start;
+  } while (elapsed < (u64_t)bench_min_ms * 1000000ULL);
+
+  if (timed != NULL) {
+    elapsed = *timed;
+  }
+
+  printf("%-32s %10.1f ns/op %12.0f op/s\n", full_name,
+         (double)elapsed / (double)(calls * ops),
+         (double)(calls * ops) * 1e9 / (double)elapsed);
+}
+
+/*
+ * Codec benchmarks
+ */
+
+static struct pbuf *codec_pbuf;
+
+static const s32_t codec_ints[] = {
+  0, 1, 127, 128, -1, -129, 32767, 100000, -8388608, 2147483647, -2147483647 - 1, 4711
+};
+
+static const u32_t codec_oid_short[] = { 1, 3, 6, 1, 2, 1, 1, 3, 0 };
+static const u32_t codec_oid_long[]  = { 1, 3, 6, 1, 4, 1, 26381, 1, 2, 16384, 3, 2097152, 4, 268435456, 5, 4294967295UL };
+
+struct codec_oid {
+  const u32_t *oid;
+  u16_t len;
+};
+
+static const struct codec_oid codec_oids[] = {
+  { codec_oid_short, LWIP_ARRAYSIZE(codec_oid_short) },
+  { codec_oid_long,  LWIP_ARRAYSIZE(codec_oid_long) }
+};
+
+static const u64_t codec_counters[] = {
+  0, 1, 255, 65536, 4294967296ULL, 1099511627776ULL, 0x7fffffffffffffffULL, 0xffffffffffffffffULL
+};
+
+static void
+codec_stream(struct snmp_pbuf_stream *stream)
+{
+  bench_check(snmp_pbuf_stream_init(stream, codec_pbuf, 0, codec_pbuf->tot_len), "snmp_pbuf_stream_init");
+}
+
+static u32_t
+bench_tlv_encode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    u16_t value_len = (u16_t)((i & 1) ? 300 : 20);
+    u8_t len_len;
+    snmp_asn1_enc_length_cnt(value_len, &len_len);
+    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_SEQUENCE, len_len, value_len);
+    bench_check(snmp_ans1_enc_tlv(&stream, &tlv), "snmp_ans1_enc_tlv");
+  }
+  return stream.offset;
+}
+
+static u32_t
+bench_tlv_decode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t sum = 0;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    bench_check(snmp_asn1_dec_tlv(&stream, &tlv), "snmp_asn1_dec_tlv");
+    sum += tlv.value_len;
+  }
+  return sum;
+}
+
+static u32_t
+bench_int_encode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    s32_t value = codec_ints[i % LWIP_ARRAYSIZE(codec_ints)];
+    u16_t value_len;
+    snmp_asn1_enc_s32t_cnt(value, &value_len);
+    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_INTEGER, 0, value_len);
+    bench_check(snmp_ans1_enc_tlv(&stream, &tlv), "snmp_ans1_enc_tlv");
+    bench_check(snmp_asn1_enc_s32t(&stream, value_len, value), "snmp_asn1_enc_s32t");
+  }
+  return stream.offset;
+}
+
+static u32_t
+bench_int_decode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t sum = 0;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    s32_t value;
+    bench_check(snmp_asn1_dec_tlv(&stream, &tlv), "snmp_asn1_dec_tlv");
+    bench_check(snmp_asn1_dec_s32t(&stream, tlv.value_len, &value), "snmp_asn1_dec_s32t");
+    sum += (u32_t)value;
+  }
+  return sum;
+}
+
+static u32_t
+bench_oid_encode(const void *arg)
+{
+  const struct codec_oid *oid = (const struct codec_oid *)arg;
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t i;
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    u16_t value_len;
+    snmp_asn1_enc_oid_cnt(oid->oid, oid->len, &value_len);
+    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OBJECT_ID, 0, value_len);
+    bench_check(snmp_ans1_enc_tlv(&stream, &tlv), "snmp_ans1_enc_tlv");
+    bench_check(snmp_asn1_enc_oid(&stream, oid->oid, oid->len), "snmp_asn1_enc_oid");
+  }
+  return stream.offset;
+}
+
+static u32_t
+bench_oid_decode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t oid[SNMP_MAX_OBJ_ID_LEN];
+  u32_t sum = 0;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    u8_t oid_len;
+    bench_check(snmp_asn1_dec_tlv(&stream, &tlv), "snmp_asn1_dec_tlv");
+    bench_check(snmp_asn1_dec_oid(&stream, tlv.value_len, oid, &oid_len, SNMP_MAX_OBJ_ID_LEN), "snmp_asn1_dec_oid");
+    sum += oid[oid_len - 1];
+  }
+  return sum;
+}
+
+static u32_t
+bench_counter64_encode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    u64_t value = codec_counters[i % LWIP_ARRAYSIZE(codec_counters)];
+    u16_t value_len;
+    snmp_asn1_enc_u64t_cnt(value, &value_len);
+    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_COUNTER64, 0, value_len);
+    bench_check(snmp_ans1_enc_tlv(&stream, &tlv), "snmp_ans1_enc_tlv");
+    bench_check(snmp_asn1_enc_u64t(&stream, value_len, value), "snmp_asn1_enc_u64t");
+  }
+  return stream.offset;
+}
+
+static u32_t
+bench_counter64_decode(const void *arg)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u32_t sum = 0;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  codec_stream(&stream);
+  for (i = 0; i < BENCH_ITEMS; i++) {
+    u64_t value;
+    bench_check(snmp_asn1_dec_tlv(&stream, &tlv), "snmp_asn1_dec_tlv");
+    bench_check(snmp_asn1_dec_u64t(&stream, tlv.value_len, &value), "snmp_asn1_dec_u64t");
+    sum += (u32_t)value;
+  }
+  return sum;
+}
+
+/** runs an encoder once so the matching decoder finds its input in codec_pbuf */
+static void
+codec_prepare(bench_fn encoder, const void *arg)
+{
+  memset(codec_pbuf->payload, 0, codec_pbuf->len);
+  encoder(arg);
+}
+
+static void
+bench_codec(void)
+{
+  u32_t i;
+
+  codec_pbuf = pbuf_alloc(PBUF_TRANSPORT, 1024, PBUF_RAM);
+  if (codec_pbuf == NULL) {
+    fprintf(stderr, "snmp_bench: no pbuf for the codec benchmarks\n");
+    exit(EXIT_FAILURE);
+  }
+
+  bench_run("codec", "tlv_encode", bench_tlv_encode, NULL, BENCH_ITEMS, NULL);
+  codec_prepare(bench_tlv_encode, NULL);
+  bench_run("codec", "tlv_decode", bench_tlv_decode, NULL, BENCH_ITEMS, NULL);
+
+  bench_run("codec", "int_encode", bench_int_encode, NULL, BENCH_ITEMS, NULL);
+  codec_prepare(bench_int_encode, NULL);
+  bench_run("codec", "int_decode", bench_int_decode, NULL, BENCH_ITEMS, NULL);
+
+  for (i = 0; i < LWIP_ARRAYSIZE(codec_oids); i++) {
+    const char *encode = (i == 0) ? "oid_encode_short" : "oid_encode_long";
+    const char *decode = (i == 0) ? "oid_decode_short" : "oid_decode_long";
+    bench_run("codec", encode, bench_oid_encode, &codec_oids[i], BENCH_ITEMS, NULL);
+    codec_prepare(bench_oid_encode, &codec_oids[i]);
+    bench_run("codec", decode, bench_oid_decode, NULL, BENCH_ITEMS, NULL);
+  }
+
+  bench_run("codec", "counter64_encode", bench_counter64_encode, NULL, BENCH_ITEMS, NULL);
+  codec_prepare(bench_counter64_encode, NULL);
+  bench_run("codec", "counter64_decode", bench_counter64_decode, NULL, BENCH_ITEMS, NULL);
+
+  pbuf_free(codec_pbuf);
+  codec_pbuf = NULL;
+}
+
+/*
+ * Frame benchmarks
+ */
+
+static u64_t frame_timed_ns;
+
+struct frame_arg {
+  const struct snmp_host_frame *frame;
+  struct pbuf *p;
+};
+
+/** one request up to, but not including, snmp_complete_outbound_frame() */
+static struct snmp_request *
+frame_request(const struct frame_arg *arg)
+{
+  struct snmp_request *request = (struct snmp_request *)snmp_arena_alloc(sizeof(*request));
+
+  if (request == NULL) {
+    fprintf(stderr, "snmp_bench: SNMP_ARENA_SIZE too small\n");
+    exit(EXIT_FAILURE);
+  }
+  snmp_host_request_init(request, arg->p);
+  return request;
+}
+
+static u32_t
+bench_frame_parse(const void *varg)
+{
+  const struct frame_arg *arg = (const struct frame_arg *)varg;
+  struct snmp_request *request = frame_request(arg);
+  u32_t result;
+
+  bench_check(snmp_host_parse_inbound_frame(request), "snmp_parse_inbound_frame");
+  result = request->request_id;
+  snmp_arena_reset();
+  return result;
+}
+
+static u32_t
+bench_frame_complete(const void *varg)
+{
+  const struct frame_arg *arg = (const struct frame_arg *)varg;
+  struct snmp_request *request = frame_request(arg);
+  u64_t start;
+  u32_t result;
+
+  bench_check(snmp_host_parse_inbound_frame(request), "snmp_parse_inbound_frame");
+  bench_check(snmp_host_prepare_outbound_frame(request), "snmp_prepare_outbound_frame");
+  bench_check(snmp_host_process_request(request), "processing");
+
+  start = bench_now_ns();
+  bench_check(snmp_host_complete_outbound_frame(request), "snmp_complete_outbound_frame");
+  frame_timed_ns += bench_now_ns() - start;
+
+  result = request->outbound_pbuf->tot_len;
+  pbuf_free(request->outbound_pbuf);
+  snmp_arena_reset();
+  return result;
+}
+
+static u32_t
+bench_frame_receive(const void *varg)
+{
+  const struct frame_arg *arg = (const struct frame_arg *)varg;
+
+  snmp_receive(NULL, arg->p, &snmp_host_source_ip, 161);
+  return snmp_host_response_len;
+}
+
+static void
+bench_frames(void)
+{
+  size_t i;
+
+  for (i = 0; i < snmp_host_frame_count; i++) {
+    struct frame_arg arg;
+    u32_t responses = snmp_host_responses;
+
+    arg.frame = &snmp_host_frames[i];
+    arg.p     = snmp_host_pbuf_from(arg.frame->data, arg.frame->len);
+    if (arg.p == NULL) {
+      fprintf(stderr, "snmp_bench: no pbuf for frame %s\n", arg.frame->name);
+      exit(EXIT_FAILURE);
+    }
+
+    /* every reference frame must be answered */
+    snmp_receive(NULL, arg.p, &snmp_host_source_ip, 161);
+    if (snmp_host_responses == responses) {
+      fprintf(stderr, "snmp_bench: frame %s was not answered\n", arg.frame->name);
+      exit(EXIT_FAILURE);
+    }
+    printf("# %-14s %4u -> %4u bytes  %s\n", arg.frame->name, arg.frame->len,
+           snmp_host_response_len, arg.frame->description);
+
+    bench_run("parse", arg.frame->name, bench_frame_parse, &arg, 1, NULL);
+    /* discovery and other reports are completed outside of the processing steps */
+    if (strcmp(arg.frame->name, "v3_discovery") != 0) {
+      frame_timed_ns = 0;
+      bench_run("complete", arg.frame->name, bench_frame_complete, &arg, 1, &frame_timed_ns);
+    }
+    bench_run("receive", arg.frame->name, bench_frame_receive, &arg, 1, NULL);
+
+    pbuf_free(arg.p);
+  }
+}
+
+/*
+ * Trap benchmarks
+ */
+
+static u64_t trap_timed_ns;
+
+static const struct snmp_obj_id trap_oid = { 10, { 1, 3, 6, 1, 4, 1, 26381, 2, 0, 1 } };
+
+static u32_t trap_alarm_id = 17;
+static u8_t trap_alarm_text[] = "temperature above limit";
+static u32_t trap_alarm_severity = 4;
+
+static struct snmp_varbind trap_varbinds[3];
+static ip_addr_t trap_dst_ip;
+
+static void
+trap_prepare(void)
+{
+  static const u32_t columns[] = { 1, 2, 3 };
+  size_t i;
+
+  for (i = 0; i < LWIP_ARRAYSIZE(trap_varbinds); i++) {
+    struct snmp_varbind *vb = &trap_varbinds[i];
+    static const u32_t base[] = { 1, 3, 6, 1, 4, 1, 26381, 2, 1, 1 };
+
+    memset(vb, 0, sizeof(*vb));
+    vb->next = (i + 1 < LWIP_ARRAYSIZE(trap_varbinds)) ? &trap_varbinds[i + 1] : NULL;
+    vb->prev = (i > 0) ? &trap_varbinds[i - 1] : NULL;
+    snmp_oid_assign(&vb->oid, base, LWIP_ARRAYSIZE(base));
+    snmp_oid_append(&vb->oid, &columns[i], 1);
+    snmp_oid_append(&vb->oid, &trap_alarm_id, 1);
+  }
+  trap_varbinds[0].type = SNMP_ASN1_TYPE_UNSIGNED32;
+  trap_varbinds[0].value_len = sizeof(trap_alarm_id);
+  trap_varbinds[0].object_value = &trap_alarm_id;
+  trap_varbinds[1].type = SNMP_ASN1_TYPE_OCTET_STRING;
+  trap_varbinds[1].value_len = sizeof(trap_alarm_text) - 1;
+  trap_varbinds[1].object_value = trap_alarm_text;
+  trap_varbinds[2].type = SNMP_ASN1_TYPE_INTEGER;
+  trap_varbinds[2].value_len = sizeof(trap_alarm_severity);
+  trap_varbinds[2].object_value = &trap_alarm_severity;
+
+  ip_addr_set_ip4_u32_val(trap_dst_ip, PP_HTONL(0x7f000001UL));
+  snmp_trap_dst_ip_set(0, &trap_dst_ip);
+  snmp_trap_dst_enable(0, 1);
+  snmp_set_default_trap_version(SNMP_VERSION_2c);
+}
+
+static u32_t
+bench_trap_send(const void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_send_trap");
+  return snmp_host_response_len;
+}
+
+/** fills the queue, timing the posts only, and drains it */
+static u32_t
+bench_trap_post(const void *arg)
+{
+  u64_t start;
+  u32_t i;
+  LWIP_UNUSED_ARG(arg);
+
+  start = bench_now_ns();
+  for (i = 0; i < SNMP_TRAP_QUEUE_DEPTH; i++) {
+    bench_check(snmp_trap_post(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_trap_post");
+  }
+  trap_timed_ns += bench_now_ns() - start;
+
+  snmp_trap_queue_flush();
+  return snmp_host_response_len;
+}
+
+/** posts to a full queue, each post drops the oldest notification */
+static u32_t
+bench_trap_post_full(const void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  bench_check(snmp_trap_post(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_trap_post");
+  return trap_alarm_id;
+}
+
+#if SNMP_TRAP_SPOOL
+/** a trap is spooled with the link down, the next one finds the link up
+ * again and the spooled one is replayed */
+static u32_t
+bench_trap_spool(const void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  snmp_host_link_down = 1;
+  (void)snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds);
+  snmp_host_link_down = 0;
+  bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_send_trap");
+  bench_check(snmp_trap_spool_poll(), "snmp_trap_spool_poll");
+  return snmp_host_response_len;
+}
+#endif
+
+/** sends the varbinds of bench_trap_send() from a template, with new values */
+static u32_t
+bench_trap_template(const void *arg)
+{
+  union snmp_variant_value values[3];
+
+  values[0].u32 = trap_alarm_id;
+  values[1].const_ptr = trap_alarm_text;
+  values[2].s32 = (s32_t)trap_alarm_severity;
+  bench_check(snmp_send_trap_template(*(const u8_t *)arg, values), "snmp_send_trap_template");
+  return snmp_host_response_len;
+}
+
+/** sends the varbinds of bench_trap_send() to the SNMPv2c targets only */
+static u32_t
+bench_trap_notification(const void *arg)
+{
+  struct snmp_notification notification;
+  LWIP_UNUSED_ARG(arg);
+
+  snmp_notification_init(&notification);
+  notification.eoid = &trap_oid;
+  notification.generic_trap = SNMP_GENTRAP_ENTERPRISE_SPECIFIC;
+  notification.specific_trap = 1;
+  notification.varbinds = trap_varbinds;
+  notification.version = SNMP_VERSION_2c;
+  bench_check(snmp_send_notification(&notification, NULL), "snmp_send_notification");
+  return snmp_host_response_len;
+}
+
+/** sends an INFORM, keeping it for retransmission, and acknowledges it */
+static u32_t
+bench_inform_ack(const void *arg)
+{
+  s32_t request_id;
+  LWIP_UNUSED_ARG(arg);
+
+  bench_check(snmp_send_inform(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds, &request_id), "snmp_send_inform");
+  snmp_inform_response(request_id, &trap_dst_ip);
+  return snmp_inform_pending();
+}
+
+/** moves *pos behind the request ID of an SNMPv2c trap, returns the
+ * position of its PDU and sets *start to the one of the version */
+static u16_t
+trap_skip_request_id(const u8_t *msg, u16_t *start, u16_t *pos)
+{
+  u16_t pdu;
+  u16_t len;
+
+  (void)bench_tlv(msg, pos, &len);              /* message */
+  *start = *pos;
+  (void)bench_tlv(msg, pos, &len); *pos += len; /* version */
+  (void)bench_tlv(msg, pos, &len); *pos += len; /* community */
+  pdu = *pos;
+  (void)bench_tlv(msg, pos, &len);              /* trap PDU */
+  (void)bench_tlv(msg, pos, &len); *pos += len; /* request-id */
+  return pdu;
+}
+
+/** exits unless the last trap equals 'sent', but for the request ID of an
+ * SNMPv2c trap */
+static void
+trap_template_compare(const u8_t *sent, u16_t sent_len, u8_t version, const char *what)
+{
+  const u8_t *tpl = snmp_host_response;
+  u16_t sent_pos = 0;
+  u16_t tpl_pos = 0;
+  u16_t sent_start;
+  u16_t tpl_start;
+  u16_t sent_pdu;
+  u16_t tpl_pdu;
+  int same;
+
+  if (version == SNMP_VERSION_1) {
+    same = (sent_len == snmp_host_response_len) && (memcmp(sent, tpl, sent_len) == 0);
+  } else {
+    sent_pdu = trap_skip_request_id(sent, &sent_start, &sent_pos);
+    tpl_pdu = trap_skip_request_id(tpl, &tpl_start, &tpl_pos);
+    /* version and community, the PDU type and everything behind the request-id */
+    same = (sent_pdu - sent_start == tpl_pdu - tpl_start) &&
+           (memcmp(&sent[sent_start], &tpl[tpl_start], sent_pdu - sent_start) == 0) &&
+           (sent[sent_pdu] == tpl[tpl_pdu]) && (sent_len - sent_pos == snmp_host_response_len - tpl_pos) &&
+           (memcmp(&sent[sent_pos], &tpl[tpl_pos], sent_len - sent_pos) == 0);
+  }
+  if (!same) {
+    fprintf(stderr, "snmp_bench: %s differs from snmp_send_trap()\n", what);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/** sends INTEGER and Unsigned32 values of every encoded length with
+ * snmp_send_trap() and from a template, whose layout changes with them,
+ * and compares the traps */
+static void
+bench_trap_template_check(void)
+{
+  static const s32_t values[] = { 0, 127, 128, 70000, (s32_t)0xFFFFFFFFUL, -129, INT_MIN, INT_MAX };
+  static const u8_t versions[] = { SNMP_VERSION_1, SNMP_VERSION_2c };
+  static const u32_t base[] = { 1, 3, 6, 1, 4, 1, 26381, 2, 2 };
+  union snmp_variant_value template_values[2];
+  struct snmp_varbind varbinds[2];
+  u8_t sent[sizeof(snmp_host_response)];
+  u16_t sent_len;
+  s32_t integer = 0;
+  u32_t unsigned32 = 0;
+  u32_t tick;
+  u8_t template_id;
+  char what[48];
+  size_t v;
+  size_t i;
+
+  memset(varbinds, 0, sizeof(varbinds));
+  for (i = 0; i < LWIP_ARRAYSIZE(varbinds); i++) {
+    u32_t column = (u32_t)i + 1;
+
+    snmp_oid_assign(&varbinds[i].oid, base, LWIP_ARRAYSIZE(base));
+    snmp_oid_append(&varbinds[i].oid, &column, 1);
+  }
+  varbinds[0].next = &varbinds[1];
+  varbinds[1].prev = &varbinds[0];
+  varbinds[0].type = SNMP_ASN1_TYPE_INTEGER;
+  varbinds[0].value_len = sizeof(integer);
+  varbinds[0].object_value = &integer;
+  varbinds[1].type = SNMP_ASN1_TYPE_UNSIGNED32;
+  varbinds[1].value_len = sizeof(unsigned32);
+  varbinds[1].object_value = &unsigned32;
+  bench_check(snmp_trap_template_register(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 2, varbinds, &template_id),
+              "snmp_trap_template_register");
+
+  for (v = 0; v < LWIP_ARRAYSIZE(versions); v++) {
+    snmp_set_default_trap_version(versions[v]);
+    for (i = 0; i < LWIP_ARRAYSIZE(values); i++) {
+      integer = values[i];
+      unsigned32 = (u32_t)values[i];
+      template_values[0].s32 = integer;
+      template_values[1].u32 = unsigned32;
+      /* both traps need the same sysUpTime */
+      do {
+        tick = sys_now() / 10;
+        bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 2, varbinds), "snmp_send_trap");
+        sent_len = snmp_host_response_len;
+        memcpy(sent, snmp_host_response, sent_len);
+        bench_check(snmp_send_trap_template(template_id, template_values), "snmp_send_trap_template");
+      } while (tick != sys_now() / 10);
+      snprintf(what, sizeof(what), "trap_template/v%u/%ld", (versions[v] == SNMP_VERSION_1) ? 1U : 2U,
+               (long)values[i]);
+      trap_template_compare(sent, sent_len, versions[v], what);
+    }
+  }
+  printf("# trap template: %u values equal to snmp_send_trap() in SNMPv1 and SNMPv2c\n",
+         (unsigned)LWIP_ARRAYSIZE(values));
+  snmp_set_default_trap_version(SNMP_VERSION_2c);
+  snmp_trap_template_remove(template_id);
+}
+
+/** exits unless the last trap carries the count varbind of
+ * snmp_trap_limit.h with 'count', which is below 128 */
+static void
+trap_count_check(u32_t count, const char *what)
+{
+  /* 1.3.6.1.4.1.26381.1.1.0, Unsigned32 of one byte */
+  static const u8_t count_vb[] = { 0x06, 0x0b, 0x2b, 0x06, 0x01, 0x04, 0x01, 0x81, 0xce, 0x0d, 0x01, 0x01, 0x00,
+                                   SNMP_ASN1_TYPE_UNSIGNED32, 0x01 };
+  u16_t pos;
+
+  for (pos = 0; pos + sizeof(count_vb) < snmp_host_response_len; pos++) {
+    if ((memcmp(&snmp_host_response[pos], count_vb, sizeof(count_vb)) == 0) &&
+        (snmp_host_response[pos + sizeof(count_vb)] == count)) {
+      return;
+    }
+  }
+  fprintf(stderr, "snmp_bench: %s does not carry a count of %u\n", what, (unsigned)count);
+  exit(EXIT_FAILURE);
+}
+
+/** exits unless 'sent' traps were passed to snmp_sendto() since 'responses' */
+static void
+trap_sent_check(u32_t responses, u32_t sent, const char *what)
+{
+  if (snmp_host_responses - responses != sent) {
+    fprintf(stderr, "snmp_bench: %s sent %u traps, not %u\n", what,
+            (unsigned)(snmp_host_responses - responses), (unsigned)sent);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/** the token bucket and the counts of a rule of snmp_trap_limit.h, with
+ * the time passed by snmp_host_time_ms */
+static void
+bench_trap_limit(const struct snmp_obj_id *rule_oid)
+{
+  struct snmp_trap_limit limit;
+  struct snmp_trap_limit_stats stats;
+  u32_t responses;
+  u32_t i;
+
+  memset(&limit, 0, sizeof(limit));
+  limit.trap_oid = *rule_oid;
+  limit.burst = 2;
+  limit.coalesce_ms = 5000;
+  /* a bucket that is never refilled is refused */
+  if (snmp_trap_limit_set(0, &limit) != ERR_ARG) {
+    fprintf(stderr, "snmp_bench: trap_limit took a burst without an interval\n");
+    exit(EXIT_FAILURE);
+  }
+  limit.interval_ms = 1000;
+  bench_check(snmp_trap_limit_set(0, &limit), "snmp_trap_limit_set");
+
+  /* the full bucket passes two traps, the other three are counted */
+  responses = snmp_host_responses;
+  for (i = 0; i < 5; i++) {
+    bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_send_trap");
+  }
+  trap_sent_check(responses, 2, "trap_limit/burst");
+
+  /* one token is gained after interval_ms, its trap carries the count */
+  snmp_host_time_ms += limit.interval_ms;
+  responses = snmp_host_responses;
+  bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_send_trap");
+  trap_sent_check(responses, 1, "trap_limit/refill");
+  trap_count_check(3, "trap_limit/refill");
+
+  /* the bucket is empty again, the count is sent alone after coalesce_ms */
+  responses = snmp_host_responses;
+  for (i = 0; i < 2; i++) {
+    bench_check(snmp_send_trap(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_send_trap");
+  }
+  snmp_trap_limit_poll();
+  trap_sent_check(responses, 0, "trap_limit/empty");
+  snmp_host_time_ms += limit.coalesce_ms;
+  snmp_trap_limit_poll();
+  trap_sent_check(responses, 1, "trap_limit/summary");
+  trap_count_check(2, "trap_limit/summary");
+
+  bench_check(snmp_trap_limit_get_stats(0, &stats), "snmp_trap_limit_get_stats");
+  printf("# trap limit: %u passed, %u rate limited, %u coalesced, %u summaries\n", (unsigned)stats.passed,
+         (unsigned)stats.rate_limited, (unsigned)stats.coalesced, (unsigned)stats.summaries);
+  if ((stats.passed != 3) || (stats.rate_limited != 5) || (stats.coalesced != 5) || (stats.summaries != 1)) {
+    fprintf(stderr, "snmp_bench: trap_limit counted other traps\n");
+    exit(EXIT_FAILURE);
+  }
+  snmp_trap_limit_remove(0);
+}
+
+static void
+bench_traps(void)
+{
+  struct snmp_trap_queue_stats stats;
+  struct snmp_inform_stats inform_stats;
+  struct snmp_trap_limit limit;
+  struct snmp_trap_limit_stats limit_stats;
+#if SNMP_TRAP_SPOOL
+  struct snmp_trap_spool_stats spool_stats;
+#endif
+  u8_t template_id;
+  u32_t i;
+
+  trap_prepare();
+  bench_run("trap", "send", bench_trap_send, NULL, 1, NULL);
+  bench_check(snmp_trap_template_register(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds, &template_id),
+              "snmp_trap_template_register");
+  bench_run("trap", "send_template", bench_trap_template, &template_id, 1, NULL);
+  for (i = 1; i < SNMP_TRAP_DESTINATIONS; i++) {
+    snmp_trap_dst_ip_set((u8_t)i, &trap_dst_ip);
+    snmp_trap_dst_enable((u8_t)i, 1);
+  }
+  bench_run("trap", "send_all_destinations", bench_trap_send, NULL, 1, NULL);
+  for (i = 1; i < SNMP_TRAP_DESTINATIONS; i++) {
+    struct snmp_target target;
+
+    snmp_target_init_defaults(&target);
+    snprintf(target.name, sizeof(target.name), "nms%u", (unsigned)i);
+    snprintf(target.security_name, sizeof(target.security_name), "trap%u", (unsigned)i);
+    ip_addr_copy(target.ip, trap_dst_ip);
+    target.version = (i & 1) ? SNMP_VERSION_1 : SNMP_VERSION_2c;
+    bench_check(snmp_target_set((u8_t)i, &target), "snmp_target_set");
+  }
+  bench_run("trap", "send_mixed_versions", bench_trap_send, NULL, 1, NULL);
+  bench_run("trap", "send_mixed_versions_template", bench_trap_template, &template_id, 1, NULL);
+  bench_run("trap", "send_notification_v2c", bench_trap_notification, NULL, 1, NULL);
+#if SNMP_NOTIFY_FILTERS
+  {
+    struct snmp_notify_filter filter;
+    struct snmp_target target;
+
+    /* the SNMPv1 targets only take another enterprise, nothing is encoded for them */
+    memset(&filter, 0, sizeof(filter));
+    strcpy(filter.profile, "other");
+    filter.subtree = trap_oid;
+    filter.subtree.id[filter.subtree.len - 1]++;
+    filter.type = SNMP_NOTIFY_FILTER_INCLUDED;
+    bench_check(snmp_notify_filter_set(0, &filter), "snmp_notify_filter_set");
+    for (i = 1; i < SNMP_TRAP_DESTINATIONS; i += 2) {
+      bench_check(snmp_target_get((u8_t)i, &target), "snmp_target_get");
+      strcpy(target.filter_profile, "other");
+      bench_check(snmp_target_set((u8_t)i, &target), "snmp_target_set");
+    }
+    bench_run("trap", "send_filtered", bench_trap_send, NULL, 1, NULL);
+    bench_run("trap", "send_filtered_template", bench_trap_template, &template_id, 1, NULL);
+    snmp_notify_filter_remove(0);
+  }
+#endif
+  for (i = 1; i < SNMP_TRAP_DESTINATIONS; i++) {
+    snmp_target_remove((u8_t)i);
+  }
+  bench_run("trap", "inform_ack", bench_inform_ack, NULL, 1, NULL);
+  snmp_inform_get_stats(0, &inform_stats);
+  printf("# informs: %u sent, %u acked, %u untracked\n", (unsigned)inform_stats.sent,
+         (unsigned)inform_stats.acked, (unsigned)inform_stats.untracked);
+#if SNMP_TRAP_SPOOL
+  bench_run("trap", "spool_replay", bench_trap_spool, NULL, 1, NULL);
+  snmp_trap_spool_get_stats(&spool_stats);
+  printf("# trap spool: %u spooled, %u replayed, %u dropped\n", (unsigned)spool_stats.spooled,
+         (unsigned)spool_stats.replayed, (unsigned)spool_stats.dropped);
+#endif
+#if LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS
+  {
+    struct snmp_target target;
+
+    /* the shared body behind the header of the noAuthNoPriv user */
+    snmp_target_init_defaults(&target);
+    strcpy(target.name, "nms_v3");
+    strcpy(target.security_name, SNMP_HOST_USER);
+    ip_addr_copy(target.ip, trap_dst_ip);
+    target.version = SNMP_VERSION_3;
+    target.security_level = SNMP_TARGET_NOAUTH_NOPRIV;
+    bench_check(snmp_target_set(1, &target), "snmp_target_set");
+    snmp_trap_dst_enable(0, 0);
+    bench_run("trap", "send_v3", bench_trap_send, NULL, 1, NULL);
+    snmp_trap_dst_enable(0, 1);
+    snmp_target_remove(1);
+  }
+#endif
+
+  /* the first trap is sent, the others are duplicates */
+  memset(&limit, 0, sizeof(limit));
+  limit.trap_oid = trap_oid;
+  limit.trap_oid.id[limit.trap_oid.len++] = 1;
+  limit.dedup_ms = 3600000;
+  bench_check(snmp_trap_limit_set(0, &limit), "snmp_trap_limit_set");
+  bench_run("trap", "send_deduplicated", bench_trap_send, NULL, 1, NULL);
+  snmp_trap_limit_get_stats(0, &limit_stats);
+  printf("# trap limit: %u passed, %u deduplicated\n", (unsigned)limit_stats.passed,
+         (unsigned)limit_stats.deduplicated);
+  snmp_trap_limit_remove(0);
+  bench_trap_limit(&limit.trap_oid);
+  trap_timed_ns = 0;
+  bench_run("trap", "post", bench_trap_post, NULL, SNMP_TRAP_QUEUE_DEPTH, &trap_timed_ns);
+
+  for (i = 0; i < SNMP_TRAP_QUEUE_DEPTH; i++) {
+    bench_check(snmp_trap_post(&trap_oid, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, 1, trap_varbinds), "snmp_trap_post");
+  }
+  bench_run("trap", "post_full", bench_trap_post_full, NULL, 1, NULL);
+  snmp_trap_queue_flush();
+
+  snmp_trap_queue_get_stats(&stats);
+  printf("# trap queue: %u posted, %u sent, %u failed, %u dropped\n", (unsigned)stats.posted,
+         (unsigned)stats.sent, (unsigned)stats.failed, (unsigned)stats.dropped);
+  snmp_trap_template_remove(template_id);
+  bench_trap_template_check();
+  snmp_trap_dst_enable(0, 0);
+}
+
+/*
+ * Streamed value benchmarks
+ */
+
+/* SNMPv2c get of 1.3.6.1.4.1.26381.3.1.0, the streamed scalar of stream_mib */
+static const u8_t frame_stream_get[] = {
+  0x30, 0x2a, 0x02, 0x01, 0x01, 0x04, 0x06, 0x70, 0x75, 0x62, 0x6c, 0x69,
+  0x63, 0xa0, 0x1d, 0x02, 0x02, 0x03, 0xee, 0x02, 0x01, 0x00, 0x02, 0x01,
+  0x00, 0x30, 0x11, 0x30, 0x0f, 0x06, 0x0b, 0x2b, 0x06, 0x01, 0x04, 0x01,
+  0x81, 0xce, 0x0d, 0x03, 0x01, 0x00, 0x05, 0x00,
+};
+
+/* what bench_stream_write() writes, against the length it announced */
+enum stream_mode {
+  STREAM_EXACT,
+  STREAM_SHORT,
+  STREAM_LONG
+};
+
+static enum stream_mode stream_mode;
+static struct pbuf *stream_pbuf;
+/* announced without its last byte, which only STREAM_LONG writes */
+static u8_t stream_value[601];
+
+static s32_t
+bench_stream_len(struct snmp_node_instance *instance)
+{
+  LWIP_UNUSED_ARG(instance);
+  return (s32_t)sizeof(stream_value) - 1;
+}
+
+/** writes stream_value in chunks of 64 bytes */
+static snmp_err_t
+bench_stream_write(struct snmp_node_instance *instance, snmp_value_writer_fct writer, void *writer_arg)
+{
+  u16_t len = (u16_t)(sizeof(stream_value) - 1);
+  u16_t offset;
+  u16_t chunk;
+  LWIP_UNUSED_ARG(instance);
+
+  if (stream_mode == STREAM_SHORT) {
+    len--;
+  } else if (stream_mode == STREAM_LONG) {
+    len++;
+  }
+  for (offset = 0; offset < len; offset = (u16_t)(offset + chunk)) {
+    chunk = (u16_t)LWIP_MIN(64, len - offset);
+    if (writer(writer_arg, &stream_value[offset], chunk) != ERR_OK) {
+      return SNMP_ERR_GENERROR;
+    }
+  }
+  return SNMP_ERR_NOERROR;
+}
+
+static const struct snmp_scalar_node stream_scalar =
+  SNMP_SCALAR_CREATE_STREAMED_NODE_READONLY(1, SNMP_ASN1_TYPE_OCTET_STRING, bench_stream_len, bench_stream_write);
+static const struct snmp_node *const stream_nodes[] = {
+  &stream_scalar.node.node
+};
+static const struct snmp_tree_node stream_root = SNMP_CREATE_TREE_NODE(3, stream_nodes);
+static const u32_t stream_base_oid[] = { 1, 3, 6, 1, 4, 1, 26381, 3 };
+static const struct snmp_mib stream_mib = SNMP_MIB_CREATE(stream_base_oid, &stream_root.node);
+
+/** checks the response: the streamed bytes, or genErr for a node that did
+ * not write what it announced */
+static void
+stream_check(const char *what)
+{
+  u16_t pos = 0;
+  u16_t len;
+  u8_t error_status;
+  u8_t type;
+
+  (void)bench_tlv(snmp_host_response, &pos, &len);              /* message */
+  (void)bench_tlv(snmp_host_response, &pos, &len); pos += len;  /* version */
+  (void)bench_tlv(snmp_host_response, &pos, &len); pos += len;  /* community */
+  (void)bench_tlv(snmp_host_response, &pos, &len);              /* response PDU */
+  (void)bench_tlv(snmp_host_response, &pos, &len); pos += len;  /* request-id */
+  (void)bench_tlv(snmp_host_response, &pos, &len);
+  error_status = snmp_host_response[pos];
+  pos += len;
+  (void)bench_tlv(snmp_host_response, &pos, &len); pos += len;  /* error-index */
+  (void)bench_tlv(snmp_host_response, &pos, &len);              /* varbind list */
+  (void)bench_tlv(snmp_host_response, &pos, &len);              /* varbind */
+  (void)bench_tlv(snmp_host_response, &pos, &len); pos += len;  /* name */
+  type = bench_tlv(snmp_host_response, &pos, &len);
+
+  if (stream_mode != STREAM_EXACT) {
+    if (error_status != SNMP_ERR_GENERROR) {
+      fprintf(stderr, "snmp_bench: %s answered with error %u, not genErr\n", what, error_status);
+      exit(EXIT_FAILURE);
+    }
+    return;
+  }
+  if ((error_status != SNMP_ERR_NOERROR) || (type != SNMP_ASN1_TYPE_OCTET_STRING) ||
+      (len != sizeof(stream_value) - 1) || (pos + len != snmp_host_response_len) ||
+      (memcmp(&snmp_host_response[pos], stream_value, len) != 0)) {
+    fprintf(stderr, "snmp_bench: %s does not carry the streamed value\n", what);
+    exit(EXIT_FAILURE);
+  }
+}
+
+static u32_t
+bench_stream_get(const void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  snmp_receive(NULL, stream_pbuf, &snmp_host_source_ip, 161);
+  return snmp_host_response_len;
+}
+
+static void
+bench_stream(void)
+{
+  static const struct snmp_mib *mibs[] = { &mib2, &stream_mib };
+  static const char *const names[] = { "exact", "short", "long" };
+  size_t i;
+
+  for (i = 0; i < sizeof(stream_value); i++) {
+    stream_value[i] = (u8_t)(i * 7 + 1);
+  }
+  snmp_set_mibs(mibs, (u8_t)LWIP_ARRAYSIZE(mibs));
+  stream_pbuf = snmp_host_pbuf_from(frame_stream_get, sizeof(frame_stream_get));
+  if (stream_pbuf == NULL) {
+    fprintf(stderr, "snmp_bench: no pbuf for the streamed get\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (i = 0; i < LWIP_ARRAYSIZE(names); i++) {
+    u32_t responses = snmp_host_responses;
+    char what[32];
+
+    stream_mode = (enum stream_mode)i;
+    snprintf(what, sizeof(what), "stream_get/%s", names[i]);
+    snmp_receive(NULL, stream_pbuf, &snmp_host_source_ip, 161);
+    if (snmp_host_responses == responses) {
+      fprintf(stderr, "snmp_bench: %s was not answered\n", what);
+      exit(EXIT_FAILURE);
+    }
+    stream_check(what);
+    if (stream_mode == STREAM_EXACT) {
+      printf("# %-14s %4u -> %4u bytes  %s\n", "stream_get", (unsigned)sizeof(frame_stream_get),
+             snmp_host_response_len, "SNMPv2c get of a value streamed in chunks of 64 bytes");
+    }
+  }
+
+  stream_mode = STREAM_EXACT;
+  bench_run("stream", "get_600", bench_stream_get, NULL, 1, NULL);
+  pbuf_free(stream_pbuf);
+}
+
+static int
+write_corpus(const char *dir)
+{
+  size_t i;
+
+  for (i = 0; i < snmp_host_frame_count; i++) {
+    char path[512];
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s.bin", dir, snmp_host_frames[i].name);
+    file = fopen(path, "wb");
+    if ((file == NULL) ||
+        (fwrite(snmp_host_frames[i].data, 1, snmp_host_frames[i].len, file) != snmp_host_frames[i].len)) {
+      fprintf(stderr, "snmp_bench: cannot write %s\n", path);
+      if (file != NULL) {
+        fclose(file);
+      }
+      return EXIT_FAILURE;
+    }
+    fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char **argv)
+{
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+      bench_min_ms = (u32_t)strtoul(argv[++i], NULL, 10);
+    } else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) {
+      bench_filter = argv[++i];
+    } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+      return write_corpus(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-t <ms per benchmark>] [-f <name filter>] [-c <corpus dir>]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  snmp_host_init();
+
+  bench_codec();
+  bench_frames();
+  bench_traps();
+  bench_stream();
+
+  {
+    struct snmp_arena_stats arena;
+    snmp_arena_get_stats(&arena);
+    printf("# arena peak %u of %u bytes\n", (unsigned)arena.peak, (unsigned)arena.size);
+  }
+
+  return EXIT_SUCCESS;
+}
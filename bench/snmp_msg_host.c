@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Builds snmp_msg.c for the host and exports the static steps of a request,
+ * so parsing and encoding of a frame can be measured on their own.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "snmp_msg.c"
+
+#include "host_port.h"
+
+void
+snmp_host_request_init(struct snmp_request *request, struct pbuf *p)
+{
+  memset(request, 0, sizeof(*request));
+  request->handle       = NULL;
+  request->source_ip    = &snmp_host_source_ip;
+  request->source_port  = 161;
+  request->inbound_pbuf = p;
+}
+
+err_t
+snmp_host_parse_inbound_frame(struct snmp_request *request)
+{
+  return snmp_parse_inbound_frame(request);
+}
+
+err_t
+snmp_host_prepare_outbound_frame(struct snmp_request *request)
+{
+  return snmp_prepare_outbound_frame(request);
+}
+
+/* same dispatch as snmp_receive_request(), without the SNMPv3 reports */
+err_t
+snmp_host_process_request(struct snmp_request *request)
+{
+  if (request->error_status != SNMP_ERR_NOERROR) {
+    return ERR_OK;
+  }
+
+  switch (request->request_type) {
+    case SNMP_ASN1_CONTEXT_PDU_GET_REQ:
+      return snmp_process_get_request(request);
+    case SNMP_ASN1_CONTEXT_PDU_GET_NEXT_REQ:
+      return snmp_process_getnext_request(request);
+    case SNMP_ASN1_CONTEXT_PDU_GET_BULK_REQ:
+      return snmp_process_getbulk_request(request);
+    case SNMP_ASN1_CONTEXT_PDU_SET_REQ:
+      return snmp_process_set_request(request);
+    default:
+      return ERR_OK;
+  }
+}
+
+err_t
+snmp_host_complete_outbound_frame(struct snmp_request *request)
+{
+  return snmp_complete_outbound_frame(request);
+}
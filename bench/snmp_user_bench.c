@@ -0,0 +1,269 @@
+/**
+ * @file
+ * Host benchmark of the SNMPv3 user store at 1000 users.
+ *
+ * Usage: snmp_user_bench [-t <ms per benchmark>] [-f <name filter>] [-n <users>]
+ *
+ * Compares the user lookup of message processing and a usmUserTable GetNext
+ * of the store with the linear strcmp() scan of a typical application table
+ * and the scan over all users the table did before, and measures adding and
+ * removing a user. Results are reported in ns per operation.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmpv3.h"
+#include "lwip/apps/snmpv3_user_store.h"
+
+#include "snmp_core_priv.h"
+#include "snmpv3_priv.h"
+
+#include "host_port.h"
+
+#if !SNMP_V3_USER_STORE
+#error "snmp_user_bench needs SNMP_V3_USER_STORE"
+#endif
+
+#define BENCH_MAX_USERS (SNMP_V3_USER_STORE_USERS - 1)
+
+static u32_t bench_min_ms = 200;
+static const char *bench_filter;
+static u32_t bench_users = 1000;
+
+/* the names, also the table of the linear baseline */
+static char bench_names[BENCH_MAX_USERS][SNMP_V3_MAX_USER_LENGTH + 1];
+static u8_t bench_key[SNMP_V3_MAX_KEY_LENGTH];
+static u32_t bench_next;
+static volatile u32_t bench_sink;
+
+/* usmUserSecurityName of the first user, the row index is appended */
+static const u32_t bench_column_oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 2, 2, 1, 3 };
+#define BENCH_COLUMN_LEN LWIP_ARRAYSIZE(bench_column_oid)
+
+static u64_t
+bench_now_ns(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (u64_t)now.tv_sec * 1000000000ULL + (u64_t)now.tv_nsec;
+}
+
+/** picks the users in a fixed, scattered order */
+static u32_t
+bench_pick(void)
+{
+  bench_next = (bench_next + 617) % bench_users;
+  return bench_next;
+}
+
+static void
+lookup_store(void)
+{
+  snmpv3_auth_algo_t auth_algo;
+  u8_t auth_key[SNMP_V3_MAX_KEY_LENGTH];
+
+  if (snmpv3_user_store_get_user(bench_names[bench_pick()], &auth_algo, auth_key, NULL, NULL) != ERR_OK) {
+    fprintf(stderr, "snmp_user_bench: user not found\n");
+    exit(EXIT_FAILURE);
+  }
+  bench_sink += auth_key[0];
+}
+
+/** the snmpv3_get_user() of an application with an array of users */
+static void
+lookup_linear(void)
+{
+  const char *name = bench_names[bench_pick()];
+  u32_t i;
+
+  for (i = 0; i < bench_users; i++) {
+    if (strcmp(bench_names[i], name) == 0) {
+      bench_sink += i;
+      return;
+    }
+  }
+  fprintf(stderr, "snmp_user_bench: user not found\n");
+  exit(EXIT_FAILURE);
+}
+
+/** the row index of a user of the local engine */
+static u8_t
+bench_index(u32_t *index, const char *name)
+{
+  u8_t len = (u8_t)strlen(name);
+  u8_t i;
+
+  index[0] = SNMP_HOST_ENGINE_ID_LEN;
+  for (i = 0; i < SNMP_HOST_ENGINE_ID_LEN; i++) {
+    index[1 + i] = (u8_t)SNMP_HOST_ENGINE_ID[i];
+  }
+  index[1 + SNMP_HOST_ENGINE_ID_LEN] = len;
+  for (i = 0; i < len; i++) {
+    index[2 + SNMP_HOST_ENGINE_ID_LEN + i] = (u8_t)name[i];
+  }
+  return (u8_t)(2 + SNMP_HOST_ENGINE_ID_LEN + len);
+}
+
+/** a GetNext of usmUserSecurityName through the MIB tree */
+static void
+getnext_store(void)
+{
+  u32_t oid[SNMP_MAX_OBJ_ID_LEN];
+  struct snmp_obj_id node_oid;
+  struct snmp_node_instance instance;
+  u8_t len;
+
+  memcpy(oid, bench_column_oid, sizeof(bench_column_oid));
+  len = (u8_t)(BENCH_COLUMN_LEN + bench_index(&oid[BENCH_COLUMN_LEN], bench_names[bench_pick()]));
+
+  memset(&instance, 0, sizeof(instance));
+  if (snmp_get_next_node_instance_from_oid(oid, len, NULL, NULL, &node_oid, &instance) != SNMP_ERR_NOERROR) {
+    fprintf(stderr, "snmp_user_bench: getnext failed\n");
+    exit(EXIT_FAILURE);
+  }
+  bench_sink += node_oid.len;
+}
+
+/** the get_next_instance of the usmUserTable without the store */
+static void
+getnext_scan(void)
+{
+  u32_t row[LWIP_ARRAYSIZE(bench_column_oid) + 2 + SNMP_V3_MAX_ENGINE_ID_LENGTH + SNMP_V3_MAX_USER_LENGTH];
+  u32_t result[32];
+  struct snmp_next_oid_state state;
+  u8_t row_len;
+  u32_t i;
+
+  row_len = bench_index(row, bench_names[bench_pick()]);
+  snmp_next_oid_init(&state, row, row_len, result, LWIP_ARRAYSIZE(result));
+  for (i = 0; i < bench_users; i++) {
+    char username[SNMP_V3_MAX_USER_LENGTH + 1];
+    u32_t test_oid[32];
+
+    strcpy(username, bench_names[i]);
+    snmp_next_oid_check(&state, test_oid, bench_index(test_oid, username), LWIP_PTR_NUMERIC_CAST(void *, i));
+  }
+  bench_sink += state.status;
+}
+
+/** removes a user and adds it again, two moves of the sorted index */
+static void
+remove_add(void)
+{
+  const char *name = bench_names[bench_pick()];
+
+  if ((snmpv3_user_store_remove(NULL, 0, name) != 0) ||
+      (snmpv3_user_store_add(NULL, 0, name, SNMP_V3_AUTH_ALGO_SHA256, bench_key, SNMP_V3_PRIV_ALGO_AES,
+                             bench_key, SNMP_V3_USER_STORAGETYPE_VOLATILE) != 0)) {
+    fprintf(stderr, "snmp_user_bench: remove/add failed\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/** runs 'fn' until bench_min_ms have passed and prints the time per call */
+static void
+bench_run(const char *name, void (*fn)(void))
+{
+  u64_t start, elapsed;
+  u64_t calls = 0;
+  u32_t batch = 1;
+  char full_name[64];
+
+  snprintf(full_name, sizeof(full_name), "%s/%u", name, (unsigned)bench_users);
+  if ((bench_filter != NULL) && (strstr(full_name, bench_filter) == NULL)) {
+    return;
+  }
+
+  fn();
+
+  start = bench_now_ns();
+  do {
+    u32_t i;
+    for (i = 0; i < batch; i++) {
+      fn();
+    }
+    calls += batch;
+    if (batch < 4096) {
+      batch *= 2;
+    }
+    elapsed = bench_now_ns() - start;
+  } while (elapsed < (u64_t)bench_min_ms * 1000000ULL);
+
+  printf("%-32s %10.1f ns/op\n", full_name, (double)elapsed / (double)calls);
+}
+
+int
+main(int argc, char **argv)
+{
+  u32_t i;
+  int a;
+
+  for (a = 1; a < argc; a++) {
+    if ((strcmp(argv[a], "-t") == 0) && (a + 1 < argc)) {
+      bench_min_ms = (u32_t)strtoul(argv[++a], NULL, 10);
+    } else if ((strcmp(argv[a], "-f") == 0) && (a + 1 < argc)) {
+      bench_filter = argv[++a];
+    } else if ((strcmp(argv[a], "-n") == 0) && (a + 1 < argc)) {
+      bench_users = (u32_t)strtoul(argv[++a], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [-t <ms per benchmark>] [-f <name filter>] [-n <users>]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((bench_users == 0) || (bench_users > BENCH_MAX_USERS)) {
+    fprintf(stderr, "snmp_user_bench: 1 to %u users\n", (unsigned)BENCH_MAX_USERS);
+    return EXIT_FAILURE;
+  }
+
+  /* adds SNMP_HOST_USER */
+  snmp_host_init();
+  for (i = 0; i < bench_users; i++) {
+    snprintf(bench_names[i], sizeof(bench_names[i]), "operator-%u", (unsigned)i);
+    if (snmpv3_user_store_add(NULL, 0, bench_names[i], SNMP_V3_AUTH_ALGO_SHA256, bench_key, SNMP_V3_PRIV_ALGO_AES,
+                              bench_key, SNMP_V3_USER_STORAGETYPE_VOLATILE) != 0) {
+      fprintf(stderr, "snmp_user_bench: adding user %u failed\n", (unsigned)i);
+      return EXIT_FAILURE;
+    }
+  }
+
+  bench_run("lookup/store", lookup_store);
+  bench_run("lookup/linear", lookup_linear);
+  bench_run("getnext/store", getnext_store);
+  bench_run("getnext/scan", getnext_scan);
+  bench_run("remove_add/store", remove_add);
+
+  return EXIT_SUCCESS;
+}
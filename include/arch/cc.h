@@ -55,8 +55,10 @@ typedef uint8_t sys_prot_t;
 #define X32_F "lx"
 #define SZT_F "uz"
 
-/* ARM/LPC17xx is little endian only */
+/* ARM/LPC17xx is little endian only, a host libc defines its own */
+#ifndef BYTE_ORDER
 #define BYTE_ORDER LITTLE_ENDIAN
+#endif
 
 /* Use LWIP error codes */
 #define LWIP_PROVIDE_ERRNO
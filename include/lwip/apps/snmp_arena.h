@@ -0,0 +1,76 @@
+/**
+ * @file
+ * SNMP per-request scratch arena.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_ARENA_H
+#define LWIP_HDR_APPS_SNMP_ARENA_H
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP
+
+#include "lwip/arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Position in the arena, see snmp_arena_mark() */
+typedef u32_t snmp_arena_mark_t;
+
+/** Usage counters of the request arena */
+struct snmp_arena_stats {
+  /** capacity in bytes (SNMP_ARENA_SIZE) */
+  u32_t size;
+  /** bytes currently allocated */
+  u32_t used;
+  /** highest value of 'used' since startup or snmp_arena_reset_peak() */
+  u32_t peak;
+  /** allocations that did not fit */
+  u32_t failed;
+};
+
+void *snmp_arena_alloc(size_t size);
+snmp_arena_mark_t snmp_arena_mark(void);
+void snmp_arena_release(snmp_arena_mark_t mark);
+void snmp_arena_reset(void);
+
+void snmp_arena_get_stats(struct snmp_arena_stats *stats);
+void snmp_arena_reset_peak(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_SNMP */
+
+#endif /* LWIP_HDR_APPS_SNMP_ARENA_H */
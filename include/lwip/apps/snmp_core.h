@@ -192,6 +192,13 @@ typedef snmp_err_t (*node_instance_set_test_method)(struct snmp_node_instance*,
 typedef snmp_err_t (*node_instance_set_value_method)(struct snmp_node_instance*, u16_t, void*);
 typedef void (*node_instance_release_method)(struct snmp_node_instance*);
 
+/** appends 'len' bytes of a streamed value to the response, see node_instance_write_value_method */
+typedef err_t (*snmp_value_writer_fct)(void *writer_arg, const void *buf, u16_t len);
+/** returns the total length of a streamed value. Return values <0 to indicate an error */
+typedef s32_t (*node_instance_get_value_len_method)(struct snmp_node_instance*);
+/** writes a streamed value in chunks by calling 'writer'; exactly the number of bytes announced by get_value_len() must be written */
+typedef snmp_err_t (*node_instance_write_value_method)(struct snmp_node_instance*, snmp_value_writer_fct writer, void *writer_arg);
+
 #define SNMP_GET_VALUE_RAW_DATA 0x4000  /* do not use 0x8000 because return value of node_instance_get_value_method is signed16 and 0x8000 would be the signed bit */
 
 /** SNMP node instance */
@@ -215,6 +222,9 @@ struct snmp_node_instance
   node_instance_set_value_method set_value;
   /** called in any case when the instance is not required anymore by stack (useful for freeing memory allocated in get_instance/get_next_instance methods) */
   node_instance_release_method release_instance;
+  /** optional, for OCTET STRING/Opaque values that do not fit the value buffer: when both are set, the stack calls these instead of get_value() and the value is written directly into the response */
+  node_instance_get_value_len_method get_value_len;
+  node_instance_write_value_method write_value;
 
   /** reference to pass arbitrary value between calls to get_instance() and get_value/test_value/set_value */
   union snmp_variant_value reference;
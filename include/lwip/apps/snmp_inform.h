@@ -0,0 +1,128 @@
+/**
+ * @file
+ * SNMP zephyr frontend: retransmission and acknowledgement of INFORMs.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_INFORM_H
+#define LWIP_HDR_APPS_SNMP_INFORM_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_target.h"
+#include "lwip/pbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP
+
+/**
+ * @brief Called once per tracked INFORM and target, with ERR_OK when the
+ *        target answered it and ERR_TIMEOUT when it never did.
+ */
+typedef void (*snmp_inform_done_fct)(s32_t request_id, u8_t target, err_t result, void *arg);
+
+#endif /* LWIP_SNMP */
+
+#if LWIP_SNMP && SNMP_INFORM_PENDING
+
+/*
+ * Every INFORM sent to a target is kept, as encoded, in one of
+ * SNMP_INFORM_PENDING entries until the target answers it. An entry that
+ * is not answered within the target's timeout is sent again, with the
+ * timeout doubled each time, until the target's retry count is used up.
+ * Responses are matched by request ID and source address through a hash
+ * of the request IDs; the timeouts are kept on a timer wheel, so neither
+ * depends on the number of pending INFORMs.
+ *
+ * An SNMPv3 INFORM to a receiver whose engine is not known yet is tracked
+ * from the first discovery message on, so the target's timeout and retry
+ * count cover the discovery as well.
+ *
+ * The completion callback and the snmp_inform_callback of snmp.h both see
+ * a response; the completion callback also sees the timeouts. Responses to
+ * SNMPv3 INFORMs only reach the completion callback.
+ */
+
+/**
+ * @brief Counters of the INFORMs of one target, they wrap around.
+ *        Round-trip times only come from INFORMs answered without a
+ *        retransmission, as the answer of one that was sent again can
+ *        not be told apart.
+ */
+struct snmp_inform_stats {
+	u32_t sent;          /* INFORMs sent for the first time */
+	u32_t retransmitted; /* INFORMs sent again */
+	u32_t acked;         /* INFORMs answered by the target */
+	u32_t timed_out;     /* INFORMs given up after the last retry */
+	u32_t untracked;     /* INFORMs sent once, all entries were in use */
+	u32_t rtt_samples;
+	u32_t rtt_last_ms;
+	u32_t rtt_min_ms;
+	u32_t rtt_max_ms;
+	u32_t rtt_avg_ms;    /* smoothed as the SRTT of TCP, 1/8 per sample */
+};
+
+void snmp_inform_set_done_callback(snmp_inform_done_fct done, void *arg);
+
+/**
+ * @brief Copies the counters of a target.
+ *
+ * @return ERR_OK, or ERR_ARG for an index outside the target table.
+ */
+err_t snmp_inform_get_stats(u8_t target, struct snmp_inform_stats *stats);
+
+/**
+ * @brief The number of INFORMs waiting for an answer.
+ */
+u16_t snmp_inform_pending(void);
+
+/**
+ * @brief Retransmits or gives up the INFORMs whose timeout expired. A work
+ *        item calls it while INFORMs are pending.
+ */
+void snmp_inform_poll(void);
+
+/* Called by the agent: keeps a copy of an INFORM about to be sent to a
+ * target, with the completion callback of its notification that is called
+ * after the one of snmp_inform_set_done_callback(), forgets it again when
+ * it could not be sent, replaces it by the next message of an SNMPv3
+ * engine discovery, and completes the INFORM a response answers */
+void snmp_inform_track(const struct pbuf *p, u8_t index, const struct snmp_target *target, s32_t request_id,
+		       snmp_inform_done_fct done, void *done_arg);
+void snmp_inform_cancel(s32_t request_id, u8_t index);
+void snmp_inform_update(s32_t request_id, const struct pbuf *p);
+void snmp_inform_response(s32_t request_id, const ip_addr_t *source_ip);
+
+#endif /* LWIP_SNMP && SNMP_INFORM_PENDING */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_INFORM_H */
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * SNMP notifications: one call for traps, INFORMs and templates, to a
+ * selection of the targets.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_NOTIFICATION_H
+#define LWIP_HDR_APPS_SNMP_NOTIFICATION_H
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_inform.h"
+#include "lwip/apps/snmp_target.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * snmp_send_notification() takes everything the snmp_send_trap*(),
+ * snmp_send_inform*() and template calls take, in one struct, and goes
+ * the same way they do: the rules of snmp_trap_limit.h for traps, the
+ * filters of snmp_notify_filter.h, then one encoded body per version that
+ * the header of each target is put in front of. The targets can be
+ * narrowed to a set and to those configured for one version; the filters
+ * still apply to the targets that are left.
+ *
+ * Nothing is allocated for the varbinds: they stay in the list of the
+ * caller, which snmp_varbind_list_link() makes from an array, e.g. one on
+ * the stack or of a pool the application keeps.
+ *
+ * snmp_send_notification() takes the SNMP core lock of snmp_core_lock()
+ * itself and can be called from any thread but an ISR.
+ */
+
+/** snmp_notification.template_id when the varbinds are sent */
+#define SNMP_NOTIFICATION_NO_TEMPLATE  0xFF
+
+struct snmp_notification {
+  /** enterprise, NULL for the one of the device (sysObjectID) */
+  const struct snmp_obj_id *eoid;
+  s32_t generic_trap;
+  /** used when generic_trap is SNMP_GENTRAP_ENTERPRISE_SPECIFIC */
+  s32_t specific_trap;
+  /** list of varbinds, may be NULL */
+  struct snmp_varbind *varbinds;
+  /** an id of snmp_trap_template_register() to send instead of eoid, the
+   *  trap codes and varbinds, or SNMP_NOTIFICATION_NO_TEMPLATE */
+  u8_t template_id;
+  /** the values of the template, see snmp_trap_template.h */
+  const union snmp_variant_value *values;
+  /** SNMP_TARGET_TRAP: as the targets are configured, an INFORM to the
+   *  targets of type SNMP_TARGET_INFORM; SNMP_TARGET_INFORM: an INFORM to
+   *  all targets */
+  u8_t type;
+  /** only the targets whose version, or the default trap version for
+   *  SNMP_TARGET_VERSION_DEFAULT, is this one; SNMP_TARGET_VERSION_DEFAULT
+   *  for all */
+  u8_t version;
+  /** a set of targets, see snmp_target.h, NULL for all */
+  const u8_t *targets;
+#if SNMP_INFORM_PENDING
+  /** called for each INFORM of the notification after the callback of
+   *  snmp_inform_set_done_callback(), set when the INFORM is sent; an
+   *  INFORM replayed from the spool only reaches that callback */
+  snmp_inform_done_fct done;
+  void *done_arg;
+#endif
+};
+
+/**
+ * @brief A notification with no varbinds, no template, as a trap to all
+ *        targets.
+ */
+void snmp_notification_init(struct snmp_notification *notification);
+
+/**
+ * @brief Sends a notification.
+ *
+ * @param request_id [out] the request ID of its INFORMs, may be NULL
+ * @return ERR_OK, also when a rule of snmp_trap_limit.h dropped it, ERR_ARG
+ *         for an unknown template, ERR_MEM when out of memory, or the error
+ *         of the first target that failed.
+ */
+err_t snmp_send_notification(const struct snmp_notification *notification, s32_t *request_id);
+
+/**
+ * @brief Links count varbinds of an array into a list.
+ *
+ * @return the first varbind, NULL when count is 0
+ */
+struct snmp_varbind *snmp_varbind_list_link(struct snmp_varbind *varbinds, u16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_SNMP */
+
+#endif /* LWIP_HDR_APPS_SNMP_NOTIFICATION_H */
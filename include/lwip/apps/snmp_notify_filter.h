@@ -0,0 +1,111 @@
+/**
+ * @file
+ * SNMP notification filter profiles and the read-only SNMP-NOTIFICATION-MIB
+ * (RFC 3413).
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_NOTIFY_FILTER_H
+#define LWIP_HDR_APPS_SNMP_NOTIFY_FILTER_H
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && SNMP_NOTIFY_FILTERS
+
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_target.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A target whose filter_profile is set only gets the notifications its
+ * profile lets through; targets without one get all of them. A profile is
+ * the set of filters of the table with its name, each a subtree that is
+ * included or excluded, with a mask whose 0 bits match any sub-identifier.
+ * As in RFC 3413, a notification passes a profile when its snmpTrapOID and
+ * the OIDs of all its varbinds do: the filter with the longest subtree an
+ * OID falls under decides, the lexicographically greater one on a tie, and
+ * an OID no filter matches does not pass. A profile without filters lets
+ * nothing through.
+ *
+ * The subtrees of all filters are compiled into a trie of sub-identifiers
+ * with SNMP_NOTIFY_FILTER_NODES nodes, a masked sub-identifier being a
+ * wildcard edge, when the table is changed. An OID is then checked against
+ * all profiles by one walk of the trie, and the targets it excludes are
+ * skipped before anything is encoded for them.
+ */
+
+/** snmpNotifyFilterType */
+#define SNMP_NOTIFY_FILTER_INCLUDED  1
+#define SNMP_NOTIFY_FILTER_EXCLUDED  2
+
+/** Longest snmpNotifyFilterMask */
+#define SNMP_NOTIFY_FILTER_MASK_LEN  16
+
+struct snmp_notify_filter {
+  /** snmpNotifyFilterProfileName, an empty name marks a free slot */
+  char profile[SNMP_TARGET_MAX_NAME_LEN + 1];
+  /** snmpNotifyFilterSubtree */
+  struct snmp_obj_id subtree;
+  /** snmpNotifyFilterMask: the most significant bit of the first octet is
+   *  the first sub-identifier, a 0 bit matches any value, missing bits are 1 */
+  u8_t mask[SNMP_NOTIFY_FILTER_MASK_LEN];
+  u8_t mask_len;
+  /** SNMP_NOTIFY_FILTER_INCLUDED or SNMP_NOTIFY_FILTER_EXCLUDED */
+  u8_t type;
+};
+
+err_t snmp_notify_filter_set(u8_t index, const struct snmp_notify_filter *filter);
+err_t snmp_notify_filter_get(u8_t index, struct snmp_notify_filter *filter);
+void snmp_notify_filter_remove(u8_t index);
+
+extern const struct snmp_mib snmpnotificationmib;
+
+/** The profiles an OID of a notification did not pass, so far */
+struct snmp_notify_filter_eval {
+  u8_t excluded[(SNMP_NOTIFY_FILTERS + 7) / 8];
+};
+
+/* Called by the agent: whether a target has a profile at all, and a counter
+ * that changes with the filters and the profiles of the targets. The OIDs of
+ * a notification are checked one by one, then the targets whose profile let
+ * all of them through are added to a set of targets, see snmp_target.h */
+u8_t snmp_notify_filter_active(void);
+u16_t snmp_notify_filter_generation(void);
+void snmp_notify_filter_begin(struct snmp_notify_filter_eval *eval);
+void snmp_notify_filter_oid(struct snmp_notify_filter_eval *eval, const u32_t *oid, u8_t oid_len);
+void snmp_notify_filter_targets(const struct snmp_notify_filter_eval *eval, u8_t *targets);
+void snmp_notify_filter_targets_changed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_SNMP && SNMP_NOTIFY_FILTERS */
+
+#endif /* LWIP_HDR_APPS_SNMP_NOTIFY_FILTER_H */
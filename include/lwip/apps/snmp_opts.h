@@ -102,13 +102,153 @@
 #endif /* SNMP_USE_NETCONN */
 
 /**
- * SNMP_TRAP_DESTINATIONS: Number of trap destinations. At least one trap
- * destination is required
+ * SNMP_TRAP_DESTINATIONS: Number of slots in the notification target table
+ * of snmp_target.h. At least one trap destination is required
  */
 #if !defined SNMP_TRAP_DESTINATIONS || defined __DOXYGEN__
 #define SNMP_TRAP_DESTINATIONS          1
 #endif
 
+/**
+ * SNMP_TRAP_QUEUE==1: snmp_trap_post() queues notifications for a sender
+ * thread instead of sending them in the caller's thread, see
+ * snmp_trap_queue.h. Needs the Zephyr kernel.
+ */
+#if !defined SNMP_TRAP_QUEUE || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE                 0
+#endif
+
+/**
+ * SNMP_TRAP_QUEUE_DEPTH: number of notifications the queue holds.
+ */
+#if !defined SNMP_TRAP_QUEUE_DEPTH || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE_DEPTH           8
+#endif
+
+/**
+ * SNMP_TRAP_QUEUE_VARBINDS, SNMP_TRAP_QUEUE_DATA_SIZE: most varbinds of a
+ * queued notification, and bytes for its trap OID, varbind OIDs (4 bytes per
+ * arc) and values. Larger notifications are rejected by snmp_trap_post().
+ */
+#if !defined SNMP_TRAP_QUEUE_VARBINDS || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE_VARBINDS        4
+#endif
+#if !defined SNMP_TRAP_QUEUE_DATA_SIZE || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE_DATA_SIZE       256
+#endif
+
+/**
+ * SNMP_TRAP_QUEUE_STACK_SIZE, SNMP_TRAP_QUEUE_THREAD_PRIO: the sender thread.
+ */
+#if !defined SNMP_TRAP_QUEUE_STACK_SIZE || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE_STACK_SIZE      2048
+#endif
+#if !defined SNMP_TRAP_QUEUE_THREAD_PRIO || defined __DOXYGEN__
+#define SNMP_TRAP_QUEUE_THREAD_PRIO     12
+#endif
+
+/**
+ * SNMP_INFORM_PENDING: number of INFORMs kept for retransmission until their
+ * target answers, see snmp_inform.h. 0 sends every INFORM once. Needs the
+ * Zephyr kernel.
+ */
+#if !defined SNMP_INFORM_PENDING || defined __DOXYGEN__
+#define SNMP_INFORM_PENDING             0
+#endif
+
+/**
+ * SNMP_INFORM_TICK_MS: resolution of the INFORM timeouts in milliseconds.
+ */
+#if !defined SNMP_INFORM_TICK_MS || defined __DOXYGEN__
+#define SNMP_INFORM_TICK_MS             100
+#endif
+
+/**
+ * SNMP_TRAP_SPOOL: number of SNMPv1 and SNMPv2c notifications kept, as
+ * encoded, when they could not be sent, and replayed when their destination
+ * is reachable again, see snmp_trap_spool.h. 0 drops them. Needs the Zephyr
+ * kernel.
+ */
+#if !defined SNMP_TRAP_SPOOL || defined __DOXYGEN__
+#define SNMP_TRAP_SPOOL                 0
+#endif
+
+/**
+ * SNMP_TRAP_SPOOL_RECORD_SIZE: largest spooled message in bytes.
+ */
+#if !defined SNMP_TRAP_SPOOL_RECORD_SIZE || defined __DOXYGEN__
+#define SNMP_TRAP_SPOOL_RECORD_SIZE     484
+#endif
+
+/**
+ * SNMP_TRAP_SPOOL_INTERVAL_MS, SNMP_TRAP_SPOOL_RETRY_MS: the replay sends
+ * one message per interval; a destination it failed for is tried again
+ * after the retry time.
+ */
+#if !defined SNMP_TRAP_SPOOL_INTERVAL_MS || defined __DOXYGEN__
+#define SNMP_TRAP_SPOOL_INTERVAL_MS     100
+#endif
+#if !defined SNMP_TRAP_SPOOL_RETRY_MS || defined __DOXYGEN__
+#define SNMP_TRAP_SPOOL_RETRY_MS        5000
+#endif
+
+/**
+ * SNMP_TRAP_SPOOL_PERSIST==1: spooled notifications are also written to the
+ * settings subsystem and survive a reboot.
+ */
+#if !defined SNMP_TRAP_SPOOL_PERSIST || defined __DOXYGEN__
+#define SNMP_TRAP_SPOOL_PERSIST         0
+#endif
+
+/**
+ * SNMP_TRAP_LIMIT_RULES: number of rules that rate limit, deduplicate and
+ * coalesce the traps of one trap OID, see snmp_trap_limit.h. 0 sends every
+ * trap. Needs the Zephyr kernel.
+ */
+#if !defined SNMP_TRAP_LIMIT_RULES || defined __DOXYGEN__
+#define SNMP_TRAP_LIMIT_RULES           0
+#endif
+
+/**
+ * SNMP_TRAP_TEMPLATES: number of notifications registered with
+ * snmp_trap_template_register(), whose OIDs are encoded once so that
+ * sending one only fills in sysUpTime and the values, see
+ * snmp_trap_template.h. 0 leaves the API out.
+ */
+#if !defined SNMP_TRAP_TEMPLATES || defined __DOXYGEN__
+#define SNMP_TRAP_TEMPLATES             0
+#endif
+
+/**
+ * SNMP_TRAP_TEMPLATE_SIZE, SNMP_TRAP_TEMPLATE_VARBINDS: most bytes of the
+ * encoded SNMPv2c PDU fields after the request ID of a template, and most
+ * varbinds of the caller in one.
+ */
+#if !defined SNMP_TRAP_TEMPLATE_SIZE || defined __DOXYGEN__
+#define SNMP_TRAP_TEMPLATE_SIZE         256
+#endif
+#if !defined SNMP_TRAP_TEMPLATE_VARBINDS || defined __DOXYGEN__
+#define SNMP_TRAP_TEMPLATE_VARBINDS     8
+#endif
+
+/**
+ * SNMP_NOTIFY_FILTERS: number of entries of snmpNotifyFilterTable, the
+ * filters of the profiles targets can be given, see snmp_notify_filter.h.
+ * 0 sends every notification to every target.
+ */
+#if !defined SNMP_NOTIFY_FILTERS || defined __DOXYGEN__
+#define SNMP_NOTIFY_FILTERS             0
+#endif
+
+/**
+ * SNMP_NOTIFY_FILTER_NODES: nodes of the trie the subtrees of the filters
+ * are compiled into, at most one per sub-identifier of a subtree; subtrees
+ * share the nodes of their common prefix.
+ */
+#if !defined SNMP_NOTIFY_FILTER_NODES || defined __DOXYGEN__
+#define SNMP_NOTIFY_FILTER_NODES        128
+#endif
+
 /**
  * Only allow SNMP write actions that are 'safe' (e.g. disabling netifs is not
  * a safe action and disabled when SNMP_SAFE_REQUESTS = 1).
@@ -265,6 +405,39 @@
 #define SNMP_LWIP_GETBULK_MAX_REPETITIONS 0
 #endif
 
+/**
+ * SNMP_ARENA_SIZE: size in bytes of the per-request scratch arena. The request
+ * state, node instances and OID buffers used while processing one request are
+ * allocated from it instead of from the stack, see snmp_arena_get_stats() for
+ * the peak usage. A request which does not fit is dropped.
+ */
+#if !defined SNMP_ARENA_SIZE || defined __DOXYGEN__
+#define SNMP_ARENA_SIZE                 2048
+#endif
+
+/**
+ * SNMP_VALUE_CACHE_ENTRIES: number of object instances whose BER encoded value
+ * can be cached, see snmp_value_cache_register(). 0 disables the cache.
+ */
+#if !defined SNMP_VALUE_CACHE_ENTRIES || defined __DOXYGEN__
+#define SNMP_VALUE_CACHE_ENTRIES        8
+#endif
+
+/**
+ * SNMP_VALUE_CACHE_VALUE_SIZE: maximum size of one encoded value (type, length
+ * and contents) in the value cache. Longer values are not cached.
+ */
+#if !defined SNMP_VALUE_CACHE_VALUE_SIZE || defined __DOXYGEN__
+#define SNMP_VALUE_CACHE_VALUE_SIZE     64
+#endif
+
+/**
+ * SNMP_VALUE_CACHE_MAX_OID_LEN: maximum length of an instance OID in the value cache.
+ */
+#if !defined SNMP_VALUE_CACHE_MAX_OID_LEN || defined __DOXYGEN__
+#define SNMP_VALUE_CACHE_MAX_OID_LEN    16
+#endif
+
 /**
  * @}
  */
@@ -292,6 +465,112 @@
 #define LWIP_SNMP_V3_CRYPTO        LWIP_SNMP_V3_MBEDTLS
 #endif
 
+/**
+ * SNMP_V3_USER_CACHE_ENTRIES: number of USM users whose algorithms, localized
+ * keys and keyed HMAC/cipher contexts are kept between requests, so that
+ * snmpv3_get_user() and the crypto setup do not run for every message.
+ */
+#if !defined SNMP_V3_USER_CACHE_ENTRIES || defined __DOXYGEN__
+#define SNMP_V3_USER_CACHE_ENTRIES 2
+#endif
+
+/**
+ * SNMP_V3_KEYS==1: derive localized user keys in a background thread and keep
+ * them in the Zephyr settings subsystem, see snmpv3_keys.h.
+ */
+#if !defined SNMP_V3_KEYS || defined __DOXYGEN__
+#define SNMP_V3_KEYS               0
+#endif
+
+/**
+ * SNMP_V3_KEYS_USERS: number of users of the key localization service.
+ */
+#if !defined SNMP_V3_KEYS_USERS || defined __DOXYGEN__
+#define SNMP_V3_KEYS_USERS         4
+#endif
+
+/**
+ * SNMP_V3_KEYS_MAX_PASSWORD_LEN: longest password accepted by
+ * snmpv3_keys_set_user(). Passwords are only kept until their key is derived.
+ */
+#if !defined SNMP_V3_KEYS_MAX_PASSWORD_LEN || defined __DOXYGEN__
+#define SNMP_V3_KEYS_MAX_PASSWORD_LEN 64
+#endif
+
+/**
+ * SNMP_V3_KEYS_STACK_SIZE, SNMP_V3_KEYS_THREAD_PRIO: the key localization
+ * thread. A low priority keeps the agent responsive while keys are derived.
+ */
+#if !defined SNMP_V3_KEYS_STACK_SIZE || defined __DOXYGEN__
+#define SNMP_V3_KEYS_STACK_SIZE    2048
+#endif
+#if !defined SNMP_V3_KEYS_THREAD_PRIO || defined __DOXYGEN__
+#define SNMP_V3_KEYS_THREAD_PRIO   14
+#endif
+
+/**
+ * SNMP_V3_ENGINE_TIME==1: the agent implements snmpv3_get_engine_boots(),
+ * snmpv3_set_engine_boots(), snmpv3_get_engine_time() and
+ * snmpv3_reset_engine_time() itself. snmpEngineBoots is kept in the Zephyr
+ * settings subsystem, snmpEngineTime follows the uptime.
+ */
+#if !defined SNMP_V3_ENGINE_TIME || defined __DOXYGEN__
+#define SNMP_V3_ENGINE_TIME        0
+#endif
+
+/**
+ * SNMP_V3_USER_STORE==1: a table of USM users with localized keys, hashed
+ * by name for message processing and sorted for usmUserTable walks, see
+ * snmpv3_user_store.h.
+ */
+#if !defined SNMP_V3_USER_STORE || defined __DOXYGEN__
+#define SNMP_V3_USER_STORE         0
+#endif
+
+/**
+ * SNMP_V3_USER_STORE_USERS: number of users of the user store, at most 4096.
+ */
+#if !defined SNMP_V3_USER_STORE_USERS || defined __DOXYGEN__
+#define SNMP_V3_USER_STORE_USERS   16
+#endif
+
+/**
+ * SNMP_V3_REMOTE_ENGINES: number of remote SNMPv3 engines, the receivers of
+ * INFORMs, whose engine ID, boots and time and keyed notification user are
+ * cached so that repeated INFORMs need no discovery. Each entry holds crypto
+ * contexts like a SNMP_V3_USER_CACHE_ENTRIES entry. 0 disables the cache.
+ */
+#if !defined SNMP_V3_REMOTE_ENGINES || defined __DOXYGEN__
+#define SNMP_V3_REMOTE_ENGINES     2
+#endif
+
+/**
+ * SNMP_V3_REMOTE_ENGINE_MAX_AGE: milliseconds after which the estimated
+ * clock of a remote engine is no longer trusted and synchronized again.
+ */
+#if !defined SNMP_V3_REMOTE_ENGINE_MAX_AGE || defined __DOXYGEN__
+#define SNMP_V3_REMOTE_ENGINE_MAX_AGE (24UL * 60UL * 60UL * 1000UL)
+#endif
+
+/**
+ * SNMP_V3_FAST_DISCOVERY==1: answer SNMPv3 messages to an unknown engine ID,
+ * the discovery probes of managers, from a pre-encoded REPORT after decoding
+ * the message header only.
+ */
+#if !defined SNMP_V3_FAST_DISCOVERY || defined __DOXYGEN__
+#define SNMP_V3_FAST_DISCOVERY     LWIP_SNMP_V3
+#endif
+
+/**
+ * SNMP_V3_NOTIFICATIONS==1: send TRAPs and INFORMs to SNMPv3 targets, with
+ * the USM security level of the target. TRAPs are sent by the user of the
+ * local engine named by the target, INFORMs by a user keyed for the engine
+ * of the receiver, which is discovered first. Needs SNMP_V3_REMOTE_ENGINES.
+ */
+#if !defined SNMP_V3_NOTIFICATIONS || defined __DOXYGEN__
+#define SNMP_V3_NOTIFICATIONS      0
+#endif
+
 #ifndef LWIP_SNMP_CONFIGURE_VERSIONS
 #define LWIP_SNMP_CONFIGURE_VERSIONS 0
 #endif
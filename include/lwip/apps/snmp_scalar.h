@@ -57,6 +57,9 @@ struct snmp_scalar_node
   node_instance_get_value_method get_value;
   node_instance_set_test_method set_test;
   node_instance_set_value_method set_value;
+  /** optional streamed value, see struct snmp_node_instance */
+  node_instance_get_value_len_method get_value_len;
+  node_instance_write_value_method write_value;
 };
 
 
@@ -67,10 +70,17 @@ snmp_err_t snmp_scalar_get_next_instance(const u32_t *root_oid, u8_t root_oid_le
   {{{ SNMP_NODE_SCALAR, (oid) }, \
     snmp_scalar_get_instance, \
     snmp_scalar_get_next_instance }, \
-    (asn1_type), (access), (get_value_method), (set_test_method), (set_value_method) }
+    (asn1_type), (access), (get_value_method), (set_test_method), (set_value_method), NULL, NULL }
 
 #define SNMP_SCALAR_CREATE_NODE_READONLY(oid, asn1_type, get_value_method) SNMP_SCALAR_CREATE_NODE(oid, SNMP_NODE_INSTANCE_READ_ONLY, asn1_type, get_value_method, NULL, NULL)
 
+/** read-only scalar whose (large) value is written in chunks directly into the response */
+#define SNMP_SCALAR_CREATE_STREAMED_NODE_READONLY(oid, asn1_type, get_value_len_method, write_value_method) \
+  {{{ SNMP_NODE_SCALAR, (oid) }, \
+    snmp_scalar_get_instance, \
+    snmp_scalar_get_next_instance }, \
+    (asn1_type), SNMP_NODE_INSTANCE_READ_ONLY, NULL, NULL, NULL, (get_value_len_method), (write_value_method) }
+
 /** scalar array node - a tree node which contains scalars only as children */
 struct snmp_scalar_array_node_def
 {
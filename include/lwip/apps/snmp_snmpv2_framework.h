@@ -17,10 +17,16 @@ extern "C" {
 extern const struct snmp_obj_id usmNoAuthProtocol;
 extern const struct snmp_obj_id usmHMACMD5AuthProtocol;
 extern const struct snmp_obj_id usmHMACSHAAuthProtocol;
+extern const struct snmp_obj_id usmHMAC128SHA224AuthProtocol;
+extern const struct snmp_obj_id usmHMAC192SHA256AuthProtocol;
+extern const struct snmp_obj_id usmHMAC256SHA384AuthProtocol;
+extern const struct snmp_obj_id usmHMAC384SHA512AuthProtocol;
 
 extern const struct snmp_obj_id usmNoPrivProtocol;
 extern const struct snmp_obj_id usmDESPrivProtocol;
 extern const struct snmp_obj_id usmAESPrivProtocol;
+extern const struct snmp_obj_id usmAES192PrivProtocol;
+extern const struct snmp_obj_id usmAES256PrivProtocol;
 
 extern const struct snmp_mib snmpframeworkmib;
 
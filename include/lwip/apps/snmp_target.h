@@ -0,0 +1,127 @@
+/**
+ * @file
+ * SNMP notification targets (SNMP-TARGET-MIB, RFC 3413).
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_TARGET_H
+#define LWIP_HDR_APPS_SNMP_TARGET_H
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/apps/snmp_core.h"
+#include "lwip/ip_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Notifications are sent to the enabled targets of a table with
+ * SNMP_TRAP_DESTINATIONS slots. A target is addressed by its slot index,
+ * so setting, reading and sending to it costs no search. Each target has
+ * its own port, version, community or user, notification type, timeout
+ * and retry count; the table is read-only in snmpTargetAddrTable and
+ * snmpTargetParamsTable, where a target shows as one row of each with
+ * its name as the index. snmpTargetParamsSecurityName is empty for
+ * SNMPv1/v2c targets, whose community is not shown.
+ *
+ * snmp_trap_dst_ip_set() and snmp_trap_dst_enable() still work: they fill
+ * in a target named "dst<index>" with the defaults of
+ * snmp_target_init_defaults().
+ */
+
+/** Longest target name and security name (SnmpAdminString of RFC 3411) */
+#define SNMP_TARGET_MAX_NAME_LEN     32
+
+/** snmpNotifyType */
+#define SNMP_TARGET_TRAP             1
+#define SNMP_TARGET_INFORM           2
+
+/** SnmpSecurityLevel, only used for SNMPv3 targets */
+#define SNMP_TARGET_NOAUTH_NOPRIV    1
+#define SNMP_TARGET_AUTH_NOPRIV      2
+#define SNMP_TARGET_AUTH_PRIV        3
+
+/** The version set by snmp_set_default_trap_version() */
+#define SNMP_TARGET_VERSION_DEFAULT  0xFF
+
+/** A set of targets: bit (index % 8) of byte (index / 8) per slot */
+#define SNMP_TARGET_SET_LEN          ((SNMP_TRAP_DESTINATIONS + 7) / 8)
+#define SNMP_TARGET_SET_ADD(set, index) ((set)[(index) / 8] |= (u8_t)(1U << ((index) % 8)))
+#define SNMP_TARGET_SET_HAS(set, index) (((set)[(index) / 8] >> ((index) % 8)) & 1U)
+
+/** Defaults of snmp_target_init_defaults() */
+#define SNMP_TARGET_DEFAULT_TIMEOUT  1500 /* centiseconds, as snmpTargetAddrTimeout */
+#define SNMP_TARGET_DEFAULT_RETRIES  3
+
+struct snmp_target {
+  /** snmpTargetAddrName and snmpTargetParamsName, an empty name marks a free slot */
+  char name[SNMP_TARGET_MAX_NAME_LEN + 1];
+  /** destination address */
+  ip_addr_t ip;
+  /** destination port in host order */
+  u16_t port;
+  /** 0 (SNMPv1), 1 (SNMPv2c), 3 (SNMPv3) or SNMP_TARGET_VERSION_DEFAULT */
+  u8_t version;
+  /** SNMP_TARGET_TRAP or SNMP_TARGET_INFORM, SNMPv1 targets only get traps */
+  u8_t type;
+  /** community for SNMPv1/v2c, the agent's trap community when empty;
+   *  the USM user for SNMPv3 */
+  char security_name[SNMP_TARGET_MAX_NAME_LEN + 1];
+  /** SNMP_TARGET_NOAUTH_NOPRIV .. SNMP_TARGET_AUTH_PRIV */
+  u8_t security_level;
+  /** retransmission count of an INFORM */
+  u8_t retries;
+  /** time to wait for the response to an INFORM, in centiseconds, at
+   *  least SNMP_INFORM_TICK_MS */
+  u16_t timeout;
+  /** notifications are only sent to enabled targets */
+  u8_t enable;
+#if SNMP_NOTIFY_FILTERS
+  /** snmpNotifyFilterProfileName, the target gets all notifications when
+   *  empty, see snmp_notify_filter.h */
+  char filter_profile[SNMP_TARGET_MAX_NAME_LEN + 1];
+#endif
+};
+
+void snmp_target_init_defaults(struct snmp_target *target);
+err_t snmp_target_set(u8_t index, const struct snmp_target *target);
+err_t snmp_target_get(u8_t index, struct snmp_target *target);
+void snmp_target_remove(u8_t index);
+void snmp_target_enable(u8_t index, u8_t enable);
+
+extern const struct snmp_mib snmptargetmib;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_SNMP */
+
+#endif /* LWIP_HDR_APPS_SNMP_TARGET_H */
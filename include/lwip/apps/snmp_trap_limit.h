@@ -0,0 +1,136 @@
+/**
+ * @file
+ * SNMP zephyr frontend: rate limiting, deduplication and coalescing of traps.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_TRAP_LIMIT_H
+#define LWIP_HDR_APPS_SNMP_TRAP_LIMIT_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && SNMP_TRAP_LIMIT_RULES
+
+/*
+ * Up to SNMP_TRAP_LIMIT_RULES rules, each for one snmpTrapOID, decide
+ * whether a trap of snmp_send_trap(), snmp_send_trap_generic() or
+ * snmp_send_trap_specific() is sent, before anything is encoded. Traps
+ * without a rule and INFORMs are always sent. A rule can:
+ * - drop a trap whose varbinds hash the same as those of the last trap it
+ *   sent, within dedup_ms of it;
+ * - drop a trap when its token bucket is empty: the bucket holds up to
+ *   burst tokens, gains one every interval_ms and a sent trap takes one;
+ * - count the traps it dropped instead of forgetting them. The next trap
+ *   it sends carries the count in an extra varbind, or, if none is sent
+ *   within coalesce_ms of the first dropped one, a trap with only the count
+ *   varbind is sent then.
+ *
+ * The snmpTrapOID is the one of SNMPv2c: the enterprise OID followed by
+ * the specific code for enterprise specific traps, snmpTraps.<n> for the
+ * generic ones.
+ */
+
+/**
+ * @brief A rule, all times are in milliseconds and 0 turns a step off.
+ */
+struct snmp_trap_limit {
+	struct snmp_obj_id trap_oid;
+	u32_t dedup_ms;    /* window in which equal varbinds are dropped */
+	u16_t burst;       /* size of the token bucket, 0: no rate limit */
+	u32_t interval_ms; /* time to gain one token, not 0 with a burst */
+	u32_t coalesce_ms; /* longest wait before dropped traps are reported */
+};
+
+/**
+ * @brief Counters of a rule, they wrap around.
+ */
+struct snmp_trap_limit_stats {
+	u32_t passed;       /* traps sent */
+	u32_t deduplicated; /* traps dropped as duplicates */
+	u32_t rate_limited; /* traps dropped by the token bucket */
+	u32_t coalesced;    /* dropped traps that were counted in a later one */
+	u32_t summaries;    /* traps sent with only the count varbind */
+};
+
+/**
+ * @brief Sets rule number index, which starts with a full bucket and zero
+ *        counters.
+ *
+ * @return ERR_OK, or ERR_ARG for a bad index, an empty trap OID or one that
+ *         another rule has, or a burst without an interval_ms.
+ */
+err_t snmp_trap_limit_set(u8_t index, const struct snmp_trap_limit *limit);
+
+/**
+ * @brief Removes a rule, the traps it counted are not reported.
+ */
+void snmp_trap_limit_remove(u8_t index);
+
+/**
+ * @brief Copies the counters of a rule.
+ *
+ * @return ERR_OK, or ERR_ARG for a bad index.
+ */
+err_t snmp_trap_limit_get_stats(u8_t index, struct snmp_trap_limit_stats *stats);
+
+/**
+ * @brief Sets the OID of the Unsigned32 varbind with the number of dropped
+ *        traps, 1.3.6.1.4.1.26381.1.1.0 by default.
+ */
+void snmp_trap_limit_set_count_oid(const struct snmp_obj_id *oid);
+
+/**
+ * @brief Sends the counts whose coalesce_ms expired. A work item calls it
+ *        while traps are counted.
+ */
+void snmp_trap_limit_poll(void);
+
+/* Called by the agent for every trap: returns 0 to drop it. Otherwise the
+ * trap is sent, and *dropped is the number of traps to report with it. */
+u8_t snmp_trap_limit_check(const struct snmp_obj_id *trap_oid, const struct snmp_obj_id *eoid,
+			   s32_t generic_trap, s32_t specific_trap,
+			   const struct snmp_varbind *varbinds, u32_t *dropped);
+
+/* Provided by the agent: sends a trap with the count varbind, bypassing
+ * the rules */
+err_t snmp_trap_limit_send_count(const struct snmp_obj_id *eoid, s32_t generic_trap,
+				 s32_t specific_trap, u32_t dropped);
+
+/* The count varbind, for the agent */
+extern struct snmp_obj_id snmp_trap_limit_count_oid;
+
+#endif /* LWIP_SNMP && SNMP_TRAP_LIMIT_RULES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_TRAP_LIMIT_H */
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * SNMP zephyr frontend: asynchronous notifications through a bounded queue.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_TRAP_QUEUE_H
+#define LWIP_HDR_APPS_SNMP_TRAP_QUEUE_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && SNMP_TRAP_QUEUE
+
+/*
+ * snmp_send_trap() encodes and sends a notification to every destination
+ * before it returns. snmp_trap_post() only copies the trap OID and the
+ * varbinds into one of SNMP_TRAP_QUEUE_DEPTH preallocated records and wakes
+ * the sender thread, which passes the records to snmp_send_trap() in the
+ * order they were posted. Posting takes no locks but a spinlock held for a
+ * few stores, so it may be called from time critical threads. The sender
+ * thread sends with the SNMP core locked, see snmp_core_lock(), like an
+ * application thread that calls snmp_send_trap() itself.
+ *
+ * A record holds at most SNMP_TRAP_QUEUE_VARBINDS varbinds, whose OIDs and
+ * values take at most SNMP_TRAP_QUEUE_DATA_SIZE bytes together.
+ */
+
+/**
+ * @brief What snmp_trap_post() does when all records are queued.
+ */
+typedef enum {
+	SNMP_TRAP_QUEUE_DROP_OLDEST, /* the oldest queued notification is dropped */
+	SNMP_TRAP_QUEUE_DROP_NEWEST, /* the posted notification is dropped */
+	SNMP_TRAP_QUEUE_COALESCE     /* the posted notification replaces a queued one
+				      * with the same trap OID and codes, or else
+				      * the oldest one */
+} snmp_trap_queue_policy_t;
+
+/**
+ * @brief Counters of the queue, they wrap around.
+ */
+struct snmp_trap_queue_stats {
+	u32_t posted;     /* notifications queued by snmp_trap_post() */
+	u32_t sent;       /* notifications sent by snmp_send_trap() */
+	u32_t failed;     /* notifications snmp_send_trap() failed on */
+	u32_t dropped;    /* notifications lost to a full queue */
+	u32_t coalesced;  /* queued notifications replaced by a newer one */
+	u32_t too_large;  /* notifications that did not fit into a record */
+	u16_t queued;     /* notifications queued right now */
+	u16_t high_water; /* most notifications queued at once */
+};
+
+/**
+ * @brief Queues a notification for snmp_send_trap(), see there for the
+ *        parameters. The varbinds are copied, the caller may reuse them
+ *        when the function returns.
+ *
+ * @return ERR_OK when queued, ERR_MEM when it was dropped because the queue
+ *         is full, ERR_VAL when it does not fit into a record.
+ */
+err_t snmp_trap_post(const struct snmp_obj_id *oid, s32_t generic_trap, s32_t specific_trap,
+		     const struct snmp_varbind *varbinds);
+
+/**
+ * @brief Selects the overflow policy, SNMP_TRAP_QUEUE_DROP_OLDEST by default.
+ */
+void snmp_trap_queue_set_policy(snmp_trap_queue_policy_t policy);
+snmp_trap_queue_policy_t snmp_trap_queue_get_policy(void);
+
+/**
+ * @brief Copies the counters of the queue.
+ */
+void snmp_trap_queue_get_stats(struct snmp_trap_queue_stats *stats);
+
+/**
+ * @brief Sends all queued notifications in the caller's thread, e.g. before
+ *        a reboot.
+ */
+void snmp_trap_queue_flush(void);
+
+#endif /* LWIP_SNMP && SNMP_TRAP_QUEUE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_TRAP_QUEUE_H */
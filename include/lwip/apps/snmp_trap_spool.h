@@ -0,0 +1,120 @@
+/**
+ * @file
+ * SNMP zephyr frontend: store-and-forward of notifications that could not
+ * be sent.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_TRAP_SPOOL_H
+#define LWIP_HDR_APPS_SNMP_TRAP_SPOOL_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_target.h"
+#include "lwip/pbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && SNMP_TRAP_SPOOL
+
+/*
+ * A SNMPv1 or SNMPv2c notification that snmp_sendto() fails on, e.g. while
+ * the link is down, is kept as encoded in one of SNMP_TRAP_SPOOL records
+ * of SNMP_TRAP_SPOOL_RECORD_SIZE bytes. When all records are in use, the
+ * oldest one is dropped. A destination a send failed for is tried again
+ * every SNMP_TRAP_SPOOL_RETRY_MS, and right away when a notification is
+ * sent to it successfully.
+ *
+ * The spool is replayed in the order the notifications were spooled, one
+ * message per SNMP_TRAP_SPOOL_INTERVAL_MS from the system work queue. A
+ * step is skipped when the agent received a request since the previous
+ * one, so a replay only uses the time the agent is idle.
+ *
+ * With SNMP_TRAP_SPOOL_PERSIST, every record is also written to the
+ * settings subsystem under "snmp/spool/<record>", by a work item, and
+ * removed once replayed. settings_load() puts the records of the previous
+ * boot back into the spool, a replayed INFORM is tracked by snmp_inform.c
+ * again. Flash is only written while notifications are spooled.
+ *
+ * SNMPv3 messages are not spooled: their msgAuthoritativeEngineTime would
+ * be outside the time window of the receiver once the link is back.
+ */
+
+/**
+ * @brief Counters of the spool, they wrap around.
+ */
+struct snmp_trap_spool_stats {
+	u32_t spooled;    /* notifications kept after a failed send */
+	u32_t replayed;   /* spooled notifications sent */
+	u32_t failed;     /* replays that failed again */
+	u32_t dropped;    /* spooled notifications lost to a full spool */
+	u32_t too_large;  /* notifications larger than a record */
+	u32_t deferred;   /* replay steps skipped for the requests of the agent */
+	u32_t restored;   /* notifications read back by settings_load() */
+	u16_t queued;     /* notifications spooled right now */
+	u16_t high_water; /* most notifications spooled at once */
+};
+
+/**
+ * @brief Copies the counters of the spool.
+ */
+void snmp_trap_spool_get_stats(struct snmp_trap_spool_stats *stats);
+
+/**
+ * @brief The number of spooled notifications.
+ */
+u16_t snmp_trap_spool_count(void);
+
+/**
+ * @brief Drops all spooled notifications, also the persisted ones.
+ */
+void snmp_trap_spool_clear(void);
+
+/**
+ * @brief Replays the oldest spooled notification whose destination is due,
+ *        a work item calls it while notifications are spooled.
+ *
+ * @return ERR_OK when one was sent, ERR_INPROGRESS when the step was
+ *         skipped for the agent, ERR_CONN when the send failed and ERR_WOULDBLOCK
+ *         when nothing is due.
+ */
+err_t snmp_trap_spool_poll(void);
+
+/* Called by the agent: keeps a notification snmp_sendto() failed on, and
+ * restarts the replay to a destination a notification was sent to */
+void snmp_trap_spool_store(const struct pbuf *p, u8_t index, const struct snmp_target *target,
+			   s32_t request_id, u8_t inform);
+void snmp_trap_spool_route_up(u8_t index);
+
+#endif /* LWIP_SNMP && SNMP_TRAP_SPOOL */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_TRAP_SPOOL_H */
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * SNMP zephyr frontend: notifications encoded once and sent with new values.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_TRAP_TEMPLATE_H
+#define LWIP_HDR_APPS_SNMP_TRAP_TEMPLATE_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && SNMP_TRAP_TEMPLATES
+
+/*
+ * A template is a notification whose snmpTrapOID and varbind OIDs do not
+ * change, only the values do. snmp_trap_template_register() encodes its
+ * SNMPv2c varbind list once, with sysUpTime and snmpTrapOID in front, and
+ * keeps where each value is. Sending it writes sysUpTime and the new
+ * values over the old ones and copies the list behind the header of every
+ * destination; nothing is encoded again while the values keep their
+ * encoded length. A value that changes its length, e.g. a counter that
+ * passes 0x7FFFFF, moves the varbinds behind it once.
+ *
+ * SNMPv1 destinations get the same varbinds without sysUpTime and
+ * snmpTrapOID, SNMPv3 destinations get them behind the header of
+ * snmpv3_notify_send(), as with snmp_send_trap(). The rules of
+ * snmp_trap_limit.h do not apply to templates.
+ *
+ * Values are passed in a union snmp_variant_value per varbind of the
+ * caller, in the order they were registered in:
+ * - INTEGER: s32;
+ * - Counter32, Gauge32/Unsigned32, TimeTicks: u32;
+ * - Counter64: u64;
+ * - OCTET STRING, IpAddress, Opaque: const_ptr, to as many bytes as the
+ *   value_len they were registered with;
+ * - OBJECT IDENTIFIER, NULL: not used, the registered value is sent.
+ *
+ * The calls take the SNMP core lock of snmp_core_lock() themselves and can
+ * be made from any thread but an ISR.
+ */
+
+/**
+ * @brief Registers a template, as for snmp_send_trap(). The values of
+ *        varbinds are the first ones sent; eoid must stay valid while
+ *        the template is registered.
+ *
+ * @param id [out] the template, for snmp_send_trap_template()
+ * @return ERR_OK, ERR_ARG for more than SNMP_TRAP_TEMPLATE_VARBINDS
+ *         varbinds or one of an unsupported type, ERR_MEM when all
+ *         templates are in use or the encoded varbinds are larger than
+ *         SNMP_TRAP_TEMPLATE_SIZE.
+ */
+err_t snmp_trap_template_register(const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap,
+				  struct snmp_varbind *varbinds, u8_t *id);
+
+/**
+ * @brief Frees a template.
+ */
+void snmp_trap_template_remove(u8_t id);
+
+/**
+ * @brief Sends a template as a trap to all targets, or as an INFORM to the
+ *        targets of type SNMP_TARGET_INFORM.
+ *
+ * @param values one per registered varbind, NULL sends the previous ones
+ * @return ERR_OK, ERR_ARG for an unknown template, ERR_MEM when the new
+ *         values do not fit SNMP_TRAP_TEMPLATE_SIZE, or the error of the
+ *         first destination that failed.
+ */
+err_t snmp_send_trap_template(u8_t id, const union snmp_variant_value *values);
+
+/**
+ * @brief Sends a template as an INFORM to all targets.
+ *
+ * @param ptr_request_id [out] the request ID, to match the acknowledgement
+ */
+err_t snmp_send_inform_template(u8_t id, const union snmp_variant_value *values, s32_t *ptr_request_id);
+
+#endif /* LWIP_SNMP && SNMP_TRAP_TEMPLATES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_TRAP_TEMPLATE_H */
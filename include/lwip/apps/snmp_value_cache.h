@@ -0,0 +1,78 @@
+/**
+ * @file
+ * SNMP cache of pre-encoded scalar values.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_VALUE_CACHE_H
+#define LWIP_HDR_APPS_SNMP_VALUE_CACHE_H
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP
+
+#include "lwip/err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if SNMP_VALUE_CACHE_ENTRIES
+
+/** Counters of the value cache */
+struct snmp_value_cache_stats {
+  /** values copied from the cache */
+  u32_t hits;
+  /** values of registered OIDs which had to be fetched and encoded */
+  u32_t misses;
+  /** values which were too long for a cache slot */
+  u32_t oversized;
+};
+
+err_t snmp_value_cache_register(const u32_t *oid, u8_t oid_len, const u32_t *version);
+void  snmp_value_cache_unregister(const u32_t *oid, u8_t oid_len);
+void  snmp_value_cache_invalidate(const u32_t *oid_prefix, u8_t prefix_len);
+void  snmp_value_cache_invalidate_all(void);
+void  snmp_value_cache_get_stats(struct snmp_value_cache_stats *stats);
+
+#else /* SNMP_VALUE_CACHE_ENTRIES */
+
+#define snmp_value_cache_invalidate(oid_prefix, prefix_len)
+#define snmp_value_cache_invalidate_all()
+
+#endif /* SNMP_VALUE_CACHE_ENTRIES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_SNMP */
+
+#endif /* LWIP_HDR_APPS_SNMP_VALUE_CACHE_H */
@@ -4,6 +4,7 @@
  */
 
 #ifndef __SNMP_ZEPHYR_H
+#define __SNMP_ZEPHYR_H
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,58 @@ extern void snmp_prepare_trap_test(const char *ip_address);
 
 void snmp_install_handlers(void);
 
+/**
+ * @brief The SNMP core lock. snmp_recv_packet() holds it while the agent
+ *        handles a request, and snmp_send_trap() and the other senders of
+ *        notifications hold it while they encode and send, so requests,
+ *        application threads, the trap queue and the work items never use
+ *        the agent's state at the same time.
+ *
+ *        Take it around the calls other threads make into the agent, e.g.
+ *        snmp_target_set() or snmp_set_mibs(); the senders take it
+ *        themselves. It may be taken again by the thread holding it, and
+ *        must not be taken from an ISR.
+ */
+void snmp_core_lock(void);
+void snmp_core_unlock(void);
+
+/**
+ * @brief The static memory pools used by the zephyr port.
+ *        PBUF and PBUF_POOL are counted in elements, HEAP in bytes.
+ */
+typedef enum {
+	SNMP_MEM_POOL_PBUF,       /* pbuf headers for PBUF_REF/PBUF_ROM */
+	SNMP_MEM_POOL_PBUF_POOL,  /* PBUF_POOL buffers */
+	SNMP_MEM_POOL_HEAP,       /* mem_malloc(), used for PBUF_RAM */
+	SNMP_MEM_POOL_COUNT
+} snmp_mem_pool_t;
+
+/**
+ * @brief Usage counters of one memory pool.
+ */
+struct snmp_mem_stats {
+	const char *name;
+	u32_t avail;   /* capacity of the pool */
+	u32_t used;    /* currently allocated */
+	u32_t max;     /* high-water mark of 'used' */
+	u32_t err;     /* allocations that failed */
+	u32_t illegal; /* frees of memory not owned by the pool */
+};
+
+/**
+ * @brief Copies the usage counters of a memory pool.
+ *
+ * @param[in] pool The pool of interest.
+ * @param[out] stats Receives a snapshot of the counters.
+ * @return 0 when 'pool' is not valid, 1 otherwise.
+ */
+u8_t snmp_mem_get_stats(snmp_mem_pool_t pool, struct snmp_mem_stats *stats);
+
+/**
+ * @brief Restarts the high-water marks at the current usage.
+ */
+void snmp_mem_reset_max(void);
+
 /**
  * @brief Converts an array of integeres to a human-readable
  *        character string, representing the OID.
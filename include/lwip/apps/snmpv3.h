@@ -48,14 +48,22 @@ typedef enum
 {
   SNMP_V3_AUTH_ALGO_INVAL = 0,
   SNMP_V3_AUTH_ALGO_MD5   = 1,
-  SNMP_V3_AUTH_ALGO_SHA   = 2
+  SNMP_V3_AUTH_ALGO_SHA   = 2,
+  /* RFC 7860 */
+  SNMP_V3_AUTH_ALGO_SHA224 = 3,
+  SNMP_V3_AUTH_ALGO_SHA256 = 4,
+  SNMP_V3_AUTH_ALGO_SHA384 = 5,
+  SNMP_V3_AUTH_ALGO_SHA512 = 6
 } snmpv3_auth_algo_t;
 
 typedef enum
 {
   SNMP_V3_PRIV_ALGO_INVAL = 0,
   SNMP_V3_PRIV_ALGO_DES   = 1,
-  SNMP_V3_PRIV_ALGO_AES   = 2
+  SNMP_V3_PRIV_ALGO_AES   = 2,
+  /* draft-blumenthal-aes-usm-04, with the key extension of Net-SNMP */
+  SNMP_V3_PRIV_ALGO_AES192 = 3,
+  SNMP_V3_PRIV_ALGO_AES256 = 4
 } snmpv3_priv_algo_t;
 
 typedef enum
@@ -75,12 +83,16 @@ typedef enum
 void snmpv3_get_engine_id(const char **id, u8_t *len);
 err_t snmpv3_set_engine_id(const char* id, u8_t len);
 
+/* provided by the agent when SNMP_V3_ENGINE_TIME is enabled */
 u32_t snmpv3_get_engine_boots(void);
 void snmpv3_set_engine_boots(u32_t boots);
 
 u32_t snmpv3_get_engine_time(void);
 void snmpv3_reset_engine_time(void);
 
+/* auth_key and priv_key point to buffers of 64 octets, the localized key
+ * length of the authentication algorithm (16 for MD5 ... 64 for SHA-512).
+ * AES-192/256 keys shorter than the cipher key are extended by the agent. */
 err_t snmpv3_get_user(const char* username, snmpv3_auth_algo_t *auth_algo, u8_t *auth_key, snmpv3_priv_algo_t *priv_algo, u8_t *priv_key);
 u8_t snmpv3_get_amount_of_users(void);
 err_t snmpv3_get_user_storagetype(const char *username, snmpv3_user_storagetype_t *storagetype);
@@ -89,6 +101,15 @@ err_t snmpv3_get_username(char *username, u8_t index);
 /* The following functions are provided by the SNMPv3 agent */
 
 void snmpv3_engine_id_changed(void);
+void snmpv3_users_changed(void);
+/* with SNMP_V3_REMOTE_ENGINES > 0 */
+void snmpv3_remote_engines_flush(void);
+/* with SNMP_V3_NOTIFICATIONS: the keys of the INFORM user of a target,
+ * Ku of the digest size of auth_algo, localized for the discovered engine.
+ * Takes the SNMP core lock, as SNMPv3 notifications are only sent and
+ * answered with it held */
+err_t snmpv3_set_inform_keys(u8_t target, snmpv3_auth_algo_t auth_algo, const u8_t *auth_ku,
+                             snmpv3_priv_algo_t priv_algo, const u8_t *priv_ku);
 s32_t snmpv3_get_engine_time_internal(void);
 
 void snmpv3_password_to_key_md5(
@@ -105,6 +126,29 @@ void snmpv3_password_to_key_sha(
     u8_t        engineLength, /* IN  - length of snmpEngineID */
     u8_t       *key);         /* OUT - pointer to caller 20-octet buffer */
 
+err_t snmpv3_password_to_key(
+    snmpv3_auth_algo_t algo,  /* IN  - hash of the authentication protocol */
+    const u8_t *password,     /* IN */
+    size_t      passwordlen,  /* IN */
+    const u8_t *engineID,     /* IN  - pointer to snmpEngineID  */
+    u8_t        engineLength, /* IN  - length of snmpEngineID */
+    u8_t       *key);         /* OUT - pointer to caller buffer of the digest size */
+
+/* the two steps of snmpv3_password_to_key(): Ku is the same for all engines,
+ * so a changed engine ID only needs snmpv3_localize_key() again */
+err_t snmpv3_password_to_ku(
+    snmpv3_auth_algo_t algo,  /* IN  - hash of the authentication protocol */
+    const u8_t *password,     /* IN */
+    size_t      passwordlen,  /* IN */
+    u8_t       *ku);          /* OUT - pointer to caller buffer of the digest size */
+
+err_t snmpv3_localize_key(
+    snmpv3_auth_algo_t algo,  /* IN  - hash of the authentication protocol */
+    const u8_t *ku,           /* IN  - result of snmpv3_password_to_ku() */
+    const u8_t *engineID,     /* IN  - pointer to snmpEngineID  */
+    u8_t        engineLength, /* IN  - length of snmpEngineID */
+    u8_t       *key);         /* OUT - pointer to caller buffer of the digest size, may be ku */
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * SNMP zephyr frontend: background localization of SNMPv3 user keys.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_V3_KEYS_H
+#define LWIP_HDR_APPS_SNMP_V3_KEYS_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmpv3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && LWIP_SNMP_V3_MBEDTLS && SNMP_V3_KEYS
+
+/*
+ * The password to key algorithm of RFC 3414 hashes one Megabyte per
+ * password, which takes hundreds of milliseconds on small targets. This
+ * service runs it in a low priority thread and stores the localized keys,
+ * never the passwords, in the Zephyr settings subsystem under
+ * "snmp/keys/<user>". Stored users are loaded by settings_load(), so they
+ * are available without any hashing after a reboot.
+ *
+ * The engine independent key Ku is kept in RAM for users whose passwords
+ * were given since boot. When the engine ID changes, their keys are
+ * localized again in the background, which costs one hash per key. Users
+ * loaded from settings need their passwords again in that case.
+ *
+ * The application's snmpv3_get_user(), snmpv3_get_amount_of_users(),
+ * snmpv3_get_username() and snmpv3_get_user_storagetype() may simply
+ * forward to the snmpv3_keys_*() functions of the same signature.
+ */
+
+/**
+ * @brief The state of the keys of a user.
+ */
+typedef enum {
+	SNMP_V3_KEYS_UNKNOWN, /* no such user */
+	SNMP_V3_KEYS_PENDING, /* keys are being derived */
+	SNMP_V3_KEYS_READY,   /* keys are localized for the current engine ID */
+	SNMP_V3_KEYS_STALE    /* keys belong to another engine ID, the passwords are needed */
+} snmpv3_keys_state_t;
+
+/**
+ * @brief Adds a user or changes its algorithms and passwords. The keys are
+ *        derived and stored in the background; until then the user is
+ *        unknown to the agent.
+ *
+ * @param[in] name The user name, at most 32 characters, without '/' or '='.
+ * @param[in] auth_algo The authentication protocol.
+ * @param[in] auth_password The authentication password, with at least 8
+ *            characters, or NULL for SNMP_V3_AUTH_ALGO_INVAL.
+ * @param[in] priv_algo The privacy protocol, needs authentication.
+ * @param[in] priv_password The privacy password, or NULL for
+ *            SNMP_V3_PRIV_ALGO_INVAL.
+ * @return 0 on success, -EINVAL for invalid parameters, -ENOMEM when all
+ *         SNMP_V3_KEYS_USERS entries are in use.
+ */
+int snmpv3_keys_set_user(const char *name,
+			 snmpv3_auth_algo_t auth_algo, const char *auth_password,
+			 snmpv3_priv_algo_t priv_algo, const char *priv_password);
+
+/**
+ * @brief Removes a user and its stored keys.
+ *
+ * @return 0 on success, -ENOENT when there is no such user.
+ */
+int snmpv3_keys_remove_user(const char *name);
+
+/**
+ * @brief Returns the state of the keys of a user.
+ */
+snmpv3_keys_state_t snmpv3_keys_get_state(const char *name);
+
+/**
+ * @brief Has to be called when the engine ID changed. snmpv3_engine_id_changed()
+ *        does this.
+ */
+void snmpv3_keys_engine_id_changed(void);
+
+/* Implementations of the snmpv3.h callbacks, users are only found once
+ * their keys are ready */
+err_t snmpv3_keys_get_user(const char *username, snmpv3_auth_algo_t *auth_algo, u8_t *auth_key,
+			   snmpv3_priv_algo_t *priv_algo, u8_t *priv_key);
+u8_t snmpv3_keys_get_amount_of_users(void);
+err_t snmpv3_keys_get_username(char *username, u8_t index);
+err_t snmpv3_keys_get_user_storagetype(const char *username, snmpv3_user_storagetype_t *storagetype);
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && LWIP_SNMP_V3_MBEDTLS && SNMP_V3_KEYS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_V3_KEYS_H */
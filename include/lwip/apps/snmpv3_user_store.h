@@ -0,0 +1,141 @@
+/**
+ * @file
+ * SNMP zephyr frontend: hash indexed SNMPv3 user store.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#ifndef LWIP_HDR_APPS_SNMP_V3_USER_STORE_H
+#define LWIP_HDR_APPS_SNMP_V3_USER_STORE_H
+
+#include "lwip/apps/snmp_opts.h"
+#include "lwip/apps/snmpv3.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_USER_STORE
+
+/*
+ * A table of SNMP_V3_USER_STORE_USERS users with localized keys, indexed
+ * twice: by a hash of (engine ID, name) for message processing, and in
+ * usmUserTable order, i.e. by (engine ID, name) as OID, for table walks.
+ * Lookups take O(1), adding or removing a user O(log n) compares plus a
+ * move of the sorted index.
+ *
+ * Each user belongs to the engine ID its keys were localized for. The agent
+ * only uses users of the current engine ID; after snmpv3_set_engine_id()
+ * the users have to be added again with keys for the new engine ID.
+ *
+ * The application's snmpv3_get_user(), snmpv3_get_amount_of_users(),
+ * snmpv3_get_username() and snmpv3_get_user_storagetype() may simply
+ * forward to the snmpv3_user_store_*() functions of the same signature.
+ * The usmUserTable of snmp_snmpv2_usm.c is then read from the store.
+ */
+
+/* SNMP_V3_MAX_ENGINE_ID_LENGTH and SNMP_V3_MAX_USER_LENGTH of snmpv3_priv.h */
+#define SNMP_V3_USER_STORE_MAX_ENGINE_ID_LEN 32
+#define SNMP_V3_USER_STORE_MAX_NAME_LEN      32
+
+/**
+ * @brief A copy of a user, without its keys.
+ */
+struct snmpv3_user_store_info {
+	u8_t engine_id[SNMP_V3_USER_STORE_MAX_ENGINE_ID_LEN];
+	u8_t engine_id_len;
+	char name[SNMP_V3_USER_STORE_MAX_NAME_LEN + 1];
+	u8_t name_len;
+	snmpv3_auth_algo_t auth_algo;
+	snmpv3_priv_algo_t priv_algo;
+	snmpv3_user_storagetype_t storagetype;
+};
+
+/**
+ * @brief Adds a user or replaces the algorithms and keys of an existing one.
+ *
+ * @param[in] engine_id The engine ID the keys are localized for, or NULL for
+ *            the current engine ID.
+ * @param[in] engine_id_len The length of engine_id.
+ * @param[in] name The user name, 1 to 32 characters.
+ * @param[in] auth_key The localized authentication key, as many octets as
+ *            the digest of auth_algo, or NULL for SNMP_V3_AUTH_ALGO_INVAL.
+ * @param[in] priv_key The localized privacy key, or NULL for
+ *            SNMP_V3_PRIV_ALGO_INVAL.
+ * @return 0 on success, -EINVAL for invalid parameters, -ENOMEM when all
+ *         SNMP_V3_USER_STORE_USERS entries are in use.
+ */
+int snmpv3_user_store_add(const u8_t *engine_id, u8_t engine_id_len, const char *name,
+			  snmpv3_auth_algo_t auth_algo, const u8_t *auth_key,
+			  snmpv3_priv_algo_t priv_algo, const u8_t *priv_key,
+			  snmpv3_user_storagetype_t storagetype);
+
+/**
+ * @brief Removes a user.
+ *
+ * @param[in] engine_id The engine ID of the user, or NULL for the current one.
+ * @return 0 on success, -ENOENT when there is no such user.
+ */
+int snmpv3_user_store_remove(const u8_t *engine_id, u8_t engine_id_len, const char *name);
+
+/**
+ * @brief Returns the number of users of all engine IDs.
+ */
+u16_t snmpv3_user_store_count(void);
+
+/**
+ * @brief Looks up a user by engine ID and name.
+ *
+ * @return ERR_OK and a copy of the user in info, ERR_VAL when there is no
+ *         such user.
+ */
+err_t snmpv3_user_store_find(const u8_t *engine_id, u8_t engine_id_len,
+			     const char *name, u8_t name_len, struct snmpv3_user_store_info *info);
+
+/**
+ * @brief Finds the first user whose usmUserTable index
+ *        (engine ID length, engine ID, name length, name) follows the given,
+ *        possibly partial, index.
+ *
+ * @return ERR_OK and a copy of the user in info, ERR_VAL at the end of the
+ *         table.
+ */
+err_t snmpv3_user_store_next(const u32_t *index, u8_t index_len, struct snmpv3_user_store_info *info);
+
+/* Implementations of the snmpv3.h callbacks for the users of the current
+ * engine ID */
+err_t snmpv3_user_store_get_user(const char *username, snmpv3_auth_algo_t *auth_algo, u8_t *auth_key,
+				 snmpv3_priv_algo_t *priv_algo, u8_t *priv_key);
+u8_t snmpv3_user_store_get_amount_of_users(void);
+err_t snmpv3_user_store_get_username(char *username, u8_t index);
+err_t snmpv3_user_store_get_user_storagetype(const char *username, snmpv3_user_storagetype_t *storagetype);
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_USER_STORE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HDR_APPS_SNMP_V3_USER_STORE_H */
@@ -36,6 +36,42 @@ u32_t sys_now (void);
 #define MEM_ALIGNMENT           4U
 #define PBUF_POOL_BUFSIZE      1470
 
+/**
+ * MEM_SIZE: the size of the static heap behind mem_malloc(), used for
+ * PBUF_RAM buffers. It is divided into blocks of 2048 bytes, one of which
+ * holds a complete outgoing SNMP message.
+ */
+#if !defined MEM_SIZE || defined __DOXYGEN__
+#ifdef CONFIG_SNMP_MEM_SIZE
+#define MEM_SIZE                        CONFIG_SNMP_MEM_SIZE
+#else
+#define MEM_SIZE                        4096
+#endif
+#endif
+
+/**
+ * MEMP_NUM_PBUF: the number of pbuf headers for PBUF_REF and PBUF_ROM.
+ */
+#if !defined MEMP_NUM_PBUF || defined __DOXYGEN__
+#ifdef CONFIG_SNMP_MEMP_NUM_PBUF
+#define MEMP_NUM_PBUF                   CONFIG_SNMP_MEMP_NUM_PBUF
+#else
+#define MEMP_NUM_PBUF                   4
+#endif
+#endif
+
+/**
+ * PBUF_POOL_SIZE: the number of buffers in the pbuf pool, each of
+ * PBUF_POOL_BUFSIZE bytes.
+ */
+#if !defined PBUF_POOL_SIZE || defined __DOXYGEN__
+#ifdef CONFIG_SNMP_PBUF_POOL_SIZE
+#define PBUF_POOL_SIZE                  CONFIG_SNMP_PBUF_POOL_SIZE
+#else
+#define PBUF_POOL_SIZE                  1
+#endif
+#endif
+
 #ifdef LWIP_ERR_T
 typedef LWIP_ERR_T err_t;
 #else /* LWIP_ERR_T */
@@ -71,6 +107,10 @@ typedef struct ip4_addr ip4_addr_t;
 #define MEMCPY(dst,src,len)             memcpy(dst,src,len)
 #endif
 
+#if !defined SMEMCPY || defined __DOXYGEN__
+#define SMEMCPY(dst,src,len)            memcpy(dst,src,len)
+#endif
+
 #define MIB2_STATS   1
 
 #define LWIP_UDP     1
@@ -99,7 +139,93 @@ extern struct netif *netif_list;
 #define SNMP_USE_NETCONN         0  /* lwIP netconn. */
 #define SNMP_USE_ZEPHYR          1  /* Use Zephyr TCP//IP stack. */
 
+#ifdef CONFIG_SNMP_V3
+#define LWIP_SNMP_V3             1
+#endif
+
+#ifndef LWIP_SNMP_V3
 #define LWIP_SNMP_V3             0
+#endif
+
+#ifdef CONFIG_SNMP_ARENA_SIZE
+#define SNMP_ARENA_SIZE          CONFIG_SNMP_ARENA_SIZE
+#endif
+
+#ifdef CONFIG_SNMP_VALUE_CACHE_ENTRIES
+#define SNMP_VALUE_CACHE_ENTRIES     CONFIG_SNMP_VALUE_CACHE_ENTRIES
+#define SNMP_VALUE_CACHE_VALUE_SIZE  CONFIG_SNMP_VALUE_CACHE_VALUE_SIZE
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_DESTINATIONS
+#define SNMP_TRAP_DESTINATIONS       CONFIG_SNMP_TRAP_DESTINATIONS
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_QUEUE
+#define SNMP_TRAP_QUEUE              1
+#define SNMP_TRAP_QUEUE_DEPTH        CONFIG_SNMP_TRAP_QUEUE_DEPTH
+#define SNMP_TRAP_QUEUE_VARBINDS     CONFIG_SNMP_TRAP_QUEUE_VARBINDS
+#define SNMP_TRAP_QUEUE_DATA_SIZE    CONFIG_SNMP_TRAP_QUEUE_DATA_SIZE
+#define SNMP_TRAP_QUEUE_STACK_SIZE   CONFIG_SNMP_TRAP_QUEUE_STACK_SIZE
+#define SNMP_TRAP_QUEUE_THREAD_PRIO  CONFIG_SNMP_TRAP_QUEUE_THREAD_PRIORITY
+#endif
+
+#ifdef CONFIG_SNMP_INFORM_PENDING
+#define SNMP_INFORM_PENDING          CONFIG_SNMP_INFORM_PENDING
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_SPOOL
+#define SNMP_TRAP_SPOOL              CONFIG_SNMP_TRAP_SPOOL
+#define SNMP_TRAP_SPOOL_RECORD_SIZE  CONFIG_SNMP_TRAP_SPOOL_RECORD_SIZE
+#define SNMP_TRAP_SPOOL_INTERVAL_MS  CONFIG_SNMP_TRAP_SPOOL_INTERVAL_MS
+#define SNMP_TRAP_SPOOL_RETRY_MS     CONFIG_SNMP_TRAP_SPOOL_RETRY_MS
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_SPOOL_PERSIST
+#define SNMP_TRAP_SPOOL_PERSIST      1
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_LIMIT_RULES
+#define SNMP_TRAP_LIMIT_RULES        CONFIG_SNMP_TRAP_LIMIT_RULES
+#endif
+
+#ifdef CONFIG_SNMP_TRAP_TEMPLATES
+#define SNMP_TRAP_TEMPLATES          CONFIG_SNMP_TRAP_TEMPLATES
+#define SNMP_TRAP_TEMPLATE_SIZE      CONFIG_SNMP_TRAP_TEMPLATE_SIZE
+#define SNMP_TRAP_TEMPLATE_VARBINDS  CONFIG_SNMP_TRAP_TEMPLATE_VARBINDS
+#endif
+
+#ifdef CONFIG_SNMP_NOTIFY_FILTERS
+#define SNMP_NOTIFY_FILTERS          CONFIG_SNMP_NOTIFY_FILTERS
+#define SNMP_NOTIFY_FILTER_NODES     CONFIG_SNMP_NOTIFY_FILTER_NODES
+#endif
+
+#ifdef CONFIG_SNMP_V3_USER_CACHE_ENTRIES
+#define SNMP_V3_USER_CACHE_ENTRIES   CONFIG_SNMP_V3_USER_CACHE_ENTRIES
+#endif
+
+#ifdef CONFIG_SNMP_V3_KEYS
+#define SNMP_V3_KEYS                 1
+#define SNMP_V3_KEYS_USERS           CONFIG_SNMP_V3_KEYS_USERS
+#define SNMP_V3_KEYS_STACK_SIZE      CONFIG_SNMP_V3_KEYS_STACK_SIZE
+#define SNMP_V3_KEYS_THREAD_PRIO     CONFIG_SNMP_V3_KEYS_THREAD_PRIORITY
+#endif
+
+#ifdef CONFIG_SNMP_V3_ENGINE_TIME
+#define SNMP_V3_ENGINE_TIME          1
+#endif
+
+#ifdef CONFIG_SNMP_V3_REMOTE_ENGINES
+#define SNMP_V3_REMOTE_ENGINES       CONFIG_SNMP_V3_REMOTE_ENGINES
+#endif
+
+#ifdef CONFIG_SNMP_V3_NOTIFICATIONS
+#define SNMP_V3_NOTIFICATIONS        1
+#endif
+
+#ifdef CONFIG_SNMP_V3_USER_STORE
+#define SNMP_V3_USER_STORE           1
+#define SNMP_V3_USER_STORE_USERS     CONFIG_SNMP_V3_USER_STORE_USERS
+#endif
 
 /**
  * LWIP_PBUF_REF_T: Refcount type in pbuf.
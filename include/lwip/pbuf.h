@@ -116,6 +116,10 @@ struct pbuf * pbuf_clone(pbuf_layer layer, pbuf_type type, struct pbuf *p);
 
 struct pbuf * pbuf_alloc_reference(void *payload, u16_t length, pbuf_type type);
 
+void pbuf_ref(struct pbuf *p);
+
+void pbuf_chain(struct pbuf *h, struct pbuf *t);
+
 #define pbuf_get_allocsrc( p )            ( ( p )->type_internal & PBUF_TYPE_ALLOC_SRC_MASK )
 #define pbuf_match_allocsrc( p, type )    ( pbuf_get_allocsrc( p ) == ( ( type ) & PBUF_TYPE_ALLOC_SRC_MASK ) )
 
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * SNMP per-request scratch arena.
+ *
+ * Objects which only live while one request is being processed (the request
+ * state, node instances, OID buffers, temporary data of MIB backends) are
+ * taken from a static bump arena of SNMP_ARENA_SIZE bytes instead of the
+ * caller's stack. Allocation is a pointer increment; nothing is freed
+ * individually. snmp_receive() resets the arena when a request is done.
+ * Nested users may take a snmp_arena_mark() and snmp_arena_release() it
+ * to give back their scratch memory earlier.
+ *
+ * The peak usage is recorded so SNMP_ARENA_SIZE and the stack of the thread
+ * calling snmp_receive() can be sized tightly.
+ *
+ * Like the rest of the SNMP core, the arena must only be used from the
+ * thread that processes SNMP requests.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/apps/snmp_arena.h"
+#include "lwip/def.h"
+
+/* All allocations are aligned for the strictest basic type, u64_t counters included */
+#define SNMP_ARENA_ALIGNMENT  8U
+#define SNMP_ARENA_ALIGN_SIZE(size) (((size) + SNMP_ARENA_ALIGNMENT - 1U) & ~(SNMP_ARENA_ALIGNMENT - 1U))
+
+static union {
+  u8_t bytes[SNMP_ARENA_ALIGN_SIZE(SNMP_ARENA_SIZE)];
+  double align;
+} snmp_arena_buf;
+
+static u32_t snmp_arena_used;
+static struct snmp_arena_stats snmp_arena_counters = { SNMP_ARENA_ALIGN_SIZE(SNMP_ARENA_SIZE), 0, 0, 0 };
+
+/**
+ * Allocates 'size' bytes of scratch memory which stays valid until the
+ * current request is finished (or until an earlier mark is released).
+ * @return NULL if the arena is exhausted
+ */
+void *
+snmp_arena_alloc(size_t size)
+{
+  u32_t aligned = SNMP_ARENA_ALIGN_SIZE((u32_t)size);
+  void *mem;
+
+  if ((size > sizeof(snmp_arena_buf.bytes)) || (aligned > (sizeof(snmp_arena_buf.bytes) - snmp_arena_used))) {
+    LWIP_DEBUGF(SNMP_DEBUG, ("snmp_arena_alloc: %u bytes do not fit, %u in use\n", (unsigned)size, (unsigned)snmp_arena_used));
+    snmp_arena_counters.failed++;
+    return NULL;
+  }
+
+  mem = &snmp_arena_buf.bytes[snmp_arena_used];
+  snmp_arena_used += aligned;
+  snmp_arena_counters.used = snmp_arena_used;
+  if (snmp_arena_counters.peak < snmp_arena_used) {
+    snmp_arena_counters.peak = snmp_arena_used;
+  }
+
+  return mem;
+}
+
+/** Returns the current fill level, to be passed to snmp_arena_release() */
+snmp_arena_mark_t
+snmp_arena_mark(void)
+{
+  return snmp_arena_used;
+}
+
+/** Frees everything that was allocated after 'mark' was taken */
+void
+snmp_arena_release(snmp_arena_mark_t mark)
+{
+  LWIP_ASSERT("snmp_arena_release: invalid mark", mark <= snmp_arena_used);
+  if (mark <= snmp_arena_used) {
+    snmp_arena_used = mark;
+    snmp_arena_counters.used = mark;
+  }
+}
+
+/** Frees the whole arena, called when a request has been processed */
+void
+snmp_arena_reset(void)
+{
+  snmp_arena_used = 0;
+  snmp_arena_counters.used = 0;
+}
+
+void
+snmp_arena_get_stats(struct snmp_arena_stats *stats)
+{
+  *stats = snmp_arena_counters;
+}
+
+void
+snmp_arena_reset_peak(void)
+{
+  snmp_arena_counters.peak = snmp_arena_used;
+}
+
+#endif /* LWIP_SNMP */
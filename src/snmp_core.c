@@ -189,6 +189,8 @@
 #include "lwip/apps/snmp.h"
 #include "lwip/apps/snmp_core.h"
 #include "lwip/apps/snmp_scalar.h"
+#include "lwip/apps/snmp_arena.h"
+#include "lwip/apps/snmp_value_cache.h"
 #include "snmp_core_priv.h"
 #include "lwip/netif.h"
 #include <string.h>
@@ -215,11 +217,23 @@ const struct snmp_obj_id_const_ref snmp_zero_dot_zero = { LWIP_ARRAYSIZE(snmp_ze
 #include "lwip/apps/snmp_mib2.h"
 #include "lwip/apps/snmp_snmpv2_framework.h"
 #include "lwip/apps/snmp_snmpv2_usm.h"
-static const struct snmp_mib *const default_mibs[] = { &mib2, &snmpframeworkmib, &snmpusmmib };
+#include "lwip/apps/snmp_target.h"
+#include "lwip/apps/snmp_notify_filter.h"
+static const struct snmp_mib *const default_mibs[] = { &mib2, &snmpframeworkmib, &snmptargetmib, &snmpusmmib
+#if SNMP_NOTIFY_FILTERS
+                                                       , &snmpnotificationmib
+#endif
+                                                     };
 static u8_t snmp_num_mibs                          = LWIP_ARRAYSIZE(default_mibs);
 #elif SNMP_LWIP_MIB2
 #include "lwip/apps/snmp_mib2.h"
-static const struct snmp_mib *const default_mibs[] = { &mib2 };
+#include "lwip/apps/snmp_target.h"
+#include "lwip/apps/snmp_notify_filter.h"
+static const struct snmp_mib *const default_mibs[] = { &mib2, &snmptargetmib
+#if SNMP_NOTIFY_FILTERS
+                                                       , &snmpnotificationmib
+#endif
+                                                     };
 static u8_t snmp_num_mibs                          = LWIP_ARRAYSIZE(default_mibs);
 #else
 static const struct snmp_mib *const default_mibs[] = { NULL };
@@ -271,6 +285,14 @@ void snmp_set_device_enterprise_oid(const struct snmp_obj_id *device_enterprise_
   } else {
     snmp_device_enterprise_oid = device_enterprise_oid;
   }
+#if SNMP_LWIP_MIB2
+  {
+    /* sysObjectID reports this OID */
+    static const u32_t sysobjectid_oid[] = { 1, 3, 6, 1, 2, 1, 1, 2 };
+    LWIP_UNUSED_ARG(sysobjectid_oid);
+    snmp_value_cache_invalidate(sysobjectid_oid, LWIP_ARRAYSIZE(sysobjectid_oid));
+  }
+#endif
 }
 
 /**
@@ -800,7 +822,7 @@ snmp_get_node_instance_from_oid(const u32_t *oid, u8_t oid_len, struct snmp_node
 
 #ifdef LWIP_DEBUG
       if (result == SNMP_ERR_NOERROR) {
-        if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != 0) && (node_instance->get_value == NULL)) {
+        if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != 0) && (node_instance->get_value == NULL) && (node_instance->write_value == NULL)) {
           LWIP_DEBUGF(SNMP_DEBUG, ("SNMP inconsistent access: node is readable but no get_value function is specified\n"));
         }
         if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_WRITE) != 0) && (node_instance->set_value == NULL)) {
@@ -867,6 +889,8 @@ snmp_get_next_node_instance_from_oid(const u32_t *oid, u8_t oid_len, snmp_valida
       node_instance->set_test         = NULL;
       node_instance->set_value        = NULL;
       node_instance->release_instance = NULL;
+      node_instance->get_value_len    = NULL;
+      node_instance->write_value      = NULL;
       node_instance->reference.ptr    = NULL;
       node_instance->reference_len    = 0;
 
@@ -877,7 +901,7 @@ snmp_get_next_node_instance_from_oid(const u32_t *oid, u8_t oid_len, snmp_valida
 
       if (result == SNMP_ERR_NOERROR) {
 #ifdef LWIP_DEBUG
-        if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != 0) && (node_instance->get_value == NULL)) {
+        if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != 0) && (node_instance->get_value == NULL) && (node_instance->write_value == NULL)) {
           LWIP_DEBUGF(SNMP_DEBUG, ("SNMP inconsistent access: node is readable but no get_value function is specified\n"));
         }
         if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_WRITE) != 0) && (node_instance->set_value == NULL)) {
@@ -1028,7 +1052,8 @@ snmp_mib_tree_resolve_next(const struct snmp_mib *mib, const u32_t *oid, u8_t oi
 {
   u8_t  oid_offset = mib->base_oid_len;
   const struct snmp_node *const *node;
-  const struct snmp_tree_node *node_stack[SNMP_MAX_OBJ_ID_LEN];
+  const struct snmp_tree_node **node_stack;
+  snmp_arena_mark_t arena_mark;
   s32_t nsi = 0; /* NodeStackIndex */
   u32_t subnode_oid;
 
@@ -1037,6 +1062,13 @@ snmp_mib_tree_resolve_next(const struct snmp_mib *mib, const u32_t *oid, u8_t oi
     return NULL;
   }
 
+  /* the node stack is scratch memory, it is taken from the request arena instead of the stack */
+  arena_mark = snmp_arena_mark();
+  node_stack = (const struct snmp_tree_node **)snmp_arena_alloc(SNMP_MAX_OBJ_ID_LEN * sizeof(*node_stack));
+  if (node_stack == NULL) {
+    return NULL;
+  }
+
   /* first build node stack related to passed oid (as far as possible), then go backwards to determine the next node */
   node_stack[nsi] = (const struct snmp_tree_node *)(const void *)mib->root_node;
   while (oid_offset < oid_len) {
@@ -1110,11 +1142,13 @@ snmp_mib_tree_resolve_next(const struct snmp_mib *mib, const u32_t *oid, u8_t oi
         oidret->id[oidret->len] = subnode->oid;
         oidret->len++;
 
+        snmp_arena_release(arena_mark);
         return subnode;
       }
     }
   }
 
+  snmp_arena_release(arena_mark);
   return NULL;
 }
 
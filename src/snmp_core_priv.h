@@ -52,6 +52,16 @@ extern "C" {
 #endif
 #endif
 
+/* The SNMP core lock of the zephyr frontend, see snmp_core_lock() */
+#if SNMP_USE_ZEPHYR
+#include "lwip/apps/snmp_zephyr.h"
+#define SNMP_CORE_LOCK()   snmp_core_lock()
+#define SNMP_CORE_UNLOCK() snmp_core_unlock()
+#else
+#define SNMP_CORE_LOCK()
+#define SNMP_CORE_UNLOCK()
+#endif
+
 /* (outdated) SNMPv1 error codes
  * shall not be used by MIBS anymore, nevertheless required from core for properly answering a v1 request
  */
@@ -82,6 +92,17 @@ typedef u8_t (*snmp_validate_node_instance_method)(struct snmp_node_instance *,
 u8_t snmp_get_node_instance_from_oid(const u32_t *oid, u8_t oid_len, struct snmp_node_instance *node_instance);
 u8_t snmp_get_next_node_instance_from_oid(const u32_t *oid, u8_t oid_len, snmp_validate_node_instance_method validate_node_instance_method, void *validate_node_instance_arg, struct snmp_obj_id *node_oid, struct snmp_node_instance *node_instance);
 
+#if SNMP_VALUE_CACHE_ENTRIES
+struct snmp_varbind;
+s16_t snmp_value_cache_find(const struct snmp_obj_id *oid);
+const u8_t *snmp_value_cache_get(s16_t slot, u16_t *enc_len);
+void snmp_value_cache_store(s16_t slot, struct snmp_varbind *varbind);
+#endif
+
+/* the notification targets of snmp_target.c, read by snmp_traps.c */
+#include "lwip/apps/snmp_target.h"
+extern struct snmp_target snmp_targets[SNMP_TRAP_DESTINATIONS];
+
 #ifdef __cplusplus
 }
 #endif
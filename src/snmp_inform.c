@@ -0,0 +1,482 @@
+/**
+ * @file
+ * SNMP zephyr frontend: retransmission and acknowledgement of INFORMs.
+ *
+ * An entry holds a flat copy of the encoded INFORM, so a retransmission
+ * only calls snmp_sendto(). Pending entries are linked twice:
+ * - into the bucket request_id % SNMP_INFORM_PENDING of a hash, consecutive
+ *   request IDs land in different buckets and only the targets of one
+ *   INFORM share one;
+ * - into the slot due_tick % INFORM_WHEEL_SLOTS of a timer wheel, where a
+ *   tick is SNMP_INFORM_TICK_MS. snmp_inform_poll() visits the slots of
+ *   the ticks that passed and fires the entries that are due in them;
+ *   entries due in a later turn of the wheel stay in their slot.
+ * All of it is protected by inform_lock, a mutex, as the retransmissions
+ * are sent while holding it.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && SNMP_INFORM_PENDING
+
+	#include "lwip/apps/snmp_inform.h"
+	#include "snmp_msg.h"
+
+	#define INFORM_NONE          0xFFU
+	#define INFORM_WHEEL_SLOTS   64U
+	/* the doubled timeout stops growing here */
+	#define INFORM_MAX_TIMEOUT   60000U
+
+	BUILD_ASSERT( SNMP_INFORM_PENDING < INFORM_NONE, "SNMP_INFORM_PENDING is too large" );
+
+	struct inform_entry
+	{
+		/* the encoded INFORM, NULL for a free entry */
+		struct pbuf * p;
+		ip_addr_t ip;
+		u16_t port;
+		s32_t request_id;
+		/* sys_now() of the last transmission */
+		u32_t sent_ms;
+		u32_t timeout_ms;
+		u32_t due_tick;
+		/* the completion callback of the notification, see snmp_inform_track() */
+		snmp_inform_done_fct done;
+		void * done_arg;
+		u8_t target;
+		u8_t retries_left;
+		bool retransmitted;
+		u8_t hash_next;
+		u8_t wheel_next;
+		u8_t wheel_prev;
+	};
+
+	static struct inform_entry inform_entries[ SNMP_INFORM_PENDING ];
+	static u8_t inform_buckets[ SNMP_INFORM_PENDING ];
+	static u8_t inform_wheel[ INFORM_WHEEL_SLOTS ];
+	/* the last tick snmp_inform_poll() visited */
+	static u32_t inform_tick;
+	static u8_t inform_free;
+	static u16_t inform_count;
+	static bool inform_ready;
+	static struct snmp_inform_stats inform_stats[ SNMP_TRAP_DESTINATIONS ];
+	static snmp_inform_done_fct inform_done;
+	static void * inform_done_arg;
+
+	/* Protects everything above. Zephyr mutexes nest, so the completion
+	 * callback may send another INFORM. */
+	static K_MUTEX_DEFINE( inform_lock );
+
+	static void inform_work_handler( struct k_work * work );
+
+	static K_WORK_DELAYABLE_DEFINE( inform_work, inform_work_handler );
+
+	static inline u32_t inform_now_tick( void )
+	{
+		return sys_now() / SNMP_INFORM_TICK_MS;
+	}
+
+	/* Call with inform_lock held. */
+	static void inform_init( void )
+	{
+		u8_t i;
+
+		for( i = 0; i < SNMP_INFORM_PENDING; i++ )
+		{
+			inform_entries[ i ].hash_next = ( i + 1 < SNMP_INFORM_PENDING ) ? ( u8_t ) ( i + 1 ) : INFORM_NONE;
+			inform_buckets[ i ] = INFORM_NONE;
+		}
+		memset( inform_wheel, INFORM_NONE, sizeof( inform_wheel ) );
+		inform_free  = 0;
+		inform_tick  = inform_now_tick();
+		inform_ready = true;
+	}
+
+	/* Call with inform_lock held: links an entry into the slot of its tick. */
+	static void inform_wheel_insert( u8_t index )
+	{
+		struct inform_entry * entry = &inform_entries[ index ];
+		u8_t * slot = &inform_wheel[ entry->due_tick % INFORM_WHEEL_SLOTS ];
+
+		entry->wheel_prev = INFORM_NONE;
+		entry->wheel_next = *slot;
+		if( *slot != INFORM_NONE )
+		{
+			inform_entries[ *slot ].wheel_prev = index;
+		}
+		*slot = index;
+	}
+
+	/* Call with inform_lock held. */
+	static void inform_wheel_remove( u8_t index )
+	{
+		struct inform_entry * entry = &inform_entries[ index ];
+
+		if( entry->wheel_prev != INFORM_NONE )
+		{
+			inform_entries[ entry->wheel_prev ].wheel_next = entry->wheel_next;
+		}
+		else
+		{
+			inform_wheel[ entry->due_tick % INFORM_WHEEL_SLOTS ] = entry->wheel_next;
+		}
+		if( entry->wheel_next != INFORM_NONE )
+		{
+			inform_entries[ entry->wheel_next ].wheel_prev = entry->wheel_prev;
+		}
+	}
+
+	/* Call with inform_lock held: schedules the next timeout of an entry. */
+	static void inform_schedule( u8_t index, u32_t now_ms )
+	{
+		struct inform_entry * entry = &inform_entries[ index ];
+
+		entry->sent_ms  = now_ms;
+		entry->due_tick = ( now_ms + entry->timeout_ms + SNMP_INFORM_TICK_MS - 1U ) / SNMP_INFORM_TICK_MS;
+		inform_wheel_insert( index );
+	}
+
+	/* Call with inform_lock held: unlinks an entry from the hash and the
+	 * wheel, frees it and reports the result. */
+	static void inform_complete( u8_t index, u8_t * link, err_t result )
+	{
+		struct inform_entry * entry = &inform_entries[ index ];
+		s32_t request_id = entry->request_id;
+		u8_t target = entry->target;
+		snmp_inform_done_fct done = entry->done;
+		void * done_arg = entry->done_arg;
+
+		*link = entry->hash_next;
+		inform_wheel_remove( index );
+		pbuf_free( entry->p );
+		entry->p         = NULL;
+		entry->hash_next = inform_free;
+		inform_free      = index;
+		inform_count--;
+
+		if( inform_done != NULL )
+		{
+			inform_done( request_id, target, result, inform_done_arg );
+		}
+		if( done != NULL )
+		{
+			done( request_id, target, result, done_arg );
+		}
+	}
+
+	/* Call with inform_lock held: the hash link that points to an entry. */
+	static u8_t * inform_link_of( u8_t index )
+	{
+		u8_t * link = &inform_buckets[ ( u32_t ) inform_entries[ index ].request_id % SNMP_INFORM_PENDING ];
+
+		while( *link != index )
+		{
+			link = &inform_entries[ *link ].hash_next;
+		}
+		return link;
+	}
+
+	void snmp_inform_track( const struct pbuf * p, u8_t index, const struct snmp_target * target, s32_t request_id,
+							snmp_inform_done_fct done, void * done_arg )
+	{
+		struct inform_entry * entry;
+		struct snmp_inform_stats * stats = &inform_stats[ index ];
+		struct pbuf * copy;
+		u8_t * bucket;
+		u8_t entry_index;
+
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		if( !inform_ready )
+		{
+			inform_init();
+		}
+		stats->sent++;
+		if( inform_free == INFORM_NONE )
+		{
+			stats->untracked++;
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		copy = pbuf_alloc( PBUF_TRANSPORT, p->tot_len, PBUF_RAM );
+		if( copy == NULL )
+		{
+			stats->untracked++;
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		( void ) pbuf_copy_partial( p, copy->payload, p->tot_len, 0 );
+
+		entry_index = inform_free;
+		entry       = &inform_entries[ entry_index ];
+		inform_free = entry->hash_next;
+		inform_count++;
+
+		entry->p             = copy;
+		ip_addr_copy( entry->ip, target->ip );
+		entry->port          = target->port;
+		entry->request_id    = request_id;
+		/* a timeout of 0 would not grow, the retries would go out tick by tick */
+		entry->timeout_ms    = LWIP_MIN( LWIP_MAX( ( u32_t ) target->timeout * 10U, SNMP_INFORM_TICK_MS ), INFORM_MAX_TIMEOUT );
+		entry->target        = index;
+		entry->retries_left  = target->retries;
+		entry->retransmitted = false;
+		entry->done          = done;
+		entry->done_arg      = done_arg;
+
+		bucket           = &inform_buckets[ ( u32_t ) request_id % SNMP_INFORM_PENDING ];
+		entry->hash_next = *bucket;
+		*bucket          = entry_index;
+		inform_schedule( entry_index, sys_now() );
+		k_mutex_unlock( &inform_lock );
+
+		/* no-op when the work is already scheduled */
+		k_work_schedule( &inform_work, K_MSEC( SNMP_INFORM_TICK_MS ) );
+	}
+
+	void snmp_inform_cancel( s32_t request_id, u8_t index )
+	{
+		struct snmp_inform_stats * stats = &inform_stats[ index ];
+		struct inform_entry * entry;
+		u8_t * link;
+
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		stats->sent--;
+		for( link = &inform_buckets[ ( u32_t ) request_id % SNMP_INFORM_PENDING ];
+			 *link != INFORM_NONE;
+			 link = &inform_entries[ *link ].hash_next )
+		{
+			entry = &inform_entries[ *link ];
+			if( ( entry->request_id == request_id ) && ( entry->target == index ) )
+			{
+				break;
+			}
+		}
+		if( *link == INFORM_NONE )
+		{
+			/* snmp_inform_track() had no entry for it */
+			stats->untracked--;
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		/* as inform_complete(), without a result */
+		entry            = &inform_entries[ *link ];
+		*link            = entry->hash_next;
+		inform_wheel_remove( ( u8_t ) ( entry - inform_entries ) );
+		pbuf_free( entry->p );
+		entry->p         = NULL;
+		entry->hash_next = inform_free;
+		inform_free      = ( u8_t ) ( entry - inform_entries );
+		inform_count--;
+		k_mutex_unlock( &inform_lock );
+	}
+
+	void snmp_inform_response( s32_t request_id, const ip_addr_t * source_ip )
+	{
+		struct snmp_inform_stats * stats;
+		struct inform_entry * entry;
+		u8_t * link;
+		u32_t rtt;
+
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		if( !inform_ready )
+		{
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		for( link = &inform_buckets[ ( u32_t ) request_id % SNMP_INFORM_PENDING ];
+			 *link != INFORM_NONE;
+			 link = &inform_entries[ *link ].hash_next )
+		{
+			entry = &inform_entries[ *link ];
+			if( ( entry->request_id == request_id ) && ip_addr_cmp( &entry->ip, source_ip ) )
+			{
+				stats = &inform_stats[ entry->target ];
+				stats->acked++;
+				if( !entry->retransmitted )
+				{
+					rtt = sys_now() - entry->sent_ms;
+					stats->rtt_last_ms = rtt;
+					if( stats->rtt_samples == 0U )
+					{
+						stats->rtt_min_ms = rtt;
+						stats->rtt_max_ms = rtt;
+						stats->rtt_avg_ms = rtt;
+					}
+					else
+					{
+						stats->rtt_min_ms = LWIP_MIN( stats->rtt_min_ms, rtt );
+						stats->rtt_max_ms = LWIP_MAX( stats->rtt_max_ms, rtt );
+						stats->rtt_avg_ms = ( u32_t ) ( ( s32_t ) stats->rtt_avg_ms + ( ( s32_t ) rtt - ( s32_t ) stats->rtt_avg_ms ) / 8 );
+					}
+					stats->rtt_samples++;
+				}
+				inform_complete( *link, link, ERR_OK );
+				break;
+			}
+		}
+		k_mutex_unlock( &inform_lock );
+	}
+
+	void snmp_inform_update( s32_t request_id, const struct pbuf * p )
+	{
+		struct inform_entry * entry;
+		struct pbuf * copy;
+		u8_t index;
+
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		if( !inform_ready )
+		{
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		for( index = inform_buckets[ ( u32_t ) request_id % SNMP_INFORM_PENDING ];
+			 index != INFORM_NONE;
+			 index = entry->hash_next )
+		{
+			entry = &inform_entries[ index ];
+			if( entry->request_id == request_id )
+			{
+				copy = pbuf_alloc( PBUF_TRANSPORT, p->tot_len, PBUF_RAM );
+				if( copy != NULL )
+				{
+					( void ) pbuf_copy_partial( p, copy->payload, p->tot_len, 0 );
+					pbuf_free( entry->p );
+					entry->p = copy;
+				}
+				/* the new message was just sent, it times out from now */
+				entry->retransmitted = false;
+				inform_wheel_remove( index );
+				inform_schedule( index, sys_now() );
+				break;
+			}
+		}
+		k_mutex_unlock( &inform_lock );
+	}
+
+	/* Call with inform_lock held: the timeout of an entry expired. */
+	static void inform_expire( u8_t index, u32_t now_ms )
+	{
+		struct inform_entry * entry = &inform_entries[ index ];
+
+		if( entry->retries_left == 0U )
+		{
+			inform_stats[ entry->target ].timed_out++;
+			inform_complete( index, inform_link_of( index ), ERR_TIMEOUT );
+			return;
+		}
+		entry->retries_left--;
+		entry->retransmitted = true;
+		inform_stats[ entry->target ].retransmitted++;
+		snmp_stats.outpkts++;
+		( void ) snmp_sendto( snmp_traps_handle, entry->p, &entry->ip, htons( entry->port ) );
+
+		inform_wheel_remove( index );
+		entry->timeout_ms = LWIP_MIN( entry->timeout_ms * 2U, INFORM_MAX_TIMEOUT );
+		inform_schedule( index, now_ms );
+	}
+
+	void snmp_inform_poll( void )
+	{
+		u32_t now_ms = sys_now();
+		u32_t now_tick = now_ms / SNMP_INFORM_TICK_MS;
+		u32_t slots;
+		u8_t index;
+		u8_t next;
+
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		if( !inform_ready )
+		{
+			k_mutex_unlock( &inform_lock );
+			return;
+		}
+		/* after a whole turn every slot has been visited */
+		slots = LWIP_MIN( now_tick - inform_tick, INFORM_WHEEL_SLOTS );
+		while( slots-- > 0U )
+		{
+			inform_tick++;
+			index = inform_wheel[ inform_tick % INFORM_WHEEL_SLOTS ];
+			while( index != INFORM_NONE )
+			{
+				next = inform_entries[ index ].wheel_next;
+				if( ( s32_t ) ( inform_entries[ index ].due_tick - now_tick ) <= 0 )
+				{
+					/* a rescheduled entry lands in a later slot */
+					inform_expire( index, now_ms );
+				}
+				index = next;
+			}
+		}
+		inform_tick = now_tick;
+		k_mutex_unlock( &inform_lock );
+	}
+
+	static void inform_work_handler( struct k_work * work )
+	{
+		ARG_UNUSED( work );
+
+		/* the agent takes inform_lock with the core locked, and the
+		 * callbacks of a poll may send */
+		snmp_core_lock();
+		snmp_inform_poll();
+		snmp_core_unlock();
+		if( snmp_inform_pending() > 0U )
+		{
+			k_work_schedule( &inform_work, K_MSEC( SNMP_INFORM_TICK_MS ) );
+		}
+	}
+
+	void snmp_inform_set_done_callback( snmp_inform_done_fct done, void * arg )
+	{
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		inform_done     = done;
+		inform_done_arg = arg;
+		k_mutex_unlock( &inform_lock );
+	}
+
+	err_t snmp_inform_get_stats( u8_t target, struct snmp_inform_stats * stats )
+	{
+		if( target >= SNMP_TRAP_DESTINATIONS )
+		{
+			return ERR_ARG;
+		}
+		k_mutex_lock( &inform_lock, K_FOREVER );
+		*stats = inform_stats[ target ];
+		k_mutex_unlock( &inform_lock );
+		return ERR_OK;
+	}
+
+	u16_t snmp_inform_pending( void )
+	{
+		return inform_count;
+	}
+
+#endif /* LWIP_SNMP && SNMP_INFORM_PENDING */
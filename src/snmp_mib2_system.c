@@ -39,6 +39,7 @@
 #include "lwip/apps/snmp_mib2.h"
 #include "lwip/apps/snmp_table.h"
 #include "lwip/apps/snmp_scalar.h"
+#include "lwip/apps/snmp_value_cache.h"
 #include "lwip/sys.h"
 
 #include <string.h>
@@ -85,6 +86,15 @@ static u8_t        *syslocation_wr            = NULL; /* if writable, points to
 static u16_t       *syslocation_wr_len        = NULL; /* if writable, points to the same buffer as syslocation_len (required for correct constness) */
 static u16_t        syslocation_bufsize       = 0;    /* 0=not writable */
 
+/** drop the pre-encoded value of mib-2.system.<oid>.0 from the value cache */
+static void
+system_invalidate_cached(u32_t oid)
+{
+  const u32_t system_oid[] = { 1, 3, 6, 1, 2, 1, 1, oid };
+  LWIP_UNUSED_ARG(system_oid);
+  snmp_value_cache_invalidate(system_oid, LWIP_ARRAYSIZE(system_oid));
+}
+
 /**
  * @ingroup snmp_mib2
  * Initializes sysDescr pointers.
@@ -98,6 +108,7 @@ snmp_mib2_set_sysdescr(const u8_t *str, const u16_t *len)
   if (str != NULL) {
     sysdescr     = str;
     sysdescr_len = len;
+    system_invalidate_cached(1);
   }
 }
 
@@ -123,6 +134,7 @@ snmp_mib2_set_syscontact(u8_t *ocstr, u16_t *ocstrlen, u16_t bufsize)
     syscontact_len     = ocstrlen;
     syscontact_wr_len  = ocstrlen;
     syscontact_bufsize = bufsize;
+    system_invalidate_cached(4);
   }
 }
 
@@ -139,6 +151,7 @@ snmp_mib2_set_syscontact_readonly(const u8_t *ocstr, const u16_t *ocstrlen)
     syscontact_wr      = NULL;
     syscontact_wr_len  = NULL;
     syscontact_bufsize = 0;
+    system_invalidate_cached(4);
   }
 }
 
@@ -165,6 +178,7 @@ snmp_mib2_set_sysname(u8_t *ocstr, u16_t *ocstrlen, u16_t bufsize)
     sysname_len     = ocstrlen;
     sysname_wr_len  = ocstrlen;
     sysname_bufsize = bufsize;
+    system_invalidate_cached(5);
   }
 }
 
@@ -181,6 +195,7 @@ snmp_mib2_set_sysname_readonly(const u8_t *ocstr, const u16_t *ocstrlen)
     sysname_wr      = NULL;
     sysname_wr_len  = NULL;
     sysname_bufsize = 0;
+    system_invalidate_cached(5);
   }
 }
 
@@ -206,6 +221,7 @@ snmp_mib2_set_syslocation(u8_t *ocstr, u16_t *ocstrlen, u16_t bufsize)
     syslocation_len     = ocstrlen;
     syslocation_wr_len  = ocstrlen;
     syslocation_bufsize = bufsize;
+    system_invalidate_cached(6);
   }
 }
 
@@ -222,6 +238,7 @@ snmp_mib2_set_syslocation_readonly(const u8_t *ocstr, const u16_t *ocstrlen)
     syslocation_wr      = NULL;
     syslocation_wr_len  = NULL;
     syslocation_bufsize = 0;
+    system_invalidate_cached(6);
   }
 }
 
@@ -238,7 +255,7 @@ const char *oid_names[] = {
 //#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
 static const char *oid_name(int index)
 {
-	if (index < (sizeof oid_names / sizeof oid_names[0])) {
+	if ((index >= 0) && ((size_t)index < (sizeof oid_names / sizeof oid_names[0]))) {
 		return oid_names[index];
 	}
 	return "oidUnknown";
@@ -377,6 +394,7 @@ system_set_value(const struct snmp_scalar_array_node_def *node, u16_t len, void
   } else {
     *var_wr_len = len;
   }
+  system_invalidate_cached(node->oid);
 
   return SNMP_ERR_NOERROR;
 }
@@ -47,6 +47,9 @@
 #include "lwip/stats.h"
 #include "lwip/snmp.h"
 #include "lwip/apps/snmp_callback.h"
+#include "lwip/apps/snmp_arena.h"
+#include "lwip/apps/snmp_value_cache.h"
+#include "lwip/apps/snmp_inform.h"
 
 #if LWIP_SNMP_V3
 #include "lwip/apps/snmpv3.h"
@@ -302,67 +305,60 @@ static const char *request_name (int request)
 	return "GET_UNKNOWN";
 }
 
-void
-snmp_receive(void *handle, struct pbuf *p, const ip_addr_t *source_ip, u16_t port)
+static void
+snmp_receive_request(struct snmp_request *request)
 {
   err_t err;
-  struct snmp_request request;
-
-  memset(&request, 0, sizeof(request));
-  request.handle       = handle;
-  request.source_ip    = source_ip;
-  request.source_port  = port;
-  request.inbound_pbuf = p;
 
-  snmp_stats.inpkts++;
-
-  err = snmp_parse_inbound_frame( &request );
+  err = snmp_parse_inbound_frame( request );
   zephyr_log( "snmp_receive: snmp_parse returns %02X type %s\n",
     err,
-	request_name (request.request_type));
+	request_name (request->request_type));
 
   if (err == ERR_OK) {
-    if (request.request_type == SNMP_ASN1_CONTEXT_PDU_GET_RESP)	{
-      if (request.error_status == SNMP_ERR_NOERROR)	{
+    if (request->request_type == SNMP_ASN1_CONTEXT_PDU_GET_RESP)	{
+#if SNMP_INFORM_PENDING
+      /* any response ends the retransmission of the INFORM it answers */
+      snmp_inform_response(request->request_id, request->source_ip);
+#endif
+      if (request->error_status == SNMP_ERR_NOERROR)	{
         snmp_vb_enumerator_err_t err;
         struct snmp_varbind vb;
         zephyr_log( "snmp_receive: received a get-response\n" );
 
         memset( &vb, 0, sizeof vb );
-        vb.object_value = request.value_buffer;
+        vb.object_value = request->value_buffer;
 
-        LWIP_DEBUGF( SNMP_DEBUG, ( "SNMP_get_request %d", request.request_type ) );
+        LWIP_DEBUGF( SNMP_DEBUG, ( "SNMP_get_request %d", request->request_type ) );
 
-        while( request.error_status == SNMP_ERR_NOERROR ) {
-          err = snmp_vb_enumerator_get_next( &request.inbound_varbind_enumerator, &vb );
-          if( err == SNMP_VB_ENUMERATOR_ERR_OK ) {
-            zephyr_log("getRequest %s\n",
-            print_oid(vb.oid.len, vb.oid.id));
-            break;
-          }
+        /* a malformed varbind list must not keep us here */
+        err = snmp_vb_enumerator_get_next( &request->inbound_varbind_enumerator, &vb );
+        if( err == SNMP_VB_ENUMERATOR_ERR_OK ) {
+          zephyr_log("getRequest %s\n",
+          print_oid(vb.oid.len, vb.oid.id));
         }
 
         /* If callback function has been defined call it. */
         if (snmp_inform_callback != NULL) {
-          snmp_inform_callback(&request, snmp_inform_callback_arg);
+          snmp_inform_callback(request, snmp_inform_callback_arg);
         }
       }
       /* stop further handling of GET RESP PDU, we are an agent */
       return;
     }
-    err = snmp_prepare_outbound_frame(&request);
+    err = snmp_prepare_outbound_frame(request);
     if (err == ERR_OK) {
 
-      if (request.error_status == SNMP_ERR_NOERROR) {
+      if (request->error_status == SNMP_ERR_NOERROR) {
         /* only process frame if we do not already have an error to return (e.g. all readonly) */
-        if (request.request_type == SNMP_ASN1_CONTEXT_PDU_GET_REQ) {
-          err = snmp_process_get_request(&request);
-        } else if (request.request_type == SNMP_ASN1_CONTEXT_PDU_GET_NEXT_REQ) {
-          err = snmp_process_getnext_request(&request);
-        } else if (request.request_type == SNMP_ASN1_CONTEXT_PDU_GET_BULK_REQ) {
-          err = snmp_process_getbulk_request(&request);
-        } else if (request.request_type == SNMP_ASN1_CONTEXT_PDU_SET_REQ) {
-          err = snmp_process_set_request(&request);
+        if (request->request_type == SNMP_ASN1_CONTEXT_PDU_GET_REQ) {
+          err = snmp_process_get_request(request);
+        } else if (request->request_type == SNMP_ASN1_CONTEXT_PDU_GET_NEXT_REQ) {
+          err = snmp_process_getnext_request(request);
+        } else if (request->request_type == SNMP_ASN1_CONTEXT_PDU_GET_BULK_REQ) {
+          err = snmp_process_getbulk_request(request);
+        } else if (request->request_type == SNMP_ASN1_CONTEXT_PDU_SET_REQ) {
+          err = snmp_process_set_request(request);
         }
       }
 #if LWIP_SNMP_V3
@@ -374,87 +370,128 @@ snmp_receive(void *handle, struct pbuf *p, const ip_addr_t *source_ip, u16_t por
         vb.type = SNMP_ASN1_TYPE_COUNTER32;
         vb.value_len = sizeof(u32_t);
 
-        switch (request.error_status) {
+        switch (request->error_status) {
           case SNMP_ERR_AUTHORIZATIONERROR: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 5, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.wrongdigests;
+            vb.object_value = &snmp_stats.wrongdigests;
           }
           break;
           case SNMP_ERR_UNKNOWN_ENGINEID: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 4, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.unknownengineids;
+            vb.object_value = &snmp_stats.unknownengineids;
           }
           break;
           case SNMP_ERR_UNKNOWN_SECURITYNAME: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 3, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.unknownusernames;
+            vb.object_value = &snmp_stats.unknownusernames;
           }
           break;
           case SNMP_ERR_UNSUPPORTED_SECLEVEL: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 1, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.unsupportedseclevels;
+            vb.object_value = &snmp_stats.unsupportedseclevels;
           }
           break;
           case SNMP_ERR_NOTINTIMEWINDOW: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 2, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.notintimewindows;
+            vb.object_value = &snmp_stats.notintimewindows;
           }
           break;
           case SNMP_ERR_DECRYIPTION_ERROR: {
             static const u32_t oid[] = { 1, 3, 6, 1, 6, 3, 15, 1, 1, 6, 0 };
             snmp_oid_assign(&vb.oid, oid, LWIP_ARRAYSIZE(oid));
-            vb.value = &snmp_stats.decryptionerrors;
+            vb.object_value = &snmp_stats.decryptionerrors;
           }
           break;
           default:
             /* Unknown or unhandled error_status */
-            zephyr_log("Unknown or unhandled error_status", request.error_status);
+            zephyr_log("Unknown or unhandled error_status", request->error_status);
             err = ERR_ARG;
         }
 
         if (err == ERR_OK) {
-          snmp_append_outbound_varbind(&(request.outbound_pbuf_stream), &vb);
-          request.error_status = SNMP_ERR_NOERROR;
+          snmp_append_outbound_varbind(&(request->outbound_pbuf_stream), &vb);
+          request->error_status = SNMP_ERR_NOERROR;
         }
 
-        request.request_out_type = (SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_REPORT);
-        request.request_id = request.msg_id;
+        request->request_out_type = (SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_REPORT);
+        request->request_id = request->msg_id;
       }
 #endif
 
       if (err == ERR_OK) {
-        err = snmp_complete_outbound_frame(&request);
+        err = snmp_complete_outbound_frame(request);
 
         if (err == ERR_OK) {
-          int rc = snmp_sendto(request.handle, request.outbound_pbuf, request.source_ip, request.source_port);
+          int rc = snmp_sendto(request->handle, request->outbound_pbuf, request->source_ip, request->source_port);
           if (rc <= 0) {
             err = ERR_CONN;
           }
-          if ((request.request_type == SNMP_ASN1_CONTEXT_PDU_SET_REQ)
-              && (request.error_status == SNMP_ERR_NOERROR)
+          if ((request->request_type == SNMP_ASN1_CONTEXT_PDU_SET_REQ)
+              && (request->error_status == SNMP_ERR_NOERROR)
               && (snmp_write_callback != NULL)) {
             /* raise write notification for all written objects */
-            snmp_execute_write_callbacks(&request);
+            snmp_execute_write_callbacks(request);
           }
         }
       }
     }
 
-    if (request.outbound_pbuf != NULL) {
-      pbuf_free(request.outbound_pbuf);
+    if (request->outbound_pbuf != NULL) {
+      pbuf_free(request->outbound_pbuf);
     }
   }
 }
 
+void
+snmp_receive(void *handle, struct pbuf *p, const ip_addr_t *source_ip, u16_t port)
+{
+  struct snmp_request *request;
+
+  snmp_stats.inpkts++;
+
+#if LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS
+  /* REPORTs and responses of the receivers of our SNMPv3 INFORMs */
+  if (snmpv3_notify_receive(p, source_ip)) {
+    return;
+  }
+#endif
+#if LWIP_SNMP_V3 && SNMP_V3_FAST_DISCOVERY
+  /* engine discovery probes are answered without a request state */
+  if (snmpv3_discovery_receive(handle, p, source_ip, port)) {
+    return;
+  }
+#endif
+
+  /* the request state lives in the arena, which is emptied when the request is done */
+  request = (struct snmp_request *)snmp_arena_alloc(sizeof(*request));
+  if (request == NULL) {
+    zephyr_log("snmp_receive: arena too small, request dropped\n");
+    return;
+  }
+
+  memset(request, 0, sizeof(*request));
+  request->handle       = handle;
+  request->source_ip    = source_ip;
+  request->source_port  = port;
+  request->inbound_pbuf = p;
+
+  snmp_receive_request(request);
+
+  snmp_arena_reset();
+}
+
 static u8_t
 snmp_msg_getnext_validate_node_inst(struct snmp_node_instance *node_instance, void *validate_arg)
 {
-  if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != SNMP_NODE_INSTANCE_ACCESS_READ) || (node_instance->get_value == NULL)) {
+  if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_READ) != SNMP_NODE_INSTANCE_ACCESS_READ) ||
+      ((node_instance->get_value == NULL) &&
+       ((node_instance->get_value_len == NULL) || (node_instance->write_value == NULL)))) {
+    /* neither a value nor a streamed one */
     return SNMP_ERR_NOSUCHINSTANCE;
   }
 
@@ -472,26 +509,39 @@ static void
 snmp_process_varbind(struct snmp_request *request, struct snmp_varbind *vb, u8_t get_next)
 {
   err_t err;
-  struct snmp_node_instance node_instance;
-  memset(&node_instance, 0, sizeof(node_instance));
+  /* node instance and result OID are scratch data, taken from the request arena */
+  snmp_arena_mark_t arena_mark = snmp_arena_mark();
+  struct snmp_node_instance *node_instance = (struct snmp_node_instance *)snmp_arena_alloc(sizeof(*node_instance));
+
+  if (node_instance == NULL) {
+    request->error_status = SNMP_ERR_GENERROR;
+    return;
+  }
+  memset(node_instance, 0, sizeof(*node_instance));
 
   if (get_next) {
-    struct snmp_obj_id result_oid;
-    request->error_status = snmp_get_next_node_instance_from_oid(vb->oid.id, vb->oid.len, snmp_msg_getnext_validate_node_inst, request,  &result_oid, &node_instance);
+    struct snmp_obj_id *result_oid = (struct snmp_obj_id *)snmp_arena_alloc(sizeof(*result_oid));
+
+    if (result_oid == NULL) {
+      request->error_status = SNMP_ERR_GENERROR;
+      snmp_arena_release(arena_mark);
+      return;
+    }
+    request->error_status = snmp_get_next_node_instance_from_oid(vb->oid.id, vb->oid.len, snmp_msg_getnext_validate_node_inst, request, result_oid, node_instance);
 
     if (request->error_status == SNMP_ERR_NOERROR) {
-      snmp_oid_assign(&vb->oid, result_oid.id, result_oid.len);
+      snmp_oid_assign(&vb->oid, result_oid->id, result_oid->len);
     }
   } else {
-    request->error_status = snmp_get_node_instance_from_oid(vb->oid.id, vb->oid.len, &node_instance);
+    request->error_status = snmp_get_node_instance_from_oid(vb->oid.id, vb->oid.len, node_instance);
 
     if (request->error_status == SNMP_ERR_NOERROR) {
       /* use 'getnext_validate' method for validation to avoid code duplication (some checks have to be executed here) */
-      request->error_status = snmp_msg_getnext_validate_node_inst(&node_instance, request);
+      request->error_status = snmp_msg_getnext_validate_node_inst(node_instance, request);
 
       if (request->error_status != SNMP_ERR_NOERROR) {
-        if (node_instance.release_instance != NULL) {
-          node_instance.release_instance(&node_instance);
+        if (node_instance->release_instance != NULL) {
+          node_instance->release_instance(node_instance);
         }
       }
     }
@@ -520,26 +570,50 @@ snmp_process_varbind(struct snmp_request *request, struct snmp_varbind *vb, u8_t
     }
   } else {
 	s16_t len = 0;
-	{
-		const char *ptr;
-		ptr = print_oid(vb->oid.len, vb->oid.id);
-		len = snmp_private_call_handler(ptr, vb->object_value);
-		/* When the OID is not found, call the earlier get_value() method. */
-		if ((len == 0) && (node_instance.get_value != NULL)) {
-		  len = node_instance.get_value(&node_instance, vb->object_value);
-		  if (len <= 0) {
-		  	/* Log this event, just for debugging. */
-			  zephyr_log("snmp_process_varbind: no value found for %s\n", ptr);
-		  }
+	if ((node_instance->get_value_len != NULL) && (node_instance->write_value != NULL)) {
+		/* large values are written by the node directly into the response */
+		err = snmp_append_outbound_varbind_streamed(&request->outbound_pbuf_stream, vb, node_instance);
+	} else {
+#if SNMP_VALUE_CACHE_ENTRIES
+		/* static and versioned scalars are copied from their pre-encoded value */
+		s16_t cache_slot = snmp_value_cache_find(&vb->oid);
+		const u8_t *cached = NULL;
+		u16_t cached_len = 0;
+
+		if (cache_slot >= 0) {
+			cached = snmp_value_cache_get(cache_slot, &cached_len);
+		}
+		if (cached != NULL) {
+			err = snmp_append_outbound_varbind_encoded(&request->outbound_pbuf_stream, &vb->oid, cached, cached_len);
+		} else
+#endif
+		{
+			const char *ptr;
+			ptr = print_oid(vb->oid.len, vb->oid.id);
+			len = snmp_private_call_handler(ptr, vb->object_value);
+			/* When the OID is not found, call the earlier get_value() method. */
+			if ((len == 0) && (node_instance->get_value != NULL)) {
+			  len = node_instance->get_value(node_instance, vb->object_value);
+			  if (len <= 0) {
+			  	/* Log this event, just for debugging. */
+				  zephyr_log("snmp_process_varbind: no value found for %s\n", ptr);
+			  }
+			}
+			if (len >= 0) {
+			  vb->value_len = (u16_t)len; /* cast is OK because we checked >= 0 above */
+			  vb->type = node_instance->asn1_type;
+
+			  LWIP_ASSERT("SNMP_MAX_VALUE_SIZE is configured too low", (vb->value_len & ~SNMP_GET_VALUE_RAW_DATA) <= SNMP_MAX_VALUE_SIZE);
+			  err = snmp_append_outbound_varbind(&request->outbound_pbuf_stream, vb);
+#if SNMP_VALUE_CACHE_ENTRIES
+			  if ((err == ERR_OK) && (cache_slot >= 0)) {
+			    snmp_value_cache_store(cache_slot, vb);
+			  }
+#endif
+			}
 		}
 	}
     if (len >= 0) {
-      vb->value_len = (u16_t)len; /* cast is OK because we checked >= 0 above */
-      vb->type = node_instance.asn1_type;
-
-      LWIP_ASSERT("SNMP_MAX_VALUE_SIZE is configured too low", (vb->value_len & ~SNMP_GET_VALUE_RAW_DATA) <= SNMP_MAX_VALUE_SIZE);
-      err = snmp_append_outbound_varbind(&request->outbound_pbuf_stream, vb);
-
       if (err == ERR_BUF) {
         request->error_status = SNMP_ERR_TOOBIG;
       } else if (err != ERR_OK) {
@@ -549,10 +623,12 @@ snmp_process_varbind(struct snmp_request *request, struct snmp_varbind *vb, u8_t
       request->error_status = SNMP_ERR_GENERROR;
     }
 
-    if (node_instance.release_instance != NULL) {
-      node_instance.release_instance(&node_instance);
+    if (node_instance->release_instance != NULL) {
+      node_instance->release_instance(node_instance);
     }
   }
+
+  snmp_arena_release(arena_mark);
 }
 
 
@@ -752,25 +828,32 @@ snmp_process_set_request(struct snmp_request *request)
   while (request->error_status == SNMP_ERR_NOERROR) {
     err = snmp_vb_enumerator_get_next(&request->inbound_varbind_enumerator, &vb);
     if (err == SNMP_VB_ENUMERATOR_ERR_OK) {
-      struct snmp_node_instance node_instance;
-      memset(&node_instance, 0, sizeof(node_instance));
+      snmp_arena_mark_t arena_mark = snmp_arena_mark();
+      struct snmp_node_instance *node_instance = (struct snmp_node_instance *)snmp_arena_alloc(sizeof(*node_instance));
+
+      if (node_instance == NULL) {
+        request->error_status = SNMP_ERR_GENERROR;
+        break;
+      }
+      memset(node_instance, 0, sizeof(*node_instance));
 
-      request->error_status = snmp_get_node_instance_from_oid(vb.oid.id, vb.oid.len, &node_instance);
+      request->error_status = snmp_get_node_instance_from_oid(vb.oid.id, vb.oid.len, node_instance);
       if (request->error_status == SNMP_ERR_NOERROR) {
-        if (node_instance.asn1_type != vb.type) {
+        if (node_instance->asn1_type != vb.type) {
           request->error_status = SNMP_ERR_WRONGTYPE;
-        } else if (((node_instance.access & SNMP_NODE_INSTANCE_ACCESS_WRITE) != SNMP_NODE_INSTANCE_ACCESS_WRITE) || (node_instance.set_value == NULL)) {
+        } else if (((node_instance->access & SNMP_NODE_INSTANCE_ACCESS_WRITE) != SNMP_NODE_INSTANCE_ACCESS_WRITE) || (node_instance->set_value == NULL)) {
           request->error_status = SNMP_ERR_NOTWRITABLE;
         } else {
-          if (node_instance.set_test != NULL) {
-            request->error_status = node_instance.set_test(&node_instance, vb.value_len, vb.object_value);
+          if (node_instance->set_test != NULL) {
+            request->error_status = node_instance->set_test(node_instance, vb.value_len, vb.object_value);
           }
         }
 
-        if (node_instance.release_instance != NULL) {
-          node_instance.release_instance(&node_instance);
+        if (node_instance->release_instance != NULL) {
+          node_instance->release_instance(node_instance);
         }
       }
+      snmp_arena_release(arena_mark);
     } else if (err == SNMP_VB_ENUMERATOR_ERR_EOVB) {
       /* no more varbinds in request */
       break;
@@ -790,11 +873,17 @@ snmp_process_set_request(struct snmp_request *request)
     while (request->error_status == SNMP_ERR_NOERROR) {
       err = snmp_vb_enumerator_get_next(&request->inbound_varbind_enumerator, &vb);
       if (err == SNMP_VB_ENUMERATOR_ERR_OK) {
-        struct snmp_node_instance node_instance;
-        memset(&node_instance, 0, sizeof(node_instance));
-        request->error_status = snmp_get_node_instance_from_oid(vb.oid.id, vb.oid.len, &node_instance);
+        snmp_arena_mark_t arena_mark = snmp_arena_mark();
+        struct snmp_node_instance *node_instance = (struct snmp_node_instance *)snmp_arena_alloc(sizeof(*node_instance));
+
+        if (node_instance == NULL) {
+          request->error_status = SNMP_ERR_GENERROR;
+          break;
+        }
+        memset(node_instance, 0, sizeof(*node_instance));
+        request->error_status = snmp_get_node_instance_from_oid(vb.oid.id, vb.oid.len, node_instance);
         if (request->error_status == SNMP_ERR_NOERROR) {
-          if (node_instance.set_value(&node_instance, vb.value_len, vb.object_value) != SNMP_ERR_NOERROR) {
+          if (node_instance->set_value(node_instance, vb.value_len, vb.object_value) != SNMP_ERR_NOERROR) {
             if (request->inbound_varbind_enumerator.varbind_count == 1) {
               request->error_status = SNMP_ERR_COMMITFAILED;
             } else {
@@ -803,10 +892,11 @@ snmp_process_set_request(struct snmp_request *request)
             }
           }
 
-          if (node_instance.release_instance != NULL) {
-            node_instance.release_instance(&node_instance);
+          if (node_instance->release_instance != NULL) {
+            node_instance->release_instance(node_instance);
           }
         }
+        snmp_arena_release(arena_mark);
       } else if (err == SNMP_VB_ENUMERATOR_ERR_EOVB) {
         /* no more varbinds in request */
         break;
@@ -1024,9 +1114,8 @@ snmp_parse_inbound_frame(struct snmp_request *request)
     inbound_msgAuthenticationParameters_offset = pbuf_stream.offset;
     LWIP_UNUSED_ARG(inbound_msgAuthenticationParameters_offset);
     /* Read auth parameters */
-    /* IF_PARSE_ASSERT(tlv.value_len <= SNMP_V3_MAX_AUTH_PARAM_LENGTH); */
     IF_PARSE_EXEC(snmp_asn1_dec_raw(&pbuf_stream, tlv.value_len, request->msg_authentication_parameters,
-                                    &u16_value, tlv.value_len));
+                                    &u16_value, SNMP_V3_MAX_AUTH_PARAM_LENGTH));
     request->msg_authentication_parameters_len = (u8_t)u16_value;
 
     /* msgPrivacyParameters */
@@ -1063,12 +1152,15 @@ snmp_parse_inbound_frame(struct snmp_request *request)
     }
 
     /* 4) verify username */
-    if (snmpv3_get_user((char *)request->msg_user_name, &auth, NULL, &priv, NULL)) {
+    request->usm_user = snmpv3_user_cache_get(request->msg_user_name, request->msg_user_name_len);
+    if (request->usm_user == NULL) {
       snmp_stats.unknownusernames++;
       request->msg_flags = 0; /* noauthnopriv */
       request->error_status = SNMP_ERR_UNKNOWN_SECURITYNAME;
       return ERR_OK;
     }
+    auth = request->usm_user->auth_algo;
+    priv = request->usm_user->priv_algo;
 
     /* 5) verify security level */
     switch (request->msg_flags & (SNMP_V3_AUTH_FLAG | SNMP_V3_PRIV_FLAG)) {
@@ -1112,11 +1204,10 @@ snmp_parse_inbound_frame(struct snmp_request *request)
 #if LWIP_SNMP_V3_CRYPTO
     if (request->msg_flags & SNMP_V3_AUTH_FLAG) {
       const u8_t zero_arr[SNMP_V3_MAX_AUTH_PARAM_LENGTH] = { 0 };
-      u8_t key[20];
-      u8_t hmac[LWIP_MAX(SNMP_V3_SHA_LEN, SNMP_V3_MD5_LEN)];
+      u8_t hmac[SNMP_V3_MAX_KEY_LENGTH];
       struct snmp_pbuf_stream auth_stream;
 
-      if (request->msg_authentication_parameters_len > SNMP_V3_MAX_AUTH_PARAM_LENGTH) {
+      if (request->msg_authentication_parameters_len != snmpv3_auth_param_length(auth)) {
         snmp_stats.wrongdigests++;
         request->msg_flags = SNMP_V3_NOAUTHNOPRIV;
         request->error_status = SNMP_ERR_AUTHORIZATIONERROR;
@@ -1132,10 +1223,9 @@ snmp_parse_inbound_frame(struct snmp_request *request)
       /* Verify authentication */
       IF_PARSE_EXEC(snmp_pbuf_stream_init(&auth_stream, request->inbound_pbuf, 0, request->inbound_pbuf->tot_len));
 
-      IF_PARSE_EXEC(snmpv3_get_user((char *)request->msg_user_name, &auth, key, NULL, NULL));
-      IF_PARSE_EXEC(snmpv3_auth(&auth_stream, request->inbound_pbuf->tot_len, key, auth, hmac));
+      IF_PARSE_EXEC(snmpv3_auth(request->usm_user, &auth_stream, request->inbound_pbuf->tot_len, hmac));
 
-      if (lwip_memcmp_consttime(request->msg_authentication_parameters, hmac, SNMP_V3_MAX_AUTH_PARAM_LENGTH)) {
+      if (lwip_memcmp_consttime(request->msg_authentication_parameters, hmac, request->msg_authentication_parameters_len)) {
         snmp_stats.wrongdigests++;
         request->msg_flags = SNMP_V3_NOAUTHNOPRIV;
         request->error_status = SNMP_ERR_AUTHORIZATIONERROR;
@@ -1176,17 +1266,14 @@ snmp_parse_inbound_frame(struct snmp_request *request)
     if (request->msg_flags & SNMP_V3_PRIV_FLAG) {
       /* Decrypt message */
 
-      u8_t key[20];
-
       IF_PARSE_EXEC(snmp_asn1_dec_tlv(&pbuf_stream, &tlv));
       IF_PARSE_ASSERT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
       parent_tlv_value_len -= SNMP_ASN1_TLV_HDR_LENGTH(tlv);
       IF_PARSE_ASSERT(parent_tlv_value_len > 0);
 
-      IF_PARSE_EXEC(snmpv3_get_user((char *)request->msg_user_name, NULL, NULL, &priv, key));
-      if (snmpv3_crypt(&pbuf_stream, tlv.value_len, key,
+      if (snmpv3_crypt(request->usm_user, &pbuf_stream, tlv.value_len,
                        request->msg_privacy_parameters, request->msg_authoritative_engine_boots,
-                       request->msg_authoritative_engine_time, priv, SNMP_V3_PRIV_MODE_DECRYPT) != ERR_OK) {
+                       request->msg_authoritative_engine_time, SNMP_V3_PRIV_MODE_DECRYPT) != ERR_OK) {
         snmp_stats.decryptionerrors++;
         request->msg_flags = SNMP_V3_AUTHNOPRIV;
         request->error_status = SNMP_ERR_DECRYIPTION_ERROR;
@@ -1458,6 +1545,18 @@ snmp_prepare_outbound_frame(struct snmp_request *request)
     OF_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
     OF_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, request->msg_authoritative_engine_id, request->msg_authoritative_engine_id_len));
 
+#if SNMP_V3_ENGINE_TIME
+    {
+      /* msgAuthoritativeEngineBoots and msgAuthoritativeEngineTime, encoded
+       * by the engine clock once per second */
+      struct snmpv3_engine_fields engine;
+
+      snmpv3_get_engine_fields(&engine);
+      request->msg_authoritative_engine_time = engine.time;
+      request->msg_authoritative_engine_boots = engine.boots;
+      OF_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, engine.enc, engine.enc_len));
+    }
+#else
     request->msg_authoritative_engine_time = snmpv3_get_engine_time();
     request->msg_authoritative_engine_boots = snmpv3_get_engine_boots();
 
@@ -1472,6 +1571,7 @@ snmp_prepare_outbound_frame(struct snmp_request *request)
     snmp_asn1_enc_s32t_cnt(request->msg_authoritative_engine_time, &tlv.value_len);
     OF_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
     OF_BUILD_EXEC(snmp_asn1_enc_s32t(pbuf_stream, tlv.value_len, request->msg_authoritative_engine_time));
+#endif
 
     /* msgUserName */
     SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 0, request->msg_user_name_len);
@@ -1481,11 +1581,16 @@ snmp_prepare_outbound_frame(struct snmp_request *request)
 #if LWIP_SNMP_V3_CRYPTO
     /* msgAuthenticationParameters */
     if (request->msg_flags & SNMP_V3_AUTH_FLAG) {
-      memset(request->msg_authentication_parameters, 0, SNMP_V3_MAX_AUTH_PARAM_LENGTH);
+      if (request->usm_user == NULL) {
+        /* security level was not lowered although the user is unknown */
+        return ERR_ARG;
+      }
+      request->msg_authentication_parameters_len = snmpv3_auth_param_length(request->usm_user->auth_algo);
+      memset(request->msg_authentication_parameters, 0, request->msg_authentication_parameters_len);
       request->outbound_msg_authentication_parameters_offset = pbuf_stream->offset;
-      SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 1, SNMP_V3_MAX_AUTH_PARAM_LENGTH);
+      SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 1, request->msg_authentication_parameters_len);
       OF_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
-      OF_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, request->msg_authentication_parameters, SNMP_V3_MAX_AUTH_PARAM_LENGTH));
+      OF_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, request->msg_authentication_parameters, request->msg_authentication_parameters_len));
     } else
 #endif
     {
@@ -1670,34 +1775,45 @@ snmp_append_outbound_varbind(struct snmp_pbuf_stream *pbuf_stream, struct snmp_v
   OVB_BUILD_EXEC(snmp_asn1_enc_oid(pbuf_stream, varbind->oid.id, varbind->oid.len));
 
   /* VarBind value */
-  SNMP_ASN1_SET_TLV_PARAMS(tlv, varbind->type, len.value_len_len, len.value_value_len);
+  return snmp_encode_varbind_value(pbuf_stream, varbind, &len);
+}
+
+/**
+ * Encodes the value part (type, length and contents) of a varbind.
+ * 'len' must have been filled by snmp_varbind_length().
+ */
+err_t
+snmp_encode_varbind_value(struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbind, const struct snmp_varbind_len *len)
+{
+  struct snmp_asn1_tlv tlv;
+
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, varbind->type, len->value_len_len, len->value_value_len);
   OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
 
-  if (len.value_value_len > 0) {
+  if (len->value_value_len > 0) {
     if (varbind->value_len & SNMP_GET_VALUE_RAW_DATA) {
-      OVB_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, (u8_t *) varbind->object_value, len.value_value_len));
+      OVB_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, (u8_t *) varbind->object_value, len->value_value_len));
     } else {
       switch (varbind->type) {
         case SNMP_ASN1_TYPE_INTEGER:
-          OVB_BUILD_EXEC(snmp_asn1_enc_s32t(pbuf_stream, len.value_value_len, *((s32_t *) varbind->object_value)));
+          OVB_BUILD_EXEC(snmp_asn1_enc_s32t(pbuf_stream, len->value_value_len, *((s32_t *) varbind->object_value)));
           break;
         case SNMP_ASN1_TYPE_COUNTER:
         case SNMP_ASN1_TYPE_GAUGE:
         case SNMP_ASN1_TYPE_TIMETICKS:
-          OVB_BUILD_EXEC(snmp_asn1_enc_u32t(pbuf_stream, len.value_value_len, *((u32_t *) varbind->object_value)));
+          OVB_BUILD_EXEC(snmp_asn1_enc_u32t(pbuf_stream, len->value_value_len, *((u32_t *) varbind->object_value)));
           break;
         case SNMP_ASN1_TYPE_OCTET_STRING:
         case SNMP_ASN1_TYPE_IPADDR:
         case SNMP_ASN1_TYPE_OPAQUE:
-          OVB_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, (u8_t *) varbind->object_value, len.value_value_len));
-          len.value_value_len = varbind->value_len;
+          OVB_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, (u8_t *) varbind->object_value, len->value_value_len));
           break;
         case SNMP_ASN1_TYPE_OBJECT_ID:
           OVB_BUILD_EXEC(snmp_asn1_enc_oid(pbuf_stream, (u32_t *) varbind->object_value, varbind->value_len / sizeof (u32_t)));
           break;
 #if LWIP_HAVE_INT64
         case SNMP_ASN1_TYPE_COUNTER64:
-          OVB_BUILD_EXEC(snmp_asn1_enc_u64t(pbuf_stream, len.value_value_len, *(u64_t *) varbind->object_value));
+          OVB_BUILD_EXEC(snmp_asn1_enc_u64t(pbuf_stream, len->value_value_len, *(u64_t *) varbind->object_value));
           break;
 #endif
         default:
@@ -1710,6 +1826,120 @@ snmp_append_outbound_varbind(struct snmp_pbuf_stream *pbuf_stream, struct snmp_v
   return ERR_OK;
 }
 
+/**
+ * Appends a varbind whose value part is already BER encoded
+ * (e.g. taken from the value cache).
+ */
+err_t
+snmp_append_outbound_varbind_encoded(struct snmp_pbuf_stream *pbuf_stream, const struct snmp_obj_id *oid, const u8_t *value, u16_t value_len)
+{
+  struct snmp_asn1_tlv tlv;
+  u16_t oid_value_len;
+  u8_t  oid_len_len;
+  u16_t vb_value_len;
+  u8_t  vb_len_len;
+
+  snmp_asn1_enc_oid_cnt(oid->id, oid->len, &oid_value_len);
+  snmp_asn1_enc_length_cnt(oid_value_len, &oid_len_len);
+  vb_value_len = 1 + oid_len_len + oid_value_len + value_len;
+  snmp_asn1_enc_length_cnt(vb_value_len, &vb_len_len);
+
+  if ((1 + vb_len_len + vb_value_len) > pbuf_stream->length) {
+    return ERR_BUF;
+  }
+
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_SEQUENCE, vb_len_len, vb_value_len);
+  OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
+
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OBJECT_ID, oid_len_len, oid_value_len);
+  OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
+  OVB_BUILD_EXEC(snmp_asn1_enc_oid(pbuf_stream, oid->id, oid->len));
+
+  OVB_BUILD_EXEC(snmp_asn1_enc_raw(pbuf_stream, value, value_len));
+
+  return ERR_OK;
+}
+
+/** state of the writer handed to node_instance_write_value_method */
+struct snmp_value_writer_state {
+  struct snmp_pbuf_stream *pbuf_stream;
+  u16_t remaining;
+};
+
+static err_t
+snmp_value_writer(void *writer_arg, const void *buf, u16_t len)
+{
+  struct snmp_value_writer_state *state = (struct snmp_value_writer_state *)writer_arg;
+  err_t err;
+
+  if (len > state->remaining) {
+    /* more data than announced by get_value_len() */
+    return ERR_VAL;
+  }
+
+  err = snmp_pbuf_stream_writebuf(state->pbuf_stream, buf, len);
+  if (err == ERR_OK) {
+    state->remaining = (u16_t)(state->remaining - len);
+  }
+
+  return err;
+}
+
+/**
+ * Appends a varbind whose value is streamed by the node: the length is taken
+ * from get_value_len(), then write_value() writes the contents in chunks
+ * directly into the outbound stream. Nothing is appended if the node fails.
+ */
+err_t
+snmp_append_outbound_varbind_streamed(struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbind, struct snmp_node_instance *node_instance)
+{
+  struct snmp_asn1_tlv tlv;
+  struct snmp_varbind_len len;
+  struct snmp_pbuf_stream saved_stream;
+  struct snmp_value_writer_state state;
+  s32_t value_len = node_instance->get_value_len(node_instance);
+
+  if ((value_len < 0) || (value_len > 0xFFFF)) {
+    return ERR_VAL;
+  }
+
+  snmp_asn1_enc_oid_cnt(varbind->oid.id, varbind->oid.len, &len.oid_value_len);
+  snmp_asn1_enc_length_cnt(len.oid_value_len, &len.oid_len_len);
+  len.value_value_len = (u16_t)value_len;
+  snmp_asn1_enc_length_cnt(len.value_value_len, &len.value_len_len);
+  if ((u32_t)1 + len.oid_len_len + len.oid_value_len + 1 + len.value_len_len + len.value_value_len > 0xFFFF) {
+    return ERR_BUF;
+  }
+  len.vb_value_len = 1 + len.oid_len_len + len.oid_value_len + 1 + len.value_len_len + len.value_value_len;
+  snmp_asn1_enc_length_cnt(len.vb_value_len, &len.vb_len_len);
+
+  if ((1 + len.vb_len_len + len.vb_value_len) > pbuf_stream->length) {
+    return ERR_BUF;
+  }
+
+  varbind->type      = node_instance->asn1_type;
+  varbind->value_len = len.value_value_len;
+  saved_stream       = *pbuf_stream;
+
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_SEQUENCE, len.vb_len_len, len.vb_value_len);
+  OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OBJECT_ID, len.oid_len_len, len.oid_value_len);
+  OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
+  OVB_BUILD_EXEC(snmp_asn1_enc_oid(pbuf_stream, varbind->oid.id, varbind->oid.len));
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, varbind->type, len.value_len_len, len.value_value_len);
+  OVB_BUILD_EXEC(snmp_ans1_enc_tlv(pbuf_stream, &tlv));
+
+  state.pbuf_stream = pbuf_stream;
+  state.remaining   = len.value_value_len;
+  if ((node_instance->write_value(node_instance, snmp_value_writer, &state) != SNMP_ERR_NOERROR) || (state.remaining != 0)) {
+    /* drop the partial varbind */
+    *pbuf_stream = saved_stream;
+    return ERR_VAL;
+  }
+
+  return ERR_OK;
+}
+
 static err_t
 snmp_complete_outbound_frame(struct snmp_request *request)
 {
@@ -1896,9 +2126,6 @@ snmp_complete_outbound_frame(struct snmp_request *request)
 #if LWIP_SNMP_V3 && LWIP_SNMP_V3_CRYPTO
   /* Encrypt response */
   if (request->version == SNMP_VERSION_3 && (request->msg_flags & SNMP_V3_PRIV_FLAG)) {
-    u8_t key[20];
-    snmpv3_priv_algo_t algo;
-
     /* complete missing length in PDU sequence */
     OF_BUILD_EXEC(snmp_pbuf_stream_init(&request->outbound_pbuf_stream, request->outbound_pbuf, 0, request->outbound_pbuf->tot_len));
     OF_BUILD_EXEC(snmp_pbuf_stream_seek_abs(&(request->outbound_pbuf_stream), request->outbound_scoped_pdu_string_offset));
@@ -1906,33 +2133,28 @@ snmp_complete_outbound_frame(struct snmp_request *request)
                              - request->outbound_scoped_pdu_string_offset - 1 - 3);
     OF_BUILD_EXEC(snmp_ans1_enc_tlv(&(request->outbound_pbuf_stream), &tlv));
 
-    OF_BUILD_EXEC(snmpv3_get_user((char *)request->msg_user_name, NULL, NULL, &algo, key));
-
-    OF_BUILD_EXEC(snmpv3_crypt(&request->outbound_pbuf_stream, tlv.value_len, key,
+    OF_BUILD_EXEC(snmpv3_crypt(request->usm_user, &request->outbound_pbuf_stream, tlv.value_len,
                                request->msg_privacy_parameters, request->msg_authoritative_engine_boots,
-                               request->msg_authoritative_engine_time, algo, SNMP_V3_PRIV_MODE_ENCRYPT));
+                               request->msg_authoritative_engine_time, SNMP_V3_PRIV_MODE_ENCRYPT));
   }
 
   if (request->version == SNMP_VERSION_3 && (request->msg_flags & SNMP_V3_AUTH_FLAG)) {
-    u8_t key[20];
-    snmpv3_auth_algo_t algo;
-    u8_t hmac[20];
+    u8_t hmac[SNMP_V3_MAX_KEY_LENGTH];
 
-    OF_BUILD_EXEC(snmpv3_get_user((char *)request->msg_user_name, &algo, key, NULL, NULL));
     OF_BUILD_EXEC(snmp_pbuf_stream_init(&(request->outbound_pbuf_stream),
                                         request->outbound_pbuf, 0, request->outbound_pbuf->tot_len));
-    OF_BUILD_EXEC(snmpv3_auth(&request->outbound_pbuf_stream, frame_size + outbound_padding, key, algo, hmac));
+    OF_BUILD_EXEC(snmpv3_auth(request->usm_user, &request->outbound_pbuf_stream, frame_size + outbound_padding, hmac));
 
-    MEMCPY(request->msg_authentication_parameters, hmac, SNMP_V3_MAX_AUTH_PARAM_LENGTH);
+    MEMCPY(request->msg_authentication_parameters, hmac, request->msg_authentication_parameters_len);
     OF_BUILD_EXEC(snmp_pbuf_stream_init(&request->outbound_pbuf_stream,
                                         request->outbound_pbuf, 0, request->outbound_pbuf->tot_len));
     OF_BUILD_EXEC(snmp_pbuf_stream_seek_abs(&request->outbound_pbuf_stream,
                                             request->outbound_msg_authentication_parameters_offset));
 
-    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 1, SNMP_V3_MAX_AUTH_PARAM_LENGTH);
+    SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 1, request->msg_authentication_parameters_len);
     OF_BUILD_EXEC(snmp_ans1_enc_tlv(&request->outbound_pbuf_stream, &tlv));
     OF_BUILD_EXEC(snmp_asn1_enc_raw(&request->outbound_pbuf_stream,
-                                    request->msg_authentication_parameters, SNMP_V3_MAX_AUTH_PARAM_LENGTH));
+                                    request->msg_authentication_parameters, request->msg_authentication_parameters_len));
   }
 #endif
 
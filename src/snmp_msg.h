@@ -119,6 +119,8 @@ struct snmp_request {
   s32_t msg_authoritative_engine_time;
   u8_t  msg_user_name[SNMP_V3_MAX_USER_LENGTH];
   u8_t  msg_user_name_len;
+  /* resolved in step 4 of the inbound security checks, NULL if unknown */
+  struct snmpv3_user_cache_entry *usm_user;
   u8_t  msg_authentication_parameters[SNMP_V3_MAX_AUTH_PARAM_LENGTH];
   u8_t  msg_authentication_parameters_len;
   u8_t  msg_privacy_parameters[SNMP_V3_MAX_PRIV_PARAM_LENGTH];
@@ -181,6 +183,9 @@ err_t snmp_sendto(void *handle, struct pbuf *p, const ip_addr_t *dst, u16_t port
 u8_t snmp_get_local_ip_for_dst(void *handle, const ip_addr_t *dst, ip_addr_t *result);
 err_t snmp_varbind_length(struct snmp_varbind *varbind, struct snmp_varbind_len *len);
 err_t snmp_append_outbound_varbind(struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbind);
+err_t snmp_append_outbound_varbind_encoded(struct snmp_pbuf_stream *pbuf_stream, const struct snmp_obj_id *oid, const u8_t *value, u16_t value_len);
+err_t snmp_encode_varbind_value(struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbind, const struct snmp_varbind_len *len);
+err_t snmp_append_outbound_varbind_streamed(struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbind, struct snmp_node_instance *node_instance);
 
 #ifdef __cplusplus
 }
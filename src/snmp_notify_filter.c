@@ -0,0 +1,694 @@
+/**
+ * @file
+ * SNMP notification filter profiles and the read-only SNMP-NOTIFICATION-MIB
+ * (RFC 3413).
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && SNMP_NOTIFY_FILTERS /* don't build if not configured for use in lwipopts.h */
+
+#include <string.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_table.h"
+#include "lwip/apps/snmp_target.h"
+#include "lwip/apps/snmp_notify_filter.h"
+#include "snmp_core_priv.h"
+
+#if SNMP_NOTIFY_FILTERS > 0xFD
+#error "SNMP_NOTIFY_FILTERS must be lower than 254"
+#endif
+
+/* the end of the list of filters of a node */
+#define SNMP_NOTIFY_NO_ENTRY         0xFF
+/* the profile of a target: no filtering, or a profile without filters */
+#define SNMP_NOTIFY_PROFILE_NONE     0xFF
+#define SNMP_NOTIFY_PROFILE_EMPTY    0xFE
+
+/* StorageType: the tables are not persistent */
+#define SNMP_NOTIFY_STORAGE_VOLATILE 2
+/* RowStatus */
+#define SNMP_NOTIFY_ROW_ACTIVE       1
+
+/* A node of the trie: a sub-identifier, or any of them for a 0 bit of the
+ * mask. Nodes are linked to their first child and next sibling. */
+struct snmp_notify_filter_node {
+  u32_t subid;
+  /* 0 for none, the root is nobody's child */
+  u16_t child;
+  u16_t sibling;
+  u8_t wildcard;
+  /* the first filter whose subtree ends here, see snmp_notify_filter_next */
+  u8_t entry;
+};
+
+static struct snmp_notify_filter snmp_notify_filters[SNMP_NOTIFY_FILTERS];
+
+/* the trie, compiled by snmp_notify_filter_compile() */
+static struct snmp_notify_filter_node snmp_notify_nodes[SNMP_NOTIFY_FILTER_NODES] = {
+  { 0, 0, 0, 0, SNMP_NOTIFY_NO_ENTRY }
+};
+static u16_t snmp_notify_nodes_used = 1;
+/* per filter: the lowest index of a filter of its profile, which is the id
+ * of the profile, the number of filters it takes precedence over and the
+ * next filter ending on the same node */
+static u8_t snmp_notify_filter_profile[SNMP_NOTIFY_FILTERS];
+static u8_t snmp_notify_filter_rank[SNMP_NOTIFY_FILTERS];
+static u8_t snmp_notify_filter_next[SNMP_NOTIFY_FILTERS];
+
+/* per target: the profile id, SNMP_NOTIFY_PROFILE_NONE or _EMPTY */
+static u8_t snmp_notify_target_profile[SNMP_TRAP_DESTINATIONS];
+static u8_t snmp_notify_targets_dirty = 1;
+static u8_t snmp_notify_targets_active;
+static u16_t snmp_notify_generation;
+
+/* the nodes an OID reached at the current and the next depth */
+static u16_t snmp_notify_walk[2][SNMP_NOTIFY_FILTER_NODES];
+/* per profile: the best filter for the OID being checked, valid when its
+ * stamp is the one of the OID */
+static u8_t snmp_notify_best_rank[SNMP_NOTIFY_FILTERS];
+static u16_t snmp_notify_best_stamp[SNMP_NOTIFY_FILTERS];
+static u16_t snmp_notify_stamp;
+
+/** whether the i-th sub-identifier of the subtree of a filter must match */
+static u8_t
+snmp_notify_filter_exact(const struct snmp_notify_filter *filter, u8_t i)
+{
+  if ((i / 8) >= filter->mask_len) {
+    return 1;
+  }
+  return (u8_t)((filter->mask[i / 8] >> (7 - (i % 8))) & 1);
+}
+
+/** whether a filter takes precedence over another of the same profile:
+ * the longer subtree, then the lexicographically greater one */
+static u8_t
+snmp_notify_filter_precedes(const struct snmp_notify_filter *filter, const struct snmp_notify_filter *other)
+{
+  if (filter->subtree.len != other->subtree.len) {
+    return (u8_t)(filter->subtree.len > other->subtree.len);
+  }
+  return (u8_t)(snmp_oid_compare(filter->subtree.id, filter->subtree.len, other->subtree.id, other->subtree.len) > 0);
+}
+
+/** finds or adds the child of a node for a sub-identifier, 0 when the trie is full */
+static u16_t
+snmp_notify_filter_child(u16_t parent, u32_t subid, u8_t wildcard)
+{
+  struct snmp_notify_filter_node *node;
+  u16_t n;
+
+  for (n = snmp_notify_nodes[parent].child; n != 0; n = snmp_notify_nodes[n].sibling) {
+    node = &snmp_notify_nodes[n];
+    if ((node->wildcard == wildcard) && (wildcard || (node->subid == subid))) {
+      return n;
+    }
+  }
+  if (snmp_notify_nodes_used >= SNMP_NOTIFY_FILTER_NODES) {
+    return 0;
+  }
+  n = snmp_notify_nodes_used++;
+  node = &snmp_notify_nodes[n];
+  node->subid = wildcard ? 0 : subid;
+  node->wildcard = wildcard;
+  node->child = 0;
+  node->entry = SNMP_NOTIFY_NO_ENTRY;
+  node->sibling = snmp_notify_nodes[parent].child;
+  snmp_notify_nodes[parent].child = n;
+  return n;
+}
+
+/**
+ * Builds the trie from the filters of the table.
+ * @return ERR_OK, or ERR_MEM when it needs more than SNMP_NOTIFY_FILTER_NODES nodes
+ */
+static err_t
+snmp_notify_filter_compile(void)
+{
+  const struct snmp_notify_filter *filter;
+  const struct snmp_notify_filter *other;
+  u16_t n;
+  u8_t i;
+  u8_t j;
+
+  memset(&snmp_notify_nodes[0], 0, sizeof(snmp_notify_nodes[0]));
+  snmp_notify_nodes[0].entry = SNMP_NOTIFY_NO_ENTRY;
+  snmp_notify_nodes_used = 1;
+  snmp_notify_targets_dirty = 1;
+  snmp_notify_generation++;
+
+  for (i = 0, filter = snmp_notify_filters; i < SNMP_NOTIFY_FILTERS; i++, filter++) {
+    if (filter->profile[0] == '\0') {
+      continue;
+    }
+    snmp_notify_filter_profile[i] = i;
+    snmp_notify_filter_rank[i] = 0;
+    for (j = 0, other = snmp_notify_filters; j < SNMP_NOTIFY_FILTERS; j++, other++) {
+      if ((j == i) || (other->profile[0] == '\0') || (strcmp(other->profile, filter->profile) != 0)) {
+        continue;
+      }
+      if (j < snmp_notify_filter_profile[i]) {
+        snmp_notify_filter_profile[i] = j;
+      }
+      if (snmp_notify_filter_precedes(filter, other)) {
+        snmp_notify_filter_rank[i]++;
+      }
+    }
+
+    n = 0;
+    for (j = 0; j < filter->subtree.len; j++) {
+      n = snmp_notify_filter_child(n, filter->subtree.id[j], (u8_t)!snmp_notify_filter_exact(filter, j));
+      if (n == 0) {
+        return ERR_MEM;
+      }
+    }
+    snmp_notify_filter_next[i] = snmp_notify_nodes[n].entry;
+    snmp_notify_nodes[n].entry = i;
+  }
+  return ERR_OK;
+}
+
+/** looks up the profile id of every target */
+static void
+snmp_notify_filter_map_targets(void)
+{
+  const struct snmp_target *target;
+  u8_t profile;
+  u8_t i;
+  u8_t j;
+
+  snmp_notify_targets_active = 0;
+  for (i = 0, target = snmp_targets; i < SNMP_TRAP_DESTINATIONS; i++, target++) {
+    profile = SNMP_NOTIFY_PROFILE_NONE;
+    if ((target->name[0] != '\0') && (target->filter_profile[0] != '\0')) {
+      profile = SNMP_NOTIFY_PROFILE_EMPTY;
+      for (j = 0; j < SNMP_NOTIFY_FILTERS; j++) {
+        if ((snmp_notify_filters[j].profile[0] != '\0') &&
+            (strcmp(snmp_notify_filters[j].profile, target->filter_profile) == 0)) {
+          profile = snmp_notify_filter_profile[j];
+          break;
+        }
+      }
+      snmp_notify_targets_active = 1;
+    }
+    snmp_notify_target_profile[i] = profile;
+  }
+  snmp_notify_targets_dirty = 0;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sets the filter in a slot of the table, replacing the one there.
+ * @param index slot in 0 .. SNMP_NOTIFY_FILTERS-1
+ * @param filter the settings, copied into the table
+ * @return ERR_OK, ERR_ARG for an invalid index, profile, subtree, mask or
+ *         type, or a profile and subtree that another slot already uses,
+ *         ERR_MEM when the trie would need more than SNMP_NOTIFY_FILTER_NODES
+ *         nodes; the table is not changed then
+ */
+err_t
+snmp_notify_filter_set(u8_t index, const struct snmp_notify_filter *filter)
+{
+  size_t profile_len = strnlen(filter->profile, sizeof(filter->profile));
+  struct snmp_notify_filter previous;
+  const struct snmp_notify_filter *other;
+  err_t err;
+  u8_t i;
+
+  LWIP_ASSERT_SNMP_LOCKED();
+  if ((index >= SNMP_NOTIFY_FILTERS) || (profile_len == 0) || (profile_len >= sizeof(filter->profile)) ||
+      (filter->subtree.len > SNMP_MAX_OBJ_ID_LEN) || (filter->mask_len > SNMP_NOTIFY_FILTER_MASK_LEN)) {
+    return ERR_ARG;
+  }
+  if ((filter->type != SNMP_NOTIFY_FILTER_INCLUDED) && (filter->type != SNMP_NOTIFY_FILTER_EXCLUDED)) {
+    return ERR_ARG;
+  }
+  /* the profile and the subtree are the index of snmpNotifyFilterTable */
+  for (i = 0, other = snmp_notify_filters; i < SNMP_NOTIFY_FILTERS; i++, other++) {
+    if ((i != index) && (strcmp(other->profile, filter->profile) == 0) &&
+        snmp_oid_equal(other->subtree.id, other->subtree.len, filter->subtree.id, filter->subtree.len)) {
+      return ERR_ARG;
+    }
+  }
+
+  MEMCPY(&previous, &snmp_notify_filters[index], sizeof(previous));
+  MEMCPY(&snmp_notify_filters[index], filter, sizeof(*filter));
+  err = snmp_notify_filter_compile();
+  if (err != ERR_OK) {
+    /* fits, it did before */
+    MEMCPY(&snmp_notify_filters[index], &previous, sizeof(previous));
+    snmp_notify_filter_compile();
+  }
+  return err;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Copies the filter of a slot.
+ * @param index slot in 0 .. SNMP_NOTIFY_FILTERS-1
+ * @param filter [out] the settings
+ * @return ERR_OK, ERR_ARG for an invalid index, ERR_VAL for a free slot
+ */
+err_t
+snmp_notify_filter_get(u8_t index, struct snmp_notify_filter *filter)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (index >= SNMP_NOTIFY_FILTERS) {
+    return ERR_ARG;
+  }
+  if (snmp_notify_filters[index].profile[0] == '\0') {
+    return ERR_VAL;
+  }
+  MEMCPY(filter, &snmp_notify_filters[index], sizeof(*filter));
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Frees a slot of the table.
+ * @param index slot in 0 .. SNMP_NOTIFY_FILTERS-1
+ */
+void
+snmp_notify_filter_remove(u8_t index)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (index < SNMP_NOTIFY_FILTERS) {
+    memset(&snmp_notify_filters[index], 0, sizeof(snmp_notify_filters[index]));
+    snmp_notify_filter_compile();
+  }
+}
+
+/** Whether any target has a filter profile, the agent skips the filters otherwise. */
+u8_t
+snmp_notify_filter_active(void)
+{
+  if (snmp_notify_targets_dirty) {
+    snmp_notify_filter_map_targets();
+  }
+  return snmp_notify_targets_active;
+}
+
+/** Changes with every change of the filters or of the profiles of the targets. */
+u16_t
+snmp_notify_filter_generation(void)
+{
+  return snmp_notify_generation;
+}
+
+/** The targets were changed, their profiles are looked up again. */
+void
+snmp_notify_filter_targets_changed(void)
+{
+  snmp_notify_targets_dirty = 1;
+  snmp_notify_generation++;
+}
+
+/** Starts checking the OIDs of a notification. */
+void
+snmp_notify_filter_begin(struct snmp_notify_filter_eval *eval)
+{
+  if (snmp_notify_targets_dirty) {
+    snmp_notify_filter_map_targets();
+  }
+  memset(eval->excluded, 0, sizeof(eval->excluded));
+}
+
+/** the filters ending on a node are better for their profile than the ones before */
+static void
+snmp_notify_filter_visit(u16_t n, u8_t *included)
+{
+  u8_t entry;
+  u8_t profile;
+
+  for (entry = snmp_notify_nodes[n].entry; entry != SNMP_NOTIFY_NO_ENTRY; entry = snmp_notify_filter_next[entry]) {
+    profile = snmp_notify_filter_profile[entry];
+    if ((snmp_notify_best_stamp[profile] != snmp_notify_stamp) ||
+        (snmp_notify_filter_rank[entry] > snmp_notify_best_rank[profile])) {
+      snmp_notify_best_stamp[profile] = snmp_notify_stamp;
+      snmp_notify_best_rank[profile] = snmp_notify_filter_rank[entry];
+      if (snmp_notify_filters[entry].type == SNMP_NOTIFY_FILTER_INCLUDED) {
+        included[profile / 8] |= (u8_t)(1 << (profile % 8));
+      } else {
+        included[profile / 8] &= (u8_t)~(1 << (profile % 8));
+      }
+    }
+  }
+}
+
+/**
+ * Checks an OID of a notification (its snmpTrapOID or the OID of a varbind)
+ * against all profiles with one walk of the trie: at each depth, the nodes
+ * reached are followed along the child for the sub-identifier and along
+ * their wildcards.
+ */
+void
+snmp_notify_filter_oid(struct snmp_notify_filter_eval *eval, const u32_t *oid, u8_t oid_len)
+{
+  u8_t included[sizeof(eval->excluded)];
+  u16_t *reached = snmp_notify_walk[0];
+  u16_t *next = snmp_notify_walk[1];
+  u16_t *swap;
+  u16_t reached_count = 1;
+  u16_t next_count;
+  u16_t i;
+  u16_t n;
+  u8_t depth;
+
+  if (++snmp_notify_stamp == 0) {
+    memset(snmp_notify_best_stamp, 0, sizeof(snmp_notify_best_stamp));
+    snmp_notify_stamp = 1;
+  }
+  memset(included, 0, sizeof(included));
+  reached[0] = 0;
+  snmp_notify_filter_visit(0, included);
+  for (depth = 0; (depth < oid_len) && (reached_count > 0); depth++) {
+    next_count = 0;
+    for (i = 0; i < reached_count; i++) {
+      for (n = snmp_notify_nodes[reached[i]].child; n != 0; n = snmp_notify_nodes[n].sibling) {
+        if (snmp_notify_nodes[n].wildcard || (snmp_notify_nodes[n].subid == oid[depth])) {
+          next[next_count++] = n;
+          snmp_notify_filter_visit(n, included);
+        }
+      }
+    }
+    swap = reached;
+    reached = next;
+    next = swap;
+    reached_count = next_count;
+  }
+
+  /* an OID no filter of a profile matches does not pass it either */
+  for (i = 0; i < sizeof(included); i++) {
+    eval->excluded[i] |= (u8_t)~included[i];
+  }
+}
+
+/** Sets the bit of every target the checked OIDs all passed the profile of,
+ * and of every target without a profile. */
+void
+snmp_notify_filter_targets(const struct snmp_notify_filter_eval *eval, u8_t *targets)
+{
+  u8_t profile;
+  u8_t i;
+
+  memset(targets, 0, SNMP_TARGET_SET_LEN);
+  for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+    profile = snmp_notify_target_profile[i];
+    if ((profile == SNMP_NOTIFY_PROFILE_NONE) ||
+        ((profile != SNMP_NOTIFY_PROFILE_EMPTY) && !(eval->excluded[profile / 8] & (1 << (profile % 8))))) {
+      SNMP_TARGET_SET_ADD(targets, i);
+    }
+  }
+}
+
+/* --- snmpNotifyTable 1.3.6.1.6.3.13.1.1, snmpNotifyFilterProfileTable 1.3.6.1.6.3.13.1.2,
+ *     snmpNotifyFilterTable 1.3.6.1.6.3.13.1.3 --- */
+
+#define SNMP_NOTIFY_TABLE            1
+#define SNMP_NOTIFY_PROFILE_TABLE    2
+#define SNMP_NOTIFY_FILTER_TABLE     3
+
+/* 1.3.6.1.6.3.13.1.<table>.1.<column> in front of the index of a row */
+#define SNMP_NOTIFY_ROW_MAX_LEN      (SNMP_MAX_OBJ_ID_LEN - 11)
+
+/* snmpNotifyTable has a row per notification type, named as the tag
+ * snmpTargetAddrTagList shows for it */
+static const char *const snmpnotify_names[] = { "inform", "trap" };
+
+static u8_t
+snmpnotify_name_to_oid(const char *name, u32_t *oid)
+{
+  u8_t i;
+
+  for (i = 0; name[i] != '\0'; i++) {
+    oid[i] = (u8_t)name[i];
+  }
+  return i;
+}
+
+static u16_t
+snmpnotify_rows(u8_t table)
+{
+  switch (table) {
+    case SNMP_NOTIFY_TABLE:
+      return LWIP_ARRAYSIZE(snmpnotify_names);
+    case SNMP_NOTIFY_PROFILE_TABLE:
+      return SNMP_TRAP_DESTINATIONS;
+    default:
+      return SNMP_NOTIFY_FILTERS;
+  }
+}
+
+/** the index of a row, 0 for a row that does not exist or can not be reached */
+static u8_t
+snmpnotify_row_oid(u8_t table, u16_t row, u32_t *oid)
+{
+  const struct snmp_notify_filter *filter;
+  u8_t len;
+
+  switch (table) {
+    case SNMP_NOTIFY_TABLE:
+      /* IMPLIED snmpNotifyName */
+      return snmpnotify_name_to_oid(snmpnotify_names[row], oid);
+    case SNMP_NOTIFY_PROFILE_TABLE:
+      /* IMPLIED snmpTargetParamsName */
+      if (snmp_targets[row].filter_profile[0] == '\0') {
+        return 0;
+      }
+      return snmpnotify_name_to_oid(snmp_targets[row].name, oid);
+    default:
+      /* snmpNotifyFilterProfileName, IMPLIED snmpNotifyFilterSubtree */
+      filter = &snmp_notify_filters[row];
+      len = (u8_t)strlen(filter->profile);
+      if ((len == 0) || (1 + len + filter->subtree.len > SNMP_NOTIFY_ROW_MAX_LEN)) {
+        return 0;
+      }
+      oid[0] = len;
+      snmpnotify_name_to_oid(filter->profile, &oid[1]);
+      MEMCPY(&oid[1 + len], filter->subtree.id, filter->subtree.len * sizeof(u32_t));
+      return (u8_t)(1 + len + filter->subtree.len);
+  }
+}
+
+static snmp_err_t
+snmpnotify_get_instance(u8_t table, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  u32_t test_oid[SNMP_NOTIFY_ROW_MAX_LEN];
+  u8_t test_len;
+  u16_t i;
+
+  for (i = 0; i < snmpnotify_rows(table); i++) {
+    test_len = snmpnotify_row_oid(table, i, test_oid);
+    if ((test_len != 0) && snmp_oid_equal(row_oid, row_oid_len, test_oid, test_len)) {
+      cell_instance->reference.u32 = i;
+      return SNMP_ERR_NOERROR;
+    }
+  }
+  return SNMP_ERR_NOSUCHINSTANCE;
+}
+
+static snmp_err_t
+snmpnotify_get_next_instance(u8_t table, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  struct snmp_next_oid_state state;
+  u32_t result_temp[SNMP_NOTIFY_ROW_MAX_LEN];
+  u32_t test_oid[SNMP_NOTIFY_ROW_MAX_LEN];
+  u8_t test_len;
+  u16_t i;
+
+  snmp_next_oid_init(&state, row_oid->id, row_oid->len, result_temp, LWIP_ARRAYSIZE(result_temp));
+  for (i = 0; i < snmpnotify_rows(table); i++) {
+    test_len = snmpnotify_row_oid(table, i, test_oid);
+    if (test_len != 0) {
+      snmp_next_oid_check(&state, test_oid, test_len, LWIP_PTR_NUMERIC_CAST(void *, i));
+    }
+  }
+
+  if (state.status == SNMP_NEXT_OID_STATUS_SUCCESS) {
+    snmp_oid_assign(row_oid, state.next_oid, state.next_oid_len);
+    cell_instance->reference.u32 = LWIP_PTR_NUMERIC_CAST(u32_t, state.reference);
+    return SNMP_ERR_NOERROR;
+  }
+  return SNMP_ERR_NOSUCHINSTANCE;
+}
+
+static snmp_err_t
+snmpnotifytable_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_instance(SNMP_NOTIFY_TABLE, row_oid, row_oid_len, cell_instance);
+}
+
+static snmp_err_t
+snmpnotifytable_get_next_instance(const u32_t *column, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_next_instance(SNMP_NOTIFY_TABLE, row_oid, cell_instance);
+}
+
+static snmp_err_t
+snmpnotifyprofiletable_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_instance(SNMP_NOTIFY_PROFILE_TABLE, row_oid, row_oid_len, cell_instance);
+}
+
+static snmp_err_t
+snmpnotifyprofiletable_get_next_instance(const u32_t *column, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_next_instance(SNMP_NOTIFY_PROFILE_TABLE, row_oid, cell_instance);
+}
+
+static snmp_err_t
+snmpnotifyfiltertable_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_instance(SNMP_NOTIFY_FILTER_TABLE, row_oid, row_oid_len, cell_instance);
+}
+
+static snmp_err_t
+snmpnotifyfiltertable_get_next_instance(const u32_t *column, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  LWIP_UNUSED_ARG(column);
+  return snmpnotify_get_next_instance(SNMP_NOTIFY_FILTER_TABLE, row_oid, cell_instance);
+}
+
+static s16_t
+snmpnotifytable_get_value(struct snmp_node_instance *cell_instance, void *value)
+{
+  const char *name = snmpnotify_names[cell_instance->reference.u32];
+  s32_t *int_ptr = (s32_t *)value;
+
+  switch (SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)) {
+    case 2: /* snmpNotifyTag */
+      MEMCPY(value, name, strlen(name));
+      return (s16_t)strlen(name);
+    case 3: /* snmpNotifyType */
+      *int_ptr = (cell_instance->reference.u32 == 0) ? SNMP_TARGET_INFORM : SNMP_TARGET_TRAP;
+      return sizeof(*int_ptr);
+    case 4: /* snmpNotifyStorageType */
+      *int_ptr = SNMP_NOTIFY_STORAGE_VOLATILE;
+      return sizeof(*int_ptr);
+    case 5: /* snmpNotifyRowStatus */
+      *int_ptr = SNMP_NOTIFY_ROW_ACTIVE;
+      return sizeof(*int_ptr);
+    default:
+      LWIP_DEBUGF(SNMP_MIB_DEBUG, ("snmpnotifytable_get_value(): unknown id: %"S32_F"\n", SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)));
+      return 0;
+  }
+}
+
+static s16_t
+snmpnotifyprofiletable_get_value(struct snmp_node_instance *cell_instance, void *value)
+{
+  const struct snmp_target *target = &snmp_targets[cell_instance->reference.u32];
+  s32_t *int_ptr = (s32_t *)value;
+
+  switch (SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)) {
+    case 1: /* snmpNotifyFilterProfileName */
+      MEMCPY(value, target->filter_profile, strlen(target->filter_profile));
+      return (s16_t)strlen(target->filter_profile);
+    case 2: /* snmpNotifyFilterProfileStorType */
+      *int_ptr = SNMP_NOTIFY_STORAGE_VOLATILE;
+      return sizeof(*int_ptr);
+    case 3: /* snmpNotifyFilterProfileRowStatus */
+      *int_ptr = SNMP_NOTIFY_ROW_ACTIVE;
+      return sizeof(*int_ptr);
+    default:
+      LWIP_DEBUGF(SNMP_MIB_DEBUG, ("snmpnotifyprofiletable_get_value(): unknown id: %"S32_F"\n", SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)));
+      return 0;
+  }
+}
+
+static s16_t
+snmpnotifyfiltertable_get_value(struct snmp_node_instance *cell_instance, void *value)
+{
+  const struct snmp_notify_filter *filter = &snmp_notify_filters[cell_instance->reference.u32];
+  s32_t *int_ptr = (s32_t *)value;
+
+  switch (SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)) {
+    case 2: /* snmpNotifyFilterMask */
+      MEMCPY(value, filter->mask, filter->mask_len);
+      return filter->mask_len;
+    case 3: /* snmpNotifyFilterType */
+      *int_ptr = filter->type;
+      return sizeof(*int_ptr);
+    case 4: /* snmpNotifyFilterStorageType */
+      *int_ptr = SNMP_NOTIFY_STORAGE_VOLATILE;
+      return sizeof(*int_ptr);
+    case 5: /* snmpNotifyFilterRowStatus */
+      *int_ptr = SNMP_NOTIFY_ROW_ACTIVE;
+      return sizeof(*int_ptr);
+    default:
+      LWIP_DEBUGF(SNMP_MIB_DEBUG, ("snmpnotifyfiltertable_get_value(): unknown id: %"S32_F"\n", SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)));
+      return 0;
+  }
+}
+
+static const struct snmp_table_col_def snmpnotifytable_columns[] = {
+  {2, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyTag */
+  {3, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyType */
+  {4, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyStorageType */
+  {5, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyRowStatus */
+};
+static const struct snmp_table_node snmpnotifytable = SNMP_TABLE_CREATE(1, snmpnotifytable_columns, snmpnotifytable_get_instance, snmpnotifytable_get_next_instance, snmpnotifytable_get_value, NULL, NULL);
+
+static const struct snmp_table_col_def snmpnotifyprofiletable_columns[] = {
+  {1, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterProfileName */
+  {2, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterProfileStorType */
+  {3, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterProfileRowStatus */
+};
+static const struct snmp_table_node snmpnotifyprofiletable = SNMP_TABLE_CREATE(2, snmpnotifyprofiletable_columns, snmpnotifyprofiletable_get_instance, snmpnotifyprofiletable_get_next_instance, snmpnotifyprofiletable_get_value, NULL, NULL);
+
+static const struct snmp_table_col_def snmpnotifyfiltertable_columns[] = {
+  {2, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterMask */
+  {3, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterType */
+  {4, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterStorageType */
+  {5, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpNotifyFilterRowStatus */
+};
+static const struct snmp_table_node snmpnotifyfiltertable = SNMP_TABLE_CREATE(3, snmpnotifyfiltertable_columns, snmpnotifyfiltertable_get_instance, snmpnotifyfiltertable_get_next_instance, snmpnotifyfiltertable_get_value, NULL, NULL);
+
+/* --- snmpNotifyObjects 1.3.6.1.6.3.13.1 ----------------------------------------------------- */
+static const struct snmp_node *const snmpnotifyobjects_subnodes[] = {
+  &snmpnotifytable.node.node,
+  &snmpnotifyprofiletable.node.node,
+  &snmpnotifyfiltertable.node.node
+};
+static const struct snmp_tree_node snmpnotifyobjects_treenode = SNMP_CREATE_TREE_NODE(1, snmpnotifyobjects_subnodes);
+
+/* --- snmpNotificationMIB  ----------------------------------------------------- */
+static const struct snmp_node *const snmpnotificationmib_subnodes[] = {
+  &snmpnotifyobjects_treenode.node
+};
+static const struct snmp_tree_node snmpnotificationmib_root = SNMP_CREATE_TREE_NODE(13, snmpnotificationmib_subnodes);
+static const u32_t snmpnotificationmib_base_oid[] = {1, 3, 6, 1, 6, 3, 13};
+const struct snmp_mib snmpnotificationmib = {snmpnotificationmib_base_oid, LWIP_ARRAYSIZE(snmpnotificationmib_base_oid), &snmpnotificationmib_root.node};
+
+#endif /* LWIP_SNMP && SNMP_NOTIFY_FILTERS */
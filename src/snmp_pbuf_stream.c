@@ -70,6 +70,35 @@ snmp_pbuf_stream_read(struct snmp_pbuf_stream *pbuf_stream, u8_t *data)
   return ERR_OK;
 }
 
+/**
+ * Returns the contiguous part of the stream at the current position (at most
+ * max_len bytes) and advances the stream behind it. This allows processing a
+ * pbuf chain one segment at a time instead of byte by byte.
+ */
+err_t
+snmp_pbuf_stream_get_chunk(struct snmp_pbuf_stream *pbuf_stream, u8_t **chunk, u16_t *chunk_len, u16_t max_len)
+{
+  u16_t chunk_offset;
+  struct pbuf *pbuf;
+
+  if ((pbuf_stream->length == 0) || (max_len == 0)) {
+    return ERR_BUF;
+  }
+
+  pbuf = pbuf_skip(pbuf_stream->pbuf, pbuf_stream->offset, &chunk_offset);
+  if ((pbuf == NULL) || (chunk_offset >= pbuf->len)) {
+    return ERR_BUF;
+  }
+
+  *chunk     = &((u8_t *)pbuf->payload)[chunk_offset];
+  *chunk_len = LWIP_MIN((u16_t)(pbuf->len - chunk_offset), LWIP_MIN(pbuf_stream->length, max_len));
+
+  pbuf_stream->offset += *chunk_len;
+  pbuf_stream->length -= *chunk_len;
+
+  return ERR_OK;
+}
+
 err_t
 snmp_pbuf_stream_write(struct snmp_pbuf_stream *pbuf_stream, u8_t data)
 {
@@ -68,6 +68,8 @@ snmp_scalar_get_instance(const u32_t *root_oid, u8_t root_oid_len, struct snmp_n
   instance->get_value = scalar_node->get_value;
   instance->set_test  = scalar_node->set_test;
   instance->set_value = scalar_node->set_value;
+  instance->get_value_len = scalar_node->get_value_len;
+  instance->write_value   = scalar_node->write_value;
   return SNMP_ERR_NOERROR;
 }
 
@@ -21,11 +21,10 @@ Generated by LwipMibCompiler
 const struct snmp_obj_id usmNoAuthProtocol      = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 1 } };
 const struct snmp_obj_id usmHMACMD5AuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 2 } };
 const struct snmp_obj_id usmHMACSHAAuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 3 } };
-/* .4 sha-224
- * .5 sha-256
- * .6 sha-384
- * .7 sha-512
- */
+const struct snmp_obj_id usmHMAC128SHA224AuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 4 } };
+const struct snmp_obj_id usmHMAC192SHA256AuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 5 } };
+const struct snmp_obj_id usmHMAC256SHA384AuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 6 } };
+const struct snmp_obj_id usmHMAC384SHA512AuthProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 1, 7 } };
 
 const struct snmp_obj_id usmNoPrivProtocol  = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 2, 1 } };
 const struct snmp_obj_id usmDESPrivProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 2, 2 } };
@@ -35,6 +34,9 @@ const struct snmp_obj_id usmAESPrivProtocol = { 10, { 1, 3, 6, 1, 6, 3, 10, 1, 2
  * .6 unknown
  * .7 unknown
  */
+/* draft-blumenthal-aes-usm-04, registered under the arc used by Net-SNMP */
+const struct snmp_obj_id usmAES192PrivProtocol = { 9, { 1, 3, 6, 1, 4, 1, 14832, 1, 3 } };
+const struct snmp_obj_id usmAES256PrivProtocol = { 9, { 1, 3, 6, 1, 4, 1, 14832, 1, 4 } };
 
 /* TODO: where should this value come from? */
 #define SNMP_FRAMEWORKMIB_SNMPENGINEMAXMESSAGESIZE 1500
@@ -11,6 +11,7 @@ Generated by LwipMibCompiler
 #include "lwip/apps/snmp_scalar.h"
 #include "lwip/apps/snmp_table.h"
 #include "lwip/apps/snmpv3.h"
+#include "lwip/apps/snmpv3_user_store.h"
 #include "snmpv3_priv.h"
 
 #include "lwip/apps/snmp_snmpv2_framework.h"
@@ -35,7 +36,7 @@ static void snmp_engineid_to_oid(const char *engineid, u32_t *oid, u32_t len)
   u8_t i;
 
   for (i = 0; i < len; i++) {
-    oid[i] = engineid[i];
+    oid[i] = (u8_t)engineid[i];
   }
 }
 
@@ -53,7 +54,7 @@ static void snmp_name_to_oid(const char *name, u32_t *oid, size_t len)
   u8_t i;
 
   for (i = 0; i < len; i++) {
-    oid[i] = name[i];
+    oid[i] = (u8_t)name[i];
   }
 }
 
@@ -63,6 +64,14 @@ static const struct snmp_obj_id *snmp_auth_algo_to_oid(snmpv3_auth_algo_t algo)
     return &usmHMACMD5AuthProtocol;
   } else if (algo ==  SNMP_V3_AUTH_ALGO_SHA) {
     return &usmHMACSHAAuthProtocol;
+  } else if (algo == SNMP_V3_AUTH_ALGO_SHA224) {
+    return &usmHMAC128SHA224AuthProtocol;
+  } else if (algo == SNMP_V3_AUTH_ALGO_SHA256) {
+    return &usmHMAC192SHA256AuthProtocol;
+  } else if (algo == SNMP_V3_AUTH_ALGO_SHA384) {
+    return &usmHMAC256SHA384AuthProtocol;
+  } else if (algo == SNMP_V3_AUTH_ALGO_SHA512) {
+    return &usmHMAC384SHA512AuthProtocol;
   }
 
   return &usmNoAuthProtocol;
@@ -74,12 +83,101 @@ static const struct snmp_obj_id *snmp_priv_algo_to_oid(snmpv3_priv_algo_t algo)
     return &usmDESPrivProtocol;
   } else if (algo == SNMP_V3_PRIV_ALGO_AES) {
     return &usmAESPrivProtocol;
+  } else if (algo == SNMP_V3_PRIV_ALGO_AES192) {
+    return &usmAES192PrivProtocol;
+  } else if (algo == SNMP_V3_PRIV_ALGO_AES256) {
+    return &usmAES256PrivProtocol;
   }
 
   return &usmNoPrivProtocol;
 }
 
-char username[32];
+#if SNMP_V3_USER_STORE
+
+/* the row found by get_instance/get_next_instance, read by get_value */
+static struct snmpv3_user_store_info usm_user;
+
+static u8_t usm_user_to_index(const struct snmpv3_user_store_info *user, u32_t *index)
+{
+  index[0] = user->engine_id_len;
+  snmp_engineid_to_oid((const char *)user->engine_id, &index[1], user->engine_id_len);
+  index[1 + user->engine_id_len] = user->name_len;
+  snmp_name_to_oid(user->name, &index[2 + user->engine_id_len], user->name_len);
+
+  return (u8_t)(2 + user->engine_id_len + user->name_len);
+}
+
+static snmp_err_t usmusertable_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  u8_t engineid[SNMP_V3_MAX_ENGINE_ID_LENGTH];
+  char name[SNMP_V3_MAX_USER_LENGTH];
+  u8_t engineid_len;
+  u8_t name_len;
+  u8_t i;
+
+  LWIP_UNUSED_ARG(column);
+
+  /* <EngineID length>.<EngineID>.<UserName length>.<UserName> */
+  if ((row_oid_len < 2) || (row_oid[0] > SNMP_V3_MAX_ENGINE_ID_LENGTH) || (row_oid[0] + 2 > row_oid_len)) {
+    return SNMP_ERR_NOSUCHINSTANCE;
+  }
+  engineid_len = (u8_t)row_oid[0];
+
+  if ((row_oid[1 + engineid_len] > SNMP_V3_MAX_USER_LENGTH) ||
+      (2 + engineid_len + row_oid[1 + engineid_len] != row_oid_len)) {
+    return SNMP_ERR_NOSUCHINSTANCE;
+  }
+  name_len = (u8_t)row_oid[1 + engineid_len];
+
+  if (!snmp_oid_in_range(&row_oid[1], engineid_len, usmUserTable_oid_ranges, engineid_len) ||
+      !snmp_oid_in_range(&row_oid[2 + engineid_len], name_len, usmUserTable_oid_ranges, name_len)) {
+    return SNMP_ERR_NOSUCHINSTANCE;
+  }
+
+  for (i = 0; i < engineid_len; i++) {
+    engineid[i] = (u8_t)row_oid[1 + i];
+  }
+  snmp_oid_to_name(name, &row_oid[2 + engineid_len], name_len);
+  if (snmpv3_user_store_find(engineid, engineid_len, name, name_len, &usm_user) != ERR_OK) {
+    return SNMP_ERR_NOSUCHINSTANCE;
+  }
+
+  cell_instance->reference.ptr = usm_user.name;
+  cell_instance->reference_len = usm_user.name_len;
+  return SNMP_ERR_NOERROR;
+}
+
+/* The store keeps the users in index order, the next row is found by a
+ * binary search for any (partial) row OID. */
+static snmp_err_t usmusertable_get_next_instance(const u32_t *column, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  u32_t index[2 + SNMP_V3_MAX_ENGINE_ID_LENGTH + SNMP_V3_MAX_USER_LENGTH];
+  const u32_t *start = row_oid->id;
+  u8_t start_len = row_oid->len;
+
+  LWIP_UNUSED_ARG(column);
+
+  while (snmpv3_user_store_next(start, start_len, &usm_user) == ERR_OK) {
+    u8_t index_len = usm_user_to_index(&usm_user, index);
+
+    /* longer rows do not fit the OID buffers, as with snmp_next_oid_check() */
+    if (index_len <= LWIP_ARRAYSIZE(usmUserTable_oid_ranges)) {
+      snmp_oid_assign(row_oid, index, index_len);
+      cell_instance->reference.ptr = usm_user.name;
+      cell_instance->reference_len = usm_user.name_len;
+      return SNMP_ERR_NOERROR;
+    }
+    start = index;
+    start_len = index_len;
+  }
+
+  /* not found */
+  return SNMP_ERR_NOSUCHINSTANCE;
+}
+
+#else /* SNMP_V3_USER_STORE */
+
+static char username[SNMP_V3_MAX_USER_LENGTH + 1];
 
 static snmp_err_t usmusertable_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
 {
@@ -119,7 +217,7 @@ static snmp_err_t usmusertable_get_instance(const u32_t *column, const u32_t *ro
   snmp_engineid_to_oid(engineid, engineid_oid, engineid_len);
 
   /* Verify EngineID */
-  if (snmp_oid_equal(&row_oid[engineid_start], engineid_len, engineid_oid, engineid_len)) {
+  if (!snmp_oid_equal(&row_oid[engineid_start], engineid_len, engineid_oid, engineid_len)) {
     return SNMP_ERR_NOSUCHINSTANCE;
   }
 
@@ -276,6 +374,8 @@ static snmp_err_t usmusertable_get_next_instance(const u32_t *column, struct snm
   return SNMP_ERR_NOSUCHINSTANCE;
 }
 
+#endif /* SNMP_V3_USER_STORE */
+
 static s16_t usmusertable_get_value(struct snmp_node_instance *cell_instance, void *value)
 {
   snmpv3_user_storagetype_t storage_type;
@@ -290,7 +390,11 @@ static s16_t usmusertable_get_value(struct snmp_node_instance *cell_instance, vo
     case 5: { /* usmUserAuthProtocol */
       const struct snmp_obj_id *auth_algo;
       snmpv3_auth_algo_t auth_algo_val;
+#if SNMP_V3_USER_STORE
+      auth_algo_val = usm_user.auth_algo;
+#else
       snmpv3_get_user((const char *)cell_instance->reference.ptr, &auth_algo_val, NULL, NULL, NULL);
+#endif
       auth_algo = snmp_auth_algo_to_oid(auth_algo_val);
       MEMCPY(value, auth_algo->id, auth_algo->len * sizeof(u32_t));
       return auth_algo->len * sizeof(u32_t);
@@ -302,7 +406,11 @@ static s16_t usmusertable_get_value(struct snmp_node_instance *cell_instance, vo
     case 8: { /* usmUserPrivProtocol */
       const struct snmp_obj_id *priv_algo;
       snmpv3_priv_algo_t priv_algo_val;
+#if SNMP_V3_USER_STORE
+      priv_algo_val = usm_user.priv_algo;
+#else
       snmpv3_get_user((const char *)cell_instance->reference.ptr, NULL, NULL, &priv_algo_val, NULL);
+#endif
       priv_algo = snmp_priv_algo_to_oid(priv_algo_val);
       MEMCPY(value, priv_algo->id, priv_algo->len * sizeof(u32_t));
       return priv_algo->len * sizeof(u32_t);
@@ -315,7 +423,11 @@ static s16_t usmusertable_get_value(struct snmp_node_instance *cell_instance, vo
       /* TODO: Implement usmUserPublic */
       return 0;
     case 12: /* usmUserStorageType */
+#if SNMP_V3_USER_STORE
+      storage_type = usm_user.storagetype;
+#else
       snmpv3_get_user_storagetype((const char *)cell_instance->reference.ptr, &storage_type);
+#endif
       *(s32_t *)value = storage_type;
       return sizeof(s32_t);
     case 13: /* usmUserStatus */
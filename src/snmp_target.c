@@ -0,0 +1,457 @@
+/**
+ * @file
+ * SNMP notification targets and the read-only SNMP-TARGET-MIB (RFC 3413).
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP /* don't build if not configured for use in lwipopts.h */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_table.h"
+#include "lwip/apps/snmp_target.h"
+#include "lwip/apps/snmp_notify_filter.h"
+#include "lwip/prot/iana.h"
+#include "snmp_msg.h"
+#include "snmp_core_priv.h"
+
+/* SnmpMessageProcessingModel of snmpTargetParamsMPModel */
+#define SNMP_TARGET_MP_V1            0
+#define SNMP_TARGET_MP_V2C           1
+#define SNMP_TARGET_MP_V3            3
+/* SnmpSecurityModel of snmpTargetParamsSecurityModel */
+#define SNMP_TARGET_SM_V1            1
+#define SNMP_TARGET_SM_V2C           2
+#define SNMP_TARGET_SM_USM           3
+/* StorageType: the table is not persistent */
+#define SNMP_TARGET_STORAGE_VOLATILE 2
+/* RowStatus */
+#define SNMP_TARGET_ROW_ACTIVE       1
+#define SNMP_TARGET_ROW_NOT_IN_SERVICE 2
+
+struct snmp_target snmp_targets[SNMP_TRAP_DESTINATIONS];
+
+/**
+ * @ingroup snmp_traps
+ * Fills in a target with the defaults: port 162, the default trap version,
+ * traps, the agent's trap community, a timeout of 15 seconds and 3 retries.
+ * The name and the address are empty and the target is enabled.
+ * @param target the target to initialize
+ */
+void
+snmp_target_init_defaults(struct snmp_target *target)
+{
+  memset(target, 0, sizeof(*target));
+  target->port = LWIP_IANA_PORT_SNMP_TRAP;
+  target->version = SNMP_TARGET_VERSION_DEFAULT;
+  target->type = SNMP_TARGET_TRAP;
+  target->security_level = SNMP_TARGET_NOAUTH_NOPRIV;
+  target->retries = SNMP_TARGET_DEFAULT_RETRIES;
+  target->timeout = SNMP_TARGET_DEFAULT_TIMEOUT;
+  target->enable = 1;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sets the target in a slot of the table, replacing the one there.
+ * @param index slot in 0 .. SNMP_TRAP_DESTINATIONS-1
+ * @param target the settings, copied into the table
+ * @return ERR_OK, or ERR_ARG for an invalid index, name, version or filter
+ *         profile, or a name that another slot already uses
+ */
+err_t
+snmp_target_set(u8_t index, const struct snmp_target *target)
+{
+  size_t name_len = strnlen(target->name, sizeof(target->name));
+  u8_t i;
+
+  LWIP_ASSERT_SNMP_LOCKED();
+  if ((index >= SNMP_TRAP_DESTINATIONS) || (name_len == 0) || (name_len >= sizeof(target->name)) ||
+      (strnlen(target->security_name, sizeof(target->security_name)) >= sizeof(target->security_name))) {
+    return ERR_ARG;
+  }
+  if ((target->version != SNMP_VERSION_1) && (target->version != SNMP_VERSION_2c) &&
+      (target->version != SNMP_VERSION_3) && (target->version != SNMP_TARGET_VERSION_DEFAULT)) {
+    return ERR_ARG;
+  }
+  if ((target->type != SNMP_TARGET_TRAP) && (target->type != SNMP_TARGET_INFORM)) {
+    return ERR_ARG;
+  }
+  if ((target->security_level < SNMP_TARGET_NOAUTH_NOPRIV) || (target->security_level > SNMP_TARGET_AUTH_PRIV)) {
+    return ERR_ARG;
+  }
+#if SNMP_NOTIFY_FILTERS
+  if (strnlen(target->filter_profile, sizeof(target->filter_profile)) >= sizeof(target->filter_profile)) {
+    return ERR_ARG;
+  }
+#endif
+  /* the name is the index of both MIB tables */
+  for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+    if ((i != index) && (strcmp(snmp_targets[i].name, target->name) == 0)) {
+      return ERR_ARG;
+    }
+  }
+  MEMCPY(&snmp_targets[index], target, sizeof(*target));
+#if SNMP_NOTIFY_FILTERS
+  snmp_notify_filter_targets_changed();
+#endif
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Copies the target of a slot.
+ * @param index slot in 0 .. SNMP_TRAP_DESTINATIONS-1
+ * @param target [out] the settings
+ * @return ERR_OK, ERR_ARG for an invalid index, ERR_VAL for a free slot
+ */
+err_t
+snmp_target_get(u8_t index, struct snmp_target *target)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (index >= SNMP_TRAP_DESTINATIONS) {
+    return ERR_ARG;
+  }
+  if (snmp_targets[index].name[0] == '\0') {
+    return ERR_VAL;
+  }
+  MEMCPY(target, &snmp_targets[index], sizeof(*target));
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Frees a slot of the table.
+ * @param index slot in 0 .. SNMP_TRAP_DESTINATIONS-1
+ */
+void
+snmp_target_remove(u8_t index)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (index < SNMP_TRAP_DESTINATIONS) {
+    memset(&snmp_targets[index], 0, sizeof(snmp_targets[index]));
+#if SNMP_NOTIFY_FILTERS
+    snmp_notify_filter_targets_changed();
+#endif
+  }
+}
+
+/**
+ * @ingroup snmp_traps
+ * Enables or disables the target of a slot, keeping its settings.
+ * @param index slot in 0 .. SNMP_TRAP_DESTINATIONS-1
+ * @param enable 0 disables the target, >0 enables it
+ */
+void
+snmp_target_enable(u8_t index, u8_t enable)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (index < SNMP_TRAP_DESTINATIONS) {
+    snmp_targets[index].enable = enable;
+  }
+}
+
+/* A free slot becomes the target "dst<index>" with the defaults. */
+static struct snmp_target *
+snmp_target_legacy(u8_t index)
+{
+  struct snmp_target *target = &snmp_targets[index];
+
+  if (target->name[0] == '\0') {
+    snmp_target_init_defaults(target);
+    target->enable = 0;
+    snprintf(target->name, sizeof(target->name), "dst%u", (unsigned int)index);
+  }
+  return target;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sets enable switch for this trap destination.
+ * @param dst_idx index in 0 .. SNMP_TRAP_DESTINATIONS-1
+ * @param enable switch if 0 destination is disabled >0 enabled.
+ *
+ * @retval void
+ */
+void
+snmp_trap_dst_enable(u8_t dst_idx, u8_t enable)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (dst_idx < SNMP_TRAP_DESTINATIONS) {
+    snmp_target_legacy(dst_idx)->enable = enable;
+  }
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sets IPv4 address for this trap destination.
+ * @param dst_idx index in 0 .. SNMP_TRAP_DESTINATIONS-1
+ * @param dst IPv4 address in host order.
+ *
+ * @retval void
+ */
+void
+snmp_trap_dst_ip_set(u8_t dst_idx, const ip_addr_t *dst)
+{
+  LWIP_ASSERT_SNMP_LOCKED();
+  if (dst_idx < SNMP_TRAP_DESTINATIONS) {
+    ip_addr_set(&snmp_target_legacy(dst_idx)->ip, dst);
+  }
+}
+
+/* --- snmpTargetAddrTable 1.3.6.1.6.3.12.1.2, snmpTargetParamsTable 1.3.6.1.6.3.12.1.3 --- */
+
+/* Both tables are indexed by the IMPLIED name: one sub-identifier per character. */
+static const struct snmp_oid_range snmptarget_oid_ranges[] = {
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff },
+  { 1, 0xff }, { 1, 0xff }, { 1, 0xff }, { 1, 0xff }
+};
+
+/* snmpUDPDomain of RFC 3417 */
+static const u32_t snmptarget_udp_domain[] = { 1, 3, 6, 1, 6, 1, 1 };
+#if LWIP_IPV6
+/* transportDomainUdpIpv6 of RFC 3419 */
+static const u32_t snmptarget_udp6_domain[] = { 1, 3, 6, 1, 2, 1, 100, 1, 2 };
+#endif
+
+static u8_t
+snmptarget_name_to_oid(const char *name, u32_t *oid)
+{
+  u8_t i;
+
+  for (i = 0; name[i] != '\0'; i++) {
+    oid[i] = (u8_t)name[i];
+  }
+  return i;
+}
+
+static snmp_err_t
+snmptarget_get_instance(const u32_t *column, const u32_t *row_oid, u8_t row_oid_len, struct snmp_node_instance *cell_instance)
+{
+  u32_t name_oid[SNMP_TARGET_MAX_NAME_LEN];
+  u8_t name_len;
+  u8_t i;
+
+  LWIP_UNUSED_ARG(column);
+
+  if ((row_oid_len > LWIP_ARRAYSIZE(snmptarget_oid_ranges)) ||
+      !snmp_oid_in_range(row_oid, row_oid_len, snmptarget_oid_ranges, row_oid_len)) {
+    return SNMP_ERR_NOSUCHINSTANCE;
+  }
+  for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+    name_len = snmptarget_name_to_oid(snmp_targets[i].name, name_oid);
+    if ((name_len != 0) && snmp_oid_equal(row_oid, row_oid_len, name_oid, name_len)) {
+      cell_instance->reference.u32 = i;
+      return SNMP_ERR_NOERROR;
+    }
+  }
+  return SNMP_ERR_NOSUCHINSTANCE;
+}
+
+static snmp_err_t
+snmptarget_get_next_instance(const u32_t *column, struct snmp_obj_id *row_oid, struct snmp_node_instance *cell_instance)
+{
+  struct snmp_next_oid_state state;
+  u32_t result_temp[SNMP_TARGET_MAX_NAME_LEN];
+  u32_t test_oid[SNMP_TARGET_MAX_NAME_LEN];
+  u8_t name_len;
+  u8_t i;
+
+  LWIP_UNUSED_ARG(column);
+
+  snmp_next_oid_init(&state, row_oid->id, row_oid->len, result_temp, LWIP_ARRAYSIZE(result_temp));
+  for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+    name_len = snmptarget_name_to_oid(snmp_targets[i].name, test_oid);
+    if (name_len != 0) {
+      snmp_next_oid_check(&state, test_oid, name_len, LWIP_PTR_NUMERIC_CAST(void *, i));
+    }
+  }
+
+  if (state.status == SNMP_NEXT_OID_STATUS_SUCCESS) {
+    snmp_oid_assign(row_oid, state.next_oid, state.next_oid_len);
+    cell_instance->reference.u32 = LWIP_PTR_NUMERIC_CAST(u32_t, state.reference);
+    return SNMP_ERR_NOERROR;
+  }
+  return SNMP_ERR_NOSUCHINSTANCE;
+}
+
+/* The version a notification to the target is sent with. */
+static u8_t
+snmptarget_version(const struct snmp_target *target)
+{
+  return (target->version == SNMP_TARGET_VERSION_DEFAULT) ? snmp_get_default_trap_version() : target->version;
+}
+
+static s16_t
+snmptargetaddrtable_get_value(struct snmp_node_instance *cell_instance, void *value)
+{
+  const struct snmp_target *target = &snmp_targets[cell_instance->reference.u32];
+  s32_t *int_ptr = (s32_t *)value;
+  u8_t *taddress = (u8_t *)value;
+  u8_t address_len = 0;
+
+  switch (SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)) {
+    case 2: /* snmpTargetAddrTDomain */
+#if LWIP_IPV6
+      if (IP_IS_V6_VAL(target->ip)) {
+        MEMCPY(value, snmptarget_udp6_domain, sizeof(snmptarget_udp6_domain));
+        return sizeof(snmptarget_udp6_domain);
+      }
+#endif
+      MEMCPY(value, snmptarget_udp_domain, sizeof(snmptarget_udp_domain));
+      return sizeof(snmptarget_udp_domain);
+    case 3: /* snmpTargetAddrTAddress: address and port in network order */
+      if (IP_IS_V6_VAL(target->ip)) {
+#if LWIP_IPV6
+        address_len = sizeof(ip_2_ip6(&target->ip)->addr);
+        MEMCPY(taddress, &ip_2_ip6(&target->ip)->addr, address_len);
+#endif
+      } else {
+#if LWIP_IPV4
+        address_len = sizeof(ip_2_ip4(&target->ip)->addr);
+        MEMCPY(taddress, &ip_2_ip4(&target->ip)->addr, address_len);
+#endif
+      }
+      taddress[address_len] = (u8_t)(target->port >> 8);
+      taddress[address_len + 1] = (u8_t)target->port;
+      return (s16_t)(address_len + 2);
+    case 4: /* snmpTargetAddrTimeout */
+      *int_ptr = target->timeout;
+      return sizeof(*int_ptr);
+    case 5: /* snmpTargetAddrRetryCount */
+      *int_ptr = target->retries;
+      return sizeof(*int_ptr);
+    case 6: /* snmpTargetAddrTagList: the snmpNotifyTag of the notification type */
+      if (target->type == SNMP_TARGET_INFORM) {
+        MEMCPY(value, "inform", 6);
+        return 6;
+      }
+      MEMCPY(value, "trap", 4);
+      return 4;
+    case 7: /* snmpTargetAddrParams: the params row has the same name */
+      MEMCPY(value, target->name, strlen(target->name));
+      return (s16_t)strlen(target->name);
+    case 8: /* snmpTargetAddrStorageType */
+      *int_ptr = SNMP_TARGET_STORAGE_VOLATILE;
+      return sizeof(*int_ptr);
+    case 9: /* snmpTargetAddrRowStatus */
+      *int_ptr = target->enable ? SNMP_TARGET_ROW_ACTIVE : SNMP_TARGET_ROW_NOT_IN_SERVICE;
+      return sizeof(*int_ptr);
+    default:
+      LWIP_DEBUGF(SNMP_MIB_DEBUG, ("snmptargetaddrtable_get_value(): unknown id: %"S32_F"\n", SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)));
+      return 0;
+  }
+}
+
+static s16_t
+snmptargetparamstable_get_value(struct snmp_node_instance *cell_instance, void *value)
+{
+  const struct snmp_target *target = &snmp_targets[cell_instance->reference.u32];
+  s32_t *int_ptr = (s32_t *)value;
+  u8_t version = snmptarget_version(target);
+  const char *security_name;
+
+  switch (SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)) {
+    case 2: /* snmpTargetParamsMPModel */
+      *int_ptr = (version == SNMP_VERSION_1) ? SNMP_TARGET_MP_V1 :
+                 (version == SNMP_VERSION_2c) ? SNMP_TARGET_MP_V2C : SNMP_TARGET_MP_V3;
+      return sizeof(*int_ptr);
+    case 3: /* snmpTargetParamsSecurityModel */
+      *int_ptr = (version == SNMP_VERSION_1) ? SNMP_TARGET_SM_V1 :
+                 (version == SNMP_VERSION_2c) ? SNMP_TARGET_SM_V2C : SNMP_TARGET_SM_USM;
+      return sizeof(*int_ptr);
+    case 4: /* snmpTargetParamsSecurityName */
+      /* the community of SNMPv1/v2c targets is a secret, only the USM user is shown */
+      if (version != SNMP_VERSION_3) {
+        return 0;
+      }
+      security_name = target->security_name;
+      MEMCPY(value, security_name, strlen(security_name));
+      return (s16_t)strlen(security_name);
+    case 5: /* snmpTargetParamsSecurityLevel */
+      *int_ptr = (version == SNMP_VERSION_3) ? target->security_level : SNMP_TARGET_NOAUTH_NOPRIV;
+      return sizeof(*int_ptr);
+    case 6: /* snmpTargetParamsStorageType */
+      *int_ptr = SNMP_TARGET_STORAGE_VOLATILE;
+      return sizeof(*int_ptr);
+    case 7: /* snmpTargetParamsRowStatus */
+      *int_ptr = SNMP_TARGET_ROW_ACTIVE;
+      return sizeof(*int_ptr);
+    default:
+      LWIP_DEBUGF(SNMP_MIB_DEBUG, ("snmptargetparamstable_get_value(): unknown id: %"S32_F"\n", SNMP_TABLE_GET_COLUMN_FROM_OID(cell_instance->instance_oid.id)));
+      return 0;
+  }
+}
+
+static const struct snmp_table_col_def snmptargetaddrtable_columns[] = {
+  {2, SNMP_ASN1_TYPE_OBJECT_ID,    SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrTDomain */
+  {3, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrTAddress */
+  {4, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrTimeout */
+  {5, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrRetryCount */
+  {6, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrTagList */
+  {7, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrParams */
+  {8, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrStorageType */
+  {9, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetAddrRowStatus */
+};
+static const struct snmp_table_node snmptargetaddrtable = SNMP_TABLE_CREATE(2, snmptargetaddrtable_columns, snmptarget_get_instance, snmptarget_get_next_instance, snmptargetaddrtable_get_value, NULL, NULL);
+
+static const struct snmp_table_col_def snmptargetparamstable_columns[] = {
+  {2, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsMPModel */
+  {3, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsSecurityModel */
+  {4, SNMP_ASN1_TYPE_OCTET_STRING, SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsSecurityName */
+  {5, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsSecurityLevel */
+  {6, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsStorageType */
+  {7, SNMP_ASN1_TYPE_INTEGER,      SNMP_NODE_INSTANCE_READ_ONLY}, /* snmpTargetParamsRowStatus */
+};
+static const struct snmp_table_node snmptargetparamstable = SNMP_TABLE_CREATE(3, snmptargetparamstable_columns, snmptarget_get_instance, snmptarget_get_next_instance, snmptargetparamstable_get_value, NULL, NULL);
+
+/* --- snmpTargetObjects 1.3.6.1.6.3.12.1 ----------------------------------------------------- */
+static const struct snmp_node *const snmptargetobjects_subnodes[] = {
+  &snmptargetaddrtable.node.node,
+  &snmptargetparamstable.node.node
+};
+static const struct snmp_tree_node snmptargetobjects_treenode = SNMP_CREATE_TREE_NODE(1, snmptargetobjects_subnodes);
+
+/* --- snmpTargetMIB  ----------------------------------------------------- */
+static const struct snmp_node *const snmptargetmib_subnodes[] = {
+  &snmptargetobjects_treenode.node
+};
+static const struct snmp_tree_node snmptargetmib_root = SNMP_CREATE_TREE_NODE(12, snmptargetmib_subnodes);
+static const u32_t snmptargetmib_base_oid[] = {1, 3, 6, 1, 6, 3, 12};
+const struct snmp_mib snmptargetmib = {snmptargetmib_base_oid, LWIP_ARRAYSIZE(snmptargetmib_base_oid), &snmptargetmib_root.node};
+
+#endif /* LWIP_SNMP */
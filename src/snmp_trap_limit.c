@@ -0,0 +1,392 @@
+/**
+ * @file
+ * SNMP zephyr frontend: rate limiting, deduplication and coalescing of traps.
+ *
+ * snmp_trap_limit_check() finds the rule of a trap OID with a linear
+ * search, rules are few and the OIDs differ early. The varbinds are hashed
+ * with 32 bit FNV-1a over their OIDs, types and values, so deduplication
+ * keeps 4 bytes per rule instead of a copy of the last trap. The state of
+ * all rules is protected by limit_lock, a spinlock held for the lookup and
+ * the hash; the counts are sent after it was released.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && SNMP_TRAP_LIMIT_RULES
+
+	#include "lwip/apps/snmp_trap_limit.h"
+	#include "lwip/apps/snmp_core.h"
+	#include "lwip/sys.h"
+
+	#define LIMIT_FNV_OFFSET    2166136261UL
+	#define LIMIT_FNV_PRIME     16777619UL
+
+	struct limit_rule
+	{
+		struct snmp_trap_limit config;
+		struct snmp_trap_limit_stats stats;
+		/* token bucket */
+		u32_t refill_ms;
+		u16_t tokens;
+		/* the last trap sent */
+		bool sent;
+		u32_t sent_hash;
+		u32_t sent_ms;
+		/* the dropped traps that were counted since first_ms */
+		u32_t dropped;
+		u32_t first_ms;
+		/* the arguments of snmp_send_trap() for the count */
+		struct snmp_obj_id eoid;
+		s32_t generic_trap;
+		s32_t specific_trap;
+	};
+
+	struct snmp_obj_id snmp_trap_limit_count_oid = { 10, { 1, 3, 6, 1, 4, 1, 26381, 1, 1, 0 } };
+
+	static struct limit_rule limit_rules[ SNMP_TRAP_LIMIT_RULES ];
+	/* when the work item runs next, valid while limit_wake_set */
+	static u32_t limit_wake_ms;
+	static bool limit_wake_set;
+
+	static struct k_spinlock limit_lock;
+
+	static void limit_work_handler( struct k_work * work );
+
+	static K_WORK_DELAYABLE_DEFINE( limit_work, limit_work_handler );
+
+	static u32_t limit_hash( u32_t hash, const void * data, size_t len )
+	{
+		const u8_t * bytes = ( const u8_t * ) data;
+
+		while( len-- > 0U )
+		{
+			hash = ( hash ^ *bytes++ ) * LIMIT_FNV_PRIME;
+		}
+		return hash;
+	}
+
+	static u32_t limit_hash_varbinds( const struct snmp_varbind * varbinds )
+	{
+		const struct snmp_varbind * varbind;
+		u32_t hash = LIMIT_FNV_OFFSET;
+
+		for( varbind = varbinds; varbind != NULL; varbind = varbind->next )
+		{
+			hash = limit_hash( hash, varbind->oid.id, varbind->oid.len * sizeof( u32_t ) );
+			hash = limit_hash( hash, &varbind->type, sizeof( varbind->type ) );
+			hash = limit_hash( hash, &varbind->value_len, sizeof( varbind->value_len ) );
+			if( varbind->value_len > 0U )
+			{
+				hash = limit_hash( hash, varbind->object_value, varbind->value_len );
+			}
+		}
+		return hash;
+	}
+
+	/* Call with limit_lock held. */
+	static struct limit_rule * limit_find( const struct snmp_obj_id * trap_oid )
+	{
+		struct limit_rule * rule;
+
+		for( rule = &limit_rules[ 0 ]; rule < &limit_rules[ SNMP_TRAP_LIMIT_RULES ]; rule++ )
+		{
+			if( ( rule->config.trap_oid.len != 0U ) &&
+				snmp_oid_equal( rule->config.trap_oid.id, rule->config.trap_oid.len, trap_oid->id, trap_oid->len ) )
+			{
+				return rule;
+			}
+		}
+		return NULL;
+	}
+
+	/* Call with limit_lock held: takes a token, adding the ones gained
+	 * since the last refill first. */
+	static bool limit_take_token( struct limit_rule * rule, u32_t now_ms )
+	{
+		u32_t gained;
+
+		if( ( rule->tokens < rule->config.burst ) && ( rule->config.interval_ms > 0U ) )
+		{
+			gained = ( now_ms - rule->refill_ms ) / rule->config.interval_ms;
+			if( gained >= ( u32_t ) ( rule->config.burst - rule->tokens ) )
+			{
+				rule->tokens    = rule->config.burst;
+				rule->refill_ms = now_ms;
+			}
+			else
+			{
+				rule->tokens    += ( u16_t ) gained;
+				rule->refill_ms += gained * rule->config.interval_ms;
+			}
+		}
+		else if( rule->tokens == rule->config.burst )
+		{
+			/* a full bucket gains nothing */
+			rule->refill_ms = now_ms;
+		}
+		if( rule->tokens == 0U )
+		{
+			return false;
+		}
+		rule->tokens--;
+		return true;
+	}
+
+	/* Call with limit_lock held: makes the work item run at due_ms at
+	 * the latest, returns true when it has to be rescheduled. */
+	static bool limit_wake_at( u32_t due_ms )
+	{
+		if( limit_wake_set && ( ( s32_t ) ( due_ms - limit_wake_ms ) >= 0 ) )
+		{
+			return false;
+		}
+		limit_wake_ms  = due_ms;
+		limit_wake_set = true;
+		return true;
+	}
+
+	u8_t snmp_trap_limit_check( const struct snmp_obj_id * trap_oid, const struct snmp_obj_id * eoid,
+								s32_t generic_trap, s32_t specific_trap,
+								const struct snmp_varbind * varbinds, u32_t * dropped )
+	{
+		struct limit_rule * rule;
+		k_spinlock_key_t key;
+		u32_t now_ms = sys_now();
+		u32_t hash;
+		u32_t delay_ms = 0U;
+		bool wake = false;
+		u8_t send = 1U;
+
+		/* outside the spinlock, the values can be long */
+		hash     = limit_hash_varbinds( varbinds );
+		*dropped = 0U;
+		key      = k_spin_lock( &limit_lock );
+		rule     = limit_find( trap_oid );
+		if( rule == NULL )
+		{
+			k_spin_unlock( &limit_lock, key );
+			return 1U;
+		}
+		if( rule->config.dedup_ms > 0U )
+		{
+			if( rule->sent && ( hash == rule->sent_hash ) && ( now_ms - rule->sent_ms < rule->config.dedup_ms ) )
+			{
+				rule->stats.deduplicated++;
+				send = 0U;
+			}
+		}
+		if( ( send != 0U ) && ( rule->config.burst > 0U ) && !limit_take_token( rule, now_ms ) )
+		{
+			rule->stats.rate_limited++;
+			send = 0U;
+		}
+
+		if( send != 0U )
+		{
+			rule->stats.passed++;
+			rule->sent      = true;
+			rule->sent_hash = hash;
+			rule->sent_ms   = now_ms;
+			if( rule->dropped > 0U )
+			{
+				rule->stats.coalesced += rule->dropped;
+				*dropped               = rule->dropped;
+				rule->dropped          = 0U;
+			}
+		}
+		else if( rule->config.coalesce_ms > 0U )
+		{
+			if( rule->dropped++ == 0U )
+			{
+				rule->first_ms = now_ms;
+				if( eoid != NULL )
+				{
+					rule->eoid = *eoid;
+				}
+				else
+				{
+					rule->eoid = *snmp_get_device_enterprise_oid();
+				}
+				rule->generic_trap  = generic_trap;
+				rule->specific_trap = specific_trap;
+				wake                = limit_wake_at( now_ms + rule->config.coalesce_ms );
+				delay_ms            = rule->config.coalesce_ms;
+			}
+		}
+		k_spin_unlock( &limit_lock, key );
+
+		if( wake )
+		{
+			k_work_reschedule( &limit_work, K_MSEC( delay_ms ) );
+		}
+		return send;
+	}
+
+	void snmp_trap_limit_poll( void )
+	{
+		struct snmp_obj_id eoid;
+		struct limit_rule * rule;
+		k_spinlock_key_t key;
+		s32_t generic_trap;
+		s32_t specific_trap;
+		u32_t now_ms;
+		u32_t dropped;
+		u32_t delay_ms;
+		bool wake;
+		u8_t i;
+
+		for( i = 0; i < SNMP_TRAP_LIMIT_RULES; i++ )
+		{
+			rule    = &limit_rules[ i ];
+			dropped = 0U;
+			key     = k_spin_lock( &limit_lock );
+			if( ( rule->dropped > 0U ) && ( sys_now() - rule->first_ms >= rule->config.coalesce_ms ) )
+			{
+				rule->stats.coalesced += rule->dropped;
+				rule->stats.summaries++;
+				dropped       = rule->dropped;
+				rule->dropped = 0U;
+				eoid          = rule->eoid;
+				generic_trap  = rule->generic_trap;
+				specific_trap = rule->specific_trap;
+			}
+			k_spin_unlock( &limit_lock, key );
+
+			if( dropped > 0U )
+			{
+				if( snmp_trap_limit_send_count( &eoid, generic_trap, specific_trap, dropped ) != ERR_OK )
+				{
+					zephyr_log( "snmp_trap_limit_poll: count of %u traps not sent\n", ( unsigned ) dropped );
+				}
+			}
+		}
+
+		/* wake up again for the counts that are left */
+		key            = k_spin_lock( &limit_lock );
+		now_ms         = sys_now();
+		limit_wake_set = false;
+		wake           = false;
+		delay_ms       = 0U;
+		for( i = 0; i < SNMP_TRAP_LIMIT_RULES; i++ )
+		{
+			rule = &limit_rules[ i ];
+			if( ( rule->dropped > 0U ) && limit_wake_at( rule->first_ms + rule->config.coalesce_ms ) )
+			{
+				wake     = true;
+				delay_ms = ( ( s32_t ) ( limit_wake_ms - now_ms ) > 0 ) ? ( limit_wake_ms - now_ms ) : 0U;
+			}
+		}
+		k_spin_unlock( &limit_lock, key );
+
+		if( wake )
+		{
+			k_work_reschedule( &limit_work, K_MSEC( delay_ms ) );
+		}
+	}
+
+	static void limit_work_handler( struct k_work * work )
+	{
+		ARG_UNUSED( work );
+
+		snmp_trap_limit_poll();
+	}
+
+	err_t snmp_trap_limit_set( u8_t index, const struct snmp_trap_limit * limit )
+	{
+		struct limit_rule * rule;
+		k_spinlock_key_t key;
+		err_t err = ERR_OK;
+
+		/* a bucket that never gains a token would drop the trap for good */
+		if( ( index >= SNMP_TRAP_LIMIT_RULES ) || ( limit->trap_oid.len == 0U ) ||
+			( limit->trap_oid.len > SNMP_MAX_OBJ_ID_LEN ) ||
+			( ( limit->burst > 0U ) && ( limit->interval_ms == 0U ) ) )
+		{
+			return ERR_ARG;
+		}
+		key  = k_spin_lock( &limit_lock );
+		rule = limit_find( &limit->trap_oid );
+		if( ( rule != NULL ) && ( rule != &limit_rules[ index ] ) )
+		{
+			err = ERR_ARG;
+		}
+		else
+		{
+			rule = &limit_rules[ index ];
+			memset( rule, 0, sizeof( *rule ) );
+			rule->config    = *limit;
+			rule->tokens    = limit->burst;
+			rule->refill_ms = sys_now();
+		}
+		k_spin_unlock( &limit_lock, key );
+		return err;
+	}
+
+	void snmp_trap_limit_remove( u8_t index )
+	{
+		k_spinlock_key_t key;
+
+		if( index < SNMP_TRAP_LIMIT_RULES )
+		{
+			key = k_spin_lock( &limit_lock );
+			memset( &limit_rules[ index ], 0, sizeof( limit_rules[ index ] ) );
+			k_spin_unlock( &limit_lock, key );
+		}
+	}
+
+	err_t snmp_trap_limit_get_stats( u8_t index, struct snmp_trap_limit_stats * stats )
+	{
+		k_spinlock_key_t key;
+
+		if( index >= SNMP_TRAP_LIMIT_RULES )
+		{
+			return ERR_ARG;
+		}
+		key    = k_spin_lock( &limit_lock );
+		*stats = limit_rules[ index ].stats;
+		k_spin_unlock( &limit_lock, key );
+		return ERR_OK;
+	}
+
+	void snmp_trap_limit_set_count_oid( const struct snmp_obj_id * oid )
+	{
+		k_spinlock_key_t key;
+
+		if( ( oid != NULL ) && ( oid->len > 0U ) && ( oid->len <= SNMP_MAX_OBJ_ID_LEN ) )
+		{
+			key                        = k_spin_lock( &limit_lock );
+			snmp_trap_limit_count_oid = *oid;
+			k_spin_unlock( &limit_lock, key );
+		}
+	}
+
+#endif /* LWIP_SNMP && SNMP_TRAP_LIMIT_RULES */
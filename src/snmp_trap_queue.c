@@ -0,0 +1,404 @@
+/**
+ * @file
+ * SNMP zephyr frontend: asynchronous notifications through a bounded queue.
+ *
+ * The queue owns SNMP_TRAP_QUEUE_DEPTH + 1 records: up to DEPTH are queued
+ * or being filled, one more can be sent at the same time. snmp_trap_post()
+ * takes a free record under queue_lock and reserves its place in the ring,
+ * copies the notification into it without the lock and appends its index to
+ * the ring. The sender thread removes the oldest index, sends the record
+ * with snmp_send_trap() and frees it again. A record that is being filled or
+ * sent is in neither the ring nor the free list, so the overflow policies
+ * never touch it.
+ *
+ * Record data: the trap OID and the varbind OIDs as u32_t arcs, followed by
+ * the varbind values.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && SNMP_TRAP_QUEUE
+
+	#include "lwip/apps/snmp.h"
+	#include "lwip/apps/snmp_trap_queue.h"
+
+	#define QUEUE_RECORDS       ( SNMP_TRAP_QUEUE_DEPTH + 1 )
+	#define QUEUE_DATA_WORDS    ( ( SNMP_TRAP_QUEUE_DATA_SIZE + 3 ) / 4 )
+	#define QUEUE_NONE          0xFFU
+
+	BUILD_ASSERT( QUEUE_RECORDS < QUEUE_NONE, "SNMP_TRAP_QUEUE_DEPTH is too large" );
+	BUILD_ASSERT( SNMP_TRAP_QUEUE_DATA_SIZE <= 0xFFFF, "SNMP_TRAP_QUEUE_DATA_SIZE is too large" );
+
+	struct queue_varbind
+	{
+		u16_t oid_offset;   /* in u32_t arcs */
+		u16_t value_offset; /* in bytes */
+		u16_t value_len;
+		u8_t oid_len;
+		u8_t type;
+	};
+
+	struct queue_record
+	{
+		s32_t generic_trap;
+		s32_t specific_trap;
+		/* the trap OID starts at data[ 0 ] */
+		u8_t oid_len;
+		bool has_oid;
+		u8_t varbind_count;
+		/* next free record */
+		u8_t next;
+		struct queue_varbind varbinds[ SNMP_TRAP_QUEUE_VARBINDS ];
+		u32_t data[ QUEUE_DATA_WORDS ];
+	};
+
+	static struct queue_record queue_records[ QUEUE_RECORDS ];
+	/* indexes of the queued records, oldest at queue_head */
+	static u8_t queue_ring[ SNMP_TRAP_QUEUE_DEPTH ];
+	static u8_t queue_head;
+	static u8_t queue_count;
+	/* records taken by snmp_trap_post() and not yet in the ring */
+	static u8_t queue_filling;
+	static u8_t queue_free = QUEUE_NONE;
+	static bool queue_ready;
+	static snmp_trap_queue_policy_t queue_policy = SNMP_TRAP_QUEUE_DROP_OLDEST;
+	static struct snmp_trap_queue_stats queue_stats;
+
+	/* Protects everything above; held for a few stores, never while copying. */
+	static struct k_spinlock queue_lock;
+	/* Given for every posted notification. */
+	static K_SEM_DEFINE( queue_work, 0, 1 );
+	/* Serializes the senders, which share queue_oid and queue_varbinds. */
+	static K_MUTEX_DEFINE( queue_send_lock );
+
+	static struct snmp_obj_id queue_oid;
+	static struct snmp_varbind queue_varbinds[ SNMP_TRAP_QUEUE_VARBINDS ];
+
+	/* Call with queue_lock held. */
+	static void queue_init( void )
+	{
+		u8_t i;
+
+		for( i = 0; i < QUEUE_RECORDS; i++ )
+		{
+			queue_records[ i ].next = ( i + 1 < QUEUE_RECORDS ) ? ( u8_t ) ( i + 1 ) : QUEUE_NONE;
+		}
+		queue_free  = 0;
+		queue_ready = true;
+	}
+
+	/* Call with queue_lock held: removes the ring entry 'position', counted
+	 * from the oldest one, and returns its record. */
+	static u8_t queue_remove( u8_t position )
+	{
+		u8_t record = queue_ring[ ( queue_head + position ) % SNMP_TRAP_QUEUE_DEPTH ];
+		u8_t i;
+
+		if( position == 0 )
+		{
+			queue_head = ( u8_t ) ( ( queue_head + 1 ) % SNMP_TRAP_QUEUE_DEPTH );
+			queue_count--;
+			return record;
+		}
+		/* a coalesced record: close the gap towards the tail */
+		for( i = position; i + 1 < queue_count; i++ )
+		{
+			queue_ring[ ( queue_head + i ) % SNMP_TRAP_QUEUE_DEPTH ] =
+				queue_ring[ ( queue_head + i + 1 ) % SNMP_TRAP_QUEUE_DEPTH ];
+		}
+		queue_count--;
+		return record;
+	}
+
+	/* Call with queue_lock held: the position of the newest queued record
+	 * of the same notification, or QUEUE_NONE. */
+	static u8_t queue_find_same( const struct snmp_obj_id * oid, s32_t generic_trap, s32_t specific_trap )
+	{
+		u8_t position = queue_count;
+
+		while( position-- > 0 )
+		{
+			const struct queue_record * record =
+				&queue_records[ queue_ring[ ( queue_head + position ) % SNMP_TRAP_QUEUE_DEPTH ] ];
+
+			if( ( record->generic_trap == generic_trap ) &&
+				( record->specific_trap == specific_trap ) &&
+				( record->has_oid == ( oid != NULL ) ) &&
+				( ( oid == NULL ) ||
+				  ( ( record->oid_len == oid->len ) &&
+					( memcmp( record->data, oid->id, oid->len * sizeof( u32_t ) ) == 0 ) ) ) )
+			{
+				return position;
+			}
+		}
+		return QUEUE_NONE;
+	}
+
+	/* Call with queue_lock held: a record to fill, whose place in the ring
+	 * is reserved until it is appended, or QUEUE_NONE when the notification
+	 * has to be dropped. */
+	static u8_t queue_take( const struct snmp_obj_id * oid, s32_t generic_trap, s32_t specific_trap )
+	{
+		u8_t record;
+		u8_t position;
+
+		if( !queue_ready )
+		{
+			queue_init();
+		}
+		if( ( queue_count + queue_filling < SNMP_TRAP_QUEUE_DEPTH ) && ( queue_free != QUEUE_NONE ) )
+		{
+			record     = queue_free;
+			queue_free = queue_records[ record ].next;
+			queue_filling++;
+			return record;
+		}
+		/* full, or the free records are all being filled */
+		if( ( queue_policy == SNMP_TRAP_QUEUE_DROP_NEWEST ) || ( queue_count == 0 ) )
+		{
+			queue_stats.dropped++;
+			return QUEUE_NONE;
+		}
+		if( queue_policy == SNMP_TRAP_QUEUE_COALESCE )
+		{
+			position = queue_find_same( oid, generic_trap, specific_trap );
+			if( position != QUEUE_NONE )
+			{
+				queue_stats.coalesced++;
+				queue_filling++;
+				return queue_remove( position );
+			}
+		}
+		queue_stats.dropped++;
+		queue_filling++;
+		return queue_remove( 0 );
+	}
+
+	/* Call with queue_lock held. */
+	static void queue_release( u8_t record )
+	{
+		queue_records[ record ].next = queue_free;
+		queue_free = record;
+	}
+
+	err_t snmp_trap_post( const struct snmp_obj_id * oid, s32_t generic_trap, s32_t specific_trap,
+						  const struct snmp_varbind * varbinds )
+	{
+		const struct snmp_varbind * varbind;
+		struct queue_record * record;
+		k_spinlock_key_t key;
+		u32_t words = ( oid != NULL ) ? oid->len : 0U;
+		u32_t bytes = 0U;
+		u8_t count = 0U;
+		u8_t index;
+
+		/* check the size first, a record is only taken when it fits */
+		for( varbind = varbinds; ( varbind != NULL ) && ( count <= SNMP_TRAP_QUEUE_VARBINDS ); varbind = varbind->next )
+		{
+			words += varbind->oid.len;
+			bytes += varbind->value_len;
+			count++;
+		}
+		if( ( count > SNMP_TRAP_QUEUE_VARBINDS ) ||
+			( ( words * sizeof( u32_t ) ) + bytes > sizeof( record->data ) ) )
+		{
+			key = k_spin_lock( &queue_lock );
+			queue_stats.too_large++;
+			k_spin_unlock( &queue_lock, key );
+			return ERR_VAL;
+		}
+
+		key   = k_spin_lock( &queue_lock );
+		index = queue_take( oid, generic_trap, specific_trap );
+		k_spin_unlock( &queue_lock, key );
+		if( index == QUEUE_NONE )
+		{
+			return ERR_MEM;
+		}
+
+		record                = &queue_records[ index ];
+		record->generic_trap  = generic_trap;
+		record->specific_trap = specific_trap;
+		record->has_oid       = ( oid != NULL );
+		record->oid_len       = 0U;
+		record->varbind_count = count;
+		words                 = 0U;
+		if( oid != NULL )
+		{
+			record->oid_len = oid->len;
+			memcpy( record->data, oid->id, oid->len * sizeof( u32_t ) );
+			words = oid->len;
+		}
+		for( varbind = varbinds, count = 0U; varbind != NULL; varbind = varbind->next, count++ )
+		{
+			record->varbinds[ count ].oid_offset = ( u16_t ) words;
+			record->varbinds[ count ].oid_len    = varbind->oid.len;
+			record->varbinds[ count ].type       = varbind->type;
+			memcpy( &record->data[ words ], varbind->oid.id, varbind->oid.len * sizeof( u32_t ) );
+			words += varbind->oid.len;
+		}
+		bytes = words * sizeof( u32_t );
+		for( varbind = varbinds, count = 0U; varbind != NULL; varbind = varbind->next, count++ )
+		{
+			record->varbinds[ count ].value_offset = ( u16_t ) bytes;
+			record->varbinds[ count ].value_len    = varbind->value_len;
+			if( varbind->value_len > 0U )
+			{
+				memcpy( ( u8_t * ) record->data + bytes, varbind->object_value, varbind->value_len );
+			}
+			bytes += varbind->value_len;
+		}
+
+		key = k_spin_lock( &queue_lock );
+		queue_ring[ ( queue_head + queue_count ) % SNMP_TRAP_QUEUE_DEPTH ] = index;
+		queue_count++;
+		queue_filling--;
+		queue_stats.posted++;
+		if( queue_count > queue_stats.high_water )
+		{
+			queue_stats.high_water = queue_count;
+		}
+		k_spin_unlock( &queue_lock, key );
+
+		k_sem_give( &queue_work );
+		return ERR_OK;
+	}
+
+	/* Call with queue_send_lock held: sends the oldest queued record,
+	 * returns false when the queue is empty. */
+	static bool queue_send_one( void )
+	{
+		struct queue_record * record;
+		struct snmp_varbind * first = NULL;
+		k_spinlock_key_t key;
+		err_t err;
+		u8_t index;
+		u8_t i;
+
+		key = k_spin_lock( &queue_lock );
+		if( queue_count == 0 )
+		{
+			k_spin_unlock( &queue_lock, key );
+			return false;
+		}
+		index = queue_remove( 0 );
+		k_spin_unlock( &queue_lock, key );
+
+		record = &queue_records[ index ];
+		if( record->has_oid )
+		{
+			queue_oid.len = record->oid_len;
+			memcpy( queue_oid.id, record->data, record->oid_len * sizeof( u32_t ) );
+		}
+		for( i = 0; i < record->varbind_count; i++ )
+		{
+			struct snmp_varbind * varbind = &queue_varbinds[ i ];
+			const struct queue_varbind * copy = &record->varbinds[ i ];
+
+			varbind->next         = ( i + 1 < record->varbind_count ) ? &queue_varbinds[ i + 1 ] : NULL;
+			varbind->prev         = ( i > 0 ) ? &queue_varbinds[ i - 1 ] : NULL;
+			varbind->oid.len      = copy->oid_len;
+			memcpy( varbind->oid.id, &record->data[ copy->oid_offset ], copy->oid_len * sizeof( u32_t ) );
+			varbind->type         = copy->type;
+			varbind->value_len    = copy->value_len;
+			varbind->object_value = ( u8_t * ) record->data + copy->value_offset;
+		}
+		if( record->varbind_count > 0 )
+		{
+			first = &queue_varbinds[ 0 ];
+		}
+
+		err = snmp_send_trap( record->has_oid ? &queue_oid : NULL,
+							  record->generic_trap, record->specific_trap, first );
+
+		key = k_spin_lock( &queue_lock );
+		queue_release( index );
+		if( err == ERR_OK )
+		{
+			queue_stats.sent++;
+		}
+		else
+		{
+			queue_stats.failed++;
+		}
+		k_spin_unlock( &queue_lock, key );
+		return true;
+	}
+
+	void snmp_trap_queue_flush( void )
+	{
+		k_mutex_lock( &queue_send_lock, K_FOREVER );
+		while( queue_send_one() )
+		{
+		}
+		k_mutex_unlock( &queue_send_lock );
+	}
+
+	static void queue_thread( void * p1, void * p2, void * p3 )
+	{
+		ARG_UNUSED( p1 );
+		ARG_UNUSED( p2 );
+		ARG_UNUSED( p3 );
+
+		for( ; ; )
+		{
+			k_sem_take( &queue_work, K_FOREVER );
+			snmp_trap_queue_flush();
+		}
+	}
+
+	K_THREAD_DEFINE( snmp_trap_queue_tid, SNMP_TRAP_QUEUE_STACK_SIZE, queue_thread, NULL, NULL, NULL,
+					 SNMP_TRAP_QUEUE_THREAD_PRIO, 0, 0 );
+
+	void snmp_trap_queue_set_policy( snmp_trap_queue_policy_t policy )
+	{
+		k_spinlock_key_t key = k_spin_lock( &queue_lock );
+
+		queue_policy = policy;
+		k_spin_unlock( &queue_lock, key );
+	}
+
+	snmp_trap_queue_policy_t snmp_trap_queue_get_policy( void )
+	{
+		return queue_policy;
+	}
+
+	void snmp_trap_queue_get_stats( struct snmp_trap_queue_stats * stats )
+	{
+		k_spinlock_key_t key = k_spin_lock( &queue_lock );
+
+		*stats        = queue_stats;
+		stats->queued = queue_count;
+		k_spin_unlock( &queue_lock, key );
+	}
+
+#endif /* LWIP_SNMP && SNMP_TRAP_QUEUE */
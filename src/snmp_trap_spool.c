@@ -0,0 +1,533 @@
+/**
+ * @file
+ * SNMP zephyr frontend: store-and-forward of notifications that could not
+ * be sent.
+ *
+ * A record holds a flat copy of the encoded message and the address it
+ * was sent to, so a replay only calls snmp_sendto(). Records are taken
+ * from a fixed array; each gets the next sequence number when it is
+ * stored, and the replay sends the used record with the lowest number
+ * among those whose destination is due. The spool is small, so both
+ * lookups are a scan of the array.
+ *
+ * With SNMP_TRAP_SPOOL_PERSIST, record i is mirrored by the settings key
+ * "snmp/spool/<i>". Changed records are marked dirty and written, or
+ * deleted, by spool_save_work, never by the sender of a notification.
+ * All of it is protected by spool_lock, a mutex, as the replay sends while
+ * holding it.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && SNMP_TRAP_SPOOL
+
+	#include "lwip/apps/snmp_inform.h"
+	#include "lwip/apps/snmp_trap_spool.h"
+	#include "snmp_core_priv.h"
+	#include "snmp_msg.h"
+
+	#if SNMP_TRAP_SPOOL_PERSIST
+		#include <zephyr/settings/settings.h>
+
+		#define SPOOL_SETTINGS_ROOT    "snmp/spool"
+	#endif
+
+	#define SPOOL_NONE    0xFFU
+
+	BUILD_ASSERT( SNMP_TRAP_SPOOL < SPOOL_NONE, "SNMP_TRAP_SPOOL is too large" );
+	BUILD_ASSERT( SNMP_TRAP_SPOOL_RECORD_SIZE <= 0xFFFF, "SNMP_TRAP_SPOOL_RECORD_SIZE is too large" );
+
+	struct spool_record
+	{
+		/* 0 for a free record */
+		u32_t seq;
+		ip_addr_t ip;
+		u16_t port;
+		u16_t len;
+		s32_t request_id;
+		/* slot in snmp_targets */
+		u8_t target;
+		u8_t inform;
+		u8_t data[ SNMP_TRAP_SPOOL_RECORD_SIZE ];
+	};
+
+	/* the part of a record that is persisted: all but the unused data */
+	#define SPOOL_HEADER_SIZE    offsetof( struct spool_record, data )
+
+	static struct spool_record spool_records[ SNMP_TRAP_SPOOL ];
+	static u32_t spool_seq = 1U;
+	static u16_t spool_used;
+	/* a destination a send failed for is not tried before its retry time */
+	static bool spool_down[ SNMP_TRAP_DESTINATIONS ];
+	static u32_t spool_retry_ms[ SNMP_TRAP_DESTINATIONS ];
+	/* snmp_stats.inpkts at the previous replay step */
+	static u32_t spool_inpkts;
+	static struct snmp_trap_spool_stats spool_stats;
+
+	/* Protects everything above. */
+	static K_MUTEX_DEFINE( spool_lock );
+
+	static void spool_work_handler( struct k_work * work );
+
+	static K_WORK_DELAYABLE_DEFINE( spool_work, spool_work_handler );
+
+	#if SNMP_TRAP_SPOOL_PERSIST
+		static bool spool_dirty[ SNMP_TRAP_SPOOL ];
+		/* records read back by settings_load(), until its commit */
+		static bool spool_restored[ SNMP_TRAP_SPOOL ];
+		static u32_t spool_restored_seq;
+		/* the record being written, copied so spool_lock is not held
+		 * while writing the flash */
+		static struct spool_record spool_save_copy;
+
+		static void spool_save_handler( struct k_work * work );
+
+		static K_WORK_DEFINE( spool_save_work, spool_save_handler );
+	#endif
+
+	/* Call with spool_lock held. */
+	static void spool_changed( u8_t index )
+	{
+		#if SNMP_TRAP_SPOOL_PERSIST
+			spool_dirty[ index ] = true;
+			k_work_submit( &spool_save_work );
+		#else
+			ARG_UNUSED( index );
+		#endif
+	}
+
+	/* Call with spool_lock held: a free record, or the oldest one, which
+	 * is dropped. */
+	static u8_t spool_take( void )
+	{
+		u8_t oldest = SPOOL_NONE;
+		u8_t i;
+
+		for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+		{
+			if( spool_records[ i ].seq == 0U )
+			{
+				spool_used++;
+				return i;
+			}
+			if( ( oldest == SPOOL_NONE ) || ( spool_records[ i ].seq < spool_records[ oldest ].seq ) )
+			{
+				oldest = i;
+			}
+		}
+		spool_stats.dropped++;
+		return oldest;
+	}
+
+	/* Call with spool_lock held. */
+	static void spool_release( u8_t index )
+	{
+		spool_records[ index ].seq = 0U;
+		spool_used--;
+		spool_changed( index );
+	}
+
+	/* Call with spool_lock held: the oldest record whose destination is
+	 * due, or SPOOL_NONE. */
+	static u8_t spool_next( u32_t now_ms )
+	{
+		u8_t next = SPOOL_NONE;
+		u8_t i;
+
+		for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+		{
+			const struct spool_record * record = &spool_records[ i ];
+
+			if( ( record->seq == 0U ) ||
+				( spool_down[ record->target ] && ( ( s32_t ) ( now_ms - spool_retry_ms[ record->target ] ) < 0 ) ) )
+			{
+				continue;
+			}
+			if( ( next == SPOOL_NONE ) || ( record->seq < spool_records[ next ].seq ) )
+			{
+				next = i;
+			}
+		}
+		return next;
+	}
+
+	/* Call with spool_lock held. */
+	static void spool_set_down( u8_t target, u32_t now_ms )
+	{
+		spool_down[ target ]     = true;
+		spool_retry_ms[ target ] = now_ms + SNMP_TRAP_SPOOL_RETRY_MS;
+	}
+
+	void snmp_trap_spool_store( const struct pbuf * p, u8_t index, const struct snmp_target * target,
+								s32_t request_id, u8_t inform )
+	{
+		struct spool_record * record;
+		u8_t record_index;
+
+		k_mutex_lock( &spool_lock, K_FOREVER );
+		if( p->tot_len > SNMP_TRAP_SPOOL_RECORD_SIZE )
+		{
+			spool_stats.too_large++;
+			k_mutex_unlock( &spool_lock );
+			return;
+		}
+		record_index = spool_take();
+		record       = &spool_records[ record_index ];
+
+		record->seq        = spool_seq++;
+		ip_addr_copy( record->ip, target->ip );
+		record->port       = target->port;
+		record->len        = p->tot_len;
+		record->request_id = request_id;
+		record->target     = index;
+		record->inform     = inform;
+		( void ) pbuf_copy_partial( p, record->data, p->tot_len, 0 );
+		#if SNMP_TRAP_SPOOL_PERSIST
+			spool_restored[ record_index ] = false;
+		#endif
+
+		spool_stats.spooled++;
+		if( spool_used > spool_stats.high_water )
+		{
+			spool_stats.high_water = spool_used;
+		}
+		spool_set_down( index, sys_now() );
+		spool_inpkts = snmp_stats.inpkts;
+		spool_changed( record_index );
+		k_mutex_unlock( &spool_lock );
+
+		/* no-op when the work is already scheduled */
+		k_work_schedule( &spool_work, K_MSEC( SNMP_TRAP_SPOOL_INTERVAL_MS ) );
+	}
+
+	void snmp_trap_spool_route_up( u8_t index )
+	{
+		/* the common case, nothing spooled, takes no lock */
+		if( spool_used == 0U )
+		{
+			return;
+		}
+		k_mutex_lock( &spool_lock, K_FOREVER );
+		spool_down[ index ] = false;
+		k_mutex_unlock( &spool_lock );
+	}
+
+	err_t snmp_trap_spool_poll( void )
+	{
+		struct spool_record * record;
+		struct pbuf * p;
+		u32_t now_ms = sys_now();
+		u8_t index;
+		int rc;
+		#if SNMP_INFORM_PENDING
+			bool tracked;
+		#endif
+
+		k_mutex_lock( &spool_lock, K_FOREVER );
+		if( spool_inpkts != snmp_stats.inpkts )
+		{
+			/* requests came in since the previous step, they go first */
+			spool_inpkts = snmp_stats.inpkts;
+			spool_stats.deferred++;
+			k_mutex_unlock( &spool_lock );
+			return ERR_INPROGRESS;
+		}
+		index = spool_next( now_ms );
+		if( index == SPOOL_NONE )
+		{
+			k_mutex_unlock( &spool_lock );
+			return ERR_WOULDBLOCK;
+		}
+		record = &spool_records[ index ];
+
+		p = pbuf_alloc_reference( record->data, record->len, PBUF_REF );
+		if( p == NULL )
+		{
+			k_mutex_unlock( &spool_lock );
+			return ERR_MEM;
+		}
+		#if SNMP_INFORM_PENDING
+			/* the target may have changed since, e.g. across a reboot */
+			tracked = record->inform &&
+					  ip_addr_cmp( &snmp_targets[ record->target ].ip, &record->ip ) &&
+					  ( snmp_targets[ record->target ].port == record->port );
+			if( tracked )
+			{
+				/* before an answer can come in */
+				/* the callback of its notification is not kept */
+				snmp_inform_track( p, record->target, &snmp_targets[ record->target ], record->request_id, NULL, NULL );
+			}
+		#endif
+		snmp_stats.outpkts++;
+		rc = snmp_sendto( snmp_traps_handle, p, &record->ip, htons( record->port ) );
+		if( rc <= 0 )
+		{
+			#if SNMP_INFORM_PENDING
+				if( tracked )
+				{
+					snmp_inform_cancel( record->request_id, record->target );
+				}
+			#endif
+			spool_stats.failed++;
+			spool_set_down( record->target, now_ms );
+			pbuf_free( p );
+			k_mutex_unlock( &spool_lock );
+			return ERR_CONN;
+		}
+		spool_stats.replayed++;
+		spool_down[ record->target ] = false;
+		pbuf_free( p );
+		spool_release( index );
+		k_mutex_unlock( &spool_lock );
+		return ERR_OK;
+	}
+
+	static void spool_work_handler( struct k_work * work )
+	{
+		ARG_UNUSED( work );
+
+		/* spool_lock and inform_lock nest both ways, the core lock orders them */
+		snmp_core_lock();
+		( void ) snmp_trap_spool_poll();
+		snmp_core_unlock();
+		if( spool_used > 0U )
+		{
+			k_work_schedule( &spool_work, K_MSEC( SNMP_TRAP_SPOOL_INTERVAL_MS ) );
+		}
+	}
+
+	void snmp_trap_spool_get_stats( struct snmp_trap_spool_stats * stats )
+	{
+		k_mutex_lock( &spool_lock, K_FOREVER );
+		*stats        = spool_stats;
+		stats->queued = spool_used;
+		k_mutex_unlock( &spool_lock );
+	}
+
+	u16_t snmp_trap_spool_count( void )
+	{
+		return spool_used;
+	}
+
+	void snmp_trap_spool_clear( void )
+	{
+		u8_t i;
+
+		k_mutex_lock( &spool_lock, K_FOREVER );
+		for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+		{
+			if( spool_records[ i ].seq != 0U )
+			{
+				spool_release( i );
+			}
+		}
+		memset( spool_down, 0, sizeof( spool_down ) );
+		k_mutex_unlock( &spool_lock );
+	}
+
+	#if SNMP_TRAP_SPOOL_PERSIST
+
+		static void spool_save_handler( struct k_work * work )
+		{
+			char path[ sizeof( SPOOL_SETTINGS_ROOT ) + 4 ];
+			bool used;
+			u8_t i;
+			int rc;
+
+			ARG_UNUSED( work );
+
+			for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+			{
+				k_mutex_lock( &spool_lock, K_FOREVER );
+				if( !spool_dirty[ i ] )
+				{
+					k_mutex_unlock( &spool_lock );
+					continue;
+				}
+				spool_dirty[ i ] = false;
+				used = ( spool_records[ i ].seq != 0U );
+				if( used )
+				{
+					memcpy( &spool_save_copy, &spool_records[ i ], SPOOL_HEADER_SIZE + spool_records[ i ].len );
+				}
+				k_mutex_unlock( &spool_lock );
+
+				snprintf( path, sizeof( path ), SPOOL_SETTINGS_ROOT "/%u", ( unsigned ) i );
+				if( used )
+				{
+					rc = settings_save_one( path, &spool_save_copy, SPOOL_HEADER_SIZE + spool_save_copy.len );
+				}
+				else
+				{
+					rc = settings_delete( path );
+				}
+				if( rc != 0 )
+				{
+					zephyr_log( "snmp_trap_spool: saving %s failed: %d\n", path, rc );
+				}
+			}
+		}
+
+		/* Call with spool_lock held: a free record, or the oldest restored
+		 * one, which is dropped; SPOOL_NONE when all records hold
+		 * notifications of this boot. */
+		static u8_t spool_take_restored( void )
+		{
+			u8_t oldest = SPOOL_NONE;
+			u8_t i;
+
+			for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+			{
+				if( spool_records[ i ].seq == 0U )
+				{
+					spool_used++;
+					return i;
+				}
+				if( spool_restored[ i ] &&
+					( ( oldest == SPOOL_NONE ) || ( spool_records[ i ].seq < spool_records[ oldest ].seq ) ) )
+				{
+					oldest = i;
+				}
+			}
+			if( oldest != SPOOL_NONE )
+			{
+				spool_stats.dropped++;
+			}
+			return oldest;
+		}
+
+		static int spool_settings_set( const char * name, size_t len, settings_read_cb read_cb, void * cb_arg )
+		{
+			struct spool_record * record;
+			char * end;
+			unsigned long slot = strtoul( name, &end, 10 );
+			u8_t index;
+
+			if( ( *end != '\0' ) || ( slot >= SNMP_TRAP_SPOOL ) ||
+				( len < SPOOL_HEADER_SIZE ) || ( len > sizeof( *record ) ) )
+			{
+				return 0;
+			}
+
+			k_mutex_lock( &spool_lock, K_FOREVER );
+			/* records spooled before settings_load() keep theirs, the
+			 * stored one moves to a free record */
+			if( spool_records[ slot ].seq == 0U )
+			{
+				index = ( u8_t ) slot;
+				spool_used++;
+			}
+			else
+			{
+				spool_dirty[ slot ] = true;
+				index = spool_take_restored();
+				if( index == SPOOL_NONE )
+				{
+					/* the spool is full of newer notifications */
+					spool_stats.dropped++;
+					k_work_submit( &spool_save_work );
+					k_mutex_unlock( &spool_lock );
+					return 0;
+				}
+			}
+			record = &spool_records[ index ];
+			if( ( read_cb( cb_arg, record, len ) != ( ssize_t ) len ) ||
+				( record->seq == 0U ) || ( SPOOL_HEADER_SIZE + record->len != len ) ||
+				( record->target >= SNMP_TRAP_DESTINATIONS ) )
+			{
+				/* unreadable: freed, and deleted by the save work */
+				spool_release( index );
+				k_mutex_unlock( &spool_lock );
+				return 0;
+			}
+			spool_restored[ index ] = true;
+			if( index != slot )
+			{
+				spool_changed( index );
+			}
+			if( record->seq > spool_restored_seq )
+			{
+				spool_restored_seq = record->seq;
+			}
+			spool_stats.restored++;
+			if( spool_used > spool_stats.high_water )
+			{
+				spool_stats.high_water = spool_used;
+			}
+			k_mutex_unlock( &spool_lock );
+			return 0;
+		}
+
+		static int spool_settings_commit( void )
+		{
+			u32_t seq;
+			u8_t i;
+
+			k_mutex_lock( &spool_lock, K_FOREVER );
+			/* the notifications of the previous boot are older than the
+			 * ones spooled before settings_load() */
+			spool_seq = 1U;
+			for( i = 0; i < SNMP_TRAP_SPOOL; i++ )
+			{
+				seq = spool_records[ i ].seq;
+				if( ( seq != 0U ) && !spool_restored[ i ] && ( spool_restored_seq != 0U ) )
+				{
+					seq += spool_restored_seq;
+					spool_records[ i ].seq = seq;
+					spool_changed( i );
+				}
+				if( seq >= spool_seq )
+				{
+					spool_seq = seq + 1U;
+				}
+				spool_restored[ i ] = false;
+			}
+			spool_restored_seq = 0U;
+			k_mutex_unlock( &spool_lock );
+
+			if( spool_used > 0U )
+			{
+				k_work_schedule( &spool_work, K_MSEC( SNMP_TRAP_SPOOL_INTERVAL_MS ) );
+				k_work_submit( &spool_save_work );
+			}
+			return 0;
+		}
+
+		SETTINGS_STATIC_HANDLER_DEFINE( snmp_trap_spool, SPOOL_SETTINGS_ROOT, NULL,
+										spool_settings_set, spool_settings_commit, NULL );
+
+	#endif /* SNMP_TRAP_SPOOL_PERSIST */
+
+#endif /* LWIP_SNMP && SNMP_TRAP_SPOOL */
@@ -46,14 +46,27 @@
 #include "lwip/sys.h"
 #include "lwip/apps/snmp.h"
 #include "lwip/apps/snmp_core.h"
-#include "lwip/prot/iana.h"
 #include "snmp_msg.h"
 #include "snmp_asn1.h"
 #include "snmp_core_priv.h"
+#include "lwip/apps/snmp_inform.h"
+#include "lwip/apps/snmp_notification.h"
+#include "lwip/apps/snmp_notify_filter.h"
+#include "lwip/apps/snmp_trap_limit.h"
+#include "lwip/apps/snmp_trap_spool.h"
+#include "lwip/apps/snmp_trap_template.h"
+#if LWIP_SNMP_V3
+#include "snmpv3_priv.h"
+#endif
 
 #define SNMP_IS_INFORM                            1
 #define SNMP_IS_TRAP                              0
 
+/* Longest header encoded per destination: message sequence, version,
+ * community and PDU tag, then the v1 enterprise OID and agent address or
+ * the v2c request ID. */
+#define SNMP_TRAP_HEADER_MAX_LEN                  (40 + LWIP_MAX(SNMP_MAX_COMMUNITY_STR_LEN, SNMP_TARGET_MAX_NAME_LEN) + (5 * SNMP_MAX_OBJ_ID_LEN))
+
 struct snmp_msg_trap
 {
   /* source enterprise ID (sysObjectID) */
@@ -68,6 +81,8 @@ struct snmp_msg_trap
   u32_t ts;
   /* snmp_version */
   u32_t snmp_version;
+  /* community of the destination */
+  const char *community;
 
   /* output trap lengths used in ASN encoding */
   /* encoding pdu length */
@@ -78,6 +93,8 @@ struct snmp_msg_trap
   u16_t seqlen;
   /* encoding varbinds sequence length */
   u16_t vbseqlen;
+  /* encoding length of the PDU fields shared by all destinations */
+  u16_t bodylen;
 
   /* error status */
   s32_t error_status;
@@ -85,19 +102,56 @@ struct snmp_msg_trap
   s32_t error_index;
   /* trap or inform? */
   u8_t trap_or_inform;
+  /* the targets the caller selected, see snmp_target.h, NULL for all */
+  const u8_t *targets;
+  /* the completion callback of its INFORMs, see snmp_notification.h */
+  snmp_inform_done_fct done;
+  void *done_arg;
+};
+
+/* the varbinds of a notification */
+struct snmp_trap_varbinds
+{
+  const struct snmp_obj_id *eoid;
+  s32_t generic_trap;
+  s32_t specific_trap;
+  /* list of the caller */
+  struct snmp_varbind *varbinds;
+  /* varbinds->prev of the caller, restored by snmp_trap_varbinds_done() */
+  struct snmp_varbind *original_prev;
+  /* sysUpTime and snmpTrapOID followed by varbinds, NULL until the
+   * SNMPv2c body is encoded */
+  struct snmp_varbind *v2_varbinds;
+  struct snmp_varbind special[2];
+  /* used for converting SNMPv1 generic/specific trap parameter to SNMPv2 snmpTrapOID,
+   * the snmpTrapOID varbind points into it */
+  struct snmp_obj_id trap_oid;
+  u32_t timestamp;
 };
 
 static u16_t snmp_trap_varbind_sum(struct snmp_msg_trap *trap, struct snmp_varbind *varbinds);
-static u16_t snmp_trap_header_sum(struct snmp_msg_trap *trap, u16_t vb_len);
+static u16_t snmp_trap_body_sum(struct snmp_msg_trap *trap, u16_t vb_len);
+static u16_t snmp_trap_header_sum(struct snmp_msg_trap *trap);
 static err_t snmp_trap_header_enc(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
+static err_t snmp_trap_body_enc(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
 static err_t snmp_trap_varbind_enc(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream, struct snmp_varbind *varbinds);
 static u16_t snmp_trap_header_sum_v1_specific(struct snmp_msg_trap *trap);
 static u16_t snmp_trap_header_sum_v2c_specific(struct snmp_msg_trap *trap);
+static u16_t snmp_trap_body_sum_v1_specific(struct snmp_msg_trap *trap);
+static u16_t snmp_trap_body_sum_v2c_specific(struct snmp_msg_trap *trap);
 static err_t snmp_trap_header_enc_v1_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
 static err_t snmp_trap_header_enc_v2c_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
+static err_t snmp_trap_body_enc_v1_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
+static err_t snmp_trap_body_enc_v2c_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream);
 static err_t snmp_prepare_trap_oid(struct snmp_obj_id *dest_snmp_trap_oid, const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap);
 static void snmp_prepare_necessary_msg_fields(struct snmp_msg_trap *trap_msg, const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap, struct snmp_varbind *varbinds);
-static err_t snmp_send_msg(struct snmp_msg_trap *trap_msg, struct snmp_varbind *varbinds, u16_t tot_len, ip_addr_t *dip);
+static err_t snmp_encode_body(struct snmp_msg_trap *trap_msg, struct snmp_varbind *varbinds, struct pbuf **body);
+static err_t snmp_send_msg(struct snmp_msg_trap *trap_msg, struct pbuf *body, u8_t index, const struct snmp_target *target);
+
+/** encodes the body of a version of a notification, see snmp_send_to_targets() */
+typedef err_t (*snmp_trap_body_fct)(struct snmp_msg_trap *msg, struct pbuf **body, void *arg);
+
+static err_t snmp_send_to_targets(struct snmp_msg_trap *trap_msg, const u8_t *targets, snmp_trap_body_fct encode_body, void *arg);
 
 #define BUILD_EXEC(code) \
   if ((code) != ERR_OK) { \
@@ -110,19 +164,6 @@ extern const char *snmp_community_trap;
 
 void *snmp_traps_handle;
 
-/**
- * @ingroup snmp_traps
- * @struct snmp_trap_dst
- */
-struct snmp_trap_dst
-{
-  /* destination IP address in network order */
-  ip_addr_t dip;
-  /* set to 0 when disabled, >0 when enabled */
-  u8_t enable;
-};
-static struct snmp_trap_dst trap_dst[SNMP_TRAP_DESTINATIONS];
-
 static u8_t snmp_auth_traps_enabled = 0;
 
 /* This is used in functions like snmp_coldstart_trap where user didn't specify which version of trap to use */
@@ -131,39 +172,39 @@ static u8_t snmp_default_trap_version = SNMP_VERSION_1;
 /* This is used in trap messages v2c */
 static s32_t req_id = 1;
 
-/**
- * @ingroup snmp_traps
- * Sets enable switch for this trap destination.
- * @param dst_idx index in 0 .. SNMP_TRAP_DESTINATIONS-1
- * @param enable switch if 0 destination is disabled >0 enabled.
- *
- * @retval void
- */
-void
-snmp_trap_dst_enable(u8_t dst_idx, u8_t enable)
-{
-  LWIP_ASSERT_SNMP_LOCKED();
-  if (dst_idx < SNMP_TRAP_DESTINATIONS) {
-    trap_dst[dst_idx].enable = enable;
-  }
-}
-
-/**
- * @ingroup snmp_traps
- * Sets IPv4 address for this trap destination.
- * @param dst_idx index in 0 .. SNMP_TRAP_DESTINATIONS-1
- * @param dst IPv4 address in host order.
- *
- * @retval void
- */
-void
-snmp_trap_dst_ip_set(u8_t dst_idx, const ip_addr_t *dst)
-{
-  LWIP_ASSERT_SNMP_LOCKED();
-  if (dst_idx < SNMP_TRAP_DESTINATIONS) {
-    ip_addr_set(&trap_dst[dst_idx].dip, dst);
-  }
-}
+/* The two varbinds SNMPv2c notifications start with, see rfc3584 */
+static const struct snmp_varbind snmp_v2_special_varbinds[] = {
+                                                     /* First varbind is used to store sysUpTime */
+                                                     {
+                                                       NULL,                            /* *next */
+                                                       NULL,                            /* *prev */
+                                                       {                                /* oid */
+                                                         9,                             /* oid len */
+                                                         {1, 3, 6, 1, 2, 1, 1, 3, 0}    /* oid for sysUpTime (1.3.6.1.2.1.1.3) */
+                                                       },
+                                                       SNMP_ASN1_TYPE_TIMETICKS,        /* type */
+                                                       sizeof(u32_t),                   /* value_len */
+                                                       NULL                             /* value */
+                                                     },
+						 /* 1.3.6.1.6.3.1.1.4.1.0
+						  * Second varbind is used to store snmpTrapOID
+						  * "The authoritative identification of the notification
+						  * currently being sent. This variable occurs as
+						  * the second varbind in every SNMPv2-Trap-PDU and
+						  * InformRequest-PDU."
+						  */
+                                                     {
+                                                       NULL,                            /* *next */
+                                                       NULL,                            /* *prev */
+                                                       {                                /* oid */
+                                                         11,                            /* oid len */
+                                                         {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0} /* oid for snmpTrapOID (1.3.6.1.6.3.1.1.4.1.0) */
+                                                       },
+                                                       SNMP_ASN1_TYPE_OBJECT_ID,        /* type */
+                                                       0,                               /* value_len */
+                                                       NULL                             /* value */
+                                                     }
+};
 
 /**
  * @ingroup snmp_traps
@@ -257,7 +298,7 @@ snmp_prepare_trap_oid(struct snmp_obj_id *dest_snmp_trap_oid, const struct snmp_
     if (sizeof(dest_snmp_trap_oid->id) >= sizeof(snmpTrapOID)) {
       MEMCPY(&dest_snmp_trap_oid->id, snmpTrapOID , sizeof(snmpTrapOID));
       dest_snmp_trap_oid->len = LWIP_ARRAYSIZE(snmpTrapOID);
-      dest_snmp_trap_oid->id[dest_snmp_trap_oid->len++] = specific_trap + 1;
+      dest_snmp_trap_oid->id[dest_snmp_trap_oid->len++] = generic_trap + 1;
     } else {
       err = ERR_MEM;
     }
@@ -293,47 +334,310 @@ snmp_prepare_necessary_msg_fields(struct snmp_msg_trap *trap_msg, const struct s
 
 /**
  * @ingroup snmp_traps
- * Copy trap message structure to pbuf and sends it
+ * Encodes the part of the message that is the same for all destinations:
+ * the PDU fields after the agent address (v1) or the request ID (v2c) and
+ * the varbinds.
  * @param trap_msg contains the data that should be sent
  * @param varbinds list of varbinds
- * @param tot_len total length of encoded data
- * @param dip destination IP address
+ * @param body [out] the encoded fields, to be freed by the caller
+ * @return ERR_OK if successful
+ */
+static err_t
+snmp_encode_body(struct snmp_msg_trap *trap_msg, struct snmp_varbind *varbinds, struct pbuf **body)
+{
+  struct snmp_pbuf_stream pbuf_stream;
+  struct pbuf *p;
+  u16_t tot_len;
+
+  /* pass 0, calculate length fields */
+  tot_len = snmp_trap_varbind_sum(trap_msg, varbinds);
+  tot_len = snmp_trap_body_sum(trap_msg, tot_len);
+
+  p = pbuf_alloc(PBUF_TRANSPORT, tot_len, PBUF_RAM);
+  if (p == NULL) {
+    zephyr_log ("snmp_encode_body: pbuf_alloc failed\n");
+    return ERR_MEM;
+  }
+
+  /* pass 1, encode the fields into the pbuf */
+  snmp_pbuf_stream_init(&pbuf_stream, p, 0, tot_len);
+  if ((snmp_trap_body_enc(trap_msg, &pbuf_stream) != ERR_OK) ||
+      (snmp_trap_varbind_enc(trap_msg, &pbuf_stream, varbinds) != ERR_OK)) {
+    pbuf_free(p);
+    return ERR_ARG;
+  }
+  *body = p;
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Encodes the header of one destination in front of the shared body and
+ * sends both, without copying the body.
+ * @param trap_msg contains the data that should be sent
+ * @param body the fields encoded by snmp_encode_body()
+ * @param index slot of the target in snmp_targets
+ * @param target the destination
  * @return ERR_OK if sending was successful
  */
 static err_t
-snmp_send_msg(struct snmp_msg_trap *trap_msg, struct snmp_varbind *varbinds, u16_t tot_len, ip_addr_t *dip)
+snmp_send_msg(struct snmp_msg_trap *trap_msg, struct pbuf *body, u8_t index, const struct snmp_target *target)
 {
-  int rc;
+  u8_t header[SNMP_TRAP_HEADER_MAX_LEN];
+  struct snmp_pbuf_stream pbuf_stream;
+  struct pbuf *p;
+  u16_t header_len;
   err_t err = ERR_OK;
-  struct pbuf *p = NULL;
-  /* allocate pbuf(s) */
-  p = pbuf_alloc(PBUF_TRANSPORT, tot_len, PBUF_RAM);
-  if (p != NULL) {
-    struct snmp_pbuf_stream pbuf_stream;
-    snmp_pbuf_stream_init(&pbuf_stream, p, 0, tot_len);
-
-    /* pass 1, encode packet ino the pbuf(s) */
-    BUILD_EXEC( snmp_trap_header_enc(trap_msg, &pbuf_stream) );
-    BUILD_EXEC( snmp_trap_varbind_enc(trap_msg, &pbuf_stream, varbinds) );
-
-    snmp_stats.outtraps++;
-    snmp_stats.outpkts++;
-
-    /* snmp_sendto() wants a network-endian port number. */
-    u16_t port = ntohs(LWIP_IANA_PORT_SNMP_TRAP);
-    /** send to the TRAP destination */
-    rc = snmp_sendto(snmp_traps_handle, p, dip, port);
-    if (rc <= 0) {
-		err = ERR_CONN;
-	}
+  int rc;
+
+  header_len = snmp_trap_header_sum(trap_msg);
+  if (header_len > sizeof(header)) {
+    return ERR_MEM;
+  }
+  p = pbuf_alloc_reference(header, header_len, PBUF_REF);
+  if (p == NULL) {
+    zephyr_log ("snmp_send_msg: pbuf_alloc_reference failed\n");
+    return ERR_MEM;
+  }
+  pbuf_chain(p, body);
+
+  snmp_pbuf_stream_init(&pbuf_stream, p, 0, header_len);
+  if (snmp_trap_header_enc(trap_msg, &pbuf_stream) != ERR_OK) {
     pbuf_free(p);
+    return ERR_ARG;
+  }
+
+  snmp_stats.outtraps++;
+  snmp_stats.outpkts++;
+
+#if SNMP_INFORM_PENDING
+  if (trap_msg->trap_or_inform == SNMP_IS_INFORM) {
+    /* keeps a copy to send again until the target answers, before an
+     * answer can come in */
+    snmp_inform_track(p, index, target, req_id, trap_msg->done, trap_msg->done_arg);
+  }
+#endif
+  /** send to the TRAP destination, snmp_sendto() wants a network-endian port number */
+  rc = snmp_sendto(snmp_traps_handle, p, &target->ip, htons(target->port));
+  if (rc <= 0) {
+    err = ERR_CONN;
+#if SNMP_INFORM_PENDING
+    if (trap_msg->trap_or_inform == SNMP_IS_INFORM) {
+      snmp_inform_cancel(req_id, index);
+    }
+#endif
+#if SNMP_TRAP_SPOOL
+    /* keeps a copy to replay when the destination can be reached again */
+    snmp_trap_spool_store(p, index, target, req_id, (u8_t)(trap_msg->trap_or_inform == SNMP_IS_INFORM));
+#endif
   } else {
-	zephyr_log ("snmp_send_msg: pbuf_alloc failed\n");
-    err = ERR_MEM;
+#if SNMP_TRAP_SPOOL
+    snmp_trap_spool_route_up(index);
+#endif
+  }
+#if !SNMP_INFORM_PENDING && !SNMP_TRAP_SPOOL
+  LWIP_UNUSED_ARG(index);
+#endif
+  /* releases the header and our reference to the body */
+  pbuf_free(p);
+  return err;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sends a notification to all enabled targets.
+ * Each target gets the version and notification type it is configured
+ * for; informs (SNMP_IS_INFORM) go to all of them as SNMPv2c. With
+ * SNMP_V3_NOTIFICATIONS, SNMPv3 targets get the SNMPv2c body behind the
+ * header and security parameters of snmpv3_notify_send(), and only SNMPv1
+ * targets get informs as SNMPv2c.
+ *
+ * @param trap_msg defines msg type, and the targets the caller selected
+ * @param targets the targets the notification filters let it through to,
+ *        NULL for all; nothing is encoded for the targets left out
+ * @param encode_body encodes the body of a version, once, for the first
+ *        destination of that version
+ * @param arg passed to encode_body
+ * @return ERR_OK when success, else the error of the first destination
+ *         that failed
+ */
+static err_t
+snmp_send_to_targets(struct snmp_msg_trap *trap_msg, const u8_t *targets, snmp_trap_body_fct encode_body, void *arg)
+{
+  const struct snmp_target *target;
+  /* the messages and bodies of SNMPv1 [0] and SNMPv2c [1] destinations */
+  struct snmp_msg_trap msgs[2];
+  struct pbuf *bodies[2] = { NULL, NULL };
+  struct snmp_msg_trap *msg;
+  u16_t i = 0;
+  u8_t version;
+  u8_t k;
+  err_t err = ERR_OK;
+  err_t dst_err;
+
+  for (i = 0, target = &snmp_targets[0]; i < SNMP_TRAP_DESTINATIONS; i++, target++) {
+    if ((target->enable == 0) || (target->name[0] == '\0') || ip_addr_isany(&target->ip)) {
+      continue;
+    }
+    if (((targets != NULL) && !SNMP_TARGET_SET_HAS(targets, i)) ||
+        ((trap_msg->targets != NULL) && !SNMP_TARGET_SET_HAS(trap_msg->targets, i))) {
+      continue;
+    }
+    if (target->version == SNMP_TARGET_VERSION_DEFAULT) {
+      version = snmp_default_trap_version;
+    } else {
+      version = target->version;
+    }
+#if LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS
+    /* informs go to SNMPv1 targets as SNMPv2c */
+    if ((trap_msg->trap_or_inform == SNMP_IS_INFORM) && (version == SNMP_VERSION_1)) {
+      version = SNMP_VERSION_2c;
+    }
+    if ((version != SNMP_VERSION_1) && (version != SNMP_VERSION_2c) && (version != SNMP_VERSION_3)) {
+      continue;
+    }
+#else
+    /* informs are always sent as SNMPv2c */
+    if (trap_msg->trap_or_inform == SNMP_IS_INFORM) {
+      version = SNMP_VERSION_2c;
+    }
+    if ((version != SNMP_VERSION_1) && (version != SNMP_VERSION_2c)) {
+      /* no SNMPv3 notifications without SNMP_V3_NOTIFICATIONS */
+      continue;
+    }
+#endif
+    /* SNMPv3 targets share the SNMPv2c body */
+    k = (version == SNMP_VERSION_1) ? 0 : 1;
+    msg = &msgs[k];
+    if (bodies[k] == NULL) {
+      *msg = *trap_msg;
+      msg->snmp_version = (k == 0) ? SNMP_VERSION_1 : SNMP_VERSION_2c;
+    }
+
+    /* lookup current source address for this dst */
+    if (!snmp_get_local_ip_for_dst(snmp_traps_handle, &target->ip, &msg->sip)) {
+      /* routing error */
+      if (err == ERR_OK) {
+        err = ERR_RTE;
+      }
+      continue;
+    }
+
+    dst_err = ERR_OK;
+    if (bodies[k] == NULL) {
+      dst_err = encode_body(msg, &bodies[k], arg);
+    }
+
+    /* encode the header of this destination and send it with the body */
+    if (dst_err == ERR_OK) {
+      msg->trap_or_inform = ((version != SNMP_VERSION_1) && (target->type == SNMP_TARGET_INFORM)) ?
+                            SNMP_IS_INFORM : trap_msg->trap_or_inform;
+      msg->community = (target->security_name[0] != '\0') ? target->security_name : snmp_community_trap;
+#if LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS
+      if (version == SNMP_VERSION_3) {
+        dst_err = snmpv3_notify_send(bodies[k], (u8_t)(msg->trap_or_inform == SNMP_IS_INFORM), req_id, (u8_t)i, target,
+                                     msg->done, msg->done_arg);
+      } else
+#endif
+      {
+        dst_err = snmp_send_msg(msg, bodies[k], (u8_t)i, target);
+      }
+    }
+    if (err == ERR_OK) {
+      err = dst_err;
+    }
+  }
+  for (k = 0; k < LWIP_ARRAYSIZE(bodies); k++) {
+    if (bodies[k] != NULL) {
+      pbuf_free(bodies[k]);
+    }
   }
+  req_id++;
   return err;
 }
 
+/**
+ * @ingroup snmp_traps
+ * Encodes the body of a version from the varbinds of the caller, with
+ * sysUpTime and snmpTrapOID put in front of them for SNMPv2c.
+ * @param msg the message of the version, see snmp_send_to_targets()
+ * @param body [out] the encoded fields, to be freed by the caller
+ * @param arg the struct snmp_trap_varbinds of the notification
+ * @return ERR_OK if successful
+ */
+static err_t
+snmp_trap_varbinds_body(struct snmp_msg_trap *msg, struct pbuf **body, void *arg)
+{
+  struct snmp_trap_varbinds *vbs = (struct snmp_trap_varbinds *)arg;
+  struct snmp_varbind *list = vbs->varbinds;
+  err_t err;
+
+  if (msg->snmp_version == SNMP_VERSION_2c) {
+    if (vbs->v2_varbinds == NULL) {
+      /* see rfc3584 */
+      err = snmp_prepare_trap_oid(&vbs->trap_oid, vbs->eoid, vbs->generic_trap, vbs->specific_trap);
+      if (err != ERR_OK) {
+        return err;
+      }
+      MEMCPY(vbs->special, snmp_v2_special_varbinds, sizeof(vbs->special));
+      vbs->special[0].next = &vbs->special[1];
+      vbs->special[0].object_value = &vbs->timestamp;
+      vbs->special[1].prev = &vbs->special[0];
+      vbs->special[1].next = vbs->varbinds;
+      vbs->special[1].value_len = vbs->trap_oid.len * sizeof(vbs->trap_oid.id[0]);
+      vbs->special[1].object_value = vbs->trap_oid.id;
+      if (vbs->varbinds != NULL) {
+        vbs->original_prev = vbs->varbinds->prev;
+        vbs->varbinds->prev = &vbs->special[1];
+      }
+      vbs->v2_varbinds = vbs->special;  /* After inserting two varbinds at the beginning of the list, make sure that pointer is pointing to the first element  */
+    }
+    list = vbs->v2_varbinds;
+  }
+  snmp_prepare_necessary_msg_fields(msg, vbs->eoid, vbs->generic_trap, vbs->specific_trap, list);
+  return snmp_encode_body(msg, list, body);
+}
+
+/** restores the list of the caller after snmp_trap_varbinds_body() */
+static void
+snmp_trap_varbinds_done(struct snmp_trap_varbinds *vbs)
+{
+  if ((vbs->v2_varbinds != NULL) && (vbs->varbinds != NULL)) {
+    vbs->varbinds->prev = vbs->original_prev;
+  }
+}
+
+#if SNMP_NOTIFY_FILTERS
+/**
+ * @ingroup snmp_traps
+ * Checks snmpTrapOID and the OIDs of the varbinds of a notification against
+ * the filter profiles of the targets.
+ * @param vbs the notification
+ * @param targets [out] a bit per target the notification passes
+ * @return targets, or NULL when no target has a profile
+ */
+static const u8_t *
+snmp_trap_varbinds_filter(struct snmp_trap_varbinds *vbs, u8_t *targets)
+{
+  struct snmp_notify_filter_eval eval;
+  struct snmp_obj_id trap_oid;
+  const struct snmp_varbind *varbind;
+
+  if (!snmp_notify_filter_active()) {
+    return NULL;
+  }
+  snmp_notify_filter_begin(&eval);
+  if (snmp_prepare_trap_oid(&trap_oid, vbs->eoid, vbs->generic_trap, vbs->specific_trap) == ERR_OK) {
+    snmp_notify_filter_oid(&eval, trap_oid.id, trap_oid.len);
+  }
+  for (varbind = vbs->varbinds; varbind != NULL; varbind = varbind->next) {
+    snmp_notify_filter_oid(&eval, varbind->oid.id, varbind->oid.len);
+  }
+  snmp_notify_filter_targets(&eval, targets);
+  return targets;
+}
+#endif /* SNMP_NOTIFY_FILTERS */
+
 /**
  * @ingroup snmp_traps
  * Prepare and sends a generic or enterprise specific trap message, notification or inform.
@@ -354,95 +658,100 @@ snmp_send_msg(struct snmp_msg_trap *trap_msg, struct snmp_varbind *varbinds, u16
 static err_t
 snmp_send_trap_or_notification_or_inform_generic(struct snmp_msg_trap *trap_msg, const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap, struct snmp_varbind *varbinds)
 {
-  struct snmp_trap_dst *td = NULL;
-  u16_t i = 0;
-  u16_t tot_len = 0;
-  err_t err = ERR_OK;
-  u32_t timestamp = 0;
-  struct snmp_varbind *original_varbinds = varbinds;
-  struct snmp_varbind *original_prev = NULL;
-  struct snmp_varbind snmp_v2_special_varbinds[] = {
-                                                     /* First varbind is used to store sysUpTime */
-                                                     {
-                                                       NULL,                            /* *next */
-                                                       NULL,                            /* *prev */
-                                                       {                                /* oid */
-                                                         9,                             /* oid len */
-                                                         {1, 3, 6, 1, 2, 1, 1, 3, 0}    /* oid for sysUpTime (1.3.6.1.2.1.1.3) */
-                                                       },
-                                                       SNMP_ASN1_TYPE_TIMETICKS,        /* type */
-                                                       sizeof(u32_t),                   /* value_len */
-                                                       NULL                             /* value */
-                                                     },
-						 /* 1.3.6.1.6.3.1.1.4.1.0
-						  * Second varbind is used to store snmpTrapOID
-						  * "The authoritative identification of the notification
-						  * currently being sent. This variable occurs as
-						  * the second varbind in every SNMPv2-Trap-PDU and
-						  * InformRequest-PDU."
-						  */
-                                                     {
-                                                       NULL,                            /* *next */
-                                                       NULL,                            /* *prev */
-                                                       {                                /* oid */
-                                                         11,                            /* oid len */
-                                                         {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0} /* oid for snmpTrapOID (1.3.6.1.6.3.1.1.4.1.0) */
-                                                       },
-                                                       SNMP_ASN1_TYPE_OBJECT_ID,        /* type */
-                                                       0,                               /* value_len */
-                                                       NULL                             /* value */
-                                                     }
-   };
+  struct snmp_trap_varbinds vbs;
+  const u8_t *targets = NULL;
+#if SNMP_NOTIFY_FILTERS
+  u8_t filtered[SNMP_TARGET_SET_LEN];
+#endif
+  err_t err;
 
   LWIP_ASSERT_SNMP_LOCKED();
 
-  snmp_v2_special_varbinds[0].next = &snmp_v2_special_varbinds[1];
-  snmp_v2_special_varbinds[1].prev = &snmp_v2_special_varbinds[0];
+  memset(&vbs, 0, sizeof(vbs));
+  vbs.eoid = eoid;
+  vbs.generic_trap = generic_trap;
+  vbs.specific_trap = specific_trap;
+  vbs.varbinds = varbinds;
+#if SNMP_NOTIFY_FILTERS
+  targets = snmp_trap_varbinds_filter(&vbs, filtered);
+#endif
+  err = snmp_send_to_targets(trap_msg, targets, snmp_trap_varbinds_body, &vbs);
+  snmp_trap_varbinds_done(&vbs);
+  return err;
+}
 
-  snmp_v2_special_varbinds[0].object_value = &timestamp;
+#if SNMP_TRAP_LIMIT_RULES
+/** the count varbind of snmp_trap_limit.h, the value stays in *dropped */
+static void
+snmp_trap_count_varbind(struct snmp_varbind *count_vb, u32_t *dropped)
+{
+  memset(count_vb, 0, sizeof(*count_vb));
+  count_vb->oid = snmp_trap_limit_count_oid;
+  count_vb->type = SNMP_ASN1_TYPE_UNSIGNED32;
+  count_vb->value_len = sizeof(*dropped);
+  count_vb->object_value = dropped;
+}
 
-  snmp_v2_special_varbinds[1].next = varbinds;
+/**
+ * @ingroup snmp_traps
+ * Passes a trap through the rules of snmp_trap_limit.h and sends it if they
+ * let it through, with the number of traps they dropped before it appended
+ * as the count varbind.
+ * @return ERR_OK also when a rule dropped the trap
+ */
+static err_t
+snmp_send_trap_limited(struct snmp_msg_trap *trap_msg, const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap, struct snmp_varbind *varbinds)
+{
+  struct snmp_obj_id trap_oid;
+  struct snmp_varbind count_vb;
+  struct snmp_varbind *last = NULL;
+  u32_t dropped = 0;
+  err_t err;
+
+  if ((snmp_prepare_trap_oid(&trap_oid, eoid, generic_trap, specific_trap) == ERR_OK) &&
+      !snmp_trap_limit_check(&trap_oid, eoid, generic_trap, specific_trap, varbinds, &dropped)) {
+    return ERR_OK;
+  }
+  if (dropped == 0) {
+    return snmp_send_trap_or_notification_or_inform_generic(trap_msg, eoid, generic_trap, specific_trap, varbinds);
+  }
 
-  /* see rfc3584 */
-  if (trap_msg->snmp_version == SNMP_VERSION_2c) {
-    struct snmp_obj_id snmp_trap_oid =  { 0 };  /* used for converting SNMPv1 generic/specific trap parameter to SNMPv2 snmpTrapOID */
-    err = snmp_prepare_trap_oid(&snmp_trap_oid, eoid, generic_trap, specific_trap);
-    if (err == ERR_OK) {
-      snmp_v2_special_varbinds[1].value_len = snmp_trap_oid.len * sizeof(snmp_trap_oid.id[0]);
-      snmp_v2_special_varbinds[1].object_value = snmp_trap_oid.id;
-      if (varbinds != NULL) {
-        original_prev = varbinds->prev;
-        varbinds->prev = &snmp_v2_special_varbinds[1];
-      }
-      varbinds = snmp_v2_special_varbinds;  /* After inserting two varbinds at the beginning of the list, make sure that pointer is pointing to the first element  */
+  snmp_trap_count_varbind(&count_vb, &dropped);
+  if (varbinds != NULL) {
+    for (last = varbinds; last->next != NULL; last = last->next) {
     }
+    last->next = &count_vb;
+    count_vb.prev = last;
   }
+  err = snmp_send_trap_or_notification_or_inform_generic(trap_msg, eoid, generic_trap, specific_trap,
+                                                          (varbinds != NULL) ? varbinds : &count_vb);
+  if (last != NULL) {
+    last->next = NULL;
+  }
+  return err;
+}
 
-  for (i = 0, td = &trap_dst[0]; (i < SNMP_TRAP_DESTINATIONS) && (err == ERR_OK); i++, td++) {
-    if ((td->enable != 0) && !ip_addr_isany(&td->dip)) {
-      /* lookup current source address for this dst */
-      if (snmp_get_local_ip_for_dst(snmp_traps_handle, &td->dip, &trap_msg->sip)) {
-        snmp_prepare_necessary_msg_fields(trap_msg, eoid, generic_trap, specific_trap, varbinds);
+/**
+ * @ingroup snmp_traps
+ * Sends the number of traps a rule of snmp_trap_limit.h dropped, with the
+ * count varbind only.
+ */
+err_t
+snmp_trap_limit_send_count(const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap, u32_t dropped)
+{
+  struct snmp_msg_trap trap_msg = {0};
+  struct snmp_varbind count_vb;
 
-        /* pass 0, calculate length fields */
-        /* _HT_ The next assignment to tot_len seems reduncant: */
-        tot_len = snmp_trap_varbind_sum(trap_msg, varbinds);
-        tot_len = snmp_trap_header_sum(trap_msg, tot_len);
+  err_t err;
 
-        /* allocate pbuf, fill it and send it */
-        err = snmp_send_msg(trap_msg, varbinds, tot_len, &td->dip);
-      } else {
-        /* routing error */
-        err = ERR_RTE;
-      }
-    }
-  }
-  if ((trap_msg->snmp_version == SNMP_VERSION_2c) && (original_varbinds != NULL)) {
-    original_varbinds->prev = original_prev;
-  }
-  req_id++;
+  snmp_trap_count_varbind(&count_vb, &dropped);
+  trap_msg.trap_or_inform = SNMP_IS_TRAP;
+  SNMP_CORE_LOCK();
+  err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, eoid, generic_trap, specific_trap, &count_vb);
+  SNMP_CORE_UNLOCK();
   return err;
 }
+#endif /* SNMP_TRAP_LIMIT_RULES */
 
 /**
  * @ingroup snmp_traps
@@ -464,9 +773,16 @@ err_t
 snmp_send_trap(const struct snmp_obj_id* oid, s32_t generic_trap, s32_t specific_trap, struct snmp_varbind *varbinds)
 {
   struct snmp_msg_trap trap_msg = {0};
-  trap_msg.snmp_version = snmp_default_trap_version;
+  err_t err;
   trap_msg.trap_or_inform = SNMP_IS_TRAP;
-  return snmp_send_trap_or_notification_or_inform_generic(&trap_msg, oid, generic_trap, specific_trap, varbinds);
+  SNMP_CORE_LOCK();
+#if SNMP_TRAP_LIMIT_RULES
+  err = snmp_send_trap_limited(&trap_msg, oid, generic_trap, specific_trap, varbinds);
+#else
+  err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, oid, generic_trap, specific_trap, varbinds);
+#endif
+  SNMP_CORE_UNLOCK();
+  return err;
 }
 
 /**
@@ -478,19 +794,18 @@ snmp_send_trap(const struct snmp_obj_id* oid, s32_t generic_trap, s32_t specific
 err_t
 snmp_send_trap_generic(s32_t generic_trap)
 {
-  err_t err = ERR_OK;
+  /* the enterprise of SNMPv1 generic traps, SNMPv2c uses the snmpTraps OIDs */
+  static const struct snmp_obj_id oid = { 7, { 1, 3, 6, 1, 2, 1, 11 } };
   struct snmp_msg_trap trap_msg = {0};
-  trap_msg.snmp_version = snmp_default_trap_version;
+  err_t err;
   trap_msg.trap_or_inform = SNMP_IS_TRAP;
-
-  if(snmp_default_trap_version == SNMP_VERSION_1) {
-    static const struct snmp_obj_id oid = { 7, { 1, 3, 6, 1, 2, 1, 11 } };
-    err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, &oid, generic_trap, 0, NULL);
-  } else if (snmp_default_trap_version == SNMP_VERSION_2c) {
-    err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, NULL, generic_trap, 0, NULL);
-  } else {
-    err = ERR_VAL;
-  }
+  SNMP_CORE_LOCK();
+#if SNMP_TRAP_LIMIT_RULES
+  err = snmp_send_trap_limited(&trap_msg, &oid, generic_trap, 0, NULL);
+#else
+  err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, &oid, generic_trap, 0, NULL);
+#endif
+  SNMP_CORE_UNLOCK();
   return err;
 }
 
@@ -505,9 +820,16 @@ err_t
 snmp_send_trap_specific(s32_t specific_trap, struct snmp_varbind *varbinds)
 {
   struct snmp_msg_trap trap_msg = {0};
-  trap_msg.snmp_version = snmp_default_trap_version;
+  err_t err;
   trap_msg.trap_or_inform = SNMP_IS_TRAP;
-  return snmp_send_trap_or_notification_or_inform_generic(&trap_msg, NULL, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, specific_trap, varbinds);
+  SNMP_CORE_LOCK();
+#if SNMP_TRAP_LIMIT_RULES
+  err = snmp_send_trap_limited(&trap_msg, NULL, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, specific_trap, varbinds);
+#else
+  err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, NULL, SNMP_GENTRAP_ENTERPRISE_SPECIFIC, specific_trap, varbinds);
+#endif
+  SNMP_CORE_UNLOCK();
+  return err;
 }
 
 /**
@@ -582,18 +904,6 @@ snmp_trap_header_sum_v1_specific(struct snmp_msg_trap *trap)
   u16_t len = 0;
   u8_t lenlen = 0;
 
-  snmp_asn1_enc_u32t_cnt(trap->ts, &len);
-  snmp_asn1_enc_length_cnt(len, &lenlen);
-  tot_len += 1 + len + lenlen;
-
-  snmp_asn1_enc_s32t_cnt(trap->spc_trap, &len);
-  snmp_asn1_enc_length_cnt(len, &lenlen);
-  tot_len += 1 + len + lenlen;
-
-  snmp_asn1_enc_s32t_cnt(trap->gen_trap, &len);
-  snmp_asn1_enc_length_cnt(len, &lenlen);
-  tot_len += 1 + len + lenlen;
-
   if (IP_IS_V6_VAL(trap->sip)) {
 #if LWIP_IPV6
     len = sizeof(ip_2_ip6(&trap->sip)->addr);
@@ -615,21 +925,66 @@ snmp_trap_header_sum_v1_specific(struct snmp_msg_trap *trap)
 
 /**
  * @ingroup snmp_traps
- * Sums trap header fields that are specific for SNMP v2c
+ * Sums trap body fields that are specific for SNMP v1
  *
  * @param trap Trap message
- * @return the required length for encoding of this part of the trap header
+ * @return the required length for encoding of this part of the trap body
  */
 static u16_t
-snmp_trap_header_sum_v2c_specific(struct snmp_msg_trap *trap)
+snmp_trap_body_sum_v1_specific(struct snmp_msg_trap *trap)
 {
   u16_t tot_len = 0;
   u16_t len = 0;
   u8_t lenlen = 0;
 
-  snmp_asn1_enc_u32t_cnt(req_id, &len);
+  snmp_asn1_enc_u32t_cnt(trap->ts, &len);
+  snmp_asn1_enc_length_cnt(len, &lenlen);
+  tot_len += 1 + len + lenlen;
+
+  snmp_asn1_enc_s32t_cnt(trap->spc_trap, &len);
   snmp_asn1_enc_length_cnt(len, &lenlen);
   tot_len += 1 + len + lenlen;
+
+  snmp_asn1_enc_s32t_cnt(trap->gen_trap, &len);
+  snmp_asn1_enc_length_cnt(len, &lenlen);
+  tot_len += 1 + len + lenlen;
+
+  return tot_len;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sums trap header fields that are specific for SNMP v2c
+ *
+ * @param trap Trap message
+ * @return the required length for encoding of this part of the trap header
+ */
+static u16_t
+snmp_trap_header_sum_v2c_specific(struct snmp_msg_trap *trap)
+{
+  u16_t len = 0;
+  u8_t lenlen = 0;
+  LWIP_UNUSED_ARG(trap);
+
+  snmp_asn1_enc_u32t_cnt(req_id, &len);
+  snmp_asn1_enc_length_cnt(len, &lenlen);
+  return 1 + len + lenlen;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sums trap body fields that are specific for SNMP v2c
+ *
+ * @param trap Trap message
+ * @return the required length for encoding of this part of the trap body
+ */
+static u16_t
+snmp_trap_body_sum_v2c_specific(struct snmp_msg_trap *trap)
+{
+  u16_t tot_len = 0;
+  u16_t len = 0;
+  u8_t lenlen = 0;
+
   snmp_asn1_enc_u32t_cnt(trap->error_status, &len);
   snmp_asn1_enc_length_cnt(len, &lenlen);
   tot_len += 1 + len + lenlen;
@@ -642,17 +997,41 @@ snmp_trap_header_sum_v2c_specific(struct snmp_msg_trap *trap)
 
 /**
  * @ingroup snmp_traps
- * Sums trap header field lengths from tail to head and
- * returns trap_header_lengths for second encoding pass.
+ * Sums the trap body, the PDU fields shared by all destinations, and
+ * stores it for snmp_trap_header_sum().
  *
  * @param trap Trap message
  * @param vb_len varbind-list length
- * @return the required length for encoding the trap header
+ * @return the required length for encoding the trap body
  */
 static u16_t
-snmp_trap_header_sum(struct snmp_msg_trap *trap, u16_t vb_len)
+snmp_trap_body_sum(struct snmp_msg_trap *trap, u16_t vb_len)
 {
   u16_t tot_len = vb_len;
+
+  if (trap->snmp_version == SNMP_VERSION_1) {
+    tot_len += snmp_trap_body_sum_v1_specific(trap);
+  } else if (trap->snmp_version == SNMP_VERSION_2c) {
+    tot_len += snmp_trap_body_sum_v2c_specific(trap);
+  }
+  trap->bodylen = tot_len;
+
+  return tot_len;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sums trap header field lengths from tail to head and
+ * returns trap_header_lengths for second encoding pass.
+ * The body must have been summed by snmp_trap_body_sum().
+ *
+ * @param trap Trap message
+ * @return the required length for encoding the trap header of one destination
+ */
+static u16_t
+snmp_trap_header_sum(struct snmp_msg_trap *trap)
+{
+  u16_t tot_len = trap->bodylen;
   u16_t len = 0;
   u8_t lenlen = 0;
 
@@ -665,7 +1044,7 @@ snmp_trap_header_sum(struct snmp_msg_trap *trap, u16_t vb_len)
   snmp_asn1_enc_length_cnt(trap->pdulen, &lenlen);
   tot_len += 1 + lenlen;
 
-  trap->comlen = (u16_t)LWIP_MIN(strlen(snmp_community_trap), 0xFFFF);
+  trap->comlen = (u16_t)LWIP_MIN(strlen(trap->community), 0xFFFF);
   snmp_asn1_enc_length_cnt(trap->comlen, &lenlen);
   tot_len += 1 + lenlen + trap->comlen;
 
@@ -677,7 +1056,8 @@ snmp_trap_header_sum(struct snmp_msg_trap *trap, u16_t vb_len)
   snmp_asn1_enc_length_cnt(trap->seqlen, &lenlen);
   tot_len += 1 + lenlen;
 
-  return tot_len;
+  /* the body is not part of the header */
+  return tot_len - trap->bodylen;
 }
 
 /**
@@ -769,6 +1149,21 @@ snmp_trap_header_enc_v1_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_st
 #endif
   }
 
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Encodes trap body part that is SNMP v1 specific.
+ * @param trap Trap message
+ * @param pbuf_stream stream used for storing data inside pbuf
+ * @retval err_t ERR_OK if successful, ERR_ARG otherwise
+ */
+static err_t
+snmp_trap_body_enc_v1_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream)
+{
+  struct snmp_asn1_tlv tlv;
+
   /* generic trap */
   SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_INTEGER, 0, 0);
   snmp_asn1_enc_s32t_cnt(trap->gen_trap, &tlv.value_len);
@@ -802,12 +1197,29 @@ static err_t
 snmp_trap_header_enc_v2c_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream)
 {
   struct snmp_asn1_tlv tlv;
+  LWIP_UNUSED_ARG(trap);
   /* request id */
   SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_INTEGER, 0, 0);
   snmp_asn1_enc_s32t_cnt(req_id, &tlv.value_len);
   BUILD_EXEC( snmp_ans1_enc_tlv(pbuf_stream, &tlv) );
   BUILD_EXEC( snmp_asn1_enc_s32t(pbuf_stream, tlv.value_len, req_id) );
 
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Encodes trap body part that is SNMP v2c specific.
+ *
+ * @param trap Trap message
+ * @param pbuf_stream stream used for storing data inside pbuf
+ * @retval err_t ERR_OK if successful, ERR_ARG otherwise
+ */
+static err_t
+snmp_trap_body_enc_v2c_specific(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream)
+{
+  struct snmp_asn1_tlv tlv;
+
   /* error status */
   SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_INTEGER, 0, 0);
   snmp_asn1_enc_s32t_cnt(trap->error_status, &tlv.value_len);
@@ -849,21 +1261,43 @@ snmp_trap_header_enc(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_s
   /* community */
   SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_OCTET_STRING, 0, trap->comlen);
   BUILD_EXEC( snmp_ans1_enc_tlv(pbuf_stream, &tlv) );
-  BUILD_EXEC( snmp_asn1_enc_raw(pbuf_stream,  (const u8_t *)snmp_community_trap, trap->comlen) );
+  BUILD_EXEC( snmp_asn1_enc_raw(pbuf_stream,  (const u8_t *)trap->community, trap->comlen) );
 
   /* PDU */
   BUILD_EXEC( snmp_trap_header_enc_pdu(trap, pbuf_stream) );
   if (trap->snmp_version == SNMP_VERSION_1) {
-    /* object ID, IP addr, generic trap, specific trap, timestamp */
+    /* object ID, IP addr */
     BUILD_EXEC( snmp_trap_header_enc_v1_specific(trap, pbuf_stream) );
   } else if (SNMP_VERSION_2c == trap->snmp_version) {
-    /* request id, error status, error index */
+    /* request id */
     BUILD_EXEC( snmp_trap_header_enc_v2c_specific(trap, pbuf_stream) );
   }
 
   return ERR_OK;
 }
 
+/**
+ * @ingroup snmp_traps
+ * Encodes the PDU fields between the header and the varbinds.
+ *
+ * @param trap Trap message
+ * @param pbuf_stream stream used for storing data inside pbuf
+ * @retval err_t ERR_OK if successful, ERR_ARG otherwise
+ */
+static err_t
+snmp_trap_body_enc(struct snmp_msg_trap *trap, struct snmp_pbuf_stream *pbuf_stream)
+{
+  if (trap->snmp_version == SNMP_VERSION_1) {
+    /* generic trap, specific trap, timestamp */
+    BUILD_EXEC( snmp_trap_body_enc_v1_specific(trap, pbuf_stream) );
+  } else if (SNMP_VERSION_2c == trap->snmp_version) {
+    /* error status, error index */
+    BUILD_EXEC( snmp_trap_body_enc_v2c_specific(trap, pbuf_stream) );
+  }
+
+  return ERR_OK;
+}
+
 /**
  * @ingroup snmp_traps
  * Wrapper function for sending informs
@@ -907,9 +1341,691 @@ snmp_send_inform(const struct snmp_obj_id* oid, s32_t generic_trap, s32_t specif
 {
   struct snmp_msg_trap trap_msg = {0};
   trap_msg.snmp_version = SNMP_VERSION_2c;
+  err_t err;
+  trap_msg.trap_or_inform = SNMP_IS_INFORM;
+  SNMP_CORE_LOCK();
+  *ptr_request_id = req_id;
+  err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, oid, generic_trap, specific_trap, varbinds);
+  SNMP_CORE_UNLOCK();
+  return err;
+}
+
+#if SNMP_TRAP_TEMPLATES
+/* a varbind of a template: where its OID and value are in the body */
+struct snmp_trap_template_vb
+{
+  /* of the OID TLV */
+  u16_t oid_offset;
+  u16_t oid_len;
+  /* of the value contents */
+  u16_t value_offset;
+  u16_t value_len;
+  u8_t type;
+};
+
+struct snmp_trap_template
+{
+  u8_t used;
+  /* sysUpTime, snmpTrapOID and the varbinds of the caller */
+  u8_t vb_count;
+  /* of the varbind list */
+  u8_t list_offset;
+  const struct snmp_obj_id *eoid;
+  s32_t generic_trap;
+  s32_t specific_trap;
+  struct snmp_trap_template_vb vbs[SNMP_TRAP_TEMPLATE_VARBINDS + 2];
+#if SNMP_NOTIFY_FILTERS
+  /* the targets of the filters, as of snmp_notify_filter_generation() */
+  u8_t filter_valid;
+  u16_t filter_generation;
+  u8_t filter_targets[SNMP_TARGET_SET_LEN];
+#endif
+  /* the SNMPv2c PDU fields after the request ID */
+  u16_t body_len;
+  u8_t body[SNMP_TRAP_TEMPLATE_SIZE];
+};
+
+/* a template being sent */
+struct snmp_trap_template_send
+{
+  const struct snmp_trap_template *tpl;
+  u32_t timestamp;
+};
+
+static struct snmp_trap_template snmp_trap_templates[SNMP_TRAP_TEMPLATES];
+/* a template is laid out again in here when a value changes its length */
+static u8_t snmp_trap_template_scratch[SNMP_TRAP_TEMPLATE_SIZE];
+
+/** reads the length of the TLV at body[*pos] and moves *pos to its contents */
+static u16_t
+snmp_trap_template_tlv(const u8_t *body, u16_t *pos)
+{
+  u16_t len = body[*pos + 1];
+
+  *pos += 2;
+  if (len == 0x81) {
+    len = body[*pos];
+    *pos += 1;
+  } else if (len == 0x82) {
+    len = (u16_t)((body[*pos] << 8) | body[*pos + 1]);
+    *pos += 2;
+  }
+  return len;
+}
+
+/** writes the type and length of a TLV, returns the number of bytes */
+static u16_t
+snmp_trap_template_put_tlv(u8_t *dst, u8_t type, u16_t len)
+{
+  u8_t lenlen;
+
+  snmp_asn1_enc_length_cnt(len, &lenlen);
+  dst[0] = type;
+  if (lenlen == 1) {
+    dst[1] = (u8_t)len;
+  } else if (lenlen == 2) {
+    dst[1] = 0x81;
+    dst[2] = (u8_t)len;
+  } else {
+    dst[1] = 0x82;
+    dst[2] = (u8_t)(len >> 8);
+    dst[3] = (u8_t)len;
+  }
+  return (u16_t)(1 + lenlen);
+}
+
+/** the length of the value contents, the registered one for the types
+ * that keep their length or value */
+static u16_t
+snmp_trap_template_value_len(const struct snmp_trap_template_vb *vb, const union snmp_variant_value *value)
+{
+  u16_t len;
+
+  switch (vb->type) {
+    case SNMP_ASN1_TYPE_INTEGER:
+      snmp_asn1_enc_s32t_cnt(value->s32, &len);
+      break;
+    case SNMP_ASN1_TYPE_COUNTER:
+    case SNMP_ASN1_TYPE_GAUGE:
+    case SNMP_ASN1_TYPE_TIMETICKS:
+      snmp_asn1_enc_u32t_cnt(value->u32, &len);
+      break;
+#if LWIP_HAVE_INT64
+    case SNMP_ASN1_TYPE_COUNTER64:
+      snmp_asn1_enc_u64t_cnt(value->u64, &len);
+      break;
+#endif
+    default:
+      len = vb->value_len;
+      break;
+  }
+  return len;
+}
+
+/** writes a value over the contents of a varbind, which has its length */
+static void
+snmp_trap_template_put_value(u8_t *dst, const struct snmp_trap_template_vb *vb, const union snmp_variant_value *value)
+{
+  u16_t shift;
+  u16_t i;
+
+  switch (vb->type) {
+    case SNMP_ASN1_TYPE_INTEGER:
+    case SNMP_ASN1_TYPE_COUNTER:
+    case SNMP_ASN1_TYPE_GAUGE:
+    case SNMP_ASN1_TYPE_TIMETICKS:
+      /* big endian, the fifth octet of an u32_t is the leading zero */
+      for (i = 0; i < vb->value_len; i++) {
+        shift = (u16_t)(8 * (vb->value_len - 1 - i));
+        dst[i] = (shift < 32) ? (u8_t)(value->u32 >> shift) : 0;
+      }
+      break;
+#if LWIP_HAVE_INT64
+    case SNMP_ASN1_TYPE_COUNTER64:
+      for (i = 0; i < vb->value_len; i++) {
+        shift = (u16_t)(8 * (vb->value_len - 1 - i));
+        dst[i] = (shift < 64) ? (u8_t)(value->u64 >> shift) : 0;
+      }
+      break;
+#endif
+    case SNMP_ASN1_TYPE_OCTET_STRING:
+    case SNMP_ASN1_TYPE_IPADDR:
+    case SNMP_ASN1_TYPE_OPAQUE:
+      MEMCPY(dst, value->const_ptr, vb->value_len);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @ingroup snmp_traps
+ * Lays the body of a template out again for new value lengths. The values
+ * that keep their length are kept, the others are left to be written.
+ * @return ERR_OK, or ERR_MEM when the body gets larger than
+ *         SNMP_TRAP_TEMPLATE_SIZE
+ */
+static err_t
+snmp_trap_template_layout(struct snmp_trap_template *tpl, const u16_t *value_lens)
+{
+  u8_t *out = snmp_trap_template_scratch;
+  struct snmp_trap_template_vb *vb;
+  u16_t vb_lens[SNMP_TRAP_TEMPLATE_VARBINDS + 2];
+  u16_t list_len = 0;
+  u16_t pos;
+  u8_t lenlen;
+  u8_t i;
+
+  for (i = 0; i < tpl->vb_count; i++) {
+    snmp_asn1_enc_length_cnt(value_lens[i], &lenlen);
+    vb_lens[i] = (u16_t)(tpl->vbs[i].oid_len + 1 + lenlen + value_lens[i]);
+    snmp_asn1_enc_length_cnt(vb_lens[i], &lenlen);
+    list_len += 1 + lenlen + vb_lens[i];
+  }
+  snmp_asn1_enc_length_cnt(list_len, &lenlen);
+  if ((u32_t)tpl->list_offset + 1 + lenlen + list_len > SNMP_TRAP_TEMPLATE_SIZE) {
+    return ERR_MEM;
+  }
+
+  /* error status and index */
+  MEMCPY(out, tpl->body, tpl->list_offset);
+  pos = tpl->list_offset;
+  pos += snmp_trap_template_put_tlv(&out[pos], SNMP_ASN1_TYPE_SEQUENCE, list_len);
+  for (i = 0, vb = tpl->vbs; i < tpl->vb_count; i++, vb++) {
+    pos += snmp_trap_template_put_tlv(&out[pos], SNMP_ASN1_TYPE_SEQUENCE, vb_lens[i]);
+    MEMCPY(&out[pos], &tpl->body[vb->oid_offset], vb->oid_len);
+    vb->oid_offset = pos;
+    pos += vb->oid_len;
+    pos += snmp_trap_template_put_tlv(&out[pos], vb->type, value_lens[i]);
+    if (value_lens[i] == vb->value_len) {
+      MEMCPY(&out[pos], &tpl->body[vb->value_offset], vb->value_len);
+    }
+    vb->value_offset = pos;
+    vb->value_len = value_lens[i];
+    pos += vb->value_len;
+  }
+  MEMCPY(tpl->body, out, pos);
+  tpl->body_len = pos;
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Copies the body of a template for a version, see snmp_send_to_targets().
+ * @param msg the message of the version
+ * @param body [out] the encoded fields, to be freed by the caller
+ * @param arg the struct snmp_trap_template_send of the notification
+ * @return ERR_OK if successful
+ */
+static err_t
+snmp_trap_template_body(struct snmp_msg_trap *msg, struct pbuf **body, void *arg)
+{
+  const struct snmp_trap_template_send *send = (const struct snmp_trap_template_send *)arg;
+  const struct snmp_trap_template *tpl = send->tpl;
+  struct snmp_pbuf_stream pbuf_stream;
+  struct snmp_asn1_tlv tlv;
+  struct pbuf *p;
+  u16_t vbs_offset;
+  u16_t tot_len;
+  u8_t lenlen;
+
+  if (msg->snmp_version == SNMP_VERSION_2c) {
+    p = pbuf_alloc(PBUF_TRANSPORT, tpl->body_len, PBUF_RAM);
+    if (p == NULL) {
+      return ERR_MEM;
+    }
+    if (pbuf_take_at(p, tpl->body, tpl->body_len, 0) != ERR_OK) {
+      pbuf_free(p);
+      return ERR_MEM;
+    }
+    msg->bodylen = tpl->body_len;
+    *body = p;
+    return ERR_OK;
+  }
+
+  /* SNMPv1: the varbinds of the caller, behind the SNMPv1 fields */
+  msg->enterprise = (tpl->eoid == NULL) ? snmp_get_device_enterprise_oid() : tpl->eoid;
+  msg->gen_trap = tpl->generic_trap;
+  msg->spc_trap = (tpl->generic_trap == SNMP_GENTRAP_ENTERPRISE_SPECIFIC) ? tpl->specific_trap : 0;
+  msg->ts = send->timestamp;
+  vbs_offset = tpl->vbs[1].value_offset + tpl->vbs[1].value_len;
+  msg->vbseqlen = tpl->body_len - vbs_offset;
+  snmp_asn1_enc_length_cnt(msg->vbseqlen, &lenlen);
+  tot_len = snmp_trap_body_sum(msg, (u16_t)(1 + lenlen + msg->vbseqlen));
+
+  p = pbuf_alloc(PBUF_TRANSPORT, tot_len, PBUF_RAM);
+  if (p == NULL) {
+    return ERR_MEM;
+  }
+  snmp_pbuf_stream_init(&pbuf_stream, p, 0, tot_len);
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, SNMP_ASN1_TYPE_SEQUENCE, 0, msg->vbseqlen);
+  if ((snmp_trap_body_enc(msg, &pbuf_stream) != ERR_OK) ||
+      (snmp_ans1_enc_tlv(&pbuf_stream, &tlv) != ERR_OK) ||
+      ((msg->vbseqlen > 0) && (snmp_asn1_enc_raw(&pbuf_stream, &tpl->body[vbs_offset], msg->vbseqlen) != ERR_OK))) {
+    pbuf_free(p);
+    return ERR_ARG;
+  }
+  *body = p;
+  return ERR_OK;
+}
+
+/** snmp_trap_template_register() with the SNMP core locked */
+static err_t
+snmp_trap_template_add(const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap,
+                       struct snmp_varbind *varbinds, u8_t *id)
+{
+  struct snmp_trap_template *tpl = NULL;
+  struct snmp_trap_varbinds vbs;
+  struct snmp_msg_trap msg;
+  struct snmp_trap_template_vb *vb;
+  struct snmp_varbind *varbind;
+  struct pbuf *body = NULL;
+  u16_t pos;
+  u16_t len;
+  u8_t count = 0;
+  u8_t i;
+  err_t err;
+
+  LWIP_ASSERT_SNMP_LOCKED();
+
+  for (varbind = varbinds; varbind != NULL; varbind = varbind->next) {
+    if ((++count > SNMP_TRAP_TEMPLATE_VARBINDS) || (varbind->value_len & SNMP_GET_VALUE_RAW_DATA)) {
+      return ERR_ARG;
+    }
+    switch (varbind->type) {
+      case SNMP_ASN1_TYPE_INTEGER:
+      case SNMP_ASN1_TYPE_COUNTER:
+      case SNMP_ASN1_TYPE_GAUGE:
+      case SNMP_ASN1_TYPE_TIMETICKS:
+#if LWIP_HAVE_INT64
+      case SNMP_ASN1_TYPE_COUNTER64:
+#endif
+      case SNMP_ASN1_TYPE_OCTET_STRING:
+      case SNMP_ASN1_TYPE_IPADDR:
+      case SNMP_ASN1_TYPE_OPAQUE:
+      case SNMP_ASN1_TYPE_OBJECT_ID:
+      case SNMP_ASN1_TYPE_NULL:
+        break;
+      default:
+        return ERR_ARG;
+    }
+  }
+  for (i = 0; i < SNMP_TRAP_TEMPLATES; i++) {
+    if (!snmp_trap_templates[i].used) {
+      tpl = &snmp_trap_templates[i];
+      break;
+    }
+  }
+  if (tpl == NULL) {
+    return ERR_MEM;
+  }
+
+  /* the body of snmp_send_trap() to a SNMPv2c destination */
+  memset(&vbs, 0, sizeof(vbs));
+  vbs.eoid = eoid;
+  vbs.generic_trap = generic_trap;
+  vbs.specific_trap = specific_trap;
+  vbs.varbinds = varbinds;
+  memset(&msg, 0, sizeof(msg));
+  msg.snmp_version = SNMP_VERSION_2c;
+  err = snmp_trap_varbinds_body(&msg, &body, &vbs);
+  snmp_trap_varbinds_done(&vbs);
+  if (err != ERR_OK) {
+    return err;
+  }
+  if (body->tot_len > sizeof(tpl->body)) {
+    pbuf_free(body);
+    return ERR_MEM;
+  }
+  tpl->body_len = pbuf_copy_partial(body, tpl->body, body->tot_len, 0);
+  pbuf_free(body);
+
+  /* skip error status and index, then find the OIDs and values */
+  pos = 0;
+  len = snmp_trap_template_tlv(tpl->body, &pos);
+  pos += len;
+  len = snmp_trap_template_tlv(tpl->body, &pos);
+  pos += len;
+  tpl->list_offset = (u8_t)pos;
+  (void)snmp_trap_template_tlv(tpl->body, &pos);
+  tpl->vb_count = count + 2;
+  for (i = 0, vb = tpl->vbs; i < tpl->vb_count; i++, vb++) {
+    (void)snmp_trap_template_tlv(tpl->body, &pos);
+    vb->oid_offset = pos;
+    len = snmp_trap_template_tlv(tpl->body, &pos);
+    pos += len;
+    vb->oid_len = pos - vb->oid_offset;
+    vb->type = tpl->body[pos];
+    vb->value_len = snmp_trap_template_tlv(tpl->body, &pos);
+    vb->value_offset = pos;
+    pos += vb->value_len;
+  }
+
+  tpl->eoid = eoid;
+  tpl->generic_trap = generic_trap;
+  tpl->specific_trap = specific_trap;
+#if SNMP_NOTIFY_FILTERS
+  tpl->filter_valid = 0;
+#endif
+  tpl->used = 1;
+  *id = (u8_t)(tpl - snmp_trap_templates);
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Registers a notification whose OIDs are encoded once, see
+ * snmp_trap_template.h.
+ * @param eoid points to enterprise object identifier, kept while registered
+ * @param generic_trap is the trap code
+ * @param specific_trap used for enterprise traps when generic_trap == 6
+ * @param varbinds linked list of varbinds, with the values sent first
+ * @param id [out] the template
+ * @return ERR_OK if successful
+ */
+err_t
+snmp_trap_template_register(const struct snmp_obj_id *eoid, s32_t generic_trap, s32_t specific_trap,
+                            struct snmp_varbind *varbinds, u8_t *id)
+{
+  err_t err;
+
+  SNMP_CORE_LOCK();
+  err = snmp_trap_template_add(eoid, generic_trap, specific_trap, varbinds, id);
+  SNMP_CORE_UNLOCK();
+  return err;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Frees a template of snmp_trap_template_register().
+ */
+void
+snmp_trap_template_remove(u8_t id)
+{
+  SNMP_CORE_LOCK();
+  if (id < SNMP_TRAP_TEMPLATES) {
+    snmp_trap_templates[id].used = 0;
+  }
+  SNMP_CORE_UNLOCK();
+}
+
+#if SNMP_NOTIFY_FILTERS
+/**
+ * @ingroup snmp_traps
+ * Checks the OIDs of a template against the filter profiles of the targets,
+ * once per change of the filters: they are decoded from the body.
+ * @param tpl the template
+ * @param targets [out] a bit per target the template passes, NULL when no
+ *        target has a profile
+ * @return ERR_OK, or ERR_MEM
+ */
+static err_t
+snmp_trap_template_filter(struct snmp_trap_template *tpl, const u8_t **targets)
+{
+  struct snmp_notify_filter_eval eval;
+  struct snmp_pbuf_stream pbuf_stream;
+  struct pbuf *p;
+  u32_t oid[SNMP_MAX_OBJ_ID_LEN];
+  u16_t pos;
+  u16_t len;
+  u8_t oid_len;
+  u8_t i;
+
+  *targets = NULL;
+  if (!snmp_notify_filter_active()) {
+    return ERR_OK;
+  }
+  *targets = tpl->filter_targets;
+  if (tpl->filter_valid && (tpl->filter_generation == snmp_notify_filter_generation())) {
+    return ERR_OK;
+  }
+  p = pbuf_alloc_reference(tpl->body, tpl->body_len, PBUF_REF);
+  if (p == NULL) {
+    return ERR_MEM;
+  }
+  snmp_notify_filter_begin(&eval);
+  /* the value of snmpTrapOID, then the OIDs of the varbinds of the caller */
+  for (i = 1; i < tpl->vb_count; i++) {
+    if (i == 1) {
+      pos = tpl->vbs[i].value_offset;
+      len = tpl->vbs[i].value_len;
+    } else {
+      pos = tpl->vbs[i].oid_offset;
+      len = snmp_trap_template_tlv(tpl->body, &pos);
+    }
+    if ((snmp_pbuf_stream_init(&pbuf_stream, p, pos, len) == ERR_OK) &&
+        (snmp_asn1_dec_oid(&pbuf_stream, len, oid, &oid_len, LWIP_ARRAYSIZE(oid)) == ERR_OK)) {
+      snmp_notify_filter_oid(&eval, oid, oid_len);
+    }
+  }
+  pbuf_free(p);
+  snmp_notify_filter_targets(&eval, tpl->filter_targets);
+  tpl->filter_generation = snmp_notify_filter_generation();
+  tpl->filter_valid = 1;
+  return ERR_OK;
+}
+#endif /* SNMP_NOTIFY_FILTERS */
+
+/**
+ * @ingroup snmp_traps
+ * Writes sysUpTime and the values into a template and sends it.
+ * @param trap_msg defines msg type
+ * @param id the template
+ * @param values one per registered varbind, NULL keeps the previous ones
+ * @return ERR_OK when success
+ */
+static err_t
+snmp_send_template_generic(struct snmp_msg_trap *trap_msg, u8_t id, const union snmp_variant_value *values)
+{
+  struct snmp_trap_template *tpl;
+  struct snmp_trap_template_send send;
+  const union snmp_variant_value *value;
+  const u8_t *targets = NULL;
+  union snmp_variant_value uptime;
+  u16_t value_lens[SNMP_TRAP_TEMPLATE_VARBINDS + 2];
+  u8_t relayout = 0;
+  u8_t i;
+  err_t err;
+
+  LWIP_ASSERT_SNMP_LOCKED();
+
+  if ((id >= SNMP_TRAP_TEMPLATES) || !snmp_trap_templates[id].used) {
+    return ERR_ARG;
+  }
+  tpl = &snmp_trap_templates[id];
+  MIB2_COPY_SYSUPTIME_TO(&send.timestamp);
+  uptime.u32 = send.timestamp;
+
+  /* the values stay where they are, unless one changes its length */
+  for (i = 0; i < tpl->vb_count; i++) {
+    value_lens[i] = tpl->vbs[i].value_len;
+    if (i == 0) {
+      value_lens[i] = snmp_trap_template_value_len(&tpl->vbs[i], &uptime);
+    } else if ((i > 1) && (values != NULL)) {
+      value_lens[i] = snmp_trap_template_value_len(&tpl->vbs[i], &values[i - 2]);
+    }
+    if (value_lens[i] != tpl->vbs[i].value_len) {
+      relayout = 1;
+    }
+  }
+  if (relayout) {
+    err = snmp_trap_template_layout(tpl, value_lens);
+    if (err != ERR_OK) {
+      return err;
+    }
+  }
+  for (i = 0; i < tpl->vb_count; i++) {
+    if (i == 0) {
+      value = &uptime;
+    } else if ((i > 1) && (values != NULL)) {
+      value = &values[i - 2];
+    } else {
+      continue;
+    }
+    snmp_trap_template_put_value(&tpl->body[tpl->vbs[i].value_offset], &tpl->vbs[i], value);
+  }
+
+  send.tpl = tpl;
+#if SNMP_NOTIFY_FILTERS
+  err = snmp_trap_template_filter(tpl, &targets);
+  if (err != ERR_OK) {
+    return err;
+  }
+#endif
+  return snmp_send_to_targets(trap_msg, targets, snmp_trap_template_body, &send);
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sends a template as a trap, or as an INFORM to the targets of type
+ * SNMP_TARGET_INFORM.
+ * @param id the template
+ * @param values one per registered varbind, NULL sends the previous ones
+ * @return ERR_OK when success
+ */
+err_t
+snmp_send_trap_template(u8_t id, const union snmp_variant_value *values)
+{
+  struct snmp_msg_trap trap_msg = {0};
+  err_t err;
+  trap_msg.trap_or_inform = SNMP_IS_TRAP;
+  SNMP_CORE_LOCK();
+  err = snmp_send_template_generic(&trap_msg, id, values);
+  SNMP_CORE_UNLOCK();
+  return err;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sends a template as an INFORM.
+ * @param id the template
+ * @param values one per registered varbind, NULL sends the previous ones
+ * @param ptr_request_id [out] variable in which to store request_id needed to verify acknowledgement
+ * @return ERR_OK when success
+ */
+err_t
+snmp_send_inform_template(u8_t id, const union snmp_variant_value *values, s32_t *ptr_request_id)
+{
+  struct snmp_msg_trap trap_msg = {0};
+  trap_msg.snmp_version = SNMP_VERSION_2c;
+  err_t err;
   trap_msg.trap_or_inform = SNMP_IS_INFORM;
+  SNMP_CORE_LOCK();
   *ptr_request_id = req_id;
-  return snmp_send_trap_or_notification_or_inform_generic(&trap_msg, oid, generic_trap, specific_trap, varbinds);
+  err = snmp_send_template_generic(&trap_msg, id, values);
+  SNMP_CORE_UNLOCK();
+  return err;
+}
+#endif /* SNMP_TRAP_TEMPLATES */
+
+/**
+ * @ingroup snmp_traps
+ * A notification with no varbinds, no template, as a trap to all targets.
+ */
+void
+snmp_notification_init(struct snmp_notification *notification)
+{
+  memset(notification, 0, sizeof(*notification));
+  notification->template_id = SNMP_NOTIFICATION_NO_TEMPLATE;
+  notification->type = SNMP_TARGET_TRAP;
+  notification->version = SNMP_TARGET_VERSION_DEFAULT;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Sends a notification, see snmp_notification.h.
+ * @param notification what to send and to which targets
+ * @param request_id [out] the request ID of its INFORMs, may be NULL
+ * @return ERR_OK when success
+ */
+err_t
+snmp_send_notification(const struct snmp_notification *notification, s32_t *request_id)
+{
+  struct snmp_msg_trap trap_msg = {0};
+  u8_t selected[SNMP_TARGET_SET_LEN];
+  s32_t id;
+  u8_t version;
+  u8_t i;
+  err_t err;
+
+  SNMP_CORE_LOCK();
+  id = req_id;
+
+  trap_msg.targets = notification->targets;
+  if (notification->version != SNMP_TARGET_VERSION_DEFAULT) {
+    memset(selected, 0, sizeof(selected));
+    for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+      if ((notification->targets != NULL) && !SNMP_TARGET_SET_HAS(notification->targets, i)) {
+        continue;
+      }
+      version = snmp_targets[i].version;
+      if (version == SNMP_TARGET_VERSION_DEFAULT) {
+        version = snmp_default_trap_version;
+      }
+      if (version == notification->version) {
+        SNMP_TARGET_SET_ADD(selected, i);
+      }
+    }
+    trap_msg.targets = selected;
+  }
+
+  if (notification->type == SNMP_TARGET_INFORM) {
+    trap_msg.snmp_version = SNMP_VERSION_2c;
+    trap_msg.trap_or_inform = SNMP_IS_INFORM;
+  } else {
+    trap_msg.trap_or_inform = SNMP_IS_TRAP;
+  }
+#if SNMP_INFORM_PENDING
+  /* tracked with each INFORM, before an answer can come in */
+  trap_msg.done = notification->done;
+  trap_msg.done_arg = notification->done_arg;
+#endif
+
+  if (notification->template_id != SNMP_NOTIFICATION_NO_TEMPLATE) {
+#if SNMP_TRAP_TEMPLATES
+    err = snmp_send_template_generic(&trap_msg, notification->template_id, notification->values);
+#else
+    err = ERR_ARG;
+#endif
+  } else {
+#if SNMP_TRAP_LIMIT_RULES
+    if (trap_msg.trap_or_inform == SNMP_IS_TRAP) {
+      err = snmp_send_trap_limited(&trap_msg, notification->eoid, notification->generic_trap,
+                                   notification->specific_trap, notification->varbinds);
+    } else
+#endif
+    {
+      err = snmp_send_trap_or_notification_or_inform_generic(&trap_msg, notification->eoid, notification->generic_trap,
+                                                              notification->specific_trap, notification->varbinds);
+    }
+  }
+
+  SNMP_CORE_UNLOCK();
+  if (request_id != NULL) {
+    *request_id = id;
+  }
+  return err;
+}
+
+/**
+ * @ingroup snmp_traps
+ * Links count varbinds of an array into a list, for the varbinds of
+ * snmp_send_notification() and the other calls that take a list.
+ * @return the first varbind, NULL when count is 0
+ */
+struct snmp_varbind *
+snmp_varbind_list_link(struct snmp_varbind *varbinds, u16_t count)
+{
+  u16_t i;
+
+  if (count == 0) {
+    return NULL;
+  }
+  for (i = 0; i < count; i++) {
+    varbinds[i].prev = (i > 0) ? &varbinds[i - 1] : NULL;
+    varbinds[i].next = (i + 1 < count) ? &varbinds[i + 1] : NULL;
+  }
+  return varbinds;
 }
 
 #endif /* LWIP_SNMP */
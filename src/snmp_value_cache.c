@@ -0,0 +1,270 @@
+/**
+ * @file
+ * SNMP cache of pre-encoded scalar values.
+ *
+ * Objects like sysDescr, sysObjectID or the identity scalars of an
+ * enterprise MIB never or rarely change, yet every poll fetches them with
+ * get_value(), counts their length and BER encodes them again.
+ *
+ * An application registers such an instance OID as
+ * - static: snmp_value_cache_register(oid, len, NULL), the value is cached
+ *   until it is invalidated explicitly, or as
+ * - versioned: snmp_value_cache_register(oid, len, &version), the value is
+ *   fetched again whenever the application changed 'version'.
+ *
+ * The first request after registration or invalidation takes the normal
+ * path and stores the encoded value (type, length and contents) in the
+ * slot. Later requests copy those bytes into the response as they are.
+ * The setters in snmp_mib2_system.c invalidate their objects.
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && SNMP_VALUE_CACHE_ENTRIES /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/apps/snmp_value_cache.h"
+#include "lwip/apps/snmp_core.h"
+#include "snmp_core_priv.h"
+#include "snmp_msg.h"
+#include "snmp_pbuf_stream.h"
+#include "lwip/pbuf.h"
+#include <string.h>
+
+#define SNMP_VALUE_CACHE_UNUSED  0 /* slot is free */
+#define SNMP_VALUE_CACHE_STALE   1 /* registered, value must be fetched again */
+#define SNMP_VALUE_CACHE_VALID   2 /* 'enc' holds the current value */
+
+struct snmp_value_cache_entry {
+  u32_t oid[SNMP_VALUE_CACHE_MAX_OID_LEN];
+  u8_t  oid_len;
+  u8_t  state;
+  u16_t enc_len;
+  /* version counter of a versioned entry, NULL for static entries */
+  const u32_t *version;
+  /* version the cached value belongs to */
+  u32_t cached_version;
+  u8_t  enc[SNMP_VALUE_CACHE_VALUE_SIZE];
+};
+
+static struct snmp_value_cache_entry snmp_value_cache[SNMP_VALUE_CACHE_ENTRIES];
+static struct snmp_value_cache_stats snmp_value_cache_counters;
+
+static s16_t
+snmp_value_cache_index(const u32_t *oid, u8_t oid_len)
+{
+  s16_t i;
+
+  for (i = 0; i < SNMP_VALUE_CACHE_ENTRIES; i++) {
+    const struct snmp_value_cache_entry *entry = &snmp_value_cache[i];
+    if ((entry->state != SNMP_VALUE_CACHE_UNUSED) &&
+        (snmp_oid_equal(entry->oid, entry->oid_len, oid, oid_len))) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * @ingroup snmp_core
+ * Registers an object instance (e.g. 1.3.6.1.2.1.1.1.0 for sysDescr) whose
+ * encoded value shall be cached.
+ * @param oid full instance OID
+ * @param oid_len number of sub-identifiers, at most SNMP_VALUE_CACHE_MAX_OID_LEN
+ * @param version NULL for a static value, otherwise a counter which the
+ *        application changes whenever the value changes
+ * @return ERR_MEM if all slots are in use, ERR_ARG if the OID is too long
+ */
+err_t
+snmp_value_cache_register(const u32_t *oid, u8_t oid_len, const u32_t *version)
+{
+  s16_t i = snmp_value_cache_index(oid, oid_len);
+
+  LWIP_ASSERT_SNMP_LOCKED();
+
+  if ((oid_len == 0) || (oid_len > SNMP_VALUE_CACHE_MAX_OID_LEN)) {
+    return ERR_ARG;
+  }
+
+  if (i < 0) {
+    for (i = 0; i < SNMP_VALUE_CACHE_ENTRIES; i++) {
+      if (snmp_value_cache[i].state == SNMP_VALUE_CACHE_UNUSED) {
+        break;
+      }
+    }
+    if (i == SNMP_VALUE_CACHE_ENTRIES) {
+      return ERR_MEM;
+    }
+    MEMCPY(snmp_value_cache[i].oid, oid, oid_len * sizeof(u32_t));
+    snmp_value_cache[i].oid_len = oid_len;
+  }
+
+  snmp_value_cache[i].version = version;
+  snmp_value_cache[i].state   = SNMP_VALUE_CACHE_STALE;
+
+  return ERR_OK;
+}
+
+/**
+ * @ingroup snmp_core
+ * Stops caching an object instance.
+ */
+void
+snmp_value_cache_unregister(const u32_t *oid, u8_t oid_len)
+{
+  s16_t i = snmp_value_cache_index(oid, oid_len);
+
+  LWIP_ASSERT_SNMP_LOCKED();
+
+  if (i >= 0) {
+    snmp_value_cache[i].state = SNMP_VALUE_CACHE_UNUSED;
+  }
+}
+
+/**
+ * @ingroup snmp_core
+ * Drops the cached values of all registered instances below 'oid_prefix',
+ * they are fetched again on the next request.
+ */
+void
+snmp_value_cache_invalidate(const u32_t *oid_prefix, u8_t prefix_len)
+{
+  s16_t i;
+
+  for (i = 0; i < SNMP_VALUE_CACHE_ENTRIES; i++) {
+    struct snmp_value_cache_entry *entry = &snmp_value_cache[i];
+    if ((entry->state == SNMP_VALUE_CACHE_VALID) && (entry->oid_len >= prefix_len) &&
+        (snmp_oid_equal(entry->oid, prefix_len, oid_prefix, prefix_len))) {
+      entry->state = SNMP_VALUE_CACHE_STALE;
+    }
+  }
+}
+
+/**
+ * @ingroup snmp_core
+ * Drops all cached values.
+ */
+void
+snmp_value_cache_invalidate_all(void)
+{
+  s16_t i;
+
+  for (i = 0; i < SNMP_VALUE_CACHE_ENTRIES; i++) {
+    if (snmp_value_cache[i].state == SNMP_VALUE_CACHE_VALID) {
+      snmp_value_cache[i].state = SNMP_VALUE_CACHE_STALE;
+    }
+  }
+}
+
+void
+snmp_value_cache_get_stats(struct snmp_value_cache_stats *stats)
+{
+  *stats = snmp_value_cache_counters;
+}
+
+/**
+ * Returns the slot of a registered instance OID, or -1. Remembers the
+ * current version of a versioned entry, so a change while the value is
+ * being fetched is not lost.
+ */
+s16_t
+snmp_value_cache_find(const struct snmp_obj_id *oid)
+{
+  s16_t i = snmp_value_cache_index(oid->id, oid->len);
+
+  if ((i >= 0) && (snmp_value_cache[i].state != SNMP_VALUE_CACHE_VALID)) {
+    snmp_value_cache[i].cached_version = (snmp_value_cache[i].version != NULL) ? *snmp_value_cache[i].version : 0;
+  }
+
+  return i;
+}
+
+/**
+ * Returns the encoded value of slot 'slot', or NULL if it must be fetched again.
+ */
+const u8_t *
+snmp_value_cache_get(s16_t slot, u16_t *enc_len)
+{
+  struct snmp_value_cache_entry *entry = &snmp_value_cache[slot];
+
+  if ((entry->state == SNMP_VALUE_CACHE_VALID) &&
+      ((entry->version == NULL) || (*entry->version == entry->cached_version))) {
+    snmp_value_cache_counters.hits++;
+    *enc_len = entry->enc_len;
+    return entry->enc;
+  }
+
+  if (entry->state == SNMP_VALUE_CACHE_VALID) {
+    /* the application bumped the version */
+    entry->state = SNMP_VALUE_CACHE_STALE;
+    entry->cached_version = *entry->version;
+  }
+  snmp_value_cache_counters.misses++;
+
+  return NULL;
+}
+
+/**
+ * Encodes the value of 'varbind' into slot 'slot'.
+ */
+void
+snmp_value_cache_store(s16_t slot, struct snmp_varbind *varbind)
+{
+  struct snmp_value_cache_entry *entry = &snmp_value_cache[slot];
+  struct snmp_varbind_len len;
+  struct snmp_pbuf_stream stream;
+  struct pbuf *p;
+  u16_t enc_len;
+
+  if ((entry->state != SNMP_VALUE_CACHE_STALE) || (snmp_varbind_length(varbind, &len) != ERR_OK)) {
+    return;
+  }
+
+  enc_len = 1 + len.value_len_len + len.value_value_len;
+  if (enc_len > sizeof(entry->enc)) {
+    snmp_value_cache_counters.oversized++;
+    return;
+  }
+
+  /* let the regular encoder write into the slot */
+  p = pbuf_alloc_reference(entry->enc, enc_len, PBUF_REF);
+  if (p == NULL) {
+    return;
+  }
+  snmp_pbuf_stream_init(&stream, p, 0, enc_len);
+  if (snmp_encode_varbind_value(&stream, varbind, &len) == ERR_OK) {
+    entry->enc_len = enc_len;
+    entry->state   = SNMP_VALUE_CACHE_VALID;
+  }
+  pbuf_free(p);
+}
+
+#endif /* LWIP_SNMP && SNMP_VALUE_CACHE_ENTRIES */
@@ -74,6 +74,9 @@
 
 	#define MAX_BUF_LEN 96 // When we have enough RAM, increase to 484
 
+	/* The longest pbuf chain snmp_sendto() sends, a trap is two pbufs. */
+	#define SNMP_SENDTO_MAX_SEGMENTS 4
+
 	typedef struct {
 		char buf[MAX_BUF_LEN];
 		ssize_t len;
@@ -83,6 +86,9 @@
 
 	static SRecvPacket recvPackets[2];
 
+	/* The SNMP core lock, a mutex so that the holder may take it again. */
+	static K_MUTEX_DEFINE( snmp_core_mutex );
+
 	const ip_addr_t ip_addr_any;
 
 /** udp_pcbs export for external reference (e.g. SNMP agent) */
@@ -161,6 +167,16 @@
 		return socket_fd;
 	}
 
+	void snmp_core_lock( void )
+	{
+		k_mutex_lock( &snmp_core_mutex, K_FOREVER );
+	}
+
+	void snmp_core_unlock( void )
+	{
+		k_mutex_unlock( &snmp_core_mutex );
+	}
+
 	void snmp_prepare_trap_test(const char * ip_address)
 	{
 		/** Initiate a trap for testing. */
@@ -229,7 +245,9 @@
 				zephyr_log( "recv[%u]: %d bytes from %s:%u\n",
 				 	port, len, inet_ntoa(sin->sin_addr), ntohs(sin->sin_port));
 
+				snmp_core_lock();
 				handle_snmp_packet(packet_id);
+				snmp_core_unlock();
 
 				recvPackets[packet_id].len = 0;
 			} /* if (recvPackets[0].len > 0) */
@@ -334,25 +352,50 @@ NET_SOCKET_SERVICE_SYNC_DEFINE_STATIC(service_udp, udp_service_handler, MAX_SERV
 	}
 
 	/* send a UDP packet to the LAN using a network-endian
-	 * port number and IP-address. */
+	 * port number and IP-address. A pbuf chain, e.g. a trap header
+	 * in front of a body shared by all destinations, is sent as one
+	 * datagram without copying it. Returns a positive value on success. */
 	err_t snmp_sendto( void * handle,
 					   struct pbuf * p,
 					   const ip_addr_t * dst,
 					   u16_t port )
 	{
-		int rc; /* Store the result of sendto(). */
+		int rc; /* Store the result of sendmsg(). */
 		struct sockaddr client_addr;
 		struct sockaddr_in * client_addr_in = (struct sockaddr_in *) &client_addr;
-		socklen_t client_addr_len = sizeof(client_addr);
+		struct iovec iov[ SNMP_SENDTO_MAX_SEGMENTS ];
+		struct msghdr msg;
+		const struct pbuf * q;
+		size_t count = 0;
 
+		for( q = p; ( q != NULL ) && ( count < ARRAY_SIZE( iov ) ); q = q->next )
+		{
+			iov[ count ].iov_base = q->payload;
+			iov[ count ].iov_len = q->len;
+			count++;
+		}
+		if( q != NULL )
+		{
+			zephyr_log( "snmp_sendto: more than %d pbufs\n", SNMP_SENDTO_MAX_SEGMENTS );
+			return 0;
+		}
+
+		memset( &client_addr, 0, sizeof( client_addr ) );
 		client_addr_in->sin_addr.s_addr = dst->addr;
 		client_addr_in->sin_port = port;
 		client_addr_in->sin_family = AF_INET;
 		// snmp_sendto: hnd = 8 port = 162, IP=C0A80213, len = 65
 
-		rc = zsock_sendto ((int) handle, p->payload, p->len, 0, &client_addr, client_addr_len);
+		memset( &msg, 0, sizeof( msg ) );
+		msg.msg_name = &client_addr;
+		msg.msg_namelen = sizeof( client_addr );
+		msg.msg_iov = iov;
+		msg.msg_iovlen = count;
+
+		rc = zsock_sendmsg( (int) handle, &msg, 0 );
 
-		return rc;
+		/* err_t is too small for the number of bytes sent */
+		return ( err_t ) ( rc > 0 );
 	}
 
 	u8_t snmp_get_local_ip_for_dst( void * handle,
@@ -370,42 +413,6 @@ NET_SOCKET_SERVICE_SYNC_DEFINE_STATIC(service_udp, udp_service_handler, MAX_SERV
 		return 1;
 	}
 
-	/* As part of the zephyr "port", we must define some
-	 * memory allocation. */
-	void * mem_malloc( mem_size_t size )
-	{
-		return k_malloc( size );
-	}
-
-	void mem_free( void * rmem )
-	{
-		k_free( rmem );
-	}
-
-	void * mem_trim( void * rmem,
-					 mem_size_t newsize )
-	{
-		( void ) rmem;
-		( void ) newsize;
-		return rmem;
-	}
-
-	void * memp_malloc( memp_t type )
-	{
-		(void)type;
-		__ASSERT( false, "memp_malloc() should not be called" );
-		return NULL;
-	}
-
-	void memp_free( memp_t type,
-					void * mem )
-	{
-		( void ) type;
-		( void ) type;
-		( void ) mem;
-		__ASSERT( false, "memp_free() should not be called" );
-	}
-
 	u32_t sys_now( void )
 	{
 		return k_uptime_get();
@@ -0,0 +1,462 @@
+/**
+ * @file
+ * SNMP zephyr frontend: static memory pools.
+ *
+ * The lwIP parts of this library need mem_malloc() for PBUF_RAM buffers
+ * and memp_malloc() for pbuf headers (PBUF_REF/PBUF_ROM) and PBUF_POOL
+ * buffers. Instead of using the Zephyr system heap, all memory is taken
+ * from static pools:
+ *
+ * - MEMP_PBUF and MEMP_PBUF_POOL are served by a k_mem_slab each, sized
+ *   by MEMP_NUM_PBUF and PBUF_POOL_SIZE.
+ * - mem_malloc() is served by a binary buddy heap of MEM_SIZE bytes with
+ *   power-of-two size classes from MEM_MIN_BLOCK_SIZE up to
+ *   MEM_MAX_BLOCK_SIZE. Allocation, free and trim take a bounded number
+ *   of steps (at most MEM_ORDERS), and mem_trim() returns the unused tail
+ *   of a block to the heap without moving it, as pbuf_realloc() requires.
+ *
+ * Usage is counted per pool, see snmp_mem_get_stats().
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && SNMP_USE_ZEPHYR
+
+	#include "lwip/arch.h"
+	#include "lwip/mem.h"
+	#include "lwip/memp.h"
+	#include "lwip/pbuf.h"
+
+	/* Smallest block handed out by mem_malloc(). A free block must be able
+	 * to hold the two free-list pointers. */
+	#define MEM_MIN_BLOCK_SIZE   32U
+	/* Number of size classes: 32, 64, ..., 2048 bytes. The largest class
+	 * must hold a PBUF_RAM with a full 1472-byte SNMP message. */
+	#define MEM_ORDERS           7U
+	#define MEM_MAX_BLOCK_SIZE   ( MEM_MIN_BLOCK_SIZE << ( MEM_ORDERS - 1U ) )
+	#define MEM_HEAP_BLOCKS      ( MEM_SIZE / MEM_MAX_BLOCK_SIZE )
+	#define MEM_HEAP_UNITS       ( MEM_HEAP_BLOCKS << ( MEM_ORDERS - 1U ) )
+
+	BUILD_ASSERT( MEM_HEAP_BLOCKS >= 1U, "MEM_SIZE must hold at least one 2048-byte block" );
+	BUILD_ASSERT( MEM_HEAP_UNITS <= 0x10000U, "MEM_SIZE too large for 16-bit unit indexes" );
+
+	/* State of each MEM_MIN_BLOCK_SIZE unit of the heap. Only the first unit
+	 * of a block carries its order, all other units are marked MEM_UNIT_INNER. */
+	#define MEM_UNIT_FREE        0x80U
+	#define MEM_UNIT_INNER       0x40U
+
+	struct mem_free_block
+	{
+		struct mem_free_block * next;
+		struct mem_free_block * prev;
+	};
+
+	static u8_t mem_heap[ MEM_HEAP_BLOCKS * MEM_MAX_BLOCK_SIZE ] __aligned( MEM_MIN_BLOCK_SIZE );
+	static u8_t mem_unit_state[ MEM_HEAP_UNITS ];
+	static struct mem_free_block * mem_free_list[ MEM_ORDERS ];
+	static bool mem_heap_ready;
+
+	K_MEM_SLAB_DEFINE_STATIC( memp_slab_pbuf,
+							  LWIP_MEM_ALIGN_SIZE( sizeof( struct pbuf ) ),
+							  MEMP_NUM_PBUF, MEM_ALIGNMENT );
+	K_MEM_SLAB_DEFINE_STATIC( memp_slab_pbuf_pool,
+							  LWIP_MEM_ALIGN_SIZE( sizeof( struct pbuf ) ) + LWIP_MEM_ALIGN_SIZE( PBUF_POOL_BUFSIZE ),
+							  PBUF_POOL_SIZE, MEM_ALIGNMENT );
+
+	static struct snmp_mem_stats mem_stats[ SNMP_MEM_POOL_COUNT ] =
+	{
+		[ SNMP_MEM_POOL_PBUF ]      = { .name = "PBUF_REF/ROM", .avail = MEMP_NUM_PBUF },
+		[ SNMP_MEM_POOL_PBUF_POOL ] = { .name = "PBUF_POOL",    .avail = PBUF_POOL_SIZE },
+		[ SNMP_MEM_POOL_HEAP ]      = { .name = "HEAP",         .avail = sizeof mem_heap },
+	};
+
+	/* Protects the buddy heap and the statistics. All operations under this
+	 * lock take a bounded number of steps. */
+	static struct k_spinlock mem_lock;
+
+	static void mem_stats_alloc( struct snmp_mem_stats * stats, u32_t amount )
+	{
+		stats->used += amount;
+		if( stats->max < stats->used )
+		{
+			stats->max = stats->used;
+		}
+	}
+
+	static inline u16_t mem_unit_of( const void * ptr )
+	{
+		return ( u16_t ) ( ( ( const u8_t * ) ptr - mem_heap ) / MEM_MIN_BLOCK_SIZE );
+	}
+
+	static inline struct mem_free_block * mem_block_at( u32_t unit )
+	{
+		return ( struct mem_free_block * ) &mem_heap[ unit * MEM_MIN_BLOCK_SIZE ];
+	}
+
+	/* Checks that 'ptr' is the start of a block that is currently allocated. */
+	static bool mem_block_in_use( const void * ptr )
+	{
+		const u8_t * mem = ( const u8_t * ) ptr;
+
+		if( ( mem < mem_heap ) || ( mem >= mem_heap + sizeof mem_heap ) ||
+			( ( ( mem - mem_heap ) % MEM_MIN_BLOCK_SIZE ) != 0 ) )
+		{
+			return false;
+		}
+		return ( mem_unit_state[ mem_unit_of( ptr ) ] & ( MEM_UNIT_FREE | MEM_UNIT_INNER ) ) == 0;
+	}
+
+	static void mem_list_push( u8_t order, u32_t unit )
+	{
+		struct mem_free_block * block = mem_block_at( unit );
+
+		block->prev = NULL;
+		block->next = mem_free_list[ order ];
+		if( block->next != NULL )
+		{
+			block->next->prev = block;
+		}
+		mem_free_list[ order ] = block;
+		mem_unit_state[ unit ] = ( u8_t ) ( MEM_UNIT_FREE | order );
+	}
+
+	static void mem_list_unlink( u8_t order, struct mem_free_block * block )
+	{
+		if( block->prev != NULL )
+		{
+			block->prev->next = block->next;
+		}
+		else
+		{
+			mem_free_list[ order ] = block->next;
+		}
+		if( block->next != NULL )
+		{
+			block->next->prev = block->prev;
+		}
+	}
+
+	/* Returns the smallest order whose block holds 'size' bytes,
+	 * or MEM_ORDERS when it does not fit at all. */
+	static u8_t mem_order_for( mem_size_t size )
+	{
+		u8_t order = 0;
+		u32_t block_size = MEM_MIN_BLOCK_SIZE;
+
+		while( ( block_size < size ) && ( order < MEM_ORDERS ) )
+		{
+			block_size <<= 1;
+			order++;
+		}
+		return order;
+	}
+
+	static void mem_heap_init( void )
+	{
+		u32_t unit;
+
+		memset( mem_unit_state, MEM_UNIT_INNER, sizeof mem_unit_state );
+		memset( mem_free_list, 0, sizeof mem_free_list );
+		for( unit = 0; unit < MEM_HEAP_UNITS; unit += ( 1U << ( MEM_ORDERS - 1U ) ) )
+		{
+			mem_list_push( MEM_ORDERS - 1U, unit );
+		}
+		mem_heap_ready = true;
+	}
+
+	void mem_init( void )
+	{
+		k_spinlock_key_t key = k_spin_lock( &mem_lock );
+
+		if( !mem_heap_ready )
+		{
+			mem_heap_init();
+		}
+		k_spin_unlock( &mem_lock, key );
+	}
+
+	/* As part of the zephyr "port", we must define some
+	 * memory allocation. */
+	void * mem_malloc( mem_size_t size )
+	{
+		struct mem_free_block * block = NULL;
+		u8_t order = mem_order_for( size );
+		u8_t split;
+		k_spinlock_key_t key = k_spin_lock( &mem_lock );
+
+		if( !mem_heap_ready )
+		{
+			mem_heap_init();
+		}
+
+		for( split = order; split < MEM_ORDERS; split++ )
+		{
+			if( mem_free_list[ split ] != NULL )
+			{
+				block = mem_free_list[ split ];
+				break;
+			}
+		}
+
+		if( block == NULL )
+		{
+			mem_stats[ SNMP_MEM_POOL_HEAP ].err++;
+		}
+		else
+		{
+			u16_t unit = mem_unit_of( block );
+
+			mem_list_unlink( split, block );
+			/* hand the upper halves back until the block has the wanted size */
+			while( split > order )
+			{
+				split--;
+				mem_list_push( split, unit + ( 1U << split ) );
+			}
+			mem_unit_state[ unit ] = order;
+			mem_stats_alloc( &mem_stats[ SNMP_MEM_POOL_HEAP ], MEM_MIN_BLOCK_SIZE << order );
+		}
+		k_spin_unlock( &mem_lock, key );
+
+		return block;
+	}
+
+	void * mem_calloc( mem_size_t count,
+					   mem_size_t size )
+	{
+		size_t total = ( size_t ) count * size;
+		void * rmem = NULL;
+
+		if( total <= MEM_MAX_BLOCK_SIZE )
+		{
+			rmem = mem_malloc( ( mem_size_t ) total );
+			if( rmem != NULL )
+			{
+				memset( rmem, 0, total );
+			}
+		}
+		return rmem;
+	}
+
+	void mem_free( void * rmem )
+	{
+		u16_t unit;
+		u8_t order;
+		k_spinlock_key_t key;
+
+		if( rmem == NULL )
+		{
+			return;
+		}
+
+		key = k_spin_lock( &mem_lock );
+		if( !mem_block_in_use( rmem ) )
+		{
+			/* not a block handed out by mem_malloc(), or freed twice */
+			mem_stats[ SNMP_MEM_POOL_HEAP ].illegal++;
+			k_spin_unlock( &mem_lock, key );
+			return;
+		}
+
+		unit = mem_unit_of( rmem );
+		order = mem_unit_state[ unit ];
+		mem_stats[ SNMP_MEM_POOL_HEAP ].used -= MEM_MIN_BLOCK_SIZE << order;
+
+		/* merge with the buddy as long as it is free and of the same size */
+		while( order < MEM_ORDERS - 1U )
+		{
+			u16_t buddy = unit ^ ( 1U << order );
+
+			if( mem_unit_state[ buddy ] != ( MEM_UNIT_FREE | order ) )
+			{
+				break;
+			}
+			mem_list_unlink( order, mem_block_at( buddy ) );
+			if( buddy < unit )
+			{
+				mem_unit_state[ unit ] = MEM_UNIT_INNER;
+				unit = buddy;
+			}
+			else
+			{
+				mem_unit_state[ buddy ] = MEM_UNIT_INNER;
+			}
+			order++;
+		}
+		mem_list_push( order, unit );
+		k_spin_unlock( &mem_lock, key );
+	}
+
+	/* Shrinks a block in place: the upper halves which are no longer needed
+	 * go back to the free lists. The returned pointer always equals 'rmem'. */
+	void * mem_trim( void * rmem,
+					 mem_size_t newsize )
+	{
+		u16_t unit;
+		u8_t order;
+		u8_t new_order = mem_order_for( newsize );
+		k_spinlock_key_t key;
+
+		if( rmem == NULL )
+		{
+			return NULL;
+		}
+
+		key = k_spin_lock( &mem_lock );
+		if( !mem_block_in_use( rmem ) )
+		{
+			mem_stats[ SNMP_MEM_POOL_HEAP ].illegal++;
+			k_spin_unlock( &mem_lock, key );
+			return rmem;
+		}
+
+		unit = mem_unit_of( rmem );
+		order = mem_unit_state[ unit ];
+		if( new_order > order )
+		{
+			/* growing is not supported */
+			k_spin_unlock( &mem_lock, key );
+			return NULL;
+		}
+
+		while( order > new_order )
+		{
+			order--;
+			/* the new free half can not be merged: its buddy is still in use */
+			mem_list_push( order, unit + ( 1U << order ) );
+			mem_stats[ SNMP_MEM_POOL_HEAP ].used -= MEM_MIN_BLOCK_SIZE << order;
+		}
+		mem_unit_state[ unit ] = order;
+		k_spin_unlock( &mem_lock, key );
+
+		return rmem;
+	}
+
+	static struct k_mem_slab * memp_slab_of( memp_t type,
+											 snmp_mem_pool_t * pool )
+	{
+		switch( type )
+		{
+			case MEMP_PBUF:
+				*pool = SNMP_MEM_POOL_PBUF;
+				return &memp_slab_pbuf;
+
+			case MEMP_PBUF_POOL:
+				*pool = SNMP_MEM_POOL_PBUF_POOL;
+				return &memp_slab_pbuf_pool;
+
+			default:
+				return NULL;
+		}
+	}
+
+	void * memp_malloc( memp_t type )
+	{
+		snmp_mem_pool_t pool;
+		struct k_mem_slab * slab = memp_slab_of( type, &pool );
+		void * mem = NULL;
+		k_spinlock_key_t key;
+
+		if( slab == NULL )
+		{
+			/* Only the pbuf pools are used by this port. */
+			return NULL;
+		}
+
+		if( k_mem_slab_alloc( slab, &mem, K_NO_WAIT ) != 0 )
+		{
+			mem = NULL;
+		}
+
+		key = k_spin_lock( &mem_lock );
+		if( mem == NULL )
+		{
+			mem_stats[ pool ].err++;
+		}
+		else
+		{
+			mem_stats_alloc( &mem_stats[ pool ], 1 );
+		}
+		k_spin_unlock( &mem_lock, key );
+
+		return mem;
+	}
+
+	void memp_free( memp_t type,
+					void * mem )
+	{
+		snmp_mem_pool_t pool;
+		struct k_mem_slab * slab = memp_slab_of( type, &pool );
+		k_spinlock_key_t key;
+
+		if( ( slab == NULL ) || ( mem == NULL ) )
+		{
+			return;
+		}
+
+		k_mem_slab_free( slab, mem );
+
+		key = k_spin_lock( &mem_lock );
+		mem_stats[ pool ].used--;
+		k_spin_unlock( &mem_lock, key );
+	}
+
+	u8_t snmp_mem_get_stats( snmp_mem_pool_t pool,
+							 struct snmp_mem_stats * stats )
+	{
+		k_spinlock_key_t key;
+
+		if( ( pool >= SNMP_MEM_POOL_COUNT ) || ( stats == NULL ) )
+		{
+			return 0;
+		}
+
+		key = k_spin_lock( &mem_lock );
+		*stats = mem_stats[ pool ];
+		k_spin_unlock( &mem_lock, key );
+
+		return 1;
+	}
+
+	void snmp_mem_reset_max( void )
+	{
+		size_t index;
+		k_spinlock_key_t key = k_spin_lock( &mem_lock );
+
+		for( index = 0; index < ARRAY_SIZE( mem_stats ); index++ )
+		{
+			mem_stats[ index ].max = mem_stats[ index ].used;
+		}
+		k_spin_unlock( &mem_lock, key );
+	}
+
+#endif /* LWIP_SNMP && SNMP_USE_ZEPHYR */
@@ -33,7 +33,9 @@
  */
 
 #include "snmpv3_priv.h"
+#include "snmp_core_priv.h"
 #include "lwip/apps/snmpv3.h"
+#include "lwip/apps/snmpv3_keys.h"
 #include "lwip/sys.h"
 #include <string.h>
 
@@ -45,11 +47,148 @@
 
 #define SNMP_MAX_TIME_BOOT 2147483647UL
 
+static struct snmpv3_user_cache_entry snmpv3_user_cache[SNMP_V3_USER_CACHE_ENTRIES];
+/* entries resolved in an older generation are stale; starts at 1 so that
+ * zeroed entries never match */
+static volatile u32_t snmpv3_user_cache_generation = 1;
+static u32_t snmpv3_user_cache_tick;
+
 /** Call this if engine has been changed. Has to reset boots, see below */
 void
 snmpv3_engine_id_changed(void)
 {
   snmpv3_set_engine_boots(0);
+  /* localized keys depend on the engine ID */
+  snmpv3_users_changed();
+#if SNMP_V3_KEYS && LWIP_SNMP_V3_MBEDTLS
+  snmpv3_keys_engine_id_changed();
+#endif
+}
+
+/**
+ * Call this after users were added, removed or modified, so that cached
+ * algorithms and keys are fetched again through snmpv3_get_user().
+ * Entries are only marked stale here; they are rebuilt by the agent on the
+ * next message of the user.
+ */
+void
+snmpv3_users_changed(void)
+{
+  snmpv3_user_cache_generation++;
+#if SNMP_V3_REMOTE_ENGINES > 0
+  /* the user store calls this from its own thread */
+  SNMP_CORE_LOCK();
+  snmpv3_remote_users_changed();
+  SNMP_CORE_UNLOCK();
+#endif
+}
+
+/**
+ * Look up a user by name in the user cache. On a miss the user is resolved
+ * through snmpv3_get_user() and, with crypto enabled, its HMAC and cipher
+ * contexts are keyed once, replacing the least recently used entry.
+ * @return the cache entry, or NULL if the user is unknown
+ */
+struct snmpv3_user_cache_entry *
+snmpv3_user_cache_get(const u8_t *name, u8_t name_len)
+{
+  struct snmpv3_user_cache_entry *entry;
+  struct snmpv3_user_cache_entry *victim = NULL;
+  u32_t generation = snmpv3_user_cache_generation;
+  char name_buf[SNMP_V3_MAX_USER_LENGTH + 1];
+  snmpv3_auth_algo_t auth_algo;
+  snmpv3_priv_algo_t priv_algo;
+#if LWIP_SNMP_V3_CRYPTO
+  u8_t auth_key[SNMP_V3_MAX_KEY_LENGTH];
+  u8_t priv_key[SNMP_V3_MAX_KEY_LENGTH];
+#endif
+  err_t err;
+  u8_t i;
+
+  if (name_len > SNMP_V3_MAX_USER_LENGTH) {
+    return NULL;
+  }
+
+  snmpv3_user_cache_tick++;
+  for (i = 0; i < SNMP_V3_USER_CACHE_ENTRIES; i++) {
+    entry = &snmpv3_user_cache[i];
+    if (entry->valid && (entry->generation == generation)) {
+      if ((entry->name_len == name_len) && (memcmp(entry->name, name, name_len) == 0)) {
+        entry->last_used = snmpv3_user_cache_tick;
+        return entry;
+      }
+      if ((victim == NULL) || (victim->valid && (victim->generation == generation) &&
+                               (entry->last_used < victim->last_used))) {
+        victim = entry;
+      }
+    } else if ((victim == NULL) || (victim->valid && (victim->generation == generation))) {
+      /* free or stale entries are replaced first */
+      victim = entry;
+    }
+  }
+
+  /* resolve the user before evicting anything, so that messages for unknown
+   * users do not displace cached ones */
+  MEMCPY(name_buf, name, name_len);
+  name_buf[name_len] = 0;
+#if LWIP_SNMP_V3_CRYPTO
+  err = snmpv3_get_user(name_buf, &auth_algo, auth_key, &priv_algo, priv_key);
+#else
+  err = snmpv3_get_user(name_buf, &auth_algo, NULL, &priv_algo, NULL);
+#endif
+
+  entry = victim;
+  if (err == ERR_OK) {
+    entry->slot = (u8_t)(entry - snmpv3_user_cache);
+    entry->valid = 0;
+#if LWIP_SNMP_V3_CRYPTO
+    err = snmpv3_crypto_user_setup(entry->slot, auth_algo, auth_key, priv_algo, priv_key);
+    if (err != ERR_OK) {
+      snmpv3_crypto_user_release(entry->slot);
+    }
+#endif
+  }
+#if LWIP_SNMP_V3_CRYPTO
+  memset(auth_key, 0, sizeof(auth_key));
+  memset(priv_key, 0, sizeof(priv_key));
+#endif
+  if (err != ERR_OK) {
+    return NULL;
+  }
+
+  MEMCPY(entry->name, name_buf, name_len + 1);
+  entry->name_len = name_len;
+  entry->auth_algo = auth_algo;
+  entry->priv_algo = priv_algo;
+  entry->generation = generation;
+  entry->last_used = snmpv3_user_cache_tick;
+  entry->valid = 1;
+  return entry;
+}
+
+/**
+ * Length of msgAuthenticationParameters, the truncated HMAC, of an
+ * authentication protocol (RFC 3414 6.3.1, 7.3.1 and RFC 7860 4.2.1).
+ * @return 0 for noAuth and unknown protocols
+ */
+u8_t
+snmpv3_auth_param_length(snmpv3_auth_algo_t algo)
+{
+  switch (algo) {
+    case SNMP_V3_AUTH_ALGO_MD5:
+    case SNMP_V3_AUTH_ALGO_SHA:
+      return 12;
+    case SNMP_V3_AUTH_ALGO_SHA224:
+      return 16;
+    case SNMP_V3_AUTH_ALGO_SHA256:
+      return 24;
+    case SNMP_V3_AUTH_ALGO_SHA384:
+      return 32;
+    case SNMP_V3_AUTH_ALGO_SHA512:
+      return 48;
+    default:
+      return 0;
+  }
 }
 
 /** According to RFC3414 2.2.2.
@@ -61,6 +200,10 @@ snmpv3_engine_id_changed(void)
 s32_t
 snmpv3_get_engine_boots_internal(void)
 {
+#if SNMP_V3_ENGINE_TIME
+  /* the engine clock latches the value itself */
+  return (s32_t)snmpv3_get_engine_boots();
+#else
   if (snmpv3_get_engine_boots() == 0 ||
       snmpv3_get_engine_boots() < SNMP_MAX_TIME_BOOT) {
     return snmpv3_get_engine_boots();
@@ -68,6 +211,7 @@ snmpv3_get_engine_boots_internal(void)
 
   snmpv3_set_engine_boots(SNMP_MAX_TIME_BOOT);
   return snmpv3_get_engine_boots();
+#endif
 }
 
 /** RFC3414 2.2.2.
@@ -78,6 +222,10 @@ snmpv3_get_engine_boots_internal(void)
 s32_t
 snmpv3_get_engine_time_internal(void)
 {
+#if SNMP_V3_ENGINE_TIME
+  /* the engine clock wraps the time once per second, not per message */
+  return (s32_t)snmpv3_get_engine_time();
+#else
   if (snmpv3_get_engine_time() >= SNMP_MAX_TIME_BOOT) {
     snmpv3_reset_engine_time();
 
@@ -89,6 +237,7 @@ snmpv3_get_engine_time_internal(void)
   }
 
   return snmpv3_get_engine_time();
+#endif
 }
 
 #if LWIP_SNMP_V3_CRYPTO
@@ -131,6 +280,27 @@ snmpv3_build_priv_param(u8_t *priv_param)
 #endif
   return ERR_OK;
 }
+
+#ifndef lwip_memcmp_consttime
+/**
+ * The lwIP core (def.c) that normally provides this is not part of this port.
+ * Compares without an early exit, so that the time taken does not reveal how
+ * many leading bytes of a digest matched.
+ */
+int
+lwip_memcmp_consttime(const void *s1, const void *s2, size_t len)
+{
+  size_t i;
+  const unsigned char *a1 = (const unsigned char *)s1;
+  const unsigned char *a2 = (const unsigned char *)s2;
+  unsigned char ret = 0;
+
+  for (i = 0; i < len; i++) {
+    ret |= a1[i] ^ a2[i];
+  }
+  return ret;
+}
+#endif
 #endif /* LWIP_SNMP_V3_CRYPTO */
 
 #endif
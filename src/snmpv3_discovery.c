@@ -0,0 +1,349 @@
+/**
+ * @file
+ * SNMPv3 engine discovery fast path (RFC 3414 4).
+ *
+ * Every SNMPv3 session starts with a probe that carries no or another
+ * msgAuthoritativeEngineID. It is answered with a REPORT of
+ * usmStatsUnknownEngineIDs that tells the manager our engine ID, boots and
+ * time. After a network outage all managers probe at once, so these
+ * requests are recognized after decoding the message header and the USM
+ * security parameters only, without a request state and without the
+ * generic encoder.
+ *
+ * The REPORT is kept pre-encoded for the current engine ID; per probe the
+ * msgID, snmpEngineBoots/Time, the user name and the counter value are
+ * filled in and the affected lengths are patched.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_FAST_DISCOVERY /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmpv3.h"
+#include "snmp_asn1.h"
+#include "snmp_msg.h"
+#include "snmp_pbuf_stream.h"
+#include "snmpv3_priv.h"
+#include "lwip/pbuf.h"
+#include <string.h>
+
+/* our msgMaxSize, the size of the outbound pbuf of snmp_prepare_outbound_frame() */
+#define SNMP_DISCOVERY_MAX_SIZE  1472
+
+/* Offsets into the template. Variable fields are not part of it, they are
+ * inserted at the three "hole" offsets. */
+#define TMPL_MSG_LEN        2   /* 30 82 xx xx */
+#define TMPL_GLOBAL_LEN     8   /* 30 xx, followed by the msgID hole */
+#define TMPL_MSGID_HOLE     9
+#define TMPL_GLOBAL_FIXED   10  /* msgMaxSize, msgFlags, msgSecurityModel */
+#define TMPL_USM_OS_LEN     20  /* 04 xx */
+#define TMPL_USM_SEQ_LEN    22  /* 30 xx, followed by the engine ID and the boots/time hole */
+
+/* usmStatsUnknownEngineIDs.0 */
+static const u8_t snmp_discovery_oid[] = {
+  0x06, 0x0a, 0x2b, 0x06, 0x01, 0x06, 0x03, 0x0f, 0x01, 0x01, 0x04, 0x00
+};
+
+/* The REPORT without msgID, boots/time, user name and counter:
+ * 30 82 LLLL                               message
+ *   02 01 03                               msgVersion
+ *   30 LL [msgID] 02 02 05c0 04 01 00 02 01 03   msgGlobalData
+ *   04 LL 30 LL                            msgSecurityParameters
+ *     04 ee <engine ID> [boots time user]
+ *     04 00 04 00                          auth, priv parameters
+ *   30 82 LLLL                             scopedPDU
+ *     04 ee <engine ID> 04 00              contextEngineID, contextName
+ *     a8 82 LLLL 02 01 00 02 01 00 02 01 00  report, request-id 0
+ *       30 82 LLLL 30 LL <oid> [counter]   variable bindings
+ */
+struct snmp_discovery_template {
+  u8_t engine_id[SNMP_V3_MAX_ENGINE_ID_LENGTH];
+  u8_t engine_id_len;
+  /* offsets of the boots/time/user hole and of the scopedPDU; the
+   * counter follows the template */
+  u8_t times_hole;
+  u8_t scoped_pdu;
+  u8_t len;
+  u8_t data[76 + 2 * SNMP_V3_MAX_ENGINE_ID_LENGTH];
+};
+
+static struct snmp_discovery_template snmp_discovery_tmpl;
+
+static u8_t *
+snmp_discovery_put(u8_t *out, const void *data, u16_t len)
+{
+  MEMCPY(out, data, len);
+  return out + len;
+}
+
+static void
+snmp_discovery_build(const u8_t *engine_id, u8_t engine_id_len)
+{
+  struct snmp_discovery_template *t = &snmp_discovery_tmpl;
+  static const u8_t head[] = { 0x30, 0x82, 0x00, 0x00, 0x02, 0x01, 0x03, 0x30, 0x00 };
+  static const u8_t global_tail[] = {
+    0x02, 0x02, (SNMP_DISCOVERY_MAX_SIZE >> 8) & 0xff, SNMP_DISCOVERY_MAX_SIZE & 0xff,
+    0x04, 0x01, 0x00, 0x02, 0x01, 0x03, /* USM */
+    0x04, 0x00, 0x30, 0x00
+  };
+  static const u8_t usm_tail[] = { 0x04, 0x00, 0x04, 0x00, 0x30, 0x82, 0x00, 0x00 };
+  static const u8_t pdu_head[] = {
+    0x04, 0x00,
+    SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_REPORT, 0x82, 0x00, 0x00,
+    0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00,
+    0x30, 0x82, 0x00, 0x00, 0x30, 0x00
+  };
+  u8_t id_tlv[2] = { SNMP_ASN1_TYPE_OCTET_STRING, 0 };
+  u8_t *p = t->data;
+
+  id_tlv[1] = engine_id_len;
+  MEMCPY(t->engine_id, engine_id, engine_id_len);
+  t->engine_id_len = engine_id_len;
+
+  p = snmp_discovery_put(p, head, sizeof(head));
+  p = snmp_discovery_put(p, global_tail, sizeof(global_tail));
+  p = snmp_discovery_put(p, id_tlv, sizeof(id_tlv));
+  p = snmp_discovery_put(p, engine_id, engine_id_len);
+  t->times_hole = (u8_t)(p - t->data);
+  t->scoped_pdu = (u8_t)(p - t->data + 4);
+  p = snmp_discovery_put(p, usm_tail, sizeof(usm_tail));
+  p = snmp_discovery_put(p, id_tlv, sizeof(id_tlv));
+  p = snmp_discovery_put(p, engine_id, engine_id_len);
+  p = snmp_discovery_put(p, pdu_head, sizeof(pdu_head));
+  p = snmp_discovery_put(p, snmp_discovery_oid, sizeof(snmp_discovery_oid));
+  t->len = (u8_t)(p - t->data);
+}
+
+/* INTEGER-like TLV of the 'len' low octets of value (len <= 5, see
+ * snmp_asn1_enc_u32t_cnt()/snmp_asn1_enc_s32t_cnt()) */
+static u8_t
+snmp_discovery_enc_int(u8_t *out, u8_t type, u32_t value, u16_t len)
+{
+  u16_t i;
+
+  out[0] = type;
+  out[1] = (u8_t)len;
+  for (i = 0; i < len; i++) {
+    u16_t shift = (u16_t)(8 * (len - 1 - i));
+    out[2 + i] = (shift < 32) ? (u8_t)(value >> shift) : 0;
+  }
+  return (u8_t)(2 + len);
+}
+
+static void
+snmp_discovery_put_len16(u8_t *out, u16_t len)
+{
+  out[0] = (u8_t)(len >> 8);
+  out[1] = (u8_t)len;
+}
+
+/* Decodes the header of a message up to the USM parameters, the same checks
+ * as snmp_parse_inbound_frame(). Returns 1 for a message to an unknown
+ * engine ID; anything else, including malformed frames, is left to the full
+ * parser so that it is counted and handled as before. */
+static u8_t
+snmp_discovery_match(struct pbuf *p, s32_t *msg_id, u8_t *user, u16_t *user_len)
+{
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+  u8_t scratch[SNMP_V3_MAX_AUTH_PARAM_LENGTH];
+  u16_t scratch_len;
+  s32_t value;
+  const char *eid;
+  u8_t eid_len;
+  u8_t i;
+  static const u16_t usm_limits[] = { SNMP_V3_MAX_USER_LENGTH, SNMP_V3_MAX_AUTH_PARAM_LENGTH, SNMP_V3_MAX_PRIV_PARAM_LENGTH };
+
+#define DISCOVERY_EXPECT(cond) do { if (!(cond)) { return 0; } } while (0)
+  DISCOVERY_EXPECT(snmp_pbuf_stream_init(&stream, p, 0, p->tot_len) == ERR_OK);
+
+  /* message, version 3 */
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT((tlv.type == SNMP_ASN1_TYPE_SEQUENCE) && (tlv.value_len == stream.length));
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  DISCOVERY_EXPECT(snmp_asn1_dec_s32t(&stream, tlv.value_len, &value) == ERR_OK);
+  DISCOVERY_EXPECT(value == SNMP_VERSION_3);
+#if LWIP_SNMP_CONFIGURE_VERSIONS
+  DISCOVERY_EXPECT(snmp_v3_enabled());
+#endif
+
+  /* msgGlobalData: msgID, msgMaxSize, msgFlags, msgSecurityModel */
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_SEQUENCE);
+  for (i = 0; i < 4; i++) {
+    DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+    DISCOVERY_EXPECT(tlv.type == ((i == 2) ? SNMP_ASN1_TYPE_OCTET_STRING : SNMP_ASN1_TYPE_INTEGER));
+    DISCOVERY_EXPECT(snmp_asn1_dec_s32t(&stream, tlv.value_len, &value) == ERR_OK);
+    if (i == 0) {
+      *msg_id = value;
+    }
+  }
+
+  /* msgSecurityParameters, msgAuthoritativeEngineID */
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_SEQUENCE);
+  DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+  DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  DISCOVERY_EXPECT(snmp_asn1_dec_raw(&stream, tlv.value_len, scratch, &scratch_len, SNMP_V3_MAX_ENGINE_ID_LENGTH) == ERR_OK);
+
+  snmpv3_get_engine_id(&eid, &eid_len);
+  if ((scratch_len == eid_len) && (eid_len != 0) && (memcmp(eid, scratch, eid_len) == 0)) {
+    /* a request to us */
+    return 0;
+  }
+
+  /* msgAuthoritativeEngineBoots/-Time, msgUserName, msgAuthentication-
+   * and msgPrivacyParameters must be well-formed, a scoped PDU must follow */
+  for (i = 0; i < 2; i++) {
+    DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+    DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+    DISCOVERY_EXPECT(snmp_asn1_dec_s32t(&stream, tlv.value_len, &value) == ERR_OK);
+  }
+  for (i = 0; i < LWIP_ARRAYSIZE(usm_limits); i++) {
+    DISCOVERY_EXPECT(snmp_asn1_dec_tlv(&stream, &tlv) == ERR_OK);
+    DISCOVERY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+    if (i == 0) {
+      /* the user name is echoed */
+      DISCOVERY_EXPECT(snmp_asn1_dec_raw(&stream, tlv.value_len, user, user_len, usm_limits[i]) == ERR_OK);
+    } else {
+      DISCOVERY_EXPECT(snmp_asn1_dec_raw(&stream, tlv.value_len, scratch, &scratch_len, usm_limits[i]) == ERR_OK);
+    }
+  }
+  DISCOVERY_EXPECT(stream.length > 0);
+#undef DISCOVERY_EXPECT
+
+  return 1;
+}
+
+/**
+ * Answers an SNMPv3 message to an unknown engine ID with the REPORT of
+ * usmStatsUnknownEngineIDs.
+ *
+ * @return 1 when the message was handled, 0 when it has to be processed by
+ *         snmp_receive() as usual
+ */
+u8_t
+snmpv3_discovery_receive(void *handle, struct pbuf *p, const ip_addr_t *source_ip, u16_t port)
+{
+  struct snmp_discovery_template *t = &snmp_discovery_tmpl;
+  /* template, msgID, boots/time, user name and counter TLVs */
+  u8_t frame[sizeof(t->data) + 6 + 12 + 2 + SNMP_V3_MAX_USER_LENGTH + 7];
+  u8_t *out = frame;
+  const char *eid;
+  u8_t eid_len;
+  s32_t msg_id = 0;
+  u8_t user[SNMP_V3_MAX_USER_LENGTH];
+  u16_t user_len;
+  u16_t msg_id_len, counter_len, scoped;
+  u8_t usm_hole_len, usm_len, counter_off, vb_len;
+  u16_t frame_len;
+  struct pbuf *reply;
+
+  if (!snmp_discovery_match(p, &msg_id, user, &user_len)) {
+    return 0;
+  }
+
+  snmpv3_get_engine_id(&eid, &eid_len);
+  if ((t->len == 0) || (t->engine_id_len != eid_len) || (memcmp(t->engine_id, eid, eid_len) != 0)) {
+    snmp_discovery_build((const u8_t *)eid, eid_len);
+  }
+
+  snmp_stats.unknownengineids++;
+
+  /* head, msgID, rest of the header up to the boots/time/user hole */
+  out = snmp_discovery_put(out, t->data, TMPL_MSGID_HOLE);
+  snmp_asn1_enc_s32t_cnt(msg_id, &msg_id_len);
+  out += snmp_discovery_enc_int(out, SNMP_ASN1_TYPE_INTEGER, (u32_t)msg_id, msg_id_len);
+  out = snmp_discovery_put(out, &t->data[TMPL_MSGID_HOLE], (u16_t)(t->times_hole - TMPL_MSGID_HOLE));
+
+#if SNMP_V3_ENGINE_TIME
+  {
+    struct snmpv3_engine_fields engine;
+
+    snmpv3_get_engine_fields(&engine);
+    out = snmp_discovery_put(out, engine.enc, engine.enc_len);
+    usm_hole_len = engine.enc_len;
+  }
+#else
+  {
+    s32_t boots = (s32_t)snmpv3_get_engine_boots();
+    s32_t time = (s32_t)snmpv3_get_engine_time();
+    u16_t boots_len, time_len;
+
+    snmp_asn1_enc_s32t_cnt(boots, &boots_len);
+    snmp_asn1_enc_s32t_cnt(time, &time_len);
+    usm_hole_len = snmp_discovery_enc_int(out, SNMP_ASN1_TYPE_INTEGER, (u32_t)boots, boots_len);
+    usm_hole_len += snmp_discovery_enc_int(out + usm_hole_len, SNMP_ASN1_TYPE_INTEGER, (u32_t)time, time_len);
+    out += usm_hole_len;
+  }
+#endif
+  /* msgUserName */
+  *out++ = SNMP_ASN1_TYPE_OCTET_STRING;
+  *out++ = (u8_t)user_len;
+  out = snmp_discovery_put(out, user, user_len);
+  usm_hole_len = (u8_t)(usm_hole_len + 2 + user_len);
+
+  /* rest of the frame, counter value */
+  out = snmp_discovery_put(out, &t->data[t->times_hole], (u16_t)(t->len - t->times_hole));
+  counter_off = (u8_t)(out - frame);
+  snmp_asn1_enc_u32t_cnt(snmp_stats.unknownengineids, &counter_len);
+  out += snmp_discovery_enc_int(out, SNMP_ASN1_TYPE_COUNTER32, snmp_stats.unknownengineids, counter_len);
+  frame_len = (u16_t)(out - frame);
+
+  /* patch the lengths, inside out: varbind, varbind list, PDU */
+  vb_len = (u8_t)(sizeof(snmp_discovery_oid) + 2 + counter_len);
+  frame[counter_off - sizeof(snmp_discovery_oid) - 1] = vb_len;
+  snmp_discovery_put_len16(&frame[counter_off - sizeof(snmp_discovery_oid) - 4], (u16_t)(vb_len + 2));
+  snmp_discovery_put_len16(&frame[counter_off - sizeof(snmp_discovery_oid) - 17], (u16_t)(vb_len + 2 + 4 + 9));
+  /* scopedPDU, it moved by the msgID and the boots/time/user hole */
+  scoped = (u16_t)(t->scoped_pdu + 2 + msg_id_len + usm_hole_len);
+  snmp_discovery_put_len16(&frame[scoped + 2], (u16_t)(frame_len - scoped - 4));
+  /* msgGlobalData, msgSecurityParameters, message */
+  frame[TMPL_GLOBAL_LEN] = (u8_t)(2 + msg_id_len + TMPL_GLOBAL_FIXED);
+  usm_len = (u8_t)(2 + eid_len + usm_hole_len + 4);
+  frame[TMPL_USM_OS_LEN + 2 + msg_id_len] = (u8_t)(usm_len + 2);
+  frame[TMPL_USM_SEQ_LEN + 2 + msg_id_len] = usm_len;
+  snmp_discovery_put_len16(&frame[TMPL_MSG_LEN], (u16_t)(frame_len - 4));
+
+  reply = pbuf_alloc(PBUF_TRANSPORT, frame_len, PBUF_RAM);
+  if (reply != NULL) {
+    pbuf_take_at(reply, frame, frame_len, 0);
+    if (snmp_sendto(handle, reply, source_ip, port) > 0) {
+      snmp_stats.outpkts++;
+    }
+    pbuf_free(reply);
+  }
+  return 1;
+}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_FAST_DISCOVERY */
@@ -0,0 +1,281 @@
+/**
+ * @file
+ * SNMP zephyr frontend: persistent snmpEngineBoots and snmpEngineTime.
+ *
+ * Implements the snmpv3_get_engine_boots(), snmpv3_set_engine_boots(),
+ * snmpv3_get_engine_time() and snmpv3_reset_engine_time() callbacks.
+ * snmpEngineBoots is stored as "snmp/engine/boots" and incremented once per
+ * boot, when settings_load() has restored it. snmpEngineTime is derived from
+ * k_uptime_get() by a timer that runs once per second; it also wraps the time
+ * (RFC 3414 2.2.2) and encodes both values as BER INTEGERs, so the agent
+ * reads and copies them without any kernel call.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/settings/settings.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_ENGINE_TIME
+
+	#include "lwip/apps/snmpv3.h"
+	#include "snmp_asn1.h"
+	#include "snmpv3_priv.h"
+
+	#define ENGINE_SETTINGS_ROOT    "snmp/engine"
+	#define ENGINE_SETTINGS_BOOTS   ENGINE_SETTINGS_ROOT "/boots"
+	/* RFC 3414 2.2.2: both values latch, resp. wrap, at 2^31 - 1 */
+	#define ENGINE_MAX_TIME_BOOT    2147483647L
+
+	/* Written by the timer and by the set/reset callbacks, copied by the
+	 * agent. Only ever held for a few stores, it is safe in the timer ISR. */
+	static struct k_spinlock engine_lock;
+	static struct snmpv3_engine_fields engine_fields;
+	/* snmpEngineTime is (uptime - engine_base_ms) / 1000 */
+	static int64_t engine_base_ms;
+
+	/* the boots read by settings_load(), applied once by the commit handler */
+	static u32_t engine_stored_boots;
+	/* snmpv3_set_engine_boots() was called before settings_load() */
+	static bool engine_boots_set;
+	static bool engine_booted;
+
+	static void engine_save_handler( struct k_work * work );
+	static void engine_timer_handler( struct k_timer * timer );
+
+	static K_WORK_DEFINE( engine_save_work, engine_save_handler );
+	static K_TIMER_DEFINE( engine_timer, engine_timer_handler, NULL );
+
+	/* A BER INTEGER TLV of a value in 0 .. 2^31 - 1, returns its length. */
+	static u8_t engine_enc_integer( u8_t * out, s32_t value )
+	{
+		u8_t len = 1U;
+		u8_t i;
+
+		while( ( len < 4U ) && ( value >= ( 1L << ( ( 8U * len ) - 1U ) ) ) )
+		{
+			len++;
+		}
+		out[ 0 ] = SNMP_ASN1_TYPE_INTEGER;
+		out[ 1 ] = len;
+		for( i = 0; i < len; i++ )
+		{
+			out[ 2U + i ] = ( u8_t ) ( ( u32_t ) value >> ( 8U * ( len - 1U - i ) ) );
+		}
+		return ( u8_t ) ( 2U + len );
+	}
+
+	/* Call with engine_lock held. */
+	static void engine_encode( void )
+	{
+		u8_t len;
+
+		len = engine_enc_integer( engine_fields.enc, engine_fields.boots );
+		len += engine_enc_integer( &engine_fields.enc[ len ], engine_fields.time );
+		engine_fields.enc_len = len;
+	}
+
+	/* Call with engine_lock held: sets the time from the uptime, wraps it
+	 * after 2^31 - 1 seconds. Returns true when snmpEngineBoots changed. */
+	static bool engine_update( int64_t now_ms )
+	{
+		int64_t seconds = ( now_ms - engine_base_ms ) / 1000;
+		bool boots_changed = false;
+
+		if( seconds >= ENGINE_MAX_TIME_BOOT )
+		{
+			engine_base_ms += ( int64_t ) ENGINE_MAX_TIME_BOOT * 1000;
+			seconds -= ENGINE_MAX_TIME_BOOT;
+			if( engine_fields.boots < ENGINE_MAX_TIME_BOOT )
+			{
+				engine_fields.boots++;
+				boots_changed = true;
+			}
+		}
+		engine_fields.time = ( s32_t ) seconds;
+		engine_encode();
+		return boots_changed;
+	}
+
+	static void engine_timer_handler( struct k_timer * timer )
+	{
+		k_spinlock_key_t key;
+		bool boots_changed;
+
+		ARG_UNUSED( timer );
+
+		key = k_spin_lock( &engine_lock );
+		boots_changed = engine_update( k_uptime_get() );
+		k_spin_unlock( &engine_lock, key );
+
+		/* the timer runs in interrupt context, the flash is written later */
+		if( boots_changed )
+		{
+			k_work_submit( &engine_save_work );
+		}
+	}
+
+	static void engine_save_handler( struct k_work * work )
+	{
+		k_spinlock_key_t key;
+		u32_t boots;
+		int rc;
+
+		ARG_UNUSED( work );
+
+		key = k_spin_lock( &engine_lock );
+		boots = ( u32_t ) engine_fields.boots;
+		k_spin_unlock( &engine_lock, key );
+
+		rc = settings_save_one( ENGINE_SETTINGS_BOOTS, &boots, sizeof( boots ) );
+		if( rc != 0 )
+		{
+			zephyr_log( "snmpv3_engine: saving snmpEngineBoots failed: %d\n", rc );
+		}
+	}
+
+	static int engine_settings_set( const char * name, size_t len, settings_read_cb read_cb, void * cb_arg )
+	{
+		k_spinlock_key_t key;
+		u32_t boots;
+
+		if( ( strcmp( name, "boots" ) != 0 ) || ( len != sizeof( boots ) ) )
+		{
+			return 0;
+		}
+		if( read_cb( cb_arg, &boots, sizeof( boots ) ) == ( ssize_t ) sizeof( boots ) )
+		{
+			key = k_spin_lock( &engine_lock );
+			if( !engine_boots_set )
+			{
+				engine_stored_boots = boots;
+			}
+			k_spin_unlock( &engine_lock, key );
+		}
+		return 0;
+	}
+
+	/* Runs at the end of every settings_load(); only the first one counts
+	 * as a boot, which is the one write per boot. */
+	static int engine_settings_commit( void )
+	{
+		k_spinlock_key_t key = k_spin_lock( &engine_lock );
+
+		if( engine_booted )
+		{
+			k_spin_unlock( &engine_lock, key );
+			return 0;
+		}
+		engine_booted = true;
+		if( engine_stored_boots < ( u32_t ) ENGINE_MAX_TIME_BOOT )
+		{
+			engine_fields.boots = ( s32_t ) engine_stored_boots + 1;
+		}
+		else
+		{
+			/* RFC 3414 2.2.2: the engine ID has to be configured again */
+			engine_fields.boots = ENGINE_MAX_TIME_BOOT;
+		}
+		engine_encode();
+		k_spin_unlock( &engine_lock, key );
+
+		k_work_submit( &engine_save_work );
+		return 0;
+	}
+
+	SETTINGS_STATIC_HANDLER_DEFINE( snmpv3_engine, ENGINE_SETTINGS_ROOT, NULL,
+									engine_settings_set, engine_settings_commit, NULL );
+
+	static int engine_init( void )
+	{
+		k_spinlock_key_t key = k_spin_lock( &engine_lock );
+
+		engine_base_ms = k_uptime_get();
+		( void ) engine_update( engine_base_ms );
+		k_spin_unlock( &engine_lock, key );
+
+		k_timer_start( &engine_timer, K_SECONDS( 1 ), K_SECONDS( 1 ) );
+		return 0;
+	}
+
+	SYS_INIT( engine_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY );
+
+	void snmpv3_get_engine_fields( struct snmpv3_engine_fields * fields )
+	{
+		k_spinlock_key_t key = k_spin_lock( &engine_lock );
+
+		*fields = engine_fields;
+		k_spin_unlock( &engine_lock, key );
+	}
+
+	u32_t snmpv3_get_engine_boots( void )
+	{
+		return ( u32_t ) engine_fields.boots;
+	}
+
+	void snmpv3_set_engine_boots( u32_t boots )
+	{
+		k_spinlock_key_t key = k_spin_lock( &engine_lock );
+		bool booted = engine_booted;
+
+		engine_fields.boots = ( boots < ( u32_t ) ENGINE_MAX_TIME_BOOT ) ? ( s32_t ) boots : ENGINE_MAX_TIME_BOOT;
+		engine_encode();
+		if( !booted )
+		{
+			/* the engine ID changed before settings_load(): the stored
+			 * value is outdated, this boot counts from here */
+			engine_stored_boots = ( u32_t ) engine_fields.boots;
+			engine_boots_set    = true;
+		}
+		k_spin_unlock( &engine_lock, key );
+
+		if( booted )
+		{
+			k_work_submit( &engine_save_work );
+		}
+	}
+
+	u32_t snmpv3_get_engine_time( void )
+	{
+		return ( u32_t ) engine_fields.time;
+	}
+
+	void snmpv3_reset_engine_time( void )
+	{
+		k_spinlock_key_t key = k_spin_lock( &engine_lock );
+
+		engine_base_ms = k_uptime_get();
+		( void ) engine_update( engine_base_ms );
+		k_spin_unlock( &engine_lock, key );
+	}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_ENGINE_TIME */
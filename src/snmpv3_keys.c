@@ -0,0 +1,600 @@
+/**
+ * @file
+ * SNMP zephyr frontend: background localization of SNMPv3 user keys.
+ *
+ * Users live in a table of SNMP_V3_KEYS_USERS entries. snmpv3_keys_set_user()
+ * copies the passwords into an entry and wakes the key thread, which derives
+ * the engine independent keys Ku, wipes the passwords, localizes the keys
+ * for the current engine ID and stores them with settings_save_one(). The
+ * table lock is never held while hashing, so the agent keeps answering other
+ * users. An entry changed while its keys were being derived is recomputed
+ * (its generation no longer matches), the stale result is dropped.
+ *
+ * Stored record: "snmp/keys/<user>" = struct snmpv3_keys_record, which holds
+ * the engine ID the keys were localized for. A record of another engine ID is
+ * loaded, but not used until it is localized again.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+
+#include <lwip/apps/snmp_opts.h>
+#include <lwip/apps/snmp_zephyr.h>
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && LWIP_SNMP_V3_MBEDTLS && SNMP_V3_KEYS
+
+	#include "lwip/apps/snmpv3.h"
+	#include "lwip/apps/snmpv3_keys.h"
+	#include "snmpv3_priv.h"
+
+	#define KEYS_SETTINGS_ROOT      "snmp/keys"
+	#define KEYS_RECORD_VERSION     1U
+	/* RFC 3414 11.2: passwords of less than 8 characters are rejected */
+	#define KEYS_MIN_PASSWORD_LEN   8U
+
+	/* The persistent part of an entry: no passwords, no Ku. */
+	struct snmpv3_keys_record
+	{
+		u8_t version;
+		u8_t auth_algo;
+		u8_t priv_algo;
+		u8_t engine_id_len;
+		u8_t engine_id[ SNMP_V3_MAX_ENGINE_ID_LENGTH ];
+		u8_t auth_key[ SNMP_V3_MAX_KEY_LENGTH ];
+		u8_t priv_key[ SNMP_V3_MAX_KEY_LENGTH ];
+	};
+
+	struct snmpv3_keys_user
+	{
+		char name[ SNMP_V3_MAX_USER_LENGTH + 1 ];
+		bool in_use;
+		/* passwords were given, Ku is not derived yet */
+		bool pending;
+		/* auth_ku/priv_ku hold Ku, the keys can be localized again */
+		bool has_ku;
+		/* the record holds keys of its engine ID */
+		bool has_keys;
+		/* incremented by every change from the API */
+		u32_t generation;
+		struct snmpv3_keys_record record;
+		u8_t auth_ku[ SNMP_V3_MAX_KEY_LENGTH ];
+		u8_t priv_ku[ SNMP_V3_MAX_KEY_LENGTH ];
+		char auth_password[ SNMP_V3_KEYS_MAX_PASSWORD_LEN ];
+		char priv_password[ SNMP_V3_KEYS_MAX_PASSWORD_LEN ];
+		u8_t auth_password_len;
+		u8_t priv_password_len;
+	};
+
+	static struct snmpv3_keys_user keys_users[ SNMP_V3_KEYS_USERS ];
+
+	/* Protects keys_users; held for copies only, never while hashing. */
+	static K_MUTEX_DEFINE( keys_lock );
+	/* Given whenever an entry may need work. */
+	static K_SEM_DEFINE( keys_work, 0, 1 );
+
+	static void keys_wipe( void * buf, size_t len )
+	{
+		volatile u8_t * p = ( volatile u8_t * ) buf;
+
+		while( len-- > 0U )
+		{
+			*p++ = 0U;
+		}
+	}
+
+	static struct snmpv3_keys_user * keys_find( const char * name )
+	{
+		size_t i;
+
+		for( i = 0; i < ARRAY_SIZE( keys_users ); i++ )
+		{
+			if( keys_users[ i ].in_use && ( strcmp( keys_users[ i ].name, name ) == 0 ) )
+			{
+				return &keys_users[ i ];
+			}
+		}
+		return NULL;
+	}
+
+	static struct snmpv3_keys_user * keys_find_or_alloc( const char * name )
+	{
+		struct snmpv3_keys_user * user = keys_find( name );
+		size_t i;
+
+		for( i = 0; ( user == NULL ) && ( i < ARRAY_SIZE( keys_users ) ); i++ )
+		{
+			if( !keys_users[ i ].in_use )
+			{
+				user = &keys_users[ i ];
+				keys_wipe( user, sizeof( *user ) );
+				strcpy( user->name, name );
+				user->in_use = true;
+			}
+		}
+		return user;
+	}
+
+	static bool keys_name_valid( const char * name )
+	{
+		size_t len = ( name != NULL ) ? strlen( name ) : 0U;
+
+		return ( len > 0U ) && ( len <= SNMP_V3_MAX_USER_LENGTH ) &&
+			   ( strchr( name, '/' ) == NULL ) && ( strchr( name, '=' ) == NULL );
+	}
+
+	/* Is the record localized for the current engine ID? Called with the lock held. */
+	static bool keys_engine_matches( const struct snmpv3_keys_record * record )
+	{
+		const char * engine_id;
+		u8_t engine_id_len;
+
+		snmpv3_get_engine_id( &engine_id, &engine_id_len );
+		return ( record->engine_id_len == engine_id_len ) &&
+			   ( memcmp( record->engine_id, engine_id, engine_id_len ) == 0 );
+	}
+
+	static bool keys_ready( const struct snmpv3_keys_user * user )
+	{
+		return user->in_use && user->has_keys && !user->pending && keys_engine_matches( &user->record );
+	}
+
+	static void keys_settings_path( char * path, size_t size, const char * name )
+	{
+		snprintf( path, size, KEYS_SETTINGS_ROOT "/%s", name );
+	}
+
+	/* Work on one entry of the key thread, a copy made under the lock. */
+	struct keys_job
+	{
+		struct snmpv3_keys_user * user;
+		u32_t generation;
+		bool derive;
+		snmpv3_auth_algo_t auth_algo;
+		snmpv3_priv_algo_t priv_algo;
+		char auth_password[ SNMP_V3_KEYS_MAX_PASSWORD_LEN ];
+		char priv_password[ SNMP_V3_KEYS_MAX_PASSWORD_LEN ];
+		u8_t auth_password_len;
+		u8_t priv_password_len;
+		u8_t auth_ku[ SNMP_V3_MAX_KEY_LENGTH ];
+		u8_t priv_ku[ SNMP_V3_MAX_KEY_LENGTH ];
+		struct snmpv3_keys_record record;
+	};
+
+	/* Picks the next entry that needs work, returns false when there is none. */
+	static bool keys_next_job( struct keys_job * job )
+	{
+		const char * engine_id;
+		u8_t engine_id_len;
+		size_t i;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		snmpv3_get_engine_id( &engine_id, &engine_id_len );
+
+		for( i = 0; i < ARRAY_SIZE( keys_users ); i++ )
+		{
+			struct snmpv3_keys_user * user = &keys_users[ i ];
+
+			if( !user->in_use || !( user->pending || ( user->has_ku && !keys_ready( user ) ) ) )
+			{
+				continue;
+			}
+
+			job->user       = user;
+			job->generation = user->generation;
+			job->derive     = user->pending;
+			job->auth_algo  = ( snmpv3_auth_algo_t ) user->record.auth_algo;
+			job->priv_algo  = ( snmpv3_priv_algo_t ) user->record.priv_algo;
+			if( job->derive )
+			{
+				memcpy( job->auth_password, user->auth_password, sizeof( job->auth_password ) );
+				memcpy( job->priv_password, user->priv_password, sizeof( job->priv_password ) );
+				job->auth_password_len = user->auth_password_len;
+				job->priv_password_len = user->priv_password_len;
+			}
+			else
+			{
+				memcpy( job->auth_ku, user->auth_ku, sizeof( job->auth_ku ) );
+				memcpy( job->priv_ku, user->priv_ku, sizeof( job->priv_ku ) );
+			}
+
+			job->record.version       = KEYS_RECORD_VERSION;
+			job->record.auth_algo     = ( u8_t ) job->auth_algo;
+			job->record.priv_algo     = ( u8_t ) job->priv_algo;
+			job->record.engine_id_len = engine_id_len;
+			memcpy( job->record.engine_id, engine_id, engine_id_len );
+
+			k_mutex_unlock( &keys_lock );
+			return true;
+		}
+
+		k_mutex_unlock( &keys_lock );
+		return false;
+	}
+
+	/* Derives Ku if needed and localizes it, without the lock. */
+	static err_t keys_run_job( struct keys_job * job )
+	{
+		struct snmpv3_keys_record * record = &job->record;
+		err_t err = ERR_OK;
+
+		if( job->derive && ( job->auth_algo != SNMP_V3_AUTH_ALGO_INVAL ) )
+		{
+			err = snmpv3_password_to_ku( job->auth_algo, ( const u8_t * ) job->auth_password,
+										 job->auth_password_len, job->auth_ku );
+			/* the privacy key is derived with the hash of the auth protocol */
+			if( ( err == ERR_OK ) && ( job->priv_algo != SNMP_V3_PRIV_ALGO_INVAL ) )
+			{
+				err = snmpv3_password_to_ku( job->auth_algo, ( const u8_t * ) job->priv_password,
+											 job->priv_password_len, job->priv_ku );
+			}
+		}
+
+		if( ( err == ERR_OK ) && ( job->auth_algo != SNMP_V3_AUTH_ALGO_INVAL ) )
+		{
+			err = snmpv3_localize_key( job->auth_algo, job->auth_ku, record->engine_id,
+									   record->engine_id_len, record->auth_key );
+			if( ( err == ERR_OK ) && ( job->priv_algo != SNMP_V3_PRIV_ALGO_INVAL ) )
+			{
+				err = snmpv3_localize_key( job->auth_algo, job->priv_ku, record->engine_id,
+										   record->engine_id_len, record->priv_key );
+			}
+		}
+		return err;
+	}
+
+	static void keys_finish_job( struct keys_job * job, err_t err )
+	{
+		struct snmpv3_keys_user * user = job->user;
+		char path[ sizeof( KEYS_SETTINGS_ROOT ) + SNMP_V3_MAX_USER_LENGTH + 1 ];
+		bool save = false;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		if( user->in_use && ( user->generation == job->generation ) )
+		{
+			if( err == ERR_OK )
+			{
+				if( job->derive )
+				{
+					memcpy( user->auth_ku, job->auth_ku, sizeof( user->auth_ku ) );
+					memcpy( user->priv_ku, job->priv_ku, sizeof( user->priv_ku ) );
+					user->has_ku = true;
+				}
+				user->record   = job->record;
+				user->has_keys = true;
+				keys_settings_path( path, sizeof( path ), user->name );
+				save = true;
+			}
+			else
+			{
+				zephyr_log( "snmpv3_keys: no keys for user %s (%d)\n", user->name, ( int ) err );
+				user->has_ku   = false;
+				user->has_keys = false;
+			}
+			/* derived or failed, the passwords are not needed anymore */
+			user->pending = false;
+			keys_wipe( user->auth_password, sizeof( user->auth_password ) );
+			keys_wipe( user->priv_password, sizeof( user->priv_password ) );
+		}
+		k_mutex_unlock( &keys_lock );
+
+		if( save )
+		{
+			int rc = settings_save_one( path, &job->record, sizeof( job->record ) );
+
+			if( rc != 0 )
+			{
+				zephyr_log( "snmpv3_keys: settings_save_one %s: %d\n", path, rc );
+			}
+			snmpv3_users_changed();
+		}
+		keys_wipe( job, sizeof( *job ) );
+	}
+
+	static void keys_thread( void * p1, void * p2, void * p3 )
+	{
+		static struct keys_job job;
+
+		ARG_UNUSED( p1 );
+		ARG_UNUSED( p2 );
+		ARG_UNUSED( p3 );
+
+		for( ; ; )
+		{
+			k_sem_take( &keys_work, K_FOREVER );
+			/* one entry at a time, the lock is released while hashing */
+			while( keys_next_job( &job ) )
+			{
+				keys_finish_job( &job, keys_run_job( &job ) );
+			}
+		}
+	}
+
+	K_THREAD_DEFINE( snmpv3_keys_tid, SNMP_V3_KEYS_STACK_SIZE, keys_thread, NULL, NULL, NULL,
+					 SNMP_V3_KEYS_THREAD_PRIO, 0, 0 );
+
+	static int keys_settings_set( const char * name, size_t len, settings_read_cb read_cb, void * cb_arg )
+	{
+		struct snmpv3_keys_record record;
+		struct snmpv3_keys_user * user;
+		ssize_t rc;
+
+		/* deleted entries and records of another layout are skipped */
+		if( ( len != sizeof( record ) ) || !keys_name_valid( name ) )
+		{
+			return 0;
+		}
+		rc = read_cb( cb_arg, &record, sizeof( record ) );
+		if( ( rc != ( ssize_t ) sizeof( record ) ) || ( record.version != KEYS_RECORD_VERSION ) ||
+			( record.engine_id_len > SNMP_V3_MAX_ENGINE_ID_LENGTH ) )
+		{
+			keys_wipe( &record, sizeof( record ) );
+			return 0;
+		}
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		user = keys_find_or_alloc( name );
+		/* passwords given before settings_load() take precedence */
+		if( ( user != NULL ) && !user->pending && !user->has_ku )
+		{
+			user->record   = record;
+			user->has_keys = true;
+			user->generation++;
+		}
+		k_mutex_unlock( &keys_lock );
+
+		keys_wipe( &record, sizeof( record ) );
+		return 0;
+	}
+
+	static int keys_settings_commit( void )
+	{
+		snmpv3_users_changed();
+		return 0;
+	}
+
+	SETTINGS_STATIC_HANDLER_DEFINE( snmpv3_keys, KEYS_SETTINGS_ROOT, NULL,
+									keys_settings_set, keys_settings_commit, NULL );
+
+	static bool keys_password_valid( const char * password )
+	{
+		size_t len = ( password != NULL ) ? strlen( password ) : 0U;
+
+		return ( len >= KEYS_MIN_PASSWORD_LEN ) && ( len <= SNMP_V3_KEYS_MAX_PASSWORD_LEN );
+	}
+
+	static void keys_copy_password( char * dst, u8_t * dst_len, const char * password )
+	{
+		if( password != NULL )
+		{
+			*dst_len = ( u8_t ) strlen( password );
+			memcpy( dst, password, *dst_len );
+		}
+	}
+
+	int snmpv3_keys_set_user( const char * name,
+							  snmpv3_auth_algo_t auth_algo, const char * auth_password,
+							  snmpv3_priv_algo_t priv_algo, const char * priv_password )
+	{
+		struct snmpv3_keys_user * user;
+		int rc = 0;
+
+		/* priv needs auth, the privacy key is derived with its hash */
+		if( !keys_name_valid( name ) ||
+			( ( auth_algo == SNMP_V3_AUTH_ALGO_INVAL ) && ( priv_algo != SNMP_V3_PRIV_ALGO_INVAL ) ) ||
+			( ( auth_algo != SNMP_V3_AUTH_ALGO_INVAL ) &&
+			  ( ( snmpv3_auth_param_length( auth_algo ) == 0U ) || !keys_password_valid( auth_password ) ) ) ||
+			( ( priv_algo != SNMP_V3_PRIV_ALGO_INVAL ) && !keys_password_valid( priv_password ) ) )
+		{
+			return -EINVAL;
+		}
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		user = keys_find_or_alloc( name );
+		if( user == NULL )
+		{
+			rc = -ENOMEM;
+		}
+		else
+		{
+			keys_wipe( &user->record, sizeof( user->record ) );
+			keys_wipe( user->auth_ku, sizeof( user->auth_ku ) );
+			keys_wipe( user->priv_ku, sizeof( user->priv_ku ) );
+			keys_wipe( user->auth_password, sizeof( user->auth_password ) );
+			keys_wipe( user->priv_password, sizeof( user->priv_password ) );
+			user->auth_password_len = 0U;
+			user->priv_password_len = 0U;
+			user->record.version    = KEYS_RECORD_VERSION;
+			user->record.auth_algo  = ( u8_t ) auth_algo;
+			user->record.priv_algo  = ( u8_t ) priv_algo;
+			user->has_keys          = false;
+			user->has_ku            = false;
+			user->pending           = true;
+			user->generation++;
+			if( auth_algo != SNMP_V3_AUTH_ALGO_INVAL )
+			{
+				keys_copy_password( user->auth_password, &user->auth_password_len, auth_password );
+			}
+			if( priv_algo != SNMP_V3_PRIV_ALGO_INVAL )
+			{
+				keys_copy_password( user->priv_password, &user->priv_password_len, priv_password );
+			}
+		}
+		k_mutex_unlock( &keys_lock );
+
+		if( rc == 0 )
+		{
+			/* the old keys of the user must not be used anymore */
+			snmpv3_users_changed();
+			k_sem_give( &keys_work );
+		}
+		return rc;
+	}
+
+	int snmpv3_keys_remove_user( const char * name )
+	{
+		char path[ sizeof( KEYS_SETTINGS_ROOT ) + SNMP_V3_MAX_USER_LENGTH + 1 ];
+		struct snmpv3_keys_user * user;
+
+		if( !keys_name_valid( name ) )
+		{
+			return -ENOENT;
+		}
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		user = keys_find( name );
+		if( user != NULL )
+		{
+			/* also drops a job of the key thread, by clearing in_use */
+			keys_wipe( user, sizeof( *user ) );
+		}
+		k_mutex_unlock( &keys_lock );
+
+		if( user == NULL )
+		{
+			return -ENOENT;
+		}
+		keys_settings_path( path, sizeof( path ), name );
+		( void ) settings_delete( path );
+		snmpv3_users_changed();
+		return 0;
+	}
+
+	snmpv3_keys_state_t snmpv3_keys_get_state( const char * name )
+	{
+		struct snmpv3_keys_user * user;
+		snmpv3_keys_state_t state = SNMP_V3_KEYS_UNKNOWN;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		user = ( name != NULL ) ? keys_find( name ) : NULL;
+		if( user != NULL )
+		{
+			if( keys_ready( user ) )
+			{
+				state = SNMP_V3_KEYS_READY;
+			}
+			else if( user->pending || user->has_ku )
+			{
+				state = SNMP_V3_KEYS_PENDING;
+			}
+			else
+			{
+				state = SNMP_V3_KEYS_STALE;
+			}
+		}
+		k_mutex_unlock( &keys_lock );
+		return state;
+	}
+
+	void snmpv3_keys_engine_id_changed( void )
+	{
+		/* the key thread compares each entry with the new engine ID */
+		k_sem_give( &keys_work );
+	}
+
+	err_t snmpv3_keys_get_user( const char * username, snmpv3_auth_algo_t * auth_algo, u8_t * auth_key,
+								snmpv3_priv_algo_t * priv_algo, u8_t * priv_key )
+	{
+		struct snmpv3_keys_user * user;
+		err_t err = ERR_VAL;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		user = keys_find( username );
+		if( ( user != NULL ) && keys_ready( user ) )
+		{
+			if( auth_algo != NULL )
+			{
+				*auth_algo = ( snmpv3_auth_algo_t ) user->record.auth_algo;
+			}
+			if( auth_key != NULL )
+			{
+				memcpy( auth_key, user->record.auth_key, sizeof( user->record.auth_key ) );
+			}
+			if( priv_algo != NULL )
+			{
+				*priv_algo = ( snmpv3_priv_algo_t ) user->record.priv_algo;
+			}
+			if( priv_key != NULL )
+			{
+				memcpy( priv_key, user->record.priv_key, sizeof( user->record.priv_key ) );
+			}
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &keys_lock );
+		return err;
+	}
+
+	u8_t snmpv3_keys_get_amount_of_users( void )
+	{
+		u8_t count = 0U;
+		size_t i;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		for( i = 0; i < ARRAY_SIZE( keys_users ); i++ )
+		{
+			if( keys_ready( &keys_users[ i ] ) )
+			{
+				count++;
+			}
+		}
+		k_mutex_unlock( &keys_lock );
+		return count;
+	}
+
+	err_t snmpv3_keys_get_username( char * username, u8_t index )
+	{
+		err_t err = ERR_VAL;
+		size_t i;
+
+		k_mutex_lock( &keys_lock, K_FOREVER );
+		for( i = 0; i < ARRAY_SIZE( keys_users ); i++ )
+		{
+			if( keys_ready( &keys_users[ i ] ) && ( index-- == 0U ) )
+			{
+				strcpy( username, keys_users[ i ].name );
+				err = ERR_OK;
+				break;
+			}
+		}
+		k_mutex_unlock( &keys_lock );
+		return err;
+	}
+
+	err_t snmpv3_keys_get_user_storagetype( const char * username, snmpv3_user_storagetype_t * storagetype )
+	{
+		if( snmpv3_keys_get_state( username ) != SNMP_V3_KEYS_READY )
+		{
+			return ERR_VAL;
+		}
+		*storagetype = SNMP_V3_USER_STORAGETYPE_NONVOLATILE;
+		return ERR_OK;
+	}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && LWIP_SNMP_V3_MBEDTLS && SNMP_V3_KEYS */
@@ -44,152 +44,382 @@
 
 #include "mbedtls/md.h"
 #include "mbedtls/cipher.h"
+#include "mbedtls/aes.h"
 
 #include "mbedtls/md5.h"
 #include "mbedtls/sha1.h"
 
-err_t
-snmpv3_auth(struct snmp_pbuf_stream *stream, u16_t length,
-            const u8_t *key, snmpv3_auth_algo_t algo, u8_t *hmac_out)
+/** Digest of an authentication protocol; the block length is the HMAC pad size */
+static const mbedtls_md_info_t *
+snmpv3_auth_md_info(snmpv3_auth_algo_t algo, u8_t *block_len)
 {
-  u32_t i;
-  u8_t key_len;
+  mbedtls_md_type_t md_type;
+
+  *block_len = 64;
+  switch (algo) {
+    case SNMP_V3_AUTH_ALGO_MD5:
+      md_type = MBEDTLS_MD_MD5;
+      break;
+    case SNMP_V3_AUTH_ALGO_SHA:
+      md_type = MBEDTLS_MD_SHA1;
+      break;
+    case SNMP_V3_AUTH_ALGO_SHA224:
+      md_type = MBEDTLS_MD_SHA224;
+      break;
+    case SNMP_V3_AUTH_ALGO_SHA256:
+      md_type = MBEDTLS_MD_SHA256;
+      break;
+    case SNMP_V3_AUTH_ALGO_SHA384:
+      md_type = MBEDTLS_MD_SHA384;
+      *block_len = 128;
+      break;
+    case SNMP_V3_AUTH_ALGO_SHA512:
+      md_type = MBEDTLS_MD_SHA512;
+      *block_len = 128;
+      break;
+    default:
+      return NULL;
+  }
+
+  /* NULL as well if mbedTLS was built without this hash */
+  return mbedtls_md_info_from_type(md_type);
+}
+
+#if LWIP_SNMP_V3_CRYPTO
+
+#define SNMP_V3_HMAC_MAX_BLOCK_LEN 128
+
+/*
+ * Keyed crypto state of one user cache entry. The HMAC inner and outer
+ * hashes are kept after absorbing the ipad/opad block, so a message costs
+ * two context copies instead of two extra compressions, and the cipher key
+ * schedules are expanded once per user instead of once per message.
+ */
+struct snmpv3_mbedtls_user {
   const mbedtls_md_info_t *md_info;
-  mbedtls_md_context_t ctx;
-  struct snmp_pbuf_stream read_stream;
-  snmp_pbuf_stream_init(&read_stream, stream->pbuf, stream->offset, stream->length);
+  mbedtls_md_context_t hmac_inner;
+  mbedtls_md_context_t hmac_outer;
+  mbedtls_md_context_t hmac_work;
+  mbedtls_cipher_context_t des_enc;
+  mbedtls_cipher_context_t des_dec;
+  u8_t des_pre_iv[8];
+  /*
+   * CFB128 uses the encryption key schedule in both directions. The AES
+   * module is used instead of the cipher layer, so MBEDTLS_AES_ALT
+   * implementations (crypto engines) are used for all key sizes.
+   */
+  mbedtls_aes_context aes;
+};
+
+static struct snmpv3_mbedtls_user snmpv3_mbedtls_users[SNMP_V3_CRYPTO_SLOTS];
+
+static err_t
+snmpv3_hmac_setup(struct snmpv3_mbedtls_user *user, snmpv3_auth_algo_t algo, const u8_t *key)
+{
+  u8_t pad[SNMP_V3_HMAC_MAX_BLOCK_LEN];
+  u8_t block_len;
+  u8_t key_len;
+  u8_t i;
+  err_t err = ERR_ARG;
 
-  if (algo == SNMP_V3_AUTH_ALGO_MD5) {
-    md_info = mbedtls_md_info_from_type(MBEDTLS_MD_MD5);
-    key_len = SNMP_V3_MD5_LEN;
-  } else if (algo == SNMP_V3_AUTH_ALGO_SHA) {
-    md_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA1);
-    key_len = SNMP_V3_SHA_LEN;
-  } else {
+  user->md_info = snmpv3_auth_md_info(algo, &block_len);
+  if (user->md_info == NULL) {
     return ERR_ARG;
   }
+  /* USM keys are as long as the digest, never longer than a block */
+  key_len = mbedtls_md_get_size(user->md_info);
 
-  mbedtls_md_init(&ctx);
-  if (mbedtls_md_setup(&ctx, md_info, 1) != 0) {
+  if ((mbedtls_md_setup(&user->hmac_inner, user->md_info, 0) != 0) ||
+      (mbedtls_md_setup(&user->hmac_outer, user->md_info, 0) != 0) ||
+      (mbedtls_md_setup(&user->hmac_work, user->md_info, 0) != 0)) {
     return ERR_ARG;
   }
 
-  if (mbedtls_md_hmac_starts(&ctx, key, key_len) != 0) {
-    goto free_md;
+  /* RFC 2104: H(K ^ opad, H(K ^ ipad, text)) */
+  memset(pad, 0x36, block_len);
+  for (i = 0; i < key_len; i++) {
+    pad[i] ^= key[i];
+  }
+  if ((mbedtls_md_starts(&user->hmac_inner) != 0) ||
+      (mbedtls_md_update(&user->hmac_inner, pad, block_len) != 0)) {
+    goto out;
+  }
+
+  memset(pad, 0x5c, block_len);
+  for (i = 0; i < key_len; i++) {
+    pad[i] ^= key[i];
+  }
+  if ((mbedtls_md_starts(&user->hmac_outer) != 0) ||
+      (mbedtls_md_update(&user->hmac_outer, pad, block_len) != 0)) {
+    goto out;
   }
+  err = ERR_OK;
 
-  for (i = 0; i < length; i++) {
-    u8_t byte;
+out:
+  memset(pad, 0, sizeof(pad));
+  return err;
+}
 
-    if (snmp_pbuf_stream_read(&read_stream, &byte)) {
-      goto free_md;
+/*
+ * Blumenthal key extension (draft-blumenthal-aes-usm-04 3.1.2.1, as done by
+ * Net-SNMP for AES-192/256): while the localized key is shorter than the
+ * cipher key, append the hash of all key octets so far.
+ */
+static err_t
+snmpv3_priv_key_extend(const mbedtls_md_info_t *md_info, const u8_t *key, u8_t *ext_key, u8_t ext_len)
+{
+  u8_t digest[MBEDTLS_MD_MAX_SIZE];
+  u8_t md_len = mbedtls_md_get_size(md_info);
+  u8_t len = LWIP_MIN(md_len, ext_len);
+  err_t err = ERR_OK;
+
+  MEMCPY(ext_key, key, len);
+  while (len < ext_len) {
+    u8_t n = LWIP_MIN(md_len, (u8_t)(ext_len - len));
+
+    if (mbedtls_md(md_info, ext_key, len, digest) != 0) {
+      err = ERR_ARG;
+      break;
     }
+    MEMCPY(&ext_key[len], digest, n);
+    len = (u8_t)(len + n);
+  }
 
-    if (mbedtls_md_hmac_update(&ctx, &byte, 1) != 0) {
-      goto free_md;
+  memset(digest, 0, sizeof(digest));
+  return err;
+}
+
+static err_t
+snmpv3_cipher_setup(struct snmpv3_mbedtls_user *user, snmpv3_priv_algo_t algo, const u8_t *key)
+{
+  if (algo == SNMP_V3_PRIV_ALGO_DES) {
+    const mbedtls_cipher_info_t *cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_DES_CBC);
+
+    if ((mbedtls_cipher_setup(&user->des_enc, cipher_info) != 0) ||
+        (mbedtls_cipher_setup(&user->des_dec, cipher_info) != 0) ||
+        (mbedtls_cipher_set_padding_mode(&user->des_enc, MBEDTLS_PADDING_NONE) != 0) ||
+        (mbedtls_cipher_set_padding_mode(&user->des_dec, MBEDTLS_PADDING_NONE) != 0) ||
+        (mbedtls_cipher_setkey(&user->des_enc, key, 8 * 8, MBEDTLS_ENCRYPT) != 0) ||
+        (mbedtls_cipher_setkey(&user->des_dec, key, 8 * 8, MBEDTLS_DECRYPT) != 0)) {
+      return ERR_ARG;
     }
+    /* the second half of the key is the pre-IV, RFC 3414 8.1.1.1 */
+    SMEMCPY(user->des_pre_iv, key + 8, sizeof(user->des_pre_iv));
+  } else if ((algo == SNMP_V3_PRIV_ALGO_AES) || (algo == SNMP_V3_PRIV_ALGO_AES192) ||
+             (algo == SNMP_V3_PRIV_ALGO_AES256)) {
+    u8_t ext_key[32];
+    u8_t key_len = (algo == SNMP_V3_PRIV_ALGO_AES) ? 16 : ((algo == SNMP_V3_PRIV_ALGO_AES192) ? 24 : 32);
+    int ret;
+
+    /* the localized key is as long as the digest of the auth protocol */
+    if ((user->md_info == NULL) ||
+        (snmpv3_priv_key_extend(user->md_info, key, ext_key, key_len) != ERR_OK)) {
+      return ERR_ARG;
+    }
+    ret = mbedtls_aes_setkey_enc(&user->aes, ext_key, key_len * 8);
+    memset(ext_key, 0, sizeof(ext_key));
+    if (ret != 0) {
+      /* e.g. MBEDTLS_AES_ONLY_128_BIT_KEY_LENGTH */
+      return ERR_ARG;
+    }
+  } else {
+    return ERR_ARG;
   }
 
-  if (mbedtls_md_hmac_finish(&ctx, hmac_out) != 0) {
-    goto free_md;
+  return ERR_OK;
+}
+
+/** Key the HMAC and cipher contexts of a user cache slot */
+err_t
+snmpv3_crypto_user_setup(u8_t slot, snmpv3_auth_algo_t auth_algo, const u8_t *auth_key,
+                         snmpv3_priv_algo_t priv_algo, const u8_t *priv_key)
+{
+  struct snmpv3_mbedtls_user *user = &snmpv3_mbedtls_users[slot];
+
+  snmpv3_crypto_user_release(slot);
+  mbedtls_md_init(&user->hmac_inner);
+  mbedtls_md_init(&user->hmac_outer);
+  mbedtls_md_init(&user->hmac_work);
+  mbedtls_cipher_init(&user->des_enc);
+  mbedtls_cipher_init(&user->des_dec);
+  mbedtls_aes_init(&user->aes);
+
+  if ((auth_algo != SNMP_V3_AUTH_ALGO_INVAL) &&
+      (snmpv3_hmac_setup(user, auth_algo, auth_key) != ERR_OK)) {
+    return ERR_ARG;
+  }
+  if ((priv_algo != SNMP_V3_PRIV_ALGO_INVAL) &&
+      (snmpv3_cipher_setup(user, priv_algo, priv_key) != ERR_OK)) {
+    return ERR_ARG;
   }
 
-  mbedtls_md_free(&ctx);
   return ERR_OK;
+}
 
-free_md:
-  mbedtls_md_free(&ctx);
-  return ERR_ARG;
+/** Free the contexts of a user cache slot and wipe its key material */
+void
+snmpv3_crypto_user_release(u8_t slot)
+{
+  struct snmpv3_mbedtls_user *user = &snmpv3_mbedtls_users[slot];
+
+  mbedtls_md_free(&user->hmac_inner);
+  mbedtls_md_free(&user->hmac_outer);
+  mbedtls_md_free(&user->hmac_work);
+  mbedtls_cipher_free(&user->des_enc);
+  mbedtls_cipher_free(&user->des_dec);
+  mbedtls_aes_free(&user->aes);
+  memset(user, 0, sizeof(*user));
 }
 
-#if LWIP_SNMP_V3_CRYPTO
+err_t
+snmpv3_auth(const struct snmpv3_user_cache_entry *user_entry, struct snmp_pbuf_stream *stream,
+            u16_t length, u8_t *hmac_out)
+{
+  struct snmpv3_mbedtls_user *user = &snmpv3_mbedtls_users[user_entry->slot];
+  u8_t digest[MBEDTLS_MD_MAX_SIZE];
+  struct snmp_pbuf_stream read_stream;
+  snmp_pbuf_stream_init(&read_stream, stream->pbuf, stream->offset, stream->length);
+
+  if ((user_entry->auth_algo == SNMP_V3_AUTH_ALGO_INVAL) || (user->md_info == NULL)) {
+    return ERR_ARG;
+  }
+
+  /* inner hash, starting from the state after the ipad block */
+  if (mbedtls_md_clone(&user->hmac_work, &user->hmac_inner) != 0) {
+    return ERR_ARG;
+  }
+
+  /* one update per contiguous pbuf segment */
+  while (length > 0) {
+    u8_t *chunk;
+    u16_t chunk_len;
+
+    if (snmp_pbuf_stream_get_chunk(&read_stream, &chunk, &chunk_len, length) != ERR_OK) {
+      return ERR_ARG;
+    }
+
+    if (mbedtls_md_update(&user->hmac_work, chunk, chunk_len) != 0) {
+      return ERR_ARG;
+    }
+    length = (u16_t)(length - chunk_len);
+  }
+
+  if (mbedtls_md_finish(&user->hmac_work, digest) != 0) {
+    return ERR_ARG;
+  }
+
+  /* outer hash, starting from the state after the opad block */
+  if ((mbedtls_md_clone(&user->hmac_work, &user->hmac_outer) != 0) ||
+      (mbedtls_md_update(&user->hmac_work, digest, mbedtls_md_get_size(user->md_info)) != 0) ||
+      (mbedtls_md_finish(&user->hmac_work, hmac_out) != 0)) {
+    return ERR_ARG;
+  }
+
+  return ERR_OK;
+}
 
 err_t
-snmpv3_crypt(struct snmp_pbuf_stream *stream, u16_t length,
-             const u8_t *key, const u8_t *priv_param, const u32_t engine_boots,
-             const u32_t engine_time, snmpv3_priv_algo_t algo, snmpv3_priv_mode_t mode)
+snmpv3_crypt(const struct snmpv3_user_cache_entry *user_entry, struct snmp_pbuf_stream *stream,
+             u16_t length, const u8_t *priv_param, const u32_t engine_boots,
+             const u32_t engine_time, snmpv3_priv_mode_t mode)
 {
+  struct snmpv3_mbedtls_user *user = &snmpv3_mbedtls_users[user_entry->slot];
   size_t i;
-  mbedtls_cipher_context_t ctx;
-  const mbedtls_cipher_info_t *cipher_info;
 
   struct snmp_pbuf_stream read_stream;
-  struct snmp_pbuf_stream write_stream;
   snmp_pbuf_stream_init(&read_stream, stream->pbuf, stream->offset, stream->length);
-  snmp_pbuf_stream_init(&write_stream, stream->pbuf, stream->offset, stream->length);
-  mbedtls_cipher_init(&ctx);
 
-  if (algo == SNMP_V3_PRIV_ALGO_DES) {
+  if (user_entry->priv_algo == SNMP_V3_PRIV_ALGO_DES) {
+    mbedtls_cipher_context_t *ctx = (mode == SNMP_V3_PRIV_MODE_ENCRYPT) ? &user->des_enc : &user->des_dec;
     u8_t iv_local[8];
-    u8_t out_bytes[8];
+    u8_t block[8];
+    u8_t block_len = 0;
     size_t out_len;
+    struct snmp_pbuf_stream write_stream;
 
     /* RFC 3414 mandates padding for DES */
     if ((length & 0x07) != 0) {
       return ERR_ARG;
     }
 
-    cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_DES_CBC);
-    if (mbedtls_cipher_setup(&ctx, cipher_info) != 0) {
-      return ERR_ARG;
-    }
-    if (mbedtls_cipher_set_padding_mode(&ctx, MBEDTLS_PADDING_NONE) != 0) {
-      return ERR_ARG;
-    }
-    if (mbedtls_cipher_setkey(&ctx, key, 8 * 8, (mode == SNMP_V3_PRIV_MODE_ENCRYPT) ? MBEDTLS_ENCRYPT : MBEDTLS_DECRYPT) != 0) {
-      goto error;
-    }
-
     /* Prepare IV */
     for (i = 0; i < LWIP_ARRAYSIZE(iv_local); i++) {
-      iv_local[i] = priv_param[i] ^ key[i + 8];
+      iv_local[i] = priv_param[i] ^ user->des_pre_iv[i];
     }
-    if (mbedtls_cipher_set_iv(&ctx, iv_local, LWIP_ARRAYSIZE(iv_local)) != 0) {
-      goto error;
+    if ((mbedtls_cipher_set_iv(ctx, iv_local, LWIP_ARRAYSIZE(iv_local)) != 0) ||
+        (mbedtls_cipher_reset(ctx) != 0)) {
+      return ERR_ARG;
     }
 
-    for (i = 0; i < length; i += 8) {
-      size_t j;
-      u8_t in_bytes[8];
-      out_len = LWIP_ARRAYSIZE(out_bytes) ;
+    /*
+     * Whole blocks are processed in place, one update per pbuf segment. A block
+     * straddling two segments is gathered in block[] and written back once
+     * complete, so the cipher never holds back unprocessed input and in-place
+     * operation stays safe.
+     */
+    while (length > 0) {
+      u8_t *chunk;
+      u16_t chunk_len;
+      u16_t n;
 
-      for (j = 0; j < LWIP_ARRAYSIZE(in_bytes); j++) {
-        if (snmp_pbuf_stream_read(&read_stream, &in_bytes[j]) != ERR_OK) {
-          goto error;
-        }
+      if (snmp_pbuf_stream_get_chunk(&read_stream, &chunk, &chunk_len, length) != ERR_OK) {
+        return ERR_ARG;
       }
+      length = (u16_t)(length - chunk_len);
+
+      if (block_len > 0) {
+        n = LWIP_MIN(chunk_len, (u16_t)(sizeof(block) - block_len));
+        MEMCPY(&block[block_len], chunk, n);
+        block_len = (u8_t)(block_len + n);
+        chunk     += n;
+        chunk_len  = (u16_t)(chunk_len - n);
+        if (block_len < sizeof(block)) {
+          continue;
+        }
 
-      if (mbedtls_cipher_update(&ctx, in_bytes, LWIP_ARRAYSIZE(in_bytes), out_bytes, &out_len) != 0) {
-        goto error;
+        out_len = sizeof(block);
+        if (mbedtls_cipher_update(ctx, block, sizeof(block), block, &out_len) != 0) {
+          return ERR_ARG;
+        }
+        if (snmp_pbuf_stream_writebuf(&write_stream, block, sizeof(block)) != ERR_OK) {
+          return ERR_ARG;
+        }
+        block_len = 0;
       }
 
-      if (snmp_pbuf_stream_writebuf(&write_stream, out_bytes, (u16_t)out_len) != ERR_OK) {
-        goto error;
+      n = (u16_t)(chunk_len & ~0x07);
+      if (n > 0) {
+        out_len = n;
+        if (mbedtls_cipher_update(ctx, chunk, n, chunk, &out_len) != 0) {
+          return ERR_ARG;
+        }
       }
-    }
 
-    out_len = LWIP_ARRAYSIZE(out_bytes);
-    if (mbedtls_cipher_finish(&ctx, out_bytes, &out_len) != 0) {
-      goto error;
+      if (chunk_len > n) {
+        block_len = (u8_t)(chunk_len - n);
+        MEMCPY(block, &chunk[n], block_len);
+        snmp_pbuf_stream_init(&write_stream, stream->pbuf, read_stream.offset - block_len, sizeof(block));
+      }
     }
 
-    if (snmp_pbuf_stream_writebuf(&write_stream, out_bytes, (u16_t)out_len) != ERR_OK) {
-      goto error;
-    }
-  } else if (algo == SNMP_V3_PRIV_ALGO_AES) {
-    u8_t iv_local[16];
-
-    cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_CFB128);
-    if (mbedtls_cipher_setup(&ctx, cipher_info) != 0) {
+    out_len = sizeof(block);
+    if (mbedtls_cipher_finish(ctx, block, &out_len) != 0) {
       return ERR_ARG;
     }
-    if (mbedtls_cipher_setkey(&ctx, key, 16 * 8, (mode == SNMP_V3_PRIV_MODE_ENCRYPT) ? MBEDTLS_ENCRYPT : MBEDTLS_DECRYPT) != 0) {
-      goto error;
-    }
+  } else if ((user_entry->priv_algo == SNMP_V3_PRIV_ALGO_AES) ||
+             (user_entry->priv_algo == SNMP_V3_PRIV_ALGO_AES192) ||
+             (user_entry->priv_algo == SNMP_V3_PRIV_ALGO_AES256)) {
+    /*
+     * The cipher layer refuses in-place updates that are not a multiple of
+     * the block size, so CFB128 goes through the AES module directly.
+     */
+    u8_t iv_local[16];
+    size_t iv_off = 0;
+    int aes_mode = (mode == SNMP_V3_PRIV_MODE_ENCRYPT) ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT;
 
     /*
      * IV is the big endian concatenation of boots,
-     * uptime and priv param - see RFC3826.
+     * uptime and priv param - see RFC3826. The same for AES-192/256.
      */
     iv_local[0 + 0] = (engine_boots >> 24) & 0xFF;
     iv_local[0 + 1] = (engine_boots >> 16) & 0xFF;
@@ -200,34 +430,22 @@ snmpv3_crypt(struct snmp_pbuf_stream *stream, u16_t length,
     iv_local[4 + 2] = (engine_time  >>  8) & 0xFF;
     iv_local[4 + 3] = (engine_time  >>  0) & 0xFF;
     SMEMCPY(iv_local + 8, priv_param, 8);
-    if (mbedtls_cipher_set_iv(&ctx, iv_local, LWIP_ARRAYSIZE(iv_local)) != 0) {
-      goto error;
-    }
 
-    for (i = 0; i < length; i++) {
-      u8_t in_byte;
-      u8_t out_byte;
-      size_t out_len = sizeof(out_byte);
+    /* CFB is a stream mode: encrypt/decrypt each pbuf segment in place */
+    while (length > 0) {
+      u8_t *chunk;
+      u16_t chunk_len;
 
-      if (snmp_pbuf_stream_read(&read_stream, &in_byte) != ERR_OK) {
-        goto error;
-      }
-      if (mbedtls_cipher_update(&ctx, &in_byte, sizeof(in_byte), &out_byte, &out_len) != 0) {
-        goto error;
-      }
-      if (snmp_pbuf_stream_write(&write_stream, out_byte) != ERR_OK) {
-        goto error;
+      if ((snmp_pbuf_stream_get_chunk(&read_stream, &chunk, &chunk_len, length) != ERR_OK) ||
+          (mbedtls_aes_crypt_cfb128(&user->aes, aes_mode, chunk_len, &iv_off, iv_local, chunk, chunk) != 0)) {
+        return ERR_ARG;
       }
+      length = (u16_t)(length - chunk_len);
     }
   } else {
     return ERR_ARG;
   }
 
-  mbedtls_cipher_free(&ctx);
-  return ERR_OK;
-
-error:
-  mbedtls_cipher_free(&ctx);
   return ERR_OK;
 }
 
@@ -339,4 +557,119 @@ snmpv3_password_to_key_sha(
   return;
 }
 
+/**
+ * First step of the password to key algorithm for any authentication protocol
+ * (RFC 3414 A.2, with the hash of the protocol as in RFC 7860 9.3): hash one
+ * Megabyte of the repeated password. The result Ku does not depend on the
+ * engine ID and is as long as the digest (16 ... 64 octets).
+ */
+err_t
+snmpv3_password_to_ku(
+  snmpv3_auth_algo_t algo, /* IN  - hash of the authentication protocol */
+  const u8_t *password,    /* IN */
+  size_t      passwordlen, /* IN */
+  u8_t       *ku)          /* OUT - pointer to caller buffer of the digest size */
+{
+  const mbedtls_md_info_t *md_info;
+  mbedtls_md_context_t ctx;
+  u8_t password_buf[64];
+  u32_t password_index = 0;
+  u32_t count = 0;
+  u8_t block_len;
+  u8_t i;
+  err_t err = ERR_ARG;
+
+  md_info = snmpv3_auth_md_info(algo, &block_len);
+  if ((md_info == NULL) || (passwordlen == 0)) {
+    return ERR_ARG;
+  }
+
+  mbedtls_md_init(&ctx);
+  if ((mbedtls_md_setup(&ctx, md_info, 0) != 0) ||
+      (mbedtls_md_starts(&ctx) != 0)) {
+    goto free_md;
+  }
+
+  /* hash 1 Megabyte of the repeated password */
+  while (count < 1048576) {
+    for (i = 0; i < sizeof(password_buf); i++) {
+      password_buf[i] = password[password_index++ % passwordlen];
+    }
+    if (mbedtls_md_update(&ctx, password_buf, sizeof(password_buf)) != 0) {
+      goto free_md;
+    }
+    count += sizeof(password_buf);
+  }
+  if (mbedtls_md_finish(&ctx, ku) == 0) {
+    err = ERR_OK;
+  }
+
+free_md:
+  mbedtls_md_free(&ctx);
+  memset(password_buf, 0, sizeof(password_buf));
+  return err;
+}
+
+/**
+ * Second step of the password to key algorithm: localize Ku for an engine,
+ * key = H(Ku | engineID | Ku). key may be the same buffer as ku.
+ */
+err_t
+snmpv3_localize_key(
+  snmpv3_auth_algo_t algo, /* IN  - hash of the authentication protocol */
+  const u8_t *ku,          /* IN  - result of snmpv3_password_to_ku() */
+  const u8_t *engineID,    /* IN  - pointer to snmpEngineID  */
+  u8_t        engineLength,/* IN  - length of snmpEngineID */
+  u8_t       *key)         /* OUT - pointer to caller buffer of the digest size */
+{
+  const mbedtls_md_info_t *md_info;
+  mbedtls_md_context_t ctx;
+  u8_t block_len;
+  u8_t key_len;
+  err_t err = ERR_ARG;
+
+  md_info = snmpv3_auth_md_info(algo, &block_len);
+  if (md_info == NULL) {
+    return ERR_ARG;
+  }
+  key_len = mbedtls_md_get_size(md_info);
+
+  mbedtls_md_init(&ctx);
+  if ((mbedtls_md_setup(&ctx, md_info, 0) == 0) &&
+      (mbedtls_md_starts(&ctx) == 0) &&
+      (mbedtls_md_update(&ctx, ku, key_len) == 0) &&
+      (mbedtls_md_update(&ctx, engineID, engineLength) == 0) &&
+      (mbedtls_md_update(&ctx, ku, key_len) == 0) &&
+      (mbedtls_md_finish(&ctx, key) == 0)) {
+    err = ERR_OK;
+  }
+  mbedtls_md_free(&ctx);
+  return err;
+}
+
+/**
+ * Password to key for any authentication protocol: snmpv3_password_to_ku()
+ * followed by snmpv3_localize_key().
+ * The key is as long as the digest (16 ... 64 octets).
+ */
+err_t
+snmpv3_password_to_key(
+  snmpv3_auth_algo_t algo, /* IN  - hash of the authentication protocol */
+  const u8_t *password,    /* IN */
+  size_t      passwordlen, /* IN */
+  const u8_t *engineID,    /* IN  - pointer to snmpEngineID  */
+  u8_t        engineLength,/* IN  - length of snmpEngineID */
+  u8_t       *key)         /* OUT - pointer to caller buffer of the digest size */
+{
+  u8_t ku[SNMP_V3_MAX_KEY_LENGTH];
+  err_t err;
+
+  err = snmpv3_password_to_ku(algo, password, passwordlen, ku);
+  if (err == ERR_OK) {
+    err = snmpv3_localize_key(algo, ku, engineID, engineLength, key);
+  }
+  memset(ku, 0, sizeof(ku));
+  return err;
+}
+
 #endif /* LWIP_SNMP && LWIP_SNMP_V3 && LWIP_SNMP_V3_MBEDTLS */
@@ -0,0 +1,975 @@
+/**
+ * @file
+ * SNMPv3 notification originator: TRAPs and INFORMs with USM
+ * authentication and privacy (RFC 3413 3.2, RFC 3414).
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * The PDU fields after the request-id, shared with the SNMPv2c targets,
+ * are encoded once by snmp_traps.c. For each SNMPv3 target they are
+ * copied behind the message header and security parameters of its user,
+ * then the scoped PDU is encrypted and the message authenticated in place:
+ * one cipher and one HMAC pass with the keyed contexts of the user.
+ *
+ * TRAPs come from the local engine, which is authoritative: the user of
+ * the target is resolved through the user cache like the user of a
+ * request. INFORMs are sent to the engine of the receiver, which is
+ * authoritative instead. Its engine ID and clock are kept in the remote
+ * engine cache of snmpv3_remote.c, together with the user keyed for it.
+ * The keys are localized from the Ku of snmpv3_set_inform_keys() once per
+ * discovered engine ID.
+ *
+ * An INFORM to an engine that is not known yet is held while the engine is
+ * discovered (RFC 3414 4): a noAuthNoPriv GetRequest gets the engine ID
+ * from a usmStatsUnknownEngineIDs REPORT, then, at the auth levels, an
+ * authenticated GetRequest with boots and time 0 gets the clock from an
+ * authenticated usmStatsNotInTimeWindows REPORT. Both use the msgID of the
+ * held INFORM. With SNMP_INFORM_PENDING the probes are retransmitted like
+ * the INFORM itself; without it a lost probe is repeated by the next
+ * INFORM to the target. A target holds one INFORM, a newer one replaces it.
+ *
+ * Threads: the state of the targets, the remote engine cache and the
+ * crypto slots of the remote users are only used with the SNMP core
+ * locked (snmp_core_lock()). snmpv3_notify_send() runs inside the senders
+ * of snmp_traps.c, which lock it, snmpv3_notify_receive() on the agent
+ * thread while it handles a message, and snmpv3_set_inform_keys() and the
+ * user and engine changes lock it themselves.
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS /* don't build if not configured for use in lwipopts.h */
+
+#if SNMP_V3_REMOTE_ENGINES == 0
+#error "SNMP_V3_NOTIFICATIONS needs SNMP_V3_REMOTE_ENGINES > 0"
+#endif
+
+#include <string.h>
+
+#include "lwip/apps/snmp.h"
+#include "lwip/apps/snmp_core.h"
+#include "lwip/apps/snmp_inform.h"
+#include "lwip/apps/snmpv3.h"
+#include "lwip/sys.h"
+#include "snmp_asn1.h"
+#include "snmp_core_priv.h"
+#include "snmp_msg.h"
+#include "snmp_pbuf_stream.h"
+#include "snmpv3_priv.h"
+
+/* our msgMaxSize, the largest message we send */
+#define SNMP_V3_NOTIFY_MAX_SIZE    1472
+/* msgSecurityModel of the USM */
+#define SNMP_V3_NOTIFY_USM         3
+
+/* msgFlags */
+#define SNMP_V3_NOTIFY_AUTH        0x01
+#define SNMP_V3_NOTIFY_PRIV        0x02
+#define SNMP_V3_NOTIFY_REPORTABLE  0x04
+
+/* discovery state of a target */
+#define SNMP_V3_NOTIFY_IDLE        0
+/* waiting for the REPORT with the engine ID */
+#define SNMP_V3_NOTIFY_ENGINE_ID   1
+/* waiting for the authenticated REPORT with boots and time */
+#define SNMP_V3_NOTIFY_TIME        2
+
+struct snmpv3_notify_target {
+  /* the INFORM user, keys from snmpv3_password_to_ku() */
+  snmpv3_auth_algo_t auth_algo;
+  snmpv3_priv_algo_t priv_algo;
+  u8_t auth_ku[SNMP_V3_MAX_KEY_LENGTH];
+  u8_t priv_ku[SNMP_V3_MAX_KEY_LENGTH];
+  /* INFORMs were sent, messages of the receiver are expected */
+  u8_t active;
+  u8_t state;
+  /* the INFORM held during the discovery, its fields after the request-id */
+  struct pbuf *held;
+  s32_t held_id;
+  /* the completion callback of the held INFORM */
+  snmp_inform_done_fct held_done;
+  void *held_done_arg;
+  /* held_id is tracked by snmp_inform.c */
+  u8_t tracked;
+};
+
+/* The fields of an outbound message */
+struct snmpv3_notify_msg {
+  /* msgID and request-id */
+  s32_t msg_id;
+  u8_t flags;
+  u8_t pdu_type;
+  /* msgAuthoritativeEngineID, -Boots and -Time */
+  const u8_t *engine_id;
+  u8_t engine_id_len;
+  s32_t boots;
+  s32_t time;
+  const u8_t *user;
+  u8_t user_len;
+  /* keyed crypto contexts, for the auth levels */
+  const struct snmpv3_user_cache_entry *keys;
+  const u8_t *context_engine_id;
+  u8_t context_engine_id_len;
+};
+
+/* The header fields of an inbound message */
+struct snmpv3_notify_header {
+  s32_t msg_id;
+  u8_t flags;
+  u8_t engine_id[SNMP_V3_MAX_ENGINE_ID_LENGTH];
+  u16_t engine_id_len;
+  s32_t boots;
+  s32_t time;
+  u8_t auth[SNMP_V3_MAX_AUTH_PARAM_LENGTH];
+  u16_t auth_len;
+  u16_t auth_offset;
+  u8_t priv[SNMP_V3_MAX_PRIV_PARAM_LENGTH];
+  u16_t priv_len;
+  /* positioned at the scoped PDU */
+  struct snmp_pbuf_stream stream;
+};
+
+/* the fields after the request-id of a discovery GetRequest: error status,
+ * error index, no variable bindings */
+static const u8_t snmpv3_notify_empty_body[] = { 0x02, 0x01, 0x00, 0x02, 0x01, 0x00, 0x30, 0x00 };
+
+static struct snmpv3_notify_target snmpv3_notify_targets[SNMP_TRAP_DESTINATIONS];
+static u8_t snmpv3_notify_active;
+
+#define NOTIFY_BUILD_EXEC(code) do { if ((code) != ERR_OK) { goto fail; } } while (0)
+#define NOTIFY_EXPECT(cond) do { if (!(cond)) { return 0; } } while (0)
+
+/** Length of a TLV with a value of value_len octets */
+static u16_t
+snmpv3_notify_tlv_len(u16_t value_len)
+{
+  u8_t length_len;
+
+  snmp_asn1_enc_length_cnt(value_len, &length_len);
+  return (u16_t)(1 + length_len + value_len);
+}
+
+static u16_t
+snmpv3_notify_int_len(s32_t value)
+{
+  u16_t len;
+
+  snmp_asn1_enc_s32t_cnt(value, &len);
+  return snmpv3_notify_tlv_len(len);
+}
+
+static err_t
+snmpv3_notify_enc_head(struct snmp_pbuf_stream *stream, u8_t type, u16_t value_len)
+{
+  struct snmp_asn1_tlv tlv;
+
+  SNMP_ASN1_SET_TLV_PARAMS(tlv, type, 0, value_len);
+  return snmp_ans1_enc_tlv(stream, &tlv);
+}
+
+static err_t
+snmpv3_notify_enc_octets(struct snmp_pbuf_stream *stream, const u8_t *data, u16_t len)
+{
+  if (snmpv3_notify_enc_head(stream, SNMP_ASN1_TYPE_OCTET_STRING, len) != ERR_OK) {
+    return ERR_ARG;
+  }
+  return (len > 0) ? snmp_asn1_enc_raw(stream, data, len) : ERR_OK;
+}
+
+static err_t
+snmpv3_notify_enc_int(struct snmp_pbuf_stream *stream, s32_t value)
+{
+  u16_t len;
+
+  snmp_asn1_enc_s32t_cnt(value, &len);
+  if (snmpv3_notify_enc_head(stream, SNMP_ASN1_TYPE_INTEGER, len) != ERR_OK) {
+    return ERR_ARG;
+  }
+  return snmp_asn1_enc_s32t(stream, len, value);
+}
+
+/**
+ * Encodes a message in a new pbuf: header, security parameters and scoped
+ * PDU, with the fields after the request-id copied from body (the empty
+ * GetRequest fields if NULL). The scoped PDU is encrypted and the message
+ * authenticated as msg->flags ask for.
+ */
+static err_t
+snmpv3_notify_encode(const struct snmpv3_notify_msg *msg, struct pbuf *body, struct pbuf **out)
+{
+  struct snmp_pbuf_stream stream;
+  struct pbuf *p;
+  u16_t body_len = (body != NULL) ? body->tot_len : (u16_t)sizeof(snmpv3_notify_empty_body);
+  u16_t pdu_len, scoped_len, scoped_tlv_len, payload_len;
+  u16_t usm_len, global_len, msg_len, total_len;
+  u16_t crypt_offset = 0;
+  u16_t auth_offset = 0;
+  u8_t auth_len = 0;
+  u8_t pad = 0;
+  u8_t priv_param[SNMP_V3_MAX_PRIV_PARAM_LENGTH];
+  const u8_t zero[SNMP_V3_MAX_AUTH_PARAM_LENGTH] = { 0 };
+
+#if LWIP_SNMP_V3_CRYPTO
+  if (msg->flags & SNMP_V3_NOTIFY_AUTH) {
+    auth_len = snmpv3_auth_param_length(msg->keys->auth_algo);
+  }
+  if (msg->flags & SNMP_V3_NOTIFY_PRIV) {
+    snmpv3_build_priv_param(priv_param);
+  }
+#else
+  if (msg->flags & (SNMP_V3_NOTIFY_AUTH | SNMP_V3_NOTIFY_PRIV)) {
+    return ERR_VAL;
+  }
+#endif
+
+  /* pass 0, the lengths from the inside out */
+  pdu_len = (u16_t)(snmpv3_notify_int_len(msg->msg_id) + body_len);
+  scoped_len = (u16_t)(snmpv3_notify_tlv_len(msg->context_engine_id_len) + snmpv3_notify_tlv_len(0) +
+                       snmpv3_notify_tlv_len(pdu_len));
+  scoped_tlv_len = snmpv3_notify_tlv_len(scoped_len);
+  payload_len = scoped_tlv_len;
+  if (msg->flags & SNMP_V3_NOTIFY_PRIV) {
+    /* padded to the DES block size, like snmp_complete_outbound_frame() */
+    pad = (u8_t)((8 - (scoped_tlv_len & 0x07)) & 0x07);
+    payload_len = snmpv3_notify_tlv_len((u16_t)(scoped_tlv_len + pad));
+  }
+  usm_len = (u16_t)(snmpv3_notify_tlv_len(msg->engine_id_len) + snmpv3_notify_int_len(msg->boots) +
+                    snmpv3_notify_int_len(msg->time) + snmpv3_notify_tlv_len(msg->user_len) +
+                    snmpv3_notify_tlv_len(auth_len) +
+                    snmpv3_notify_tlv_len((msg->flags & SNMP_V3_NOTIFY_PRIV) ? SNMP_V3_MAX_PRIV_PARAM_LENGTH : 0));
+  global_len = (u16_t)(snmpv3_notify_int_len(msg->msg_id) + snmpv3_notify_int_len(SNMP_V3_NOTIFY_MAX_SIZE) +
+                       snmpv3_notify_tlv_len(1) + snmpv3_notify_int_len(SNMP_V3_NOTIFY_USM));
+  msg_len = (u16_t)(snmpv3_notify_int_len(SNMP_VERSION_3) + snmpv3_notify_tlv_len(global_len) +
+                    snmpv3_notify_tlv_len(snmpv3_notify_tlv_len(usm_len)) + payload_len);
+  total_len = snmpv3_notify_tlv_len(msg_len);
+  if (total_len > SNMP_V3_NOTIFY_MAX_SIZE) {
+    return ERR_VAL;
+  }
+
+  p = pbuf_alloc(PBUF_TRANSPORT, total_len, PBUF_RAM);
+  if (p == NULL) {
+    return ERR_MEM;
+  }
+
+  /* pass 1, encode */
+  NOTIFY_BUILD_EXEC(snmp_pbuf_stream_init(&stream, p, 0, total_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_SEQUENCE, msg_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, SNMP_VERSION_3));
+
+  /* msgGlobalData */
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_SEQUENCE, global_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, msg->msg_id));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, SNMP_V3_NOTIFY_MAX_SIZE));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_octets(&stream, &msg->flags, 1));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, SNMP_V3_NOTIFY_USM));
+
+  /* msgSecurityParameters */
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_OCTET_STRING, snmpv3_notify_tlv_len(usm_len)));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_SEQUENCE, usm_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_octets(&stream, msg->engine_id, msg->engine_id_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, msg->boots));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, msg->time));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_octets(&stream, msg->user, msg->user_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_OCTET_STRING, auth_len));
+  auth_offset = stream.offset;
+  if (auth_len > 0) {
+    NOTIFY_BUILD_EXEC(snmp_asn1_enc_raw(&stream, zero, auth_len));
+  }
+  if (msg->flags & SNMP_V3_NOTIFY_PRIV) {
+    NOTIFY_BUILD_EXEC(snmpv3_notify_enc_octets(&stream, priv_param, SNMP_V3_MAX_PRIV_PARAM_LENGTH));
+    NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_OCTET_STRING, (u16_t)(scoped_tlv_len + pad)));
+    crypt_offset = stream.offset;
+  } else {
+    NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_OCTET_STRING, 0));
+  }
+
+  /* scopedPDU */
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_SEQUENCE, scoped_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_octets(&stream, msg->context_engine_id, msg->context_engine_id_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, SNMP_ASN1_TYPE_OCTET_STRING, 0));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_head(&stream, msg->pdu_type, pdu_len));
+  NOTIFY_BUILD_EXEC(snmpv3_notify_enc_int(&stream, msg->msg_id));
+  if (body != NULL) {
+    struct snmp_pbuf_stream body_stream;
+
+    NOTIFY_BUILD_EXEC(snmp_pbuf_stream_init(&body_stream, body, 0, body_len));
+    NOTIFY_BUILD_EXEC(snmp_pbuf_stream_writeto(&body_stream, &stream, body_len));
+  } else {
+    NOTIFY_BUILD_EXEC(snmp_asn1_enc_raw(&stream, snmpv3_notify_empty_body, body_len));
+  }
+  if (pad > 0) {
+    NOTIFY_BUILD_EXEC(snmp_asn1_enc_raw(&stream, zero, pad));
+  }
+
+#if LWIP_SNMP_V3_CRYPTO
+  if (msg->flags & SNMP_V3_NOTIFY_PRIV) {
+    NOTIFY_BUILD_EXEC(snmp_pbuf_stream_init(&stream, p, crypt_offset, (u16_t)(total_len - crypt_offset)));
+    NOTIFY_BUILD_EXEC(snmpv3_crypt(msg->keys, &stream, (u16_t)(scoped_tlv_len + pad), priv_param,
+                                   (u32_t)msg->boots, (u32_t)msg->time, SNMP_V3_PRIV_MODE_ENCRYPT));
+  }
+  if (msg->flags & SNMP_V3_NOTIFY_AUTH) {
+    u8_t hmac[SNMP_V3_MAX_KEY_LENGTH];
+
+    NOTIFY_BUILD_EXEC(snmp_pbuf_stream_init(&stream, p, 0, total_len));
+    NOTIFY_BUILD_EXEC(snmpv3_auth(msg->keys, &stream, total_len, hmac));
+    NOTIFY_BUILD_EXEC(pbuf_take_at(p, hmac, auth_len, auth_offset));
+  }
+#else
+  LWIP_UNUSED_ARG(crypt_offset);
+  LWIP_UNUSED_ARG(auth_offset);
+#endif
+
+  *out = p;
+  return ERR_OK;
+
+fail:
+  pbuf_free(p);
+  return ERR_ARG;
+}
+
+static err_t
+snmpv3_notify_sendto(struct pbuf *p, const struct snmp_target *target)
+{
+  int rc;
+
+  snmp_stats.outpkts++;
+  /* snmp_sendto() wants a network-endian port number */
+  rc = snmp_sendto(snmp_traps_handle, p, &target->ip, htons(target->port));
+  return (rc > 0) ? ERR_OK : ERR_CONN;
+}
+
+/** msgFlags of the security level of a target */
+static u8_t
+snmpv3_notify_level_flags(const struct snmp_target *target)
+{
+  switch (target->security_level) {
+    case SNMP_TARGET_AUTH_PRIV:
+      return SNMP_V3_NOTIFY_AUTH | SNMP_V3_NOTIFY_PRIV;
+    case SNMP_TARGET_AUTH_NOPRIV:
+      return SNMP_V3_NOTIFY_AUTH;
+    default:
+      return 0;
+  }
+}
+
+/** @return 1 if the keys of a user allow the security level of the flags */
+static u8_t
+snmpv3_notify_keys_allow(const struct snmpv3_user_cache_entry *user, u8_t flags)
+{
+  if ((flags & SNMP_V3_NOTIFY_AUTH) && (user->auth_algo == SNMP_V3_AUTH_ALGO_INVAL)) {
+    return 0;
+  }
+  if ((flags & SNMP_V3_NOTIFY_PRIV) && (user->priv_algo == SNMP_V3_PRIV_ALGO_INVAL)) {
+    return 0;
+  }
+  return 1;
+}
+
+/** A TRAP from the local engine, by the local user named by the target */
+static err_t
+snmpv3_notify_send_trap(struct pbuf *body, s32_t request_id, const struct snmp_target *target)
+{
+  struct snmpv3_notify_msg msg;
+  struct snmpv3_user_cache_entry *user;
+  struct pbuf *p;
+  const char *engine_id;
+  u8_t engine_id_len;
+  size_t user_len = strlen(target->security_name);
+  err_t err;
+
+  msg.flags = snmpv3_notify_level_flags(target);
+  user = snmpv3_user_cache_get((const u8_t *)target->security_name, (u8_t)user_len);
+  if ((user == NULL) || !snmpv3_notify_keys_allow(user, msg.flags)) {
+    LWIP_DEBUGF(SNMP_DEBUG, ("snmpv3_notify: no keys of user %s for the security level\n", target->security_name));
+    return ERR_VAL;
+  }
+
+  snmpv3_get_engine_id(&engine_id, &engine_id_len);
+  msg.msg_id = request_id;
+  msg.pdu_type = SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_V2_TRAP;
+  msg.engine_id = (const u8_t *)engine_id;
+  msg.engine_id_len = engine_id_len;
+  msg.boots = snmpv3_get_engine_boots_internal();
+  msg.time = snmpv3_get_engine_time_internal();
+  msg.user = (const u8_t *)target->security_name;
+  msg.user_len = (u8_t)user_len;
+  msg.keys = user;
+  msg.context_engine_id = (const u8_t *)engine_id;
+  msg.context_engine_id_len = engine_id_len;
+
+  err = snmpv3_notify_encode(&msg, body, &p);
+  if (err == ERR_OK) {
+    snmp_stats.outtraps++;
+    err = snmpv3_notify_sendto(p, target);
+    pbuf_free(p);
+  }
+  return err;
+}
+
+/** Keys the INFORM user of a target for the discovered engine ID */
+static err_t
+snmpv3_notify_key_user(struct snmpv3_remote_engine *remote, const struct snmpv3_notify_target *state,
+                       const struct snmp_target *target)
+{
+  u8_t flags = snmpv3_notify_level_flags(target);
+
+  if (flags == 0) {
+    return snmpv3_remote_set_user(remote, target->security_name, SNMP_V3_AUTH_ALGO_INVAL, NULL,
+                                  SNMP_V3_PRIV_ALGO_INVAL, NULL);
+  }
+#if LWIP_SNMP_V3_CRYPTO
+  if ((state->auth_algo == SNMP_V3_AUTH_ALGO_INVAL) ||
+      ((flags & SNMP_V3_NOTIFY_PRIV) && (state->priv_algo == SNMP_V3_PRIV_ALGO_INVAL))) {
+    return ERR_VAL;
+  }
+  return snmpv3_remote_localize_user(remote, target->security_name, state->auth_algo, state->auth_ku,
+                                     (flags & SNMP_V3_NOTIFY_PRIV) ? state->priv_algo : SNMP_V3_PRIV_ALGO_INVAL,
+                                     state->priv_ku);
+#else
+  LWIP_UNUSED_ARG(state);
+  return ERR_VAL;
+#endif
+}
+
+/** @return 1 if INFORMs of a target can be sent to its engine without discovery */
+static u8_t
+snmpv3_notify_remote_ready(const struct snmpv3_remote_engine *remote, const struct snmp_target *target)
+{
+  u8_t flags = snmpv3_notify_level_flags(target);
+
+  if ((remote->engine_id_len == 0) || !remote->user.valid ||
+      (strcmp(remote->user.name, target->security_name) != 0) || !snmpv3_notify_keys_allow(&remote->user, flags)) {
+    return 0;
+  }
+  /* the clock only matters for authenticated messages */
+  return (u8_t)((flags == 0) || snmpv3_remote_is_synchronized(remote));
+}
+
+/** Sends an INFORM, or a discovery probe, to the engine of a target and tracks it */
+static err_t
+snmpv3_notify_send_tracked(struct snmpv3_notify_target *state, const struct snmpv3_notify_msg *msg, struct pbuf *body,
+                           u8_t index, const struct snmp_target *target, snmp_inform_done_fct done, void *done_arg)
+{
+  struct pbuf *p;
+  u8_t update = (u8_t)(state->tracked && (state->held_id == msg->msg_id));
+  err_t err;
+
+  err = snmpv3_notify_encode(msg, body, &p);
+  if (err != ERR_OK) {
+    return err;
+  }
+#if SNMP_INFORM_PENDING
+  /* tracked before an answer can come in */
+  if (update) {
+    snmp_inform_update(msg->msg_id, p);
+  } else {
+    snmp_inform_track(p, index, target, msg->msg_id, done, done_arg);
+  }
+#else
+  LWIP_UNUSED_ARG(done);
+  LWIP_UNUSED_ARG(done_arg);
+#endif
+  err = snmpv3_notify_sendto(p, target);
+#if SNMP_INFORM_PENDING
+  if ((err != ERR_OK) && !update) {
+    snmp_inform_cancel(msg->msg_id, index);
+  }
+#else
+  LWIP_UNUSED_ARG(index);
+#endif
+  /* a replaced message is sent again by snmp_inform_poll() */
+  state->tracked = (u8_t)(update || (err == ERR_OK));
+  pbuf_free(p);
+  return err;
+}
+
+static err_t
+snmpv3_notify_send_inform(struct snmpv3_notify_target *state, struct snmpv3_remote_engine *remote, struct pbuf *body,
+                          s32_t request_id, u8_t index, const struct snmp_target *target,
+                          snmp_inform_done_fct done, void *done_arg)
+{
+  struct snmpv3_notify_msg msg;
+  const char *engine_id;
+  u8_t engine_id_len;
+  err_t err;
+
+  snmpv3_get_engine_id(&engine_id, &engine_id_len);
+  msg.msg_id = request_id;
+  msg.flags = (u8_t)(snmpv3_notify_level_flags(target) | SNMP_V3_NOTIFY_REPORTABLE);
+  msg.pdu_type = SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_INFORM_REQ;
+  msg.engine_id = remote->engine_id;
+  msg.engine_id_len = remote->engine_id_len;
+  snmpv3_remote_get_time(remote, &msg.boots, &msg.time);
+  msg.user = (const u8_t *)remote->user.name;
+  msg.user_len = remote->user.name_len;
+  msg.keys = &remote->user;
+  /* RFC 3413 3.2: the contextEngineID of a notification is our snmpEngineID */
+  msg.context_engine_id = (const u8_t *)engine_id;
+  msg.context_engine_id_len = engine_id_len;
+
+  err = snmpv3_notify_send_tracked(state, &msg, body, index, target, done, done_arg);
+  if (err == ERR_OK) {
+    snmp_stats.outtraps++;
+  }
+  return err;
+}
+
+/**
+ * Sends the discovery probe of the next missing piece: the engine ID, or,
+ * at the auth levels, the clock of the engine.
+ */
+static err_t
+snmpv3_notify_probe(struct snmpv3_notify_target *state, struct snmpv3_remote_engine *remote,
+                    u8_t index, const struct snmp_target *target)
+{
+  struct snmpv3_notify_msg msg;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_id = state->held_id;
+  msg.flags = SNMP_V3_NOTIFY_REPORTABLE;
+  msg.pdu_type = SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_GET_REQ;
+  if (remote->engine_id_len == 0) {
+    state->state = SNMP_V3_NOTIFY_ENGINE_ID;
+  } else {
+    /* RFC 3414 4: answered by an authenticated notInTimeWindow REPORT */
+    state->state = SNMP_V3_NOTIFY_TIME;
+    msg.flags |= SNMP_V3_NOTIFY_AUTH;
+    msg.engine_id = remote->engine_id;
+    msg.engine_id_len = remote->engine_id_len;
+    msg.user = (const u8_t *)remote->user.name;
+    msg.user_len = remote->user.name_len;
+    msg.keys = &remote->user;
+    msg.context_engine_id = remote->engine_id;
+    msg.context_engine_id_len = remote->engine_id_len;
+  }
+  return snmpv3_notify_send_tracked(state, &msg, NULL, index, target, state->held_done, state->held_done_arg);
+}
+
+static void
+snmpv3_notify_release(struct snmpv3_notify_target *state)
+{
+  if (state->held != NULL) {
+    pbuf_free(state->held);
+    state->held = NULL;
+  }
+  state->state = SNMP_V3_NOTIFY_IDLE;
+  state->tracked = 0;
+}
+
+/**
+ * Continues the discovery of a target after a REPORT: keys the user for
+ * the engine ID, then sends the held INFORM or the next probe.
+ */
+static void
+snmpv3_notify_resume(struct snmpv3_notify_target *state, struct snmpv3_remote_engine *remote,
+                     u8_t index, const struct snmp_target *target)
+{
+  err_t err = ERR_OK;
+
+  if (state->held == NULL) {
+    state->state = SNMP_V3_NOTIFY_IDLE;
+    return;
+  }
+  if (!remote->user.valid || (strcmp(remote->user.name, target->security_name) != 0)) {
+    err = snmpv3_notify_key_user(remote, state, target);
+  }
+  if (err == ERR_OK) {
+    if (snmpv3_notify_remote_ready(remote, target)) {
+      (void)snmpv3_notify_send_inform(state, remote, state->held, state->held_id, index, target,
+                                      state->held_done, state->held_done_arg);
+    } else if (state->state != SNMP_V3_NOTIFY_TIME) {
+      (void)snmpv3_notify_probe(state, remote, index, target);
+      return;
+    }
+  }
+  /* sent, or the REPORTs do not get us further: retransmissions of the
+   * last probe time the INFORM out */
+  snmpv3_notify_release(state);
+}
+
+/**
+ * Sends a notification to an SNMPv3 target.
+ *
+ * @param body the PDU fields after the request-id, see snmp_encode_body()
+ * @param inform 1 for an InformRequest-PDU, 0 for an SNMPv2-Trap-PDU
+ * @param request_id the request-id, also used as msgID
+ * @param index slot of the target in snmp_targets
+ * @param target the destination
+ * @param done the completion callback of an INFORM, see snmp_inform_track()
+ * @param done_arg its argument
+ * @return ERR_OK if the message, or the discovery probe of an INFORM, was sent
+ */
+err_t
+snmpv3_notify_send(struct pbuf *body, u8_t inform, s32_t request_id, u8_t index, const struct snmp_target *target,
+                   snmp_inform_done_fct done, void *done_arg)
+{
+  struct snmpv3_notify_target *state = &snmpv3_notify_targets[index];
+  struct snmpv3_remote_engine *remote;
+  err_t err;
+
+  if (!inform) {
+    return snmpv3_notify_send_trap(body, request_id, target);
+  }
+
+  remote = snmpv3_remote_get(&target->ip, target->port);
+  if (remote == NULL) {
+    return ERR_MEM;
+  }
+  if (!state->active) {
+    state->active = 1;
+    snmpv3_notify_active++;
+  }
+
+  if ((remote->engine_id_len != 0) && !snmpv3_notify_remote_ready(remote, target)) {
+    /* engine known, user not keyed for it yet (or any more) */
+    if (snmpv3_notify_key_user(remote, state, target) != ERR_OK) {
+      LWIP_DEBUGF(SNMP_DEBUG, ("snmpv3_notify: no keys of user %s for the security level\n", target->security_name));
+      return ERR_VAL;
+    }
+  }
+  if (snmpv3_notify_remote_ready(remote, target)) {
+    return snmpv3_notify_send_inform(state, remote, body, request_id, index, target, done, done_arg);
+  }
+
+  /* hold the INFORM until the engine is discovered */
+  snmpv3_notify_release(state);
+  pbuf_ref(body);
+  state->held = body;
+  state->held_id = request_id;
+  state->held_done = done;
+  state->held_done_arg = done_arg;
+  err = snmpv3_notify_probe(state, remote, index, target);
+  if (err != ERR_OK) {
+    snmpv3_notify_release(state);
+  }
+  return err;
+}
+
+/**
+ * Decodes the header of an SNMPv3 message up to the scoped PDU, the same
+ * checks as snmp_parse_inbound_frame().
+ * @return 1 if the header is well-formed
+ */
+static u8_t
+snmpv3_notify_parse_header(struct pbuf *p, struct snmpv3_notify_header *hdr)
+{
+  struct snmp_pbuf_stream *stream = &hdr->stream;
+  struct snmp_asn1_tlv tlv;
+  u8_t scratch[SNMP_V3_MAX_USER_LENGTH];
+  u16_t scratch_len;
+  s32_t value;
+  u8_t i;
+
+  NOTIFY_EXPECT(snmp_pbuf_stream_init(stream, p, 0, p->tot_len) == ERR_OK);
+
+  /* message, version 3 */
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT((tlv.type == SNMP_ASN1_TYPE_SEQUENCE) && (tlv.value_len == stream->length));
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, &value) == ERR_OK);
+  NOTIFY_EXPECT(value == SNMP_VERSION_3);
+
+  /* msgGlobalData: msgID, msgMaxSize, msgFlags, msgSecurityModel */
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_SEQUENCE);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, &hdr->msg_id) == ERR_OK);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, &value) == ERR_OK);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT((tlv.type == SNMP_ASN1_TYPE_OCTET_STRING) && (tlv.value_len == 1));
+  NOTIFY_EXPECT(snmp_asn1_dec_raw(stream, tlv.value_len, &hdr->flags, &scratch_len, 1) == ERR_OK);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, &value) == ERR_OK);
+  NOTIFY_EXPECT(value == SNMP_V3_NOTIFY_USM);
+
+  /* msgSecurityParameters */
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_SEQUENCE);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  NOTIFY_EXPECT(snmp_asn1_dec_raw(stream, tlv.value_len, hdr->engine_id, &hdr->engine_id_len,
+                                  SNMP_V3_MAX_ENGINE_ID_LENGTH) == ERR_OK);
+  for (i = 0; i < 2; i++) {
+    NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+    NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+    NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, (i == 0) ? &hdr->boots : &hdr->time) == ERR_OK);
+  }
+  /* msgUserName, the user is the one of the target */
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  NOTIFY_EXPECT(snmp_asn1_dec_raw(stream, tlv.value_len, scratch, &scratch_len, SNMP_V3_MAX_USER_LENGTH) == ERR_OK);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  hdr->auth_offset = stream->offset;
+  NOTIFY_EXPECT(snmp_asn1_dec_raw(stream, tlv.value_len, hdr->auth, &hdr->auth_len, SNMP_V3_MAX_AUTH_PARAM_LENGTH) == ERR_OK);
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+  NOTIFY_EXPECT(snmp_asn1_dec_raw(stream, tlv.value_len, hdr->priv, &hdr->priv_len, SNMP_V3_MAX_PRIV_PARAM_LENGTH) == ERR_OK);
+
+  return 1;
+}
+
+/**
+ * Decodes the scoped PDU up to the request-id.
+ * @return 1 if it is well-formed
+ */
+static u8_t
+snmpv3_notify_parse_pdu(struct snmp_pbuf_stream *stream, u8_t *pdu_type, s32_t *request_id)
+{
+  struct snmp_asn1_tlv tlv;
+  u8_t i;
+
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_SEQUENCE);
+  /* contextEngineID, contextName */
+  for (i = 0; i < 2; i++) {
+    NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+    NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_OCTET_STRING);
+    NOTIFY_EXPECT(snmp_pbuf_stream_seek(stream, tlv.value_len) == ERR_OK);
+  }
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  *pdu_type = tlv.type;
+  NOTIFY_EXPECT(snmp_asn1_dec_tlv(stream, &tlv) == ERR_OK);
+  NOTIFY_EXPECT(tlv.type == SNMP_ASN1_TYPE_INTEGER);
+  NOTIFY_EXPECT(snmp_asn1_dec_s32t(stream, tlv.value_len, request_id) == ERR_OK);
+  return 1;
+}
+
+#if LWIP_SNMP_V3_CRYPTO
+/**
+ * Authenticates a message with the user keyed for the remote engine and
+ * decrypts its scoped PDU in place.
+ * @return 1 if the message is authentic and could be decrypted
+ */
+static u8_t
+snmpv3_notify_unwrap(struct pbuf *p, struct snmpv3_notify_header *hdr, const struct snmpv3_remote_engine *remote)
+{
+  const u8_t zero[SNMP_V3_MAX_AUTH_PARAM_LENGTH] = { 0 };
+  u8_t hmac[SNMP_V3_MAX_KEY_LENGTH];
+  struct snmp_pbuf_stream stream;
+  struct snmp_asn1_tlv tlv;
+
+  if (!remote->user.valid || (remote->user.auth_algo == SNMP_V3_AUTH_ALGO_INVAL) ||
+      (hdr->auth_len != snmpv3_auth_param_length(remote->user.auth_algo))) {
+    snmp_stats.wrongdigests++;
+    return 0;
+  }
+  NOTIFY_EXPECT(pbuf_take_at(p, zero, hdr->auth_len, hdr->auth_offset) == ERR_OK);
+  NOTIFY_EXPECT(snmp_pbuf_stream_init(&stream, p, 0, p->tot_len) == ERR_OK);
+  NOTIFY_EXPECT(snmpv3_auth(&remote->user, &stream, p->tot_len, hmac) == ERR_OK);
+  if (lwip_memcmp_consttime(hdr->auth, hmac, hdr->auth_len) != 0) {
+    snmp_stats.wrongdigests++;
+    return 0;
+  }
+
+  if (hdr->flags & SNMP_V3_NOTIFY_PRIV) {
+    if ((remote->user.priv_algo == SNMP_V3_PRIV_ALGO_INVAL) || (hdr->priv_len != SNMP_V3_MAX_PRIV_PARAM_LENGTH)) {
+      snmp_stats.decryptionerrors++;
+      return 0;
+    }
+    NOTIFY_EXPECT(snmp_asn1_dec_tlv(&hdr->stream, &tlv) == ERR_OK);
+    NOTIFY_EXPECT((tlv.type == SNMP_ASN1_TYPE_OCTET_STRING) && (tlv.value_len <= hdr->stream.length));
+    if (snmpv3_crypt(&remote->user, &hdr->stream, tlv.value_len, hdr->priv, (u32_t)hdr->boots, (u32_t)hdr->time,
+                     SNMP_V3_PRIV_MODE_DECRYPT) != ERR_OK) {
+      snmp_stats.decryptionerrors++;
+      return 0;
+    }
+  }
+  return 1;
+}
+#endif /* LWIP_SNMP_V3_CRYPTO */
+
+/**
+ * Handles the messages of the receivers of our INFORMs: the REPORTs of the
+ * discovery and the responses to the INFORMs. Called by snmp_receive()
+ * before anything else looks at a message.
+ *
+ * @return 1 when the message was handled, 0 when it has to be processed by
+ *         snmp_receive() as usual
+ */
+u8_t
+snmpv3_notify_receive(struct pbuf *p, const ip_addr_t *source_ip)
+{
+  struct snmpv3_notify_header hdr;
+  struct snmpv3_notify_target *state = NULL;
+  struct snmpv3_remote_engine *remote;
+  const struct snmp_target *target = NULL;
+  const char *engine_id;
+  u8_t engine_id_len;
+  u8_t pdu_type;
+  s32_t request_id;
+  u8_t i;
+
+  if (snmpv3_notify_active == 0) {
+    return 0;
+  }
+  for (i = 0; i < SNMP_TRAP_DESTINATIONS; i++) {
+    if (snmpv3_notify_targets[i].active && (snmp_targets[i].version == SNMP_VERSION_3) &&
+        ip_addr_cmp(&snmp_targets[i].ip, source_ip)) {
+      state = &snmpv3_notify_targets[i];
+      target = &snmp_targets[i];
+      break;
+    }
+  }
+  if ((target == NULL) || !snmpv3_notify_parse_header(p, &hdr)) {
+    return 0;
+  }
+  snmpv3_get_engine_id(&engine_id, &engine_id_len);
+  if ((hdr.engine_id_len == 0) ||
+      ((hdr.engine_id_len == engine_id_len) && (memcmp(hdr.engine_id, engine_id, engine_id_len) == 0))) {
+    /* a request to us */
+    return 0;
+  }
+
+  remote = snmpv3_remote_find(&target->ip, target->port);
+  if (remote == NULL) {
+    return 1;
+  }
+
+  if (remote->engine_id_len == 0) {
+    /* the usmStatsUnknownEngineIDs REPORT to our first probe */
+    if ((state->state == SNMP_V3_NOTIFY_ENGINE_ID) && !(hdr.flags & (SNMP_V3_NOTIFY_AUTH | SNMP_V3_NOTIFY_PRIV)) &&
+        snmpv3_notify_parse_pdu(&hdr.stream, &pdu_type, &request_id) &&
+        (pdu_type == (SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_REPORT))) {
+      snmpv3_remote_set_engine_id(remote, hdr.engine_id, (u8_t)hdr.engine_id_len);
+      if (snmpv3_notify_level_flags(target) == 0) {
+        /* good enough for noAuthNoPriv, where the clock is not checked */
+        snmpv3_remote_sync(remote, hdr.boots, hdr.time);
+      }
+      snmpv3_notify_resume(state, remote, i, target);
+    }
+    return 1;
+  }
+  if ((hdr.engine_id_len != remote->engine_id_len) || (memcmp(hdr.engine_id, remote->engine_id, hdr.engine_id_len) != 0)) {
+    return 1;
+  }
+
+  if (hdr.flags & SNMP_V3_NOTIFY_AUTH) {
+#if LWIP_SNMP_V3_CRYPTO
+    if (!snmpv3_notify_unwrap(p, &hdr, remote)) {
+      return 1;
+    }
+#else
+    return 1;
+#endif
+  } else if (hdr.flags & SNMP_V3_NOTIFY_PRIV) {
+    return 1;
+  }
+  if (!snmpv3_notify_parse_pdu(&hdr.stream, &pdu_type, &request_id)) {
+    snmp_stats.inasnparseerrs++;
+    return 1;
+  }
+
+  if (pdu_type == (SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_REPORT)) {
+    if (hdr.flags & SNMP_V3_NOTIFY_AUTH) {
+      /* RFC 3414 3.2.7: an authentic REPORT carries the clock of the engine */
+      snmpv3_remote_sync(remote, hdr.boots, hdr.time);
+      if (state->state == SNMP_V3_NOTIFY_TIME) {
+        snmpv3_notify_resume(state, remote, i, target);
+      }
+    }
+  } else if (pdu_type == (SNMP_ASN1_CLASS_CONTEXT | SNMP_ASN1_CONTENTTYPE_CONSTRUCTED | SNMP_ASN1_CONTEXT_PDU_GET_RESP)) {
+    snmp_stats.ingetresponses++;
+#if SNMP_INFORM_PENDING
+    snmp_inform_response(request_id, source_ip);
+#endif
+  }
+  return 1;
+}
+
+/** The length of Ku, the digest size of the authentication hash */
+static u8_t
+snmpv3_notify_ku_length(snmpv3_auth_algo_t algo)
+{
+  switch (algo) {
+    case SNMP_V3_AUTH_ALGO_MD5:
+      return SNMP_V3_MD5_LEN;
+    case SNMP_V3_AUTH_ALGO_SHA:
+      return SNMP_V3_SHA_LEN;
+    case SNMP_V3_AUTH_ALGO_SHA224:
+      return SNMP_V3_SHA224_LEN;
+    case SNMP_V3_AUTH_ALGO_SHA256:
+      return SNMP_V3_SHA256_LEN;
+    case SNMP_V3_AUTH_ALGO_SHA384:
+      return SNMP_V3_SHA384_LEN;
+    case SNMP_V3_AUTH_ALGO_SHA512:
+      return SNMP_V3_SHA512_LEN;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @ingroup snmpv3
+ * Sets the keys of the user of the SNMPv3 INFORMs of a target, the user
+ * named by its security_name. auth_ku and priv_ku are the engine
+ * independent keys of snmpv3_password_to_ku(), both of the digest size of
+ * auth_algo; they are localized for every engine ID the INFORMs discover.
+ * SNMP_V3_AUTH_ALGO_INVAL clears them.
+ */
+err_t
+snmpv3_set_inform_keys(u8_t target, snmpv3_auth_algo_t auth_algo, const u8_t *auth_ku,
+                       snmpv3_priv_algo_t priv_algo, const u8_t *priv_ku)
+{
+  struct snmpv3_notify_target *state;
+  u8_t ku_len = snmpv3_notify_ku_length(auth_algo);
+
+  if (target >= SNMP_TRAP_DESTINATIONS) {
+    return ERR_ARG;
+  }
+  if (((auth_algo != SNMP_V3_AUTH_ALGO_INVAL) && ((ku_len == 0) || (auth_ku == NULL))) ||
+      ((priv_algo != SNMP_V3_PRIV_ALGO_INVAL) && ((auth_algo == SNMP_V3_AUTH_ALGO_INVAL) || (priv_ku == NULL)))) {
+    return ERR_VAL;
+  }
+
+  SNMP_CORE_LOCK();
+  state = &snmpv3_notify_targets[target];
+  memset(state->auth_ku, 0, sizeof(state->auth_ku));
+  memset(state->priv_ku, 0, sizeof(state->priv_ku));
+  state->auth_algo = auth_algo;
+  state->priv_algo = (auth_algo != SNMP_V3_AUTH_ALGO_INVAL) ? priv_algo : SNMP_V3_PRIV_ALGO_INVAL;
+  if (auth_algo != SNMP_V3_AUTH_ALGO_INVAL) {
+    MEMCPY(state->auth_ku, auth_ku, ku_len);
+  }
+  if (state->priv_algo != SNMP_V3_PRIV_ALGO_INVAL) {
+    MEMCPY(state->priv_ku, priv_ku, ku_len);
+  }
+  /* the users keyed with the old keys are keyed again */
+  snmpv3_remote_users_changed();
+  SNMP_CORE_UNLOCK();
+  return ERR_OK;
+}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_NOTIFICATIONS */
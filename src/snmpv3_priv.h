@@ -40,28 +40,123 @@
 #if LWIP_SNMP && LWIP_SNMP_V3
 
 #include "lwip/apps/snmpv3.h"
+#include "lwip/apps/snmp_inform.h"
 #include "snmp_pbuf_stream.h"
+#include "lwip/ip_addr.h"
 
 /* According to RFC 3411 */
 #define SNMP_V3_MAX_ENGINE_ID_LENGTH  32
 #define SNMP_V3_MAX_USER_LENGTH       32
 
-#define SNMP_V3_MAX_AUTH_PARAM_LENGTH  12
+/* RFC 7860: 48 octets for usmHMAC384SHA512AuthProtocol */
+#define SNMP_V3_MAX_AUTH_PARAM_LENGTH  48
 #define SNMP_V3_MAX_PRIV_PARAM_LENGTH  8
 
 #define SNMP_V3_MD5_LEN        16
 #define SNMP_V3_SHA_LEN        20
+#define SNMP_V3_SHA224_LEN     28
+#define SNMP_V3_SHA256_LEN     32
+#define SNMP_V3_SHA384_LEN     48
+#define SNMP_V3_SHA512_LEN     64
+
+/* localized keys and HMAC digests */
+#define SNMP_V3_MAX_KEY_LENGTH SNMP_V3_SHA512_LEN
 
 typedef enum {
   SNMP_V3_PRIV_MODE_DECRYPT = 0,
   SNMP_V3_PRIV_MODE_ENCRYPT = 1
 } snmpv3_priv_mode_t;
 
+/** A USM user resolved through snmpv3_get_user() and kept between requests */
+struct snmpv3_user_cache_entry {
+  char  name[SNMP_V3_MAX_USER_LENGTH + 1];
+  u8_t  name_len;
+  u8_t  valid;
+  /* index of the entry, selects the crypto contexts of the user */
+  u8_t  slot;
+  snmpv3_auth_algo_t auth_algo;
+  snmpv3_priv_algo_t priv_algo;
+  /* user cache generation the entry was resolved in */
+  u32_t generation;
+  u32_t last_used;
+};
+
+/* the crypto contexts of the user cache, followed by those of the remote engines */
+#define SNMP_V3_CRYPTO_SLOTS (SNMP_V3_USER_CACHE_ENTRIES + SNMP_V3_REMOTE_ENGINES)
+
 s32_t snmpv3_get_engine_boots_internal(void);
-err_t snmpv3_auth(struct snmp_pbuf_stream *stream, u16_t length, const u8_t *key, snmpv3_auth_algo_t algo, u8_t *hmac_out);
-err_t snmpv3_crypt(struct snmp_pbuf_stream *stream, u16_t length, const u8_t *key,
-                   const u8_t *priv_param, const u32_t engine_boots, const u32_t engine_time, snmpv3_priv_algo_t algo, snmpv3_priv_mode_t mode);
+u8_t snmpv3_auth_param_length(snmpv3_auth_algo_t algo);
+struct snmpv3_user_cache_entry *snmpv3_user_cache_get(const u8_t *name, u8_t name_len);
+#if LWIP_SNMP_V3_CRYPTO
+/* implemented by the crypto backend */
+err_t snmpv3_crypto_user_setup(u8_t slot, snmpv3_auth_algo_t auth_algo, const u8_t *auth_key,
+                               snmpv3_priv_algo_t priv_algo, const u8_t *priv_key);
+void snmpv3_crypto_user_release(u8_t slot);
+err_t snmpv3_auth(const struct snmpv3_user_cache_entry *user, struct snmp_pbuf_stream *stream, u16_t length, u8_t *hmac_out);
+err_t snmpv3_crypt(const struct snmpv3_user_cache_entry *user, struct snmp_pbuf_stream *stream, u16_t length,
+                   const u8_t *priv_param, const u32_t engine_boots, const u32_t engine_time, snmpv3_priv_mode_t mode);
+#endif
 err_t snmpv3_build_priv_param(u8_t *priv_param);
+#if SNMP_V3_NOTIFICATIONS
+struct snmp_target;
+err_t snmpv3_notify_send(struct pbuf *body, u8_t inform, s32_t request_id, u8_t index, const struct snmp_target *target,
+                         snmp_inform_done_fct done, void *done_arg);
+u8_t snmpv3_notify_receive(struct pbuf *p, const ip_addr_t *source_ip);
+#endif
+#if SNMP_V3_FAST_DISCOVERY
+u8_t snmpv3_discovery_receive(void *handle, struct pbuf *p, const ip_addr_t *source_ip, u16_t port);
+#endif
+#if SNMP_V3_ENGINE_TIME
+/** snmpEngineBoots and snmpEngineTime of the built-in engine clock, with
+ * their BER encoding as msgAuthoritativeEngineBoots/-Time (two INTEGERs) */
+struct snmpv3_engine_fields {
+  s32_t boots;
+  s32_t time;
+  u8_t  enc_len;
+  u8_t  enc[2 * 6];
+};
+void snmpv3_get_engine_fields(struct snmpv3_engine_fields *fields);
+#endif
+#if SNMP_V3_REMOTE_ENGINES > 0
+/** A remote authoritative engine, the receiver of our INFORMs */
+struct snmpv3_remote_engine {
+  ip_addr_t addr;
+  u16_t port;
+  u8_t  in_use;
+  /* boots and time were taken from the remote engine at sync_ms */
+  u8_t  synchronized;
+  u8_t  engine_id[SNMP_V3_MAX_ENGINE_ID_LENGTH];
+  /* 0 until discovered */
+  u8_t  engine_id_len;
+  s32_t boots;
+  s32_t time;
+  /* latestReceivedEngineTime of RFC 3414 2.3 */
+  s32_t latest_time;
+  u32_t sync_ms;
+  /* the notification user, keyed for engine_id */
+  struct snmpv3_user_cache_entry user;
+  u32_t last_used;
+};
+
+struct snmpv3_remote_engine *snmpv3_remote_find(const ip_addr_t *addr, u16_t port);
+struct snmpv3_remote_engine *snmpv3_remote_get(const ip_addr_t *addr, u16_t port);
+void snmpv3_remote_set_engine_id(struct snmpv3_remote_engine *remote, const u8_t *engine_id, u8_t engine_id_len);
+void snmpv3_remote_sync(struct snmpv3_remote_engine *remote, s32_t boots, s32_t engine_time);
+u8_t snmpv3_remote_is_synchronized(const struct snmpv3_remote_engine *remote);
+void snmpv3_remote_get_time(const struct snmpv3_remote_engine *remote, s32_t *boots, s32_t *engine_time);
+u8_t snmpv3_remote_in_time_window(const struct snmpv3_remote_engine *remote, s32_t boots, s32_t engine_time);
+err_t snmpv3_remote_set_user(struct snmpv3_remote_engine *remote, const char *name,
+                             snmpv3_auth_algo_t auth_algo, const u8_t *auth_key,
+                             snmpv3_priv_algo_t priv_algo, const u8_t *priv_key);
+#if LWIP_SNMP_V3_CRYPTO
+err_t snmpv3_remote_localize_user(struct snmpv3_remote_engine *remote, const char *name,
+                                  snmpv3_auth_algo_t auth_algo, const u8_t *auth_ku,
+                                  snmpv3_priv_algo_t priv_algo, const u8_t *priv_ku);
+#endif
+u8_t snmpv3_remote_is_ready(const struct snmpv3_remote_engine *remote, const char *name);
+void snmpv3_remote_remove(struct snmpv3_remote_engine *remote);
+void snmpv3_remote_users_changed(void);
+#endif
 void snmpv3_enginetime_timer(void *arg);
 
 #endif
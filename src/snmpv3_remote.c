@@ -0,0 +1,345 @@
+/**
+ * @file
+ * Cache of remote SNMPv3 engines (RFC 3414 2.3 and 3.2.7).
+ *
+ * For INFORMs the receiver is the authoritative engine. The sender has to
+ * learn its snmpEngineID, snmpEngineBoots and snmpEngineTime by discovery
+ * and to localize the keys of the notification user for that engine ID.
+ * This cache keeps SNMP_V3_REMOTE_ENGINES such engines by address and
+ * port, with their boots, the time as an offset to sys_now(), and the user
+ * with HMAC and cipher contexts keyed for the remote engine ID, so that an
+ * INFORM to a known target needs no discovery round trip and costs one HMAC
+ * and one cipher pass. The least recently used entry is replaced.
+ *
+ * The remote clock is estimated from the last synchronization. Entries not
+ * synchronized for SNMP_V3_REMOTE_ENGINE_MAX_AGE ms are treated as
+ * unsynchronized again; engine ID and keys are kept.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ */
+
+#include "lwip/apps/snmp_opts.h"
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && (SNMP_V3_REMOTE_ENGINES > 0)
+
+#include <string.h>
+
+#include "lwip/apps/snmpv3.h"
+#include "lwip/sys.h"
+#include "snmpv3_priv.h"
+#include "snmp_core_priv.h"
+
+/* RFC 3414 2.2.2: snmpEngineBoots latches at 2^31 - 1 */
+#define SNMP_V3_REMOTE_MAX_TIME_BOOT 2147483647L
+/* RFC 3414 3.2.7: messages more than 150 seconds old are not accepted */
+#define SNMP_V3_REMOTE_TIME_WINDOW   150
+
+static struct snmpv3_remote_engine snmpv3_remote_engines[SNMP_V3_REMOTE_ENGINES];
+static u32_t snmpv3_remote_tick;
+
+static void
+snmpv3_remote_release_user(struct snmpv3_remote_engine *remote)
+{
+#if LWIP_SNMP_V3_CRYPTO
+  if (remote->user.valid) {
+    snmpv3_crypto_user_release(remote->user.slot);
+  }
+#endif
+  remote->user.valid = 0;
+}
+
+static void
+snmpv3_remote_reset(struct snmpv3_remote_engine *remote)
+{
+  snmpv3_remote_release_user(remote);
+  memset(remote, 0, sizeof(*remote));
+  remote->user.slot = (u8_t)(SNMP_V3_USER_CACHE_ENTRIES + (remote - snmpv3_remote_engines));
+}
+
+/**
+ * Look up a remote engine by address and port.
+ * @return the entry, or NULL if the target is not cached
+ */
+struct snmpv3_remote_engine *
+snmpv3_remote_find(const ip_addr_t *addr, u16_t port)
+{
+  struct snmpv3_remote_engine *remote;
+  u8_t i;
+
+  for (i = 0; i < SNMP_V3_REMOTE_ENGINES; i++) {
+    remote = &snmpv3_remote_engines[i];
+    if (remote->in_use && (remote->port == port) && ip_addr_cmp(&remote->addr, addr)) {
+      remote->last_used = ++snmpv3_remote_tick;
+      return remote;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Look up a remote engine, or replace the least recently used entry with
+ * an undiscovered one for this target.
+ */
+struct snmpv3_remote_engine *
+snmpv3_remote_get(const ip_addr_t *addr, u16_t port)
+{
+  struct snmpv3_remote_engine *remote = snmpv3_remote_find(addr, port);
+  struct snmpv3_remote_engine *victim = NULL;
+  u8_t i;
+
+  if (remote != NULL) {
+    return remote;
+  }
+  for (i = 0; i < SNMP_V3_REMOTE_ENGINES; i++) {
+    remote = &snmpv3_remote_engines[i];
+    if (!remote->in_use) {
+      victim = remote;
+      break;
+    }
+    if ((victim == NULL) || (remote->last_used < victim->last_used)) {
+      victim = remote;
+    }
+  }
+
+  snmpv3_remote_reset(victim);
+  ip_addr_copy(victim->addr, *addr);
+  victim->port = port;
+  victim->in_use = 1;
+  victim->last_used = ++snmpv3_remote_tick;
+  return victim;
+}
+
+/**
+ * Store the snmpEngineID learned from a discovery REPORT. A different ID
+ * means another engine: its clock and the keys of the user are dropped.
+ */
+void
+snmpv3_remote_set_engine_id(struct snmpv3_remote_engine *remote, const u8_t *engine_id, u8_t engine_id_len)
+{
+  if ((engine_id_len == 0) || (engine_id_len > SNMP_V3_MAX_ENGINE_ID_LENGTH)) {
+    return;
+  }
+  if ((remote->engine_id_len == engine_id_len) && (memcmp(remote->engine_id, engine_id, engine_id_len) == 0)) {
+    return;
+  }
+  snmpv3_remote_release_user(remote);
+  MEMCPY(remote->engine_id, engine_id, engine_id_len);
+  remote->engine_id_len = engine_id_len;
+  remote->synchronized = 0;
+}
+
+/**
+ * Update the clock of a remote engine from msgAuthoritativeEngineBoots/-Time
+ * of an authentic message or a notInTimeWindow REPORT (RFC 3414 3.2.7 b):
+ * only newer values are taken, unless the entry is not synchronized.
+ */
+void
+snmpv3_remote_sync(struct snmpv3_remote_engine *remote, s32_t boots, s32_t engine_time)
+{
+  if ((boots < 0) || (engine_time < 0)) {
+    return;
+  }
+  if (!snmpv3_remote_is_synchronized(remote) ||
+      (boots > remote->boots) ||
+      ((boots == remote->boots) && (engine_time > remote->latest_time))) {
+    remote->boots = boots;
+    remote->time = engine_time;
+    remote->latest_time = engine_time;
+    remote->sync_ms = sys_now();
+    remote->synchronized = 1;
+  }
+}
+
+/**
+ * @return 1 if boots and time were synchronized within
+ * SNMP_V3_REMOTE_ENGINE_MAX_AGE ms
+ */
+u8_t
+snmpv3_remote_is_synchronized(const struct snmpv3_remote_engine *remote)
+{
+  return (u8_t)(remote->synchronized && ((u32_t)(sys_now() - remote->sync_ms) < SNMP_V3_REMOTE_ENGINE_MAX_AGE));
+}
+
+/**
+ * Estimate the current snmpEngineBoots and snmpEngineTime of a synchronized
+ * remote engine, for msgAuthoritativeEngineBoots/-Time of outgoing messages.
+ */
+void
+snmpv3_remote_get_time(const struct snmpv3_remote_engine *remote, s32_t *boots, s32_t *engine_time)
+{
+  s32_t elapsed = (s32_t)((u32_t)(sys_now() - remote->sync_ms) / 1000);
+
+  *boots = remote->boots;
+  if (remote->time > SNMP_V3_REMOTE_MAX_TIME_BOOT - elapsed) {
+    *engine_time = SNMP_V3_REMOTE_MAX_TIME_BOOT;
+  } else {
+    *engine_time = remote->time + elapsed;
+  }
+}
+
+/**
+ * The timeliness check of the non-authoritative side (RFC 3414 3.2.7 b)
+ * for an authentic message from a remote engine.
+ * @return 1 if the message is in the time window
+ */
+u8_t
+snmpv3_remote_in_time_window(const struct snmpv3_remote_engine *remote, s32_t boots, s32_t engine_time)
+{
+  s32_t local_boots;
+  s32_t local_time;
+
+  if (!snmpv3_remote_is_synchronized(remote) || (boots == SNMP_V3_REMOTE_MAX_TIME_BOOT)) {
+    return 0;
+  }
+  snmpv3_remote_get_time(remote, &local_boots, &local_time);
+  /* the boots of the cached engine are latched at their maximum */
+  if (local_boots == SNMP_V3_REMOTE_MAX_TIME_BOOT) {
+    return 0;
+  }
+  if (boots < local_boots) {
+    return 0;
+  }
+  if ((boots == local_boots) && (engine_time < local_time - SNMP_V3_REMOTE_TIME_WINDOW)) {
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Key the notification user of a remote engine with keys localized for
+ * its engine ID. The keys are only kept in the crypto contexts.
+ */
+err_t
+snmpv3_remote_set_user(struct snmpv3_remote_engine *remote, const char *name,
+                       snmpv3_auth_algo_t auth_algo, const u8_t *auth_key,
+                       snmpv3_priv_algo_t priv_algo, const u8_t *priv_key)
+{
+  size_t name_len = strlen(name);
+
+  if ((remote->engine_id_len == 0) || (name_len > SNMP_V3_MAX_USER_LENGTH)) {
+    return ERR_VAL;
+  }
+  snmpv3_remote_release_user(remote);
+#if LWIP_SNMP_V3_CRYPTO
+  if (snmpv3_crypto_user_setup(remote->user.slot, auth_algo, auth_key, priv_algo, priv_key) != ERR_OK) {
+    snmpv3_crypto_user_release(remote->user.slot);
+    return ERR_VAL;
+  }
+#else
+  LWIP_UNUSED_ARG(auth_key);
+  LWIP_UNUSED_ARG(priv_key);
+  if ((auth_algo != SNMP_V3_AUTH_ALGO_INVAL) || (priv_algo != SNMP_V3_PRIV_ALGO_INVAL)) {
+    return ERR_VAL;
+  }
+#endif
+  MEMCPY(remote->user.name, name, name_len + 1);
+  remote->user.name_len = (u8_t)name_len;
+  remote->user.auth_algo = auth_algo;
+  remote->user.priv_algo = priv_algo;
+  remote->user.valid = 1;
+  return ERR_OK;
+}
+
+#if LWIP_SNMP_V3_CRYPTO
+/**
+ * Like snmpv3_remote_set_user(), with the engine independent keys Ku of
+ * snmpv3_password_to_ku(): costs one hash per key instead of the
+ * password to key algorithm.
+ */
+err_t
+snmpv3_remote_localize_user(struct snmpv3_remote_engine *remote, const char *name,
+                            snmpv3_auth_algo_t auth_algo, const u8_t *auth_ku,
+                            snmpv3_priv_algo_t priv_algo, const u8_t *priv_ku)
+{
+  u8_t auth_key[SNMP_V3_MAX_KEY_LENGTH];
+  u8_t priv_key[SNMP_V3_MAX_KEY_LENGTH];
+  err_t err = ERR_OK;
+
+  if (remote->engine_id_len == 0) {
+    return ERR_VAL;
+  }
+  if (auth_algo != SNMP_V3_AUTH_ALGO_INVAL) {
+    err = snmpv3_localize_key(auth_algo, auth_ku, remote->engine_id, remote->engine_id_len, auth_key);
+  }
+  if ((err == ERR_OK) && (priv_algo != SNMP_V3_PRIV_ALGO_INVAL)) {
+    /* the privacy key is localized with the authentication hash */
+    err = snmpv3_localize_key(auth_algo, priv_ku, remote->engine_id, remote->engine_id_len, priv_key);
+  }
+  if (err == ERR_OK) {
+    err = snmpv3_remote_set_user(remote, name, auth_algo, auth_key, priv_algo, priv_key);
+  }
+  memset(auth_key, 0, sizeof(auth_key));
+  memset(priv_key, 0, sizeof(priv_key));
+  return err;
+}
+#endif /* LWIP_SNMP_V3_CRYPTO */
+
+/**
+ * @return 1 if a message of the user can be sent to the remote engine
+ * without discovery: engine ID known, clock synchronized, user keyed
+ */
+u8_t
+snmpv3_remote_is_ready(const struct snmpv3_remote_engine *remote, const char *name)
+{
+  return (u8_t)((remote->engine_id_len != 0) && snmpv3_remote_is_synchronized(remote) &&
+                remote->user.valid && (strcmp(remote->user.name, name) == 0));
+}
+
+/** Forget a remote engine, e.g. after a usmStatsUnknownEngineIDs REPORT */
+void
+snmpv3_remote_remove(struct snmpv3_remote_engine *remote)
+{
+  snmpv3_remote_reset(remote);
+}
+
+/** Called by snmpv3_users_changed(): the keys of the users may be outdated */
+void
+snmpv3_remote_users_changed(void)
+{
+  u8_t i;
+
+  for (i = 0; i < SNMP_V3_REMOTE_ENGINES; i++) {
+    snmpv3_remote_release_user(&snmpv3_remote_engines[i]);
+  }
+}
+
+/**
+ * @ingroup snmpv3
+ * Forget all remote engines, INFORMs discover them again.
+ */
+void
+snmpv3_remote_engines_flush(void)
+{
+  u8_t i;
+
+  SNMP_CORE_LOCK();
+  for (i = 0; i < SNMP_V3_REMOTE_ENGINES; i++) {
+    snmpv3_remote_reset(&snmpv3_remote_engines[i]);
+  }
+  SNMP_CORE_UNLOCK();
+}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && (SNMP_V3_REMOTE_ENGINES > 0) */
@@ -0,0 +1,561 @@
+/**
+ * @file
+ * SNMP zephyr frontend: hash indexed SNMPv3 user store.
+ *
+ * Users live in a table of SNMP_V3_USER_STORE_USERS entries with two
+ * indexes. Buckets of 16-bit entry numbers chain the users by an FNV-1a hash
+ * of their (engine ID, name) for the lookups of message processing. The
+ * order array holds the entry numbers sorted like the usmUserTable index,
+ * engine ID length, engine ID, name length, name, so a GetNext is a binary
+ * search instead of a scan over all users. Unused entries are chained in a
+ * free list through the same next field as the buckets.
+ */
+
+/*
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <lwip/apps/snmp_opts.h>
+
+#if LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_USER_STORE
+
+	#include "lwip/apps/snmpv3.h"
+	#include "lwip/apps/snmpv3_user_store.h"
+	#include "snmpv3_priv.h"
+
+	BUILD_ASSERT( SNMP_V3_USER_STORE_USERS < 0xFFFFU, "SNMP_V3_USER_STORE_USERS must fit 16-bit entry numbers" );
+	BUILD_ASSERT( SNMP_V3_USER_STORE_MAX_ENGINE_ID_LEN == SNMP_V3_MAX_ENGINE_ID_LENGTH, "engine ID length mismatch" );
+	BUILD_ASSERT( SNMP_V3_USER_STORE_MAX_NAME_LEN == SNMP_V3_MAX_USER_LENGTH, "user name length mismatch" );
+
+	#define STORE_NONE     0xFFFFU
+	/* a power of two with at most one user per bucket on average */
+	#define STORE_BUCKETS                          \
+		( ( SNMP_V3_USER_STORE_USERS <= 16 ) ? 16 :   \
+		  ( SNMP_V3_USER_STORE_USERS <= 64 ) ? 64 :   \
+		  ( SNMP_V3_USER_STORE_USERS <= 256 ) ? 256 : \
+		  ( SNMP_V3_USER_STORE_USERS <= 1024 ) ? 1024 : 4096 )
+
+	struct store_user
+	{
+		u8_t engine_id[ SNMP_V3_MAX_ENGINE_ID_LENGTH ];
+		u8_t engine_id_len;
+		char name[ SNMP_V3_MAX_USER_LENGTH + 1 ];
+		u8_t name_len;
+		u8_t auth_algo;
+		u8_t priv_algo;
+		u8_t storagetype;
+		/* next entry of the bucket, or of the free list */
+		u16_t next;
+		u8_t auth_key[ SNMP_V3_MAX_KEY_LENGTH ];
+		u8_t priv_key[ SNMP_V3_MAX_KEY_LENGTH ];
+	};
+
+	/* An (engine ID, name) pair, the key of both indexes. */
+	struct store_key
+	{
+		const u8_t * engine_id;
+		u8_t engine_id_len;
+		const char * name;
+		u8_t name_len;
+	};
+
+	static struct store_user store_users[ SNMP_V3_USER_STORE_USERS ];
+	static u16_t store_buckets[ STORE_BUCKETS ];
+	/* entry numbers in usmUserTable order, store_count of them are valid */
+	static u16_t store_order[ SNMP_V3_USER_STORE_USERS ];
+	static u16_t store_count;
+	static u16_t store_free;
+	static bool store_ready;
+
+	/* Protects all of the above. Held for lookups, copies and the move of
+	 * the order array, which is bounded by SNMP_V3_USER_STORE_USERS. */
+	static K_MUTEX_DEFINE( store_lock );
+
+	/* Call with store_lock held. */
+	static void store_init( void )
+	{
+		u16_t i;
+
+		if( store_ready )
+		{
+			return;
+		}
+		for( i = 0; i < STORE_BUCKETS; i++ )
+		{
+			store_buckets[ i ] = STORE_NONE;
+		}
+		for( i = 0; i < SNMP_V3_USER_STORE_USERS; i++ )
+		{
+			store_users[ i ].next = ( u16_t ) ( i + 1U );
+		}
+		store_users[ SNMP_V3_USER_STORE_USERS - 1 ].next = STORE_NONE;
+		store_free = 0;
+		store_ready = true;
+	}
+
+	/* localized keys are as long as the digest of the authentication hash */
+	static size_t store_key_len( snmpv3_auth_algo_t auth_algo )
+	{
+		static const u8_t key_lens[] =
+		{
+			[ SNMP_V3_AUTH_ALGO_MD5 ]    = SNMP_V3_MD5_LEN,
+			[ SNMP_V3_AUTH_ALGO_SHA ]    = SNMP_V3_SHA_LEN,
+			[ SNMP_V3_AUTH_ALGO_SHA224 ] = SNMP_V3_SHA224_LEN,
+			[ SNMP_V3_AUTH_ALGO_SHA256 ] = SNMP_V3_SHA256_LEN,
+			[ SNMP_V3_AUTH_ALGO_SHA384 ] = SNMP_V3_SHA384_LEN,
+			[ SNMP_V3_AUTH_ALGO_SHA512 ] = SNMP_V3_SHA512_LEN,
+		};
+
+		return key_lens[ auth_algo ];
+	}
+
+	static void store_local_key( struct store_key * key, const char * name, u8_t name_len )
+	{
+		const char * engine_id;
+
+		snmpv3_get_engine_id( &engine_id, &key->engine_id_len );
+		key->engine_id = ( const u8_t * ) engine_id;
+		key->name = name;
+		key->name_len = name_len;
+	}
+
+	/* Fills key, takes the current engine ID when engine_id is NULL. */
+	static bool store_make_key( struct store_key * key, const u8_t * engine_id, u8_t engine_id_len, const char * name )
+	{
+		size_t name_len = ( name != NULL ) ? strlen( name ) : 0U;
+
+		if( ( name_len == 0U ) || ( name_len > SNMP_V3_MAX_USER_LENGTH ) )
+		{
+			return false;
+		}
+		store_local_key( key, name, ( u8_t ) name_len );
+		if( engine_id != NULL )
+		{
+			if( ( engine_id_len == 0U ) || ( engine_id_len > SNMP_V3_MAX_ENGINE_ID_LENGTH ) )
+			{
+				return false;
+			}
+			key->engine_id = engine_id;
+			key->engine_id_len = engine_id_len;
+		}
+		return true;
+	}
+
+	static u16_t store_hash( const struct store_key * key )
+	{
+		u32_t hash = 2166136261UL;
+		u8_t i;
+
+		for( i = 0; i < key->engine_id_len; i++ )
+		{
+			hash = ( hash ^ key->engine_id[ i ] ) * 16777619UL;
+		}
+		for( i = 0; i < key->name_len; i++ )
+		{
+			hash = ( hash ^ ( u8_t ) key->name[ i ] ) * 16777619UL;
+		}
+		return ( u16_t ) ( ( hash ^ ( hash >> 16 ) ) & ( STORE_BUCKETS - 1U ) );
+	}
+
+	/* usmUserTable order: the lengths come before the octets, so shorter
+	 * engine IDs and names sort first. */
+	static int store_compare( const struct store_user * user, const struct store_key * key )
+	{
+		int rc;
+
+		if( user->engine_id_len != key->engine_id_len )
+		{
+			return ( int ) user->engine_id_len - ( int ) key->engine_id_len;
+		}
+		rc = memcmp( user->engine_id, key->engine_id, key->engine_id_len );
+		if( rc != 0 )
+		{
+			return rc;
+		}
+		if( user->name_len != key->name_len )
+		{
+			return ( int ) user->name_len - ( int ) key->name_len;
+		}
+		return memcmp( user->name, key->name, key->name_len );
+	}
+
+	/* Compares the index OID of a user with a possibly partial index. */
+	static int store_compare_index( const struct store_user * user, const u32_t * index, u8_t index_len )
+	{
+		u8_t arcs = ( u8_t ) ( 2U + user->engine_id_len + user->name_len );
+		u8_t i;
+
+		for( i = 0; ( i < arcs ) && ( i < index_len ); i++ )
+		{
+			u32_t arc;
+
+			if( i == 0U )
+			{
+				arc = user->engine_id_len;
+			}
+			else if( i <= user->engine_id_len )
+			{
+				arc = user->engine_id[ i - 1U ];
+			}
+			else if( i == user->engine_id_len + 1U )
+			{
+				arc = user->name_len;
+			}
+			else
+			{
+				arc = ( u8_t ) user->name[ i - 2U - user->engine_id_len ];
+			}
+			if( arc != index[ i ] )
+			{
+				return ( arc < index[ i ] ) ? -1 : 1;
+			}
+		}
+		return ( int ) arcs - ( int ) index_len;
+	}
+
+	/* Position of the first user in store_order that does not sort before
+	 * key. Call with store_lock held. */
+	static u16_t store_lower_bound( const struct store_key * key )
+	{
+		u16_t lo = 0;
+		u16_t hi = store_count;
+
+		while( lo < hi )
+		{
+			u16_t mid = ( u16_t ) ( lo + ( ( hi - lo ) / 2U ) );
+
+			if( store_compare( &store_users[ store_order[ mid ] ], key ) < 0 )
+			{
+				lo = ( u16_t ) ( mid + 1U );
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		return lo;
+	}
+
+	/* Call with store_lock held. */
+	static u16_t store_find( const struct store_key * key )
+	{
+		u16_t i = store_buckets[ store_hash( key ) ];
+
+		while( ( i != STORE_NONE ) && ( store_compare( &store_users[ i ], key ) != 0 ) )
+		{
+			i = store_users[ i ].next;
+		}
+		return i;
+	}
+
+	static void store_copy_info( const struct store_user * user, struct snmpv3_user_store_info * info )
+	{
+		memcpy( info->engine_id, user->engine_id, user->engine_id_len );
+		info->engine_id_len = user->engine_id_len;
+		memcpy( info->name, user->name, sizeof( info->name ) );
+		info->name_len = user->name_len;
+		info->auth_algo = ( snmpv3_auth_algo_t ) user->auth_algo;
+		info->priv_algo = ( snmpv3_priv_algo_t ) user->priv_algo;
+		info->storagetype = ( snmpv3_user_storagetype_t ) user->storagetype;
+	}
+
+	/* The users of the current engine ID are adjacent in store_order: sets
+	 * first to the position of the first one and returns their number. */
+	static u16_t store_local_range( u16_t * first )
+	{
+		struct store_key key;
+		u16_t lo;
+		u16_t hi;
+
+		/* no name sorts before the empty one */
+		store_local_key( &key, "", 0U );
+		lo = store_lower_bound( &key );
+		for( hi = lo; hi < store_count; hi++ )
+		{
+			const struct store_user * user = &store_users[ store_order[ hi ] ];
+
+			if( ( user->engine_id_len != key.engine_id_len ) ||
+				( memcmp( user->engine_id, key.engine_id, key.engine_id_len ) != 0 ) )
+			{
+				break;
+			}
+		}
+		*first = lo;
+		return ( u16_t ) ( hi - lo );
+	}
+
+	int snmpv3_user_store_add( const u8_t * engine_id, u8_t engine_id_len, const char * name,
+							   snmpv3_auth_algo_t auth_algo, const u8_t * auth_key,
+							   snmpv3_priv_algo_t priv_algo, const u8_t * priv_key,
+							   snmpv3_user_storagetype_t storagetype )
+	{
+		struct store_key key;
+		struct store_user * user;
+		u16_t i;
+
+		if( !store_make_key( &key, engine_id, engine_id_len, name ) ||
+			( auth_algo > SNMP_V3_AUTH_ALGO_SHA512 ) || ( priv_algo > SNMP_V3_PRIV_ALGO_AES256 ) ||
+			( ( auth_algo != SNMP_V3_AUTH_ALGO_INVAL ) && ( auth_key == NULL ) ) ||
+			( ( priv_algo != SNMP_V3_PRIV_ALGO_INVAL ) &&
+			  ( ( priv_key == NULL ) || ( auth_algo == SNMP_V3_AUTH_ALGO_INVAL ) ) ) )
+		{
+			return -EINVAL;
+		}
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		store_init();
+		i = store_find( &key );
+		if( i == STORE_NONE )
+		{
+			u16_t bucket = store_hash( &key );
+			u16_t pos;
+
+			if( store_free == STORE_NONE )
+			{
+				k_mutex_unlock( &store_lock );
+				return -ENOMEM;
+			}
+			/* the key may point to the current engine ID, sort before copying */
+			pos = store_lower_bound( &key );
+			i = store_free;
+			user = &store_users[ i ];
+			store_free = user->next;
+
+			memcpy( user->engine_id, key.engine_id, key.engine_id_len );
+			user->engine_id_len = key.engine_id_len;
+			memcpy( user->name, name, key.name_len );
+			user->name[ key.name_len ] = '\0';
+			user->name_len = key.name_len;
+			user->next = store_buckets[ bucket ];
+			store_buckets[ bucket ] = i;
+
+			memmove( &store_order[ pos + 1U ], &store_order[ pos ], ( store_count - pos ) * sizeof( store_order[ 0 ] ) );
+			store_order[ pos ] = i;
+			store_count++;
+		}
+		user = &store_users[ i ];
+		user->auth_algo = ( u8_t ) auth_algo;
+		user->priv_algo = ( u8_t ) priv_algo;
+		user->storagetype = ( u8_t ) storagetype;
+		memset( user->auth_key, 0, sizeof( user->auth_key ) );
+		memset( user->priv_key, 0, sizeof( user->priv_key ) );
+		if( auth_algo != SNMP_V3_AUTH_ALGO_INVAL )
+		{
+			memcpy( user->auth_key, auth_key, store_key_len( auth_algo ) );
+		}
+		if( priv_algo != SNMP_V3_PRIV_ALGO_INVAL )
+		{
+			/* the privacy key is localized with the authentication hash */
+			memcpy( user->priv_key, priv_key, store_key_len( auth_algo ) );
+		}
+		k_mutex_unlock( &store_lock );
+
+		snmpv3_users_changed();
+		return 0;
+	}
+
+	int snmpv3_user_store_remove( const u8_t * engine_id, u8_t engine_id_len, const char * name )
+	{
+		struct store_key key;
+		u16_t * link;
+		u16_t pos;
+		u16_t i;
+
+		if( !store_make_key( &key, engine_id, engine_id_len, name ) )
+		{
+			return -ENOENT;
+		}
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		store_init();
+		link = &store_buckets[ store_hash( &key ) ];
+		while( ( *link != STORE_NONE ) && ( store_compare( &store_users[ *link ], &key ) != 0 ) )
+		{
+			link = &store_users[ *link ].next;
+		}
+		i = *link;
+		if( i == STORE_NONE )
+		{
+			k_mutex_unlock( &store_lock );
+			return -ENOENT;
+		}
+		*link = store_users[ i ].next;
+
+		pos = store_lower_bound( &key );
+		store_count--;
+		memmove( &store_order[ pos ], &store_order[ pos + 1U ], ( store_count - pos ) * sizeof( store_order[ 0 ] ) );
+
+		memset( &store_users[ i ], 0, sizeof( store_users[ i ] ) );
+		store_users[ i ].next = store_free;
+		store_free = i;
+		k_mutex_unlock( &store_lock );
+
+		snmpv3_users_changed();
+		return 0;
+	}
+
+	u16_t snmpv3_user_store_count( void )
+	{
+		return store_count;
+	}
+
+	err_t snmpv3_user_store_find( const u8_t * engine_id, u8_t engine_id_len,
+								  const char * name, u8_t name_len, struct snmpv3_user_store_info * info )
+	{
+		struct store_key key = { engine_id, engine_id_len, name, name_len };
+		err_t err = ERR_VAL;
+		u16_t i;
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		store_init();
+		i = store_find( &key );
+		if( i != STORE_NONE )
+		{
+			store_copy_info( &store_users[ i ], info );
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &store_lock );
+		return err;
+	}
+
+	err_t snmpv3_user_store_next( const u32_t * index, u8_t index_len, struct snmpv3_user_store_info * info )
+	{
+		err_t err = ERR_VAL;
+		u16_t lo = 0;
+		u16_t hi;
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		/* first user whose index is greater than the given one */
+		hi = store_count;
+		while( lo < hi )
+		{
+			u16_t mid = ( u16_t ) ( lo + ( ( hi - lo ) / 2U ) );
+
+			if( store_compare_index( &store_users[ store_order[ mid ] ], index, index_len ) <= 0 )
+			{
+				lo = ( u16_t ) ( mid + 1U );
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		if( lo < store_count )
+		{
+			store_copy_info( &store_users[ store_order[ lo ] ], info );
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &store_lock );
+		return err;
+	}
+
+	err_t snmpv3_user_store_get_user( const char * username, snmpv3_auth_algo_t * auth_algo, u8_t * auth_key,
+									  snmpv3_priv_algo_t * priv_algo, u8_t * priv_key )
+	{
+		struct store_key key;
+		err_t err = ERR_VAL;
+		u16_t i;
+
+		store_local_key( &key, username, ( u8_t ) strnlen( username, SNMP_V3_MAX_USER_LENGTH + 1U ) );
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		store_init();
+		i = store_find( &key );
+		if( i != STORE_NONE )
+		{
+			const struct store_user * user = &store_users[ i ];
+
+			if( auth_algo != NULL )
+			{
+				*auth_algo = ( snmpv3_auth_algo_t ) user->auth_algo;
+			}
+			if( auth_key != NULL )
+			{
+				memcpy( auth_key, user->auth_key, sizeof( user->auth_key ) );
+			}
+			if( priv_algo != NULL )
+			{
+				*priv_algo = ( snmpv3_priv_algo_t ) user->priv_algo;
+			}
+			if( priv_key != NULL )
+			{
+				memcpy( priv_key, user->priv_key, sizeof( user->priv_key ) );
+			}
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &store_lock );
+		return err;
+	}
+
+	u8_t snmpv3_user_store_get_amount_of_users( void )
+	{
+		u16_t first;
+		u16_t count;
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		count = store_local_range( &first );
+		k_mutex_unlock( &store_lock );
+		return ( count > 0xFFU ) ? 0xFFU : ( u8_t ) count;
+	}
+
+	err_t snmpv3_user_store_get_username( char * username, u8_t index )
+	{
+		err_t err = ERR_VAL;
+		u16_t first;
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		if( index < store_local_range( &first ) )
+		{
+			strcpy( username, store_users[ store_order[ first + index ] ].name );
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &store_lock );
+		return err;
+	}
+
+	err_t snmpv3_user_store_get_user_storagetype( const char * username, snmpv3_user_storagetype_t * storagetype )
+	{
+		struct store_key key;
+		err_t err = ERR_VAL;
+		u16_t i;
+
+		store_local_key( &key, username, ( u8_t ) strnlen( username, SNMP_V3_MAX_USER_LENGTH + 1U ) );
+
+		k_mutex_lock( &store_lock, K_FOREVER );
+		store_init();
+		i = store_find( &key );
+		if( i != STORE_NONE )
+		{
+			*storagetype = ( snmpv3_user_storagetype_t ) store_users[ i ].storagetype;
+			err = ERR_OK;
+		}
+		k_mutex_unlock( &store_lock );
+		return err;
+	}
+
+#endif /* LWIP_SNMP && LWIP_SNMP_V3 && SNMP_V3_USER_STORE */